@@ -0,0 +1,773 @@
+/**
+ * @file bench_aes.c
+ * @brief Throughput and latency benchmarks for every backend, mode and key size.
+ *
+ * @details Usage:
+ *
+ *     bench_aes [-b BACKENDS] [-m OPERATIONS] [-k KEYBITS] [-s MINSIZE] [-S MAXSIZE] [-t MS] [-f csv|json]
+ *
+ * Lists are comma-separated; "all" selects every supported backend or every
+ * operation. Each measurement repeats the operation in samples of at least
+ * BENCH_SAMPLE_NS, calibrated once, until the time budget is spent. A row
+ * reports the mean time per call, the throughput, cycles per byte and the
+ * 50th/90th/99th percentile of the per-call time across samples. Bulk modes
+ * run at every power-of-four message size from MINSIZE to MAXSIZE; key
+ * expansion and single blocks run once per key size, with the key or block
+ * size as their byte count. key_expansion_encrypt derives the encryption
+ * schedule only, and key_batch initializes BENCH_KEY_BATCH contexts per call
+ * with aes_ctx_init_batch(). cbc_encrypt_multi splits each message into
+ * BENCH_CBC_STREAMS independent streams for aes_cbc_encrypt_multi(), to
+ * compare with the serial chain of cbc_encrypt at the same size.
+ *
+ * Cycles come from the CPU cycle counter through perf_event_open(2) when the
+ * kernel allows it (which also provides retired instructions), from the time
+ * stamp counter on x86 otherwise (reference cycles at the nominal frequency),
+ * and are left empty when neither is available. The cycles_source column says
+ * which one was used.
+ */
+
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE // syscall()
+#endif
+#define _POSIX_C_SOURCE 200809L
+
+#include "../include/aes.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_HAVE_TSC 1
+#endif
+
+/* ============================================================================
+ * Constants and Types
+ * ========================================================================= */
+
+// Each sample runs the operation for at least this long, so timer overhead stays small.
+#define BENCH_SAMPLE_NS 20000
+
+// Measurements take at least this many samples, whatever the time budget.
+#define BENCH_MIN_SAMPLES 3
+
+// Contexts initialized by each key_batch call.
+#define BENCH_KEY_BATCH 16
+
+// Independent streams each cbc_encrypt_multi message is split into.
+#define BENCH_CBC_STREAMS 8
+
+// Upper bound on the samples kept for the percentiles.
+#define BENCH_MAX_SAMPLES 4096
+
+//! The benchmarked operations.
+typedef enum
+{
+    OP_KEY_EXPANSION,
+    OP_KEY_EXPANSION_ENCRYPT,
+    OP_KEY_BATCH,
+    OP_BLOCK_ENCRYPT,
+    OP_BLOCK_DECRYPT,
+    OP_ECB_ENCRYPT,
+    OP_ECB_DECRYPT,
+    OP_CTR,
+    OP_CBC_ENCRYPT,
+    OP_CBC_DECRYPT,
+    OP_CBC_ENCRYPT_MULTI,
+    OP_XTS_ENCRYPT,
+    OP_XTS_DECRYPT,
+    OP_GCM_SEAL,
+    OP_GCM_OPEN,
+    OP_OCB_SEAL,
+    OP_OCB_OPEN,
+    OP_CMAC,
+    OP_PMAC,
+    OP_DRBG,
+    OP_COUNT
+} bench_op_t;
+
+//! Names of the operations, indexed by bench_op_t.
+static const char* const op_names[OP_COUNT] = {
+    "key_expansion",     "key_expansion_encrypt", "key_batch",   "block_encrypt", "block_decrypt",
+    "ecb_encrypt",       "ecb_decrypt",           "ctr",         "cbc_encrypt",   "cbc_decrypt",
+    "cbc_encrypt_multi", "xts_encrypt",           "xts_decrypt", "gcm_seal",      "gcm_open",
+    "ocb_seal",          "ocb_open",              "cmac",        "pmac",          "drbg",
+};
+
+//! Every explicit backend, in the order they are reported.
+static const aes_backend_t all_backends[] = {AES_BACKEND_REFERENCE, AES_BACKEND_TTABLE, AES_BACKEND_AESNI,
+                                             AES_BACKEND_BITSLICE, AES_BACKEND_VPAES};
+
+#define BACKEND_COUNT (sizeof(all_backends) / sizeof(all_backends[0]))
+
+//! Command-line options.
+typedef struct
+{
+    const char* backends;   /**< Comma-separated backend names, "auto" or "all". */
+    const char* operations; /**< Comma-separated operation names or "all". */
+    const char* key_bits;   /**< Comma-separated key sizes in bits. */
+    size_t      min_size;   /**< Smallest bulk message size. */
+    size_t      max_size;   /**< Largest bulk message size. */
+    uint64_t    budget_ns;  /**< Time spent on each measurement. */
+    int         json;       /**< Nonzero for JSON output, zero for CSV. */
+} bench_options_t;
+
+//! The keys, contexts and buffers an operation works on.
+typedef struct
+{
+    aes_backend_t    backend;
+    aes_key_size_t   key_size;
+    uint8_t          key[64];
+    aes_ctx_t        ctx;
+    aes_xts_ctx_t    xts;
+    aes_gcm_ctx_t    gcm;
+    aes_ocb_ctx_t    ocb;
+    aes_cmac_ctx_t   cmac;
+    aes_pmac_ctx_t   pmac;
+    aes_drbg_ctx_t   drbg;
+    aes_ctx_t        batch[BENCH_KEY_BATCH];
+    uint8_t          batch_keys[BENCH_KEY_BATCH * AES_KEY_SIZE_256];
+    uint8_t          iv[AES_BLOCK_SIZE];
+    uint8_t          stream_ivs[BENCH_CBC_STREAMS][AES_BLOCK_SIZE];
+    aes_cbc_stream_t streams[BENCH_CBC_STREAMS];
+    uint8_t          tag[AES_BLOCK_SIZE];
+    uint8_t*         in;
+    uint8_t*         out;
+} bench_state_t;
+
+//! The result of one measurement.
+typedef struct
+{
+    uint64_t calls;
+    double   ns_per_call;
+    double   gb_per_s;
+    double   cycles_per_byte;       /**< Negative when no cycle counter is available. */
+    double   instructions_per_byte; /**< Negative when no instruction counter is available. */
+    double   percentile_ns[3];      /**< 50th, 90th and 99th percentile per-call time. */
+} bench_result_t;
+
+/* ============================================================================
+ * Timers and Counters
+ * ========================================================================= */
+
+static int cycles_fd       = -1;
+static int instructions_fd = -1;
+
+/** @brief Returns a monotonic timestamp in nanoseconds. */
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+#ifdef __linux__
+/**
+ * @brief Opens a user-space hardware counter for the calling thread.
+ * @return The counter file descriptor, or -1 if it is not available.
+ */
+static int open_counter(uint64_t config)
+{
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.type           = PERF_TYPE_HARDWARE;
+    attr.size           = sizeof(attr);
+    attr.config         = config;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv     = 1;
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+/** @brief Reads a counter opened by open_counter(). */
+static uint64_t read_counter(int fd)
+{
+    uint64_t value = 0;
+    if (read(fd, &value, sizeof(value)) != (ssize_t)sizeof(value))
+        return 0;
+    return value;
+}
+#endif
+
+/** @brief Opens the hardware counters and returns the name of the cycle source. */
+static const char* open_counters(void)
+{
+#ifdef __linux__
+    cycles_fd       = open_counter(PERF_COUNT_HW_CPU_CYCLES);
+    instructions_fd = open_counter(PERF_COUNT_HW_INSTRUCTIONS);
+    if (cycles_fd >= 0)
+        return "perf";
+#endif
+#ifdef BENCH_HAVE_TSC
+    return "tsc";
+#else
+    return "none";
+#endif
+}
+
+/** @brief Reads the cycle source chosen by open_counters(). */
+static uint64_t read_cycles(void)
+{
+#ifdef __linux__
+    if (cycles_fd >= 0)
+        return read_counter(cycles_fd);
+#endif
+#ifdef BENCH_HAVE_TSC
+    return (uint64_t)__rdtsc();
+#else
+    return 0;
+#endif
+}
+
+/** @brief Reads the retired instruction counter, or 0 if it is not open. */
+static uint64_t read_instructions(void)
+{
+#ifdef __linux__
+    if (instructions_fd >= 0)
+        return read_counter(instructions_fd);
+#endif
+    return 0;
+}
+
+/* ============================================================================
+ * Operations
+ * ========================================================================= */
+
+/** @brief Returns nonzero if the operation takes a message size. */
+static int op_is_bulk(bench_op_t op)
+{
+    return op >= OP_ECB_ENCRYPT;
+}
+
+/** @brief Returns nonzero if the operation supports the key size; the DRBG is always AES-256. */
+static int op_supports_key(bench_op_t op, aes_key_size_t key_size)
+{
+    if (op == OP_DRBG)
+        return key_size == AES_KEY_SIZE_256;
+    return (op != OP_XTS_ENCRYPT && op != OP_XTS_DECRYPT) || key_size != AES_KEY_SIZE_192;
+}
+
+/** @brief aes_drbg_entropy_fn for the benchmark: the output is never used as randomness. */
+static int bench_entropy(void* arg, uint8_t* out, size_t length)
+{
+    memcpy(out, arg, length);
+    return 0;
+}
+
+/**
+ * @brief Sets up the keys and contexts for one backend and key size.
+ * @return AES_SUCCESS, or the error from the first failing setup call.
+ */
+static aes_error_t init_state(bench_state_t* state)
+{
+    aes_error_t result = aes_ctx_init_backend(&state->ctx, state->key, state->key_size, state->backend);
+    if (result == AES_SUCCESS)
+        result = aes_gcm_init(&state->gcm, state->key, state->key_size, state->backend);
+    if (result == AES_SUCCESS)
+        result = aes_ocb_init(&state->ocb, state->key, state->key_size, state->backend);
+    if (result == AES_SUCCESS)
+        result = aes_cmac_init(&state->cmac, state->key, state->key_size, state->backend);
+    if (result == AES_SUCCESS)
+        result = aes_pmac_init(&state->pmac, state->key, state->key_size, state->backend);
+    if (result == AES_SUCCESS)
+        result = aes_drbg_init(&state->drbg, bench_entropy, state->key, NULL, 0, state->backend);
+    if (result == AES_SUCCESS && state->key_size != AES_KEY_SIZE_192)
+        result = aes_xts_init(&state->xts, state->key, state->key_size, state->backend);
+    return result;
+}
+
+/**
+ * @brief Prepares the buffers before an operation is measured at a size:
+ * GCM and OCB open need a ciphertext and tag that verify, or they would
+ * measure the failure path, and cbc_encrypt_multi splits the message into
+ * streams whose lengths differ by at most one block.
+ */
+static void prepare_op(bench_state_t* state, bench_op_t op, size_t size)
+{
+    if (op == OP_CBC_ENCRYPT_MULTI)
+    {
+        size_t blocks = size / AES_BLOCK_SIZE, offset = 0;
+        for (size_t i = 0; i < BENCH_CBC_STREAMS; i++)
+        {
+            size_t length = (blocks / BENCH_CBC_STREAMS + (i < blocks % BENCH_CBC_STREAMS)) * AES_BLOCK_SIZE;
+            state->streams[i].ctx    = &state->ctx;
+            state->streams[i].iv     = state->stream_ivs[i];
+            state->streams[i].in     = state->in + offset;
+            state->streams[i].out    = state->out + offset;
+            state->streams[i].length = length;
+            offset += length;
+        }
+    }
+    if (op == OP_GCM_OPEN)
+        aes_gcm_seal(&state->gcm, state->iv, 12, NULL, 0, state->in, state->out, size, state->tag,
+                     sizeof(state->tag));
+    if (op == OP_OCB_OPEN)
+        aes_ocb_seal(&state->ocb, state->iv, 12, NULL, 0, state->in, state->out, size, state->tag,
+                     sizeof(state->tag));
+}
+
+/**
+ * @brief Runs one call of an operation.
+ * @details Decrypting operations read the output buffer, which holds valid
+ * ciphertext for GCM and OCB open, and write the input buffer.
+ */
+static void run_op(bench_state_t* state, bench_op_t op, size_t size)
+{
+    size_t sector_size = size < 4096 ? size : 4096;
+
+    switch (op)
+    {
+        case OP_KEY_EXPANSION:
+            aes_ctx_init_backend(&state->ctx, state->key, state->key_size, state->backend);
+            break;
+        case OP_KEY_EXPANSION_ENCRYPT:
+            aes_ctx_init_ex(&state->ctx, state->key, state->key_size, state->backend, AES_KEY_USAGE_ENCRYPT);
+            break;
+        case OP_KEY_BATCH:
+            aes_ctx_init_batch(state->batch, state->batch_keys, state->key_size, BENCH_KEY_BATCH, state->backend,
+                               AES_KEY_USAGE_BOTH);
+            break;
+        case OP_BLOCK_ENCRYPT:
+            aes_ctx_encrypt(&state->ctx, state->in, state->out);
+            break;
+        case OP_BLOCK_DECRYPT:
+            aes_ctx_decrypt(&state->ctx, state->out, state->in);
+            break;
+        case OP_ECB_ENCRYPT:
+            aes_ecb_encrypt(&state->ctx, state->in, state->out, size);
+            break;
+        case OP_ECB_DECRYPT:
+            aes_ecb_decrypt(&state->ctx, state->out, state->in, size);
+            break;
+        case OP_CTR:
+            aes_ctr_xcrypt(&state->ctx, state->iv, state->in, state->out, size);
+            break;
+        case OP_CBC_ENCRYPT:
+            aes_cbc_encrypt(&state->ctx, state->iv, state->in, state->out, size);
+            break;
+        case OP_CBC_DECRYPT:
+            aes_cbc_decrypt(&state->ctx, state->iv, state->out, state->in, size);
+            break;
+        case OP_CBC_ENCRYPT_MULTI:
+            aes_cbc_encrypt_multi(state->streams, BENCH_CBC_STREAMS);
+            break;
+        case OP_XTS_ENCRYPT:
+            aes_xts_encrypt_sectors(&state->xts, 0, sector_size, state->in, state->out, size / sector_size);
+            break;
+        case OP_XTS_DECRYPT:
+            aes_xts_decrypt_sectors(&state->xts, 0, sector_size, state->out, state->in, size / sector_size);
+            break;
+        case OP_GCM_SEAL:
+            aes_gcm_seal(&state->gcm, state->iv, 12, NULL, 0, state->in, state->out, size, state->tag,
+                         sizeof(state->tag));
+            break;
+        case OP_GCM_OPEN:
+            aes_gcm_open(&state->gcm, state->iv, 12, NULL, 0, state->out, state->in, size, state->tag,
+                         sizeof(state->tag));
+            break;
+        case OP_OCB_SEAL:
+            aes_ocb_seal(&state->ocb, state->iv, 12, NULL, 0, state->in, state->out, size, state->tag,
+                         sizeof(state->tag));
+            break;
+        case OP_OCB_OPEN:
+            aes_ocb_open(&state->ocb, state->iv, 12, NULL, 0, state->out, state->in, size, state->tag,
+                         sizeof(state->tag));
+            break;
+        case OP_CMAC:
+            aes_cmac_update(&state->cmac, state->in, size);
+            aes_cmac_final(&state->cmac, state->tag, sizeof(state->tag));
+            break;
+        case OP_PMAC:
+            aes_pmac_update(&state->pmac, state->in, size);
+            aes_pmac_final(&state->pmac, state->tag, sizeof(state->tag));
+            break;
+        case OP_DRBG:
+            aes_drbg_generate(&state->drbg, state->out, size);
+            break;
+        default:
+            break;
+    }
+}
+
+/* ============================================================================
+ * Measurement
+ * ========================================================================= */
+
+/** @brief qsort() comparison for doubles. */
+static int compare_doubles(const void* a, const void* b)
+{
+    double x = *(const double*)a;
+    double y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief Measures one operation at one size.
+ * @param[in,out] state The benchmark state.
+ * @param[in] op The operation.
+ * @param[in] size The message size (ignored by non-bulk operations).
+ * @param[in] bytes The bytes processed per call, for the per-byte figures.
+ * @param[in] budget_ns The time to spend on the measurement.
+ * @param[out] result The measurement.
+ */
+static void measure(bench_state_t* state, bench_op_t op, size_t size, size_t bytes, uint64_t budget_ns,
+                    bench_result_t* result)
+{
+    static double samples[BENCH_MAX_SAMPLES];
+    size_t        num_samples = 0;
+    uint64_t      reps        = 1;
+    uint64_t      total_ns = 0, total_cycles = 0, total_instructions = 0, calls = 0;
+
+    // Warm up, then double the repetitions until a sample is long enough to time.
+    run_op(state, op, size);
+    for (;;)
+    {
+        uint64_t start = now_ns();
+        for (uint64_t i = 0; i < reps; i++)
+            run_op(state, op, size);
+        if (now_ns() - start >= BENCH_SAMPLE_NS || reps >= (1u << 24))
+            break;
+        reps *= 2;
+    }
+
+    while (num_samples < BENCH_MAX_SAMPLES && (total_ns < budget_ns || num_samples < BENCH_MIN_SAMPLES))
+    {
+        uint64_t instructions = read_instructions();
+        uint64_t cycles       = read_cycles();
+        uint64_t start        = now_ns();
+        for (uint64_t i = 0; i < reps; i++)
+            run_op(state, op, size);
+        uint64_t elapsed = now_ns() - start;
+        total_cycles += read_cycles() - cycles;
+        total_instructions += read_instructions() - instructions;
+
+        total_ns += elapsed;
+        calls += reps;
+        samples[num_samples++] = (double)elapsed / (double)reps;
+    }
+
+    qsort(samples, num_samples, sizeof(samples[0]), compare_doubles);
+    static const double percentiles[3] = {0.50, 0.90, 0.99};
+    for (int i = 0; i < 3; i++)
+        result->percentile_ns[i] = samples[(size_t)(percentiles[i] * (double)(num_samples - 1) + 0.5)];
+
+    double total_bytes            = (double)bytes * (double)calls;
+    result->calls                 = calls;
+    result->ns_per_call           = (double)total_ns / (double)calls;
+    result->gb_per_s              = total_bytes / (double)total_ns;
+    result->cycles_per_byte       = total_cycles ? (double)total_cycles / total_bytes : -1.0;
+    result->instructions_per_byte = total_instructions ? (double)total_instructions / total_bytes : -1.0;
+}
+
+/* ============================================================================
+ * Output
+ * ========================================================================= */
+
+static const char* cycles_source = "none";
+static int         rows_printed  = 0;
+
+/** @brief Prints the CSV header or opens the JSON document. */
+static void print_header(const bench_options_t* options)
+{
+    if (options->json)
+        printf("{\n  \"cycles_source\": \"%s\",\n  \"results\": [", cycles_source);
+    else
+        printf("backend,operation,key_bits,bytes,calls,ns_per_call,gb_per_s,cycles_per_byte,p50_ns,p90_ns,p99_ns,"
+               "instructions_per_byte,cycles_source\n");
+}
+
+/** @brief Prints a value, or an empty CSV field / JSON null if it is negative. */
+static void print_optional(const bench_options_t* options, double value)
+{
+    if (value >= 0.0)
+        printf("%.3f", value);
+    else if (options->json)
+        printf("null");
+}
+
+/** @brief Prints one result row. */
+static void print_row(const bench_options_t* options, const char* backend, bench_op_t op, aes_key_size_t key_size,
+                      size_t bytes, const bench_result_t* r)
+{
+    if (options->json)
+    {
+        printf("%s\n    {\"backend\": \"%s\", \"operation\": \"%s\", \"key_bits\": %d, \"bytes\": %zu, "
+               "\"calls\": %llu, \"ns_per_call\": %.3f, \"gb_per_s\": %.4f, \"cycles_per_byte\": ",
+               rows_printed ? "," : "", backend, op_names[op], (int)key_size * 8, bytes, (unsigned long long)r->calls,
+               r->ns_per_call, r->gb_per_s);
+        print_optional(options, r->cycles_per_byte);
+        printf(", \"p50_ns\": %.3f, \"p90_ns\": %.3f, \"p99_ns\": %.3f, \"instructions_per_byte\": ",
+               r->percentile_ns[0], r->percentile_ns[1], r->percentile_ns[2]);
+        print_optional(options, r->instructions_per_byte);
+        printf("}");
+    }
+    else
+    {
+        printf("%s,%s,%d,%zu,%llu,%.3f,%.4f,", backend, op_names[op], (int)key_size * 8, bytes,
+               (unsigned long long)r->calls, r->ns_per_call, r->gb_per_s);
+        print_optional(options, r->cycles_per_byte);
+        printf(",%.3f,%.3f,%.3f,", r->percentile_ns[0], r->percentile_ns[1], r->percentile_ns[2]);
+        print_optional(options, r->instructions_per_byte);
+        printf(",%s\n", cycles_source);
+    }
+    rows_printed++;
+    fflush(stdout);
+}
+
+/** @brief Closes the JSON document. */
+static void print_footer(const bench_options_t* options)
+{
+    if (options->json)
+        printf("\n  ]\n}\n");
+}
+
+/* ============================================================================
+ * Main Function
+ * ========================================================================= */
+
+/** @brief Returns nonzero if name is an element of the comma-separated list, or the list is "all". */
+static int list_contains(const char* list, const char* name)
+{
+    size_t len = strlen(name);
+    if (strcmp(list, "all") == 0)
+        return 1;
+    for (const char* p = list; p;)
+    {
+        const char* end = strchr(p, ',');
+        size_t      n   = end ? (size_t)(end - p) : strlen(p);
+        if (n == len && strncmp(p, name, len) == 0)
+            return 1;
+        p = end ? end + 1 : NULL;
+    }
+    return 0;
+}
+
+/**
+ * @brief Parses a size with an optional K, M or G suffix.
+ * @return The size in bytes, or 0 if the string is not a size.
+ */
+static size_t parse_size(const char* text)
+{
+    char*              end;
+    unsigned long long value = strtoull(text, &end, 10);
+    switch (*end)
+    {
+        case 'K':
+            value <<= 10;
+            end++;
+            break;
+        case 'M':
+            value <<= 20;
+            end++;
+            break;
+        case 'G':
+            value <<= 30;
+            end++;
+            break;
+        default:
+            break;
+    }
+    return *end == '\0' ? (size_t)value : 0;
+}
+
+/** @brief Prints the usage text. */
+static void print_usage(const char* program)
+{
+    fprintf(stderr,
+            "Usage: %s [-b BACKENDS] [-m OPERATIONS] [-k KEYBITS] [-s MINSIZE] [-S MAXSIZE] [-t MS] [-f csv|json]\n"
+            "  -b  Backends: auto (default), all, or a list of reference,ttable,aesni,bitslice,vpaes.\n"
+            "  -m  Operations: all (default) or a list of key_expansion,key_expansion_encrypt,key_batch,\n"
+            "      block_encrypt,block_decrypt,ecb_encrypt,ecb_decrypt,ctr,cbc_encrypt,cbc_decrypt,\n"
+            "      cbc_encrypt_multi,xts_encrypt,xts_decrypt,gcm_seal,gcm_open,ocb_seal,ocb_open,cmac,pmac,drbg.\n"
+            "  -k  Key sizes in bits (default 128,192,256).\n"
+            "  -s  Smallest bulk message size (default 16); K, M and G suffixes are accepted.\n"
+            "  -S  Largest bulk message size (default 64M).\n"
+            "  -t  Milliseconds per measurement (default 50).\n"
+            "  -f  Output format (default csv).\n",
+            program);
+}
+
+/**
+ * @brief Parses the command line.
+ * @return 0 on success, -1 on a usage error.
+ */
+static int parse_options(int argc, char** argv, bench_options_t* options)
+{
+    options->backends   = "auto";
+    options->operations = "all";
+    options->key_bits   = "128,192,256";
+    options->min_size   = AES_BLOCK_SIZE;
+    options->max_size   = 64u << 20;
+    options->budget_ns  = 50u * 1000000u;
+
+    for (int i = 1; i < argc; i += 2)
+    {
+        const char* flag  = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : NULL;
+        if (!value || flag[0] != '-' || flag[1] == '\0' || flag[2] != '\0')
+            return -1;
+
+        switch (flag[1])
+        {
+            case 'b':
+                options->backends = value;
+                break;
+            case 'm':
+                options->operations = value;
+                break;
+            case 'k':
+                options->key_bits = value;
+                break;
+            case 's':
+                options->min_size = parse_size(value);
+                break;
+            case 'S':
+                options->max_size = parse_size(value);
+                break;
+            case 't':
+                options->budget_ns = strtoull(value, NULL, 10) * 1000000u;
+                break;
+            case 'f':
+                if (strcmp(value, "json") != 0 && strcmp(value, "csv") != 0)
+                    return -1;
+                options->json = strcmp(value, "json") == 0;
+                break;
+            default:
+                return -1;
+        }
+    }
+
+    if (options->min_size < AES_BLOCK_SIZE || options->min_size % AES_BLOCK_SIZE != 0 ||
+        options->max_size < options->min_size || options->max_size % AES_BLOCK_SIZE != 0)
+    {
+        fprintf(stderr, "Error: Message sizes must be nonzero multiples of %d.\n", AES_BLOCK_SIZE);
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Runs every selected operation for one backend and key size.
+ */
+static void run_key_size(const bench_options_t* options, bench_state_t* state)
+{
+    const char*    name = aes_backend_name(state->backend);
+    bench_result_t result;
+
+    if (init_state(state) != AES_SUCCESS)
+        return;
+
+    for (int op = 0; op < OP_COUNT; op++)
+    {
+        if (!list_contains(options->operations, op_names[op]) || !op_supports_key((bench_op_t)op, state->key_size))
+            continue;
+
+        if (!op_is_bulk((bench_op_t)op))
+        {
+            size_t bytes = AES_BLOCK_SIZE;
+            if (op == OP_KEY_EXPANSION || op == OP_KEY_EXPANSION_ENCRYPT)
+                bytes = (size_t)state->key_size;
+            else if (op == OP_KEY_BATCH)
+                bytes = BENCH_KEY_BATCH * (size_t)state->key_size;
+            measure(state, (bench_op_t)op, 0, bytes, options->budget_ns, &result);
+            print_row(options, name, (bench_op_t)op, state->key_size, bytes, &result);
+            continue;
+        }
+
+        // Power-of-four sizes from the minimum, always ending at the maximum.
+        for (size_t size = options->min_size;; size *= 4)
+        {
+            if (size > options->max_size)
+                size = options->max_size;
+            prepare_op(state, (bench_op_t)op, size);
+            measure(state, (bench_op_t)op, size, size, options->budget_ns, &result);
+            print_row(options, name, (bench_op_t)op, state->key_size, size, &result);
+            if (size == options->max_size)
+                break;
+        }
+    }
+
+    aes_ctx_clear(&state->ctx);
+    aes_xts_clear(&state->xts);
+    aes_gcm_clear(&state->gcm);
+    aes_ocb_clear(&state->ocb);
+    aes_cmac_clear(&state->cmac);
+    aes_pmac_clear(&state->pmac);
+    aes_drbg_clear(&state->drbg);
+    for (size_t i = 0; i < BENCH_KEY_BATCH; i++)
+        aes_ctx_clear(&state->batch[i]);
+}
+
+/**
+ * @brief The entry point of the benchmark suite.
+ * @return 0 on success, 1 on failure, 2 on a usage error.
+ */
+int main(int argc, char** argv)
+{
+    static const aes_key_size_t key_sizes[] = {AES_KEY_SIZE_128, AES_KEY_SIZE_192, AES_KEY_SIZE_256};
+    bench_options_t             options     = {0};
+    bench_state_t               state       = {0};
+
+    if (parse_options(argc, argv, &options) != 0)
+    {
+        print_usage(argv[0]);
+        return 2;
+    }
+
+    // The tag and any final partial block fit in the extra block.
+    state.in  = malloc(options.max_size + AES_BLOCK_SIZE);
+    state.out = malloc(options.max_size + AES_BLOCK_SIZE);
+    if (!state.in || !state.out)
+    {
+        fprintf(stderr, "Error: %s.\n", aes_error_to_string(AES_ERROR_MEMORY_ALLOCATION_FAILED));
+        free(state.in);
+        free(state.out);
+        return 1;
+    }
+    // Touch every page now so that page faults stay out of the measurements.
+    for (size_t i = 0; i < options.max_size + AES_BLOCK_SIZE; i++)
+        state.in[i] = (uint8_t)(i * 131u);
+    memset(state.out, 0, options.max_size + AES_BLOCK_SIZE);
+    for (size_t i = 0; i < sizeof(state.key); i++)
+        state.key[i] = (uint8_t)(i * 7u + 1u);
+    for (size_t i = 0; i < sizeof(state.batch_keys); i++)
+        state.batch_keys[i] = (uint8_t)(i * 11u + 3u);
+    memset(state.iv, 0xa5, sizeof(state.iv));
+
+    cycles_source = open_counters();
+    print_header(&options);
+
+    for (size_t b = 0; b < BACKEND_COUNT + 1; b++)
+    {
+        // Entry BACKEND_COUNT stands for "auto", benchmarked under the name of the backend it resolves to.
+        aes_backend_t backend = b < BACKEND_COUNT ? all_backends[b] : aes_get_default_backend();
+        int           chosen  = b < BACKEND_COUNT ? list_contains(options.backends, aes_backend_name(backend))
+                                                  : strcmp(options.backends, "all") != 0 &&
+                                                      list_contains(options.backends, "auto");
+        if (!chosen || !aes_backend_is_supported(backend))
+            continue;
+
+        state.backend = backend;
+        for (size_t k = 0; k < sizeof(key_sizes) / sizeof(key_sizes[0]); k++)
+        {
+            char bits[8];
+            snprintf(bits, sizeof(bits), "%d", (int)key_sizes[k] * 8);
+            if (!list_contains(options.key_bits, bits))
+                continue;
+            state.key_size = key_sizes[k];
+            run_key_size(&options, &state);
+        }
+    }
+
+    print_footer(&options);
+    free(state.in);
+    free(state.out);
+    return 0;
+}
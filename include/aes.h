@@ -31,6 +31,59 @@
  */
 #define AES_MAX_EXPANDED_KEY_SIZE 240
 
+/**
+ * @brief Number of precomputed PMAC offset multiples L.x^i.
+ * @details One per bit of the 64-bit block index, so no message is too long.
+ */
+#define AES_PMAC_L_COUNT 64
+
+/**
+ * @brief Number of precomputed OCB offsets L_i.
+ * @details As for PMAC, one per bit of the 64-bit block index.
+ */
+#define AES_OCB_L_COUNT 64
+
+/** @brief Bytes of entropy input per CTR_DRBG seed: one AES-256 key plus one block. */
+#define AES_DRBG_SEED_SIZE 48
+
+/**
+ * @brief Bytes of output a CTR_DRBG context generates ahead of its callers.
+ * @details Requests smaller than this are copied out of the buffer; one
+ * refill is one SP 800-90A generate call.
+ */
+#define AES_DRBG_BUFFER_SIZE 4096
+
+/** @brief The largest SP 800-90A generate request (2^19 bits) for aes_drbg_generate_direct(). */
+#define AES_DRBG_MAX_REQUEST 65536
+
+/** @brief Bytes of the header at the start of an encrypted archive. */
+#define AES_ARCHIVE_HEADER_SIZE 64
+
+/** @brief Bytes of an archive's nonce base; chunk nonces are derived from it. */
+#define AES_ARCHIVE_NONCE_SIZE 12
+
+/** @brief Bytes of each chunk's entry in an archive's index: the chunk's tag. */
+#define AES_ARCHIVE_TAG_SIZE 16
+
+/**
+ * @brief Maximum number of lanes of a job manager.
+ * @details Each lane holds one job; a step advances every lane by one block.
+ */
+#define AES_JOB_MAX_LANES 32
+
+/**
+ * @brief Entries of aes_stats_t::backends, indexed by aes_backend_t.
+ * @details Leaves room for backends added later without changing the layout.
+ */
+#define AES_STATS_BACKEND_SLOTS 8
+
+/**
+ * @brief Environment variable that forces the default backend.
+ * @details Set it to a backend name such as "reference", "ttable", "aesni", "bitslice" or "vpaes"
+ * before the first context is created. Unknown or unsupported names are ignored.
+ */
+#define AES_BACKEND_ENV "AES_BACKEND"
+
 /* ============================================================================
  * Public Enums and Typedefs
  * ========================================================================= */
@@ -46,6 +99,15 @@ typedef enum
     AES_SUCCESS = 0,                    /**< The operation completed successfully. */
     AES_ERROR_UNSUPPORTED_KEY_SIZE,     /**< The provided key size is not supported. */
     AES_ERROR_MEMORY_ALLOCATION_FAILED, /**< A memory allocation call failed. */
+    AES_ERROR_INVALID_ARGUMENT,         /**< A required pointer argument was NULL. */
+    AES_ERROR_UNSUPPORTED_BACKEND,      /**< The requested backend is not available on this CPU. */
+    AES_ERROR_INVALID_LENGTH,           /**< The data length is not valid for the operation. */
+    AES_ERROR_AUTHENTICATION_FAILED,    /**< The authentication tag did not verify. */
+    AES_ERROR_INVALID_PADDING,          /**< The decrypted padding is malformed. */
+    AES_ERROR_KEYRING_FULL,             /**< Every slot of the keyring is in use. */
+    AES_ERROR_KEY_NOT_FOUND,            /**< The key handle is unknown or was removed. */
+    AES_ERROR_ENTROPY_FAILED,           /**< The entropy source reported a failure. */
+    AES_ERROR_INVALID_FORMAT,           /**< The input is not a well-formed archive. */
 } aes_error_t;
 
 /**
@@ -58,6 +120,405 @@ typedef enum
     AES_KEY_SIZE_256 = 32  /**< For 256-bit keys (32 bytes). */
 } aes_key_size_t;
 
+/**
+ * @brief Enumeration of the block cipher implementations (backends).
+ */
+typedef enum
+{
+    AES_BACKEND_AUTO = 0,  /**< Let the library choose the fastest available backend. */
+    AES_BACKEND_REFERENCE, /**< Byte-wise FIPS-197 transforms on the 4x4 state matrix. */
+    AES_BACKEND_TTABLE,    /**< 32-bit words with fused SubBytes/ShiftRows/MixColumns tables. */
+    AES_BACKEND_AESNI,     /**< x86 AES-NI instructions (aesenc/aesdec/aesimc). */
+    AES_BACKEND_BITSLICE,  /**< Constant-time bitsliced circuit, eight blocks per batch. */
+    AES_BACKEND_VPAES,     /**< Constant-time SSSE3 vector permutes: pshufb S-box in a GF(2^4) tower. */
+} aes_backend_t;
+
+/**
+ * @brief The directions a context's key schedule is derived for.
+ * @details CTR, GCM, CMAC and PMAC only run the forward cipher, so a context
+ * used for them needs no decryption schedule, whose derivation (InvMixColumns
+ * on every round key) is a large share of the cost of initializing a context.
+ */
+typedef enum
+{
+    AES_KEY_USAGE_BOTH = 0, /**< Encryption and decryption. */
+    AES_KEY_USAGE_ENCRYPT,  /**< Encryption only. */
+    AES_KEY_USAGE_DECRYPT,  /**< Decryption only. */
+} aes_key_usage_t;
+
+/**
+ * @brief Width of the counter field that CTR mode increments.
+ * @details The counter is the big-endian integer in the low-order bits of the
+ * 16-byte counter block; the remaining high-order bytes (the nonce) never change.
+ */
+typedef enum
+{
+    AES_CTR_WIDTH_32  = 32,  /**< Low 32 bits count, e.g. GCM and RFC 3686. */
+    AES_CTR_WIDTH_64  = 64,  /**< Low 64 bits count, with a 64-bit nonce. */
+    AES_CTR_WIDTH_128 = 128, /**< The whole block is one 128-bit counter (SP 800-38A). */
+} aes_ctr_width_t;
+
+/** @brief Opaque per-backend dispatch table. */
+struct aes_backend_ops;
+
+/**
+ * @brief An expanded-key context for repeated operations under a single key.
+ *
+ * @details The key schedule is computed once by aes_ctx_init() and reused by
+ * every subsequent block operation, so the per-block cost is only the cipher
+ * itself. The context holds no heap pointers: it may live on the stack or in
+ * any caller-owned memory, and should be wiped with aes_ctx_clear() once it is
+ * no longer needed.
+ */
+typedef struct aes_ctx
+{
+    /** The expanded key schedule. Its layout is private to the selected backend. */
+    _Alignas(16) uint32_t round_keys[AES_MAX_EXPANDED_KEY_SIZE / sizeof(uint32_t)];
+    /** A separate decryption schedule, for backends that run the equivalent inverse cipher. */
+    _Alignas(16) uint32_t dec_round_keys[AES_MAX_EXPANDED_KEY_SIZE / sizeof(uint32_t)];
+    uint16_t                      num_rounds; /**< Number of cipher rounds (10, 12 or 14). */
+    aes_key_size_t                key_size;   /**< Size of the key the schedule was derived from. */
+    aes_key_usage_t               usage;      /**< The directions the schedule was derived for. */
+    const struct aes_backend_ops* backend;    /**< The backend that owns the schedule. */
+    /** Block kernels for this context's key size, selected once when the key is expanded. */
+    void (*encrypt_blocks)(const struct aes_ctx* ctx, const uint8_t* in, uint8_t* out, size_t num_blocks);
+    void (*decrypt_blocks)(const struct aes_ctx* ctx, const uint8_t* in, uint8_t* out, size_t num_blocks);
+} aes_ctx_t;
+
+/**
+ * @brief One segment of a scatter-gather list, with the members of POSIX
+ * struct iovec.
+ */
+typedef struct
+{
+    void*  iov_base; /**< The first byte of the segment. May be NULL if iov_len is 0. */
+    size_t iov_len;  /**< The segment length in bytes; any length, including 0. */
+} aes_iovec_t;
+
+/**
+ * @brief One independent CBC stream for aes_cbc_encrypt_multi(): its key,
+ * its chaining value and its buffers.
+ */
+typedef struct
+{
+    const aes_ctx_t* ctx;    /**< A context prepared by aes_ctx_init(). */
+    uint8_t*         iv;     /**< The 16-byte IV; replaced by the chaining value on return. */
+    const uint8_t*   in;     /**< The plaintext. May be NULL if length is 0. */
+    uint8_t*         out;    /**< The ciphertext buffer. May equal in. May be NULL if length is 0. */
+    size_t           length; /**< The number of bytes, a multiple of AES_BLOCK_SIZE. */
+} aes_cbc_stream_t;
+
+/**
+ * @brief A GCM (Galois/Counter Mode) context: the block cipher context plus
+ * the precomputed GHASH key tables.
+ *
+ * @details Like aes_ctx_t it holds no heap pointers and can be reused for any
+ * number of messages under one key; wipe it with aes_gcm_clear() when done.
+ * The GHASH tables are private to the library.
+ */
+typedef struct
+{
+    aes_ctx_t cipher; /**< The block cipher context. */
+    /** Powers H^1..H^8 of the hash key for the carry-less multiply GHASH. */
+    _Alignas(16) uint8_t ghash_h_powers[8][AES_BLOCK_SIZE];
+    uint64_t ghash_hl[16]; /**< Low halves of the 4-bit multiplication table. */
+    uint64_t ghash_hh[16]; /**< High halves of the 4-bit multiplication table. */
+    int      use_clmul;    /**< Nonzero when the AES-NI/PCLMULQDQ kernel is used. */
+} aes_gcm_ctx_t;
+
+/**
+ * @brief An OCB3 (RFC 7253) context: the block cipher context plus the
+ * precomputed offsets.
+ *
+ * @details Like aes_gcm_ctx_t it holds no heap pointers and can be reused for
+ * any number of messages under one key; wipe it with aes_ocb_clear() when done.
+ */
+typedef struct
+{
+    aes_ctx_t cipher;                             /**< The block cipher context. */
+    uint8_t   l_star[AES_BLOCK_SIZE];             /**< L_* = E(K, 0^128), for partial final blocks. */
+    uint8_t   l_dollar[AES_BLOCK_SIZE];           /**< L_$ = double(L_*), for the tag. */
+    uint8_t   l[AES_OCB_L_COUNT][AES_BLOCK_SIZE]; /**< L_i = double^(i + 2)(L_*), indexed by ntz(block index). */
+} aes_ocb_ctx_t;
+
+/**
+ * @brief An XTS-AES context: the data key and the tweak key.
+ *
+ * @details Like aes_ctx_t it holds no heap pointers; wipe it with
+ * aes_xts_clear() when done.
+ */
+typedef struct
+{
+    aes_ctx_t data;  /**< Context for Key1, which encrypts the data. */
+    aes_ctx_t tweak; /**< Context for Key2, which encrypts the tweak. */
+} aes_xts_ctx_t;
+
+/**
+ * @brief An AES-CMAC (NIST SP 800-38B, RFC 4493) computation.
+ *
+ * @details The key schedule and both subkeys are derived once by
+ * aes_cmac_init(); after that a context authenticates any number of messages
+ * in turn, each one fed through aes_cmac_update() and ended by
+ * aes_cmac_final(). It holds no heap pointers; wipe it with aes_cmac_clear().
+ */
+typedef struct
+{
+    aes_ctx_t cipher;                 /**< The block cipher context. */
+    uint8_t   k1[AES_BLOCK_SIZE];     /**< Subkey K1, for a complete final block. */
+    uint8_t   k2[AES_BLOCK_SIZE];     /**< Subkey K2, for a padded final block. */
+    uint8_t   state[AES_BLOCK_SIZE];  /**< The CBC-MAC chaining value. */
+    uint8_t   buffer[AES_BLOCK_SIZE]; /**< Input held back until it is known not to end the message. */
+    size_t    buffered;               /**< The number of bytes in buffer. */
+} aes_cmac_ctx_t;
+
+/**
+ * @brief A PMAC (Black and Rogaway, PMAC1) computation.
+ *
+ * @details Used like aes_cmac_ctx_t. Every block is encrypted independently
+ * under its own offset and the results are XORed together, so long messages
+ * go through the backend's multi-block kernels and can be split across
+ * threads with aes_engine_pmac_update().
+ */
+typedef struct
+{
+    aes_ctx_t cipher;                              /**< The block cipher context. */
+    uint8_t   l[AES_PMAC_L_COUNT][AES_BLOCK_SIZE]; /**< L.x^i for L = E(K, 0^128). */
+    uint8_t   l_inv[AES_BLOCK_SIZE];               /**< L.x^-1, for a complete final block. */
+    uint8_t   sigma[AES_BLOCK_SIZE];               /**< The XOR of the encrypted blocks so far. */
+    uint8_t   buffer[AES_BLOCK_SIZE];              /**< Input held back until it is known not to end the message. */
+    size_t    buffered;                            /**< The number of bytes in buffer. */
+    uint64_t  num_blocks;                          /**< The number of blocks folded into sigma. */
+} aes_pmac_ctx_t;
+
+/**
+ * @brief Supplies entropy to a CTR_DRBG.
+ * @param[in] arg The argument registered with the callback.
+ * @param[out] out Receives length bytes of full-entropy input.
+ * @param[in] length The number of bytes requested.
+ * @return 0 on success, nonzero if the source failed.
+ */
+typedef int (*aes_drbg_entropy_fn)(void* arg, uint8_t* out, size_t length);
+
+/**
+ * @brief A CTR_DRBG (NIST SP 800-90A) on AES-256, without a derivation
+ * function, with a buffer of pregenerated output.
+ *
+ * @details A context is not thread-safe and takes no locks: give each thread
+ * its own, or use aes_drbg_thread_generate(). It holds no heap pointers;
+ * wipe it with aes_drbg_clear() when done.
+ */
+typedef struct
+{
+    aes_ctx_t           cipher;                       /**< The DRBG key, expanded. */
+    uint8_t             counter[AES_BLOCK_SIZE];      /**< V + 1, the next counter block. */
+    uint64_t            reseed_counter;               /**< Generate calls since the last (re)seed, plus one. */
+    aes_drbg_entropy_fn entropy;                      /**< The entropy source for reseeding. */
+    void*               entropy_arg;                  /**< The argument passed to entropy. */
+    size_t              available;                    /**< Unread bytes at the end of buffer. */
+    uint8_t             buffer[AES_DRBG_BUFFER_SIZE]; /**< Pregenerated output. */
+} aes_drbg_ctx_t;
+
+/** @brief Opaque multi-threaded engine with a persistent worker pool. */
+typedef struct aes_engine aes_engine_t;
+
+/**
+ * @brief Configuration for aes_engine_create(). Zero-initialize it and set
+ * only the fields of interest; zero selects the default for every field.
+ */
+typedef struct
+{
+    unsigned num_threads; /**< Threads sharing each operation, including the caller. Default: online CPUs. */
+    size_t   chunk_size;  /**< Bytes per work item, a multiple of AES_BLOCK_SIZE. Default: 128 KiB. */
+    /** Operations shorter than this run on the calling thread alone. Default: 1 MiB. */
+    size_t min_parallel_size;
+    /**
+     * Optional affinity hints: worker thread i is pinned to CPU cpu_affinity[i]
+     * (a negative entry leaves it unpinned). Holds num_threads - 1 entries,
+     * since the calling thread also works and is never re-pinned. Pinning the
+     * workers of one engine to the CPUs of one NUMA node keeps each worker's
+     * key schedule copy and chunk buffers node-local.
+     */
+    const int* cpu_affinity;
+} aes_engine_config_t;
+
+/** @brief Opaque shared store of expanded keys with lock-free lookup. */
+typedef struct aes_keyring aes_keyring_t;
+
+/**
+ * @brief A handle to a key registered in a keyring. Zero is never a valid
+ * handle, and a handle is never reused once its key has been removed.
+ */
+typedef uint64_t aes_key_handle_t;
+
+/**
+ * @brief The authenticated modes an archive's chunks can be sealed with.
+ */
+typedef enum
+{
+    AES_ARCHIVE_MODE_GCM = 1, /**< AES-GCM. */
+    AES_ARCHIVE_MODE_OCB = 2, /**< OCB3. */
+} aes_archive_mode_t;
+
+/**
+ * @brief The parameters of an archive, as recorded in its header.
+ */
+typedef struct
+{
+    aes_archive_mode_t mode;       /**< The mode every chunk is sealed with. */
+    aes_key_size_t     key_size;   /**< The size of the archive key. */
+    uint32_t           chunk_size; /**< Plaintext bytes per chunk, a nonzero multiple of AES_BLOCK_SIZE. */
+    uint64_t           key_id;     /**< The caller's identifier for the key; stored, never interpreted. */
+    /** Random per archive; chunk i's nonce is this with i XORed into its last eight bytes. */
+    uint8_t  nonce_base[AES_ARCHIVE_NONCE_SIZE];
+    uint64_t length; /**< Total plaintext bytes. */
+} aes_archive_info_t;
+
+/**
+ * @brief A keyed archive: its parameters, its serialized header and the
+ * context of its mode.
+ *
+ * @details Like aes_gcm_ctx_t it holds no heap pointers; wipe it with
+ * aes_archive_clear() when done.
+ */
+typedef struct
+{
+    aes_archive_info_t info;                            /**< The archive's parameters. */
+    uint64_t           num_chunks;                      /**< The number of chunks, at least one. */
+    uint8_t            header[AES_ARCHIVE_HEADER_SIZE]; /**< The serialized header, authenticated by every chunk. */
+    aes_gcm_ctx_t      gcm;                             /**< The GCM context, for AES_ARCHIVE_MODE_GCM. */
+    aes_ocb_ctx_t      ocb;                             /**< The OCB context, for AES_ARCHIVE_MODE_OCB. */
+} aes_archive_ctx_t;
+
+/** @brief Opaque manager that batches small jobs from many threads into lanes. */
+typedef struct aes_job_manager aes_job_manager_t;
+
+/**
+ * @brief The operations a job manager runs.
+ */
+typedef enum
+{
+    AES_JOB_ECB_ENCRYPT = 0, /**< aes_ecb_encrypt(). */
+    AES_JOB_ECB_DECRYPT,     /**< aes_ecb_decrypt(). */
+    AES_JOB_CBC_ENCRYPT,     /**< aes_cbc_encrypt(). */
+    AES_JOB_CBC_DECRYPT,     /**< aes_cbc_decrypt(). */
+    AES_JOB_CTR,             /**< aes_ctr_xcrypt_ex(). */
+} aes_job_mode_t;
+
+typedef struct aes_job aes_job_t;
+
+/**
+ * @brief Called once a job is complete.
+ *
+ * @details Runs on the manager's thread, so it must be thread-safe and short:
+ * wake the owner or queue the job. The job belongs to the caller again from
+ * the moment the callback is entered.
+ *
+ * @param[in] job The completed job.
+ */
+typedef void (*aes_job_callback_fn)(aes_job_t* job);
+
+/**
+ * @brief One request to a job manager, in caller-owned memory.
+ *
+ * @details Fill in the public fields and pass the job to aes_job_submit(); it
+ * must stay valid and untouched until it completes, which is signalled by the
+ * callback if one is set and by aes_job_done() otherwise. The buffers follow
+ * the rules of the matching contiguous function. A job may be resubmitted
+ * once it is complete.
+ */
+struct aes_job
+{
+    const aes_ctx_t*    ctx;    /**< A context prepared by aes_ctx_init(). */
+    aes_job_mode_t      mode;   /**< The operation. */
+    const uint8_t*      in;     /**< The input. */
+    uint8_t*            out;    /**< The output; may equal in. */
+    size_t              length; /**< Bytes to process; a multiple of AES_BLOCK_SIZE except for CTR. */
+    /** CBC: the IV, replaced by the chaining value. CTR: the counter block, advanced. Unused by ECB. */
+    uint8_t             iv[AES_BLOCK_SIZE];
+    aes_ctr_width_t     width;     /**< CTR: the width of the incrementing counter field. */
+    aes_job_callback_fn callback;  /**< Called on completion, or NULL to poll aes_job_done(). */
+    void*               user_data; /**< Free for the caller's use. */
+    /* Private to the manager. */
+    _Atomic int         done;
+    aes_job_t* _Atomic  next;
+};
+
+/**
+ * @brief Configuration for aes_job_manager_create(). Zero-initialize it and
+ * set only the fields of interest; zero selects the default for every field.
+ */
+typedef struct
+{
+    unsigned lanes; /**< Jobs processed side by side, at most AES_JOB_MAX_LANES. Default: 8. */
+    /** Longest a job waits for its lanes to fill before a partial batch runs, in microseconds. Default: 50. */
+    uint32_t max_latency_us;
+} aes_job_manager_config_t;
+
+/**
+ * @brief The operations the statistics layer counts separately.
+ */
+typedef enum
+{
+    AES_STATS_KEY_EXPANSION = 0, /**< Key schedule expansion, by any init function. */
+    AES_STATS_ECB,               /**< ECB, including keyring and engine ECB. */
+    AES_STATS_CTR,               /**< CTR, including engine CTR. */
+    AES_STATS_CBC,               /**< CBC, with or without padding. */
+    AES_STATS_XTS,               /**< XTS, whole messages and sectors. */
+    AES_STATS_GCM,               /**< GCM seal and open. */
+    AES_STATS_OCB,               /**< OCB seal and open. */
+    AES_STATS_MAC,               /**< CMAC and PMAC updates. */
+    AES_STATS_DRBG,              /**< CTR_DRBG output. */
+    AES_STATS_OP_COUNT           /**< The number of operations; not an operation. */
+} aes_stats_op_t;
+
+/**
+ * @brief Totals for one operation or one backend.
+ */
+typedef struct
+{
+    uint64_t calls;        /**< Completed calls. */
+    uint64_t bytes;        /**< Bytes of message processed; 0 for key expansion. */
+    uint64_t blocks;       /**< Blocks processed, a trailing partial block counted as one. */
+    uint64_t timed_calls;  /**< Calls whose duration was sampled. */
+    uint64_t timed_cycles; /**< Summed duration of the sampled calls, in TSC ticks (nanoseconds off x86). */
+} aes_stats_counter_t;
+
+/**
+ * @brief A snapshot of the library's counters, summed over every thread
+ * since the process started.
+ */
+typedef struct
+{
+    aes_stats_counter_t ops[AES_STATS_OP_COUNT];           /**< Per operation, over all backends. */
+    aes_stats_counter_t backends[AES_STATS_BACKEND_SLOTS]; /**< Per backend, over all operations. */
+    uint64_t            allocation_failures; /**< Calls that returned AES_ERROR_MEMORY_ALLOCATION_FAILED. */
+    aes_backend_t       default_backend;     /**< The backend AES_BACKEND_AUTO currently selects. */
+} aes_stats_t;
+
+/**
+ * @brief Receives each sampled timing measurement.
+ *
+ * @details Runs on the thread that made the call, right after it, so it must
+ * be thread-safe and should be short: hand the value to a histogram or queue.
+ *
+ * @param[in] arg The argument registered with the hook.
+ * @param[in] op The operation that was timed.
+ * @param[in] backend The backend that ran it.
+ * @param[in] bytes The bytes it processed.
+ * @param[in] cycles Its duration, in TSC ticks (nanoseconds off x86).
+ */
+typedef void (*aes_stats_callback_fn)(void* arg, aes_stats_op_t op, aes_backend_t backend, size_t bytes,
+                                      uint64_t cycles);
+
+/**
+ * @brief A timing hook for aes_stats_set_hook().
+ */
+typedef struct
+{
+    aes_stats_callback_fn callback; /**< Called with each sampled measurement. */
+    void*                 arg;      /**< Passed to callback. */
+} aes_stats_hook_t;
+
 /* ============================================================================
  * Public API
  * ========================================================================= */
@@ -69,7 +530,8 @@ typedef enum
  * The size must be sufficient for the chosen key size.
  * @param[in]  key A pointer to the original AES key.
  * @param[in]  key_size The size of the key (use AES_KEY_SIZE_128, AES_KEY_SIZE_192, or AES_KEY_SIZE_256).
- * @param[in]  expanded_key_size The total size of the expanded_key buffer.
+ * @param[in]  expanded_key_size The total size of the expanded_key buffer. Only whole
+ * 32-bit words of it are written.
  */
 void aes_expand_key(uint8_t* expanded_key, const uint8_t* key, aes_key_size_t key_size, size_t expanded_key_size);
 
@@ -95,6 +557,1408 @@ aes_error_t aes_encrypt(const uint8_t* plaintext, uint8_t* ciphertext, const uin
  */
 aes_error_t aes_decrypt(const uint8_t* ciphertext, uint8_t* plaintext, const uint8_t* key, aes_key_size_t key_size);
 
+/**
+ * @brief Initializes a context by expanding the given key once.
+ *
+ * @param[out] ctx A pointer to the context to initialize.
+ * @param[in]  key A pointer to the AES key.
+ * @param[in]  key_size The size of the key (128, 192, or 256 bits).
+ * @return AES_SUCCESS on success, or an appropriate aes_error_t on failure.
+ */
+aes_error_t aes_ctx_init(aes_ctx_t* ctx, const uint8_t* key, aes_key_size_t key_size);
+
+/**
+ * @brief Initializes a context for a specific backend.
+ *
+ * @details Behaves like aes_ctx_init() but pins the context to the requested
+ * implementation, e.g. to compare an optimized backend against the reference.
+ *
+ * @param[out] ctx A pointer to the context to initialize.
+ * @param[in]  key A pointer to the AES key.
+ * @param[in]  key_size The size of the key (128, 192, or 256 bits).
+ * @param[in]  backend The backend to use, or AES_BACKEND_AUTO for the default.
+ * @return AES_SUCCESS on success, AES_ERROR_UNSUPPORTED_BACKEND if the backend
+ * cannot run on this CPU, or another aes_error_t on failure.
+ */
+aes_error_t aes_ctx_init_backend(aes_ctx_t* ctx, const uint8_t* key, aes_key_size_t key_size, aes_backend_t backend);
+
+/**
+ * @brief Initializes a context for a specific backend and for one or both directions.
+ *
+ * @details With AES_KEY_USAGE_ENCRYPT the decryption schedule is not
+ * derived, and with AES_KEY_USAGE_DECRYPT the encryption schedule is not
+ * kept where the backend can avoid it. Functions that need the missing
+ * direction reject the context with AES_ERROR_INVALID_ARGUMENT.
+ *
+ * @param[out] ctx A pointer to the context to initialize.
+ * @param[in]  key A pointer to the AES key.
+ * @param[in]  key_size The size of the key (128, 192, or 256 bits).
+ * @param[in]  backend The backend to use, or AES_BACKEND_AUTO for the default.
+ * @param[in]  usage The directions the context will be used for.
+ * @return AES_SUCCESS on success, AES_ERROR_UNSUPPORTED_BACKEND if the backend
+ * cannot run on this CPU, or another aes_error_t on failure.
+ */
+aes_error_t aes_ctx_init_ex(aes_ctx_t* ctx, const uint8_t* key, aes_key_size_t key_size, aes_backend_t backend,
+                            aes_key_usage_t usage);
+
+/**
+ * @brief Initializes count contexts from count keys of one size at once.
+ *
+ * @details Equivalent to calling aes_ctx_init_ex() for each key, but the
+ * arguments are checked once and backends that can expand several keys side
+ * by side do so: AES-NI runs the schedule chains of four keys
+ * interleaved, so their latencies overlap. Use it to rekey many sessions or
+ * records at a time.
+ *
+ * @param[out] ctxs An array of count contexts to initialize.
+ * @param[in]  keys count keys of key_size bytes each, back to back.
+ * @param[in]  key_size The size of every key.
+ * @param[in]  count The number of keys.
+ * @param[in]  backend The backend to use, or AES_BACKEND_AUTO for the default.
+ * @param[in]  usage The directions the contexts will be used for.
+ * @return AES_SUCCESS on success, AES_ERROR_UNSUPPORTED_BACKEND if the backend
+ * cannot run on this CPU, or another aes_error_t on failure, in which case no
+ * context is initialized.
+ */
+aes_error_t aes_ctx_init_batch(aes_ctx_t* ctxs, const uint8_t* keys, aes_key_size_t key_size, size_t count,
+                               aes_backend_t backend, aes_key_usage_t usage);
+
+/**
+ * @brief Returns the backend an initialized context is bound to.
+ *
+ * @param[in] ctx A pointer to an initialized context.
+ * @return The backend identifier, or AES_BACKEND_AUTO if ctx is NULL or uninitialized.
+ */
+aes_backend_t aes_ctx_get_backend(const aes_ctx_t* ctx);
+
+/**
+ * @brief Returns a short human-readable name for a backend.
+ *
+ * @param[in] backend The backend identifier.
+ * @return A constant string such as "reference", "ttable" or "aesni".
+ */
+const char* aes_backend_name(aes_backend_t backend);
+
+/**
+ * @brief Reports whether a backend is compiled in and runs on this CPU.
+ *
+ * @param[in] backend The backend identifier.
+ * @return 1 if contexts can be initialized with the backend, 0 otherwise.
+ */
+int aes_backend_is_supported(aes_backend_t backend);
+
+/**
+ * @brief Overrides the backend used by aes_ctx_init() and AES_BACKEND_AUTO.
+ *
+ * @details Without a call to this function the default is chosen once, on
+ * first use, from CPUID detection and the AES_BACKEND_ENV environment
+ * variable. Passing AES_BACKEND_AUTO repeats that detection. Contexts that are
+ * already initialized keep their backend.
+ *
+ * @param[in] backend The backend to use by default.
+ * @return AES_SUCCESS, or AES_ERROR_UNSUPPORTED_BACKEND if it cannot run here.
+ */
+aes_error_t aes_set_default_backend(aes_backend_t backend);
+
+/**
+ * @brief Returns the backend used by aes_ctx_init(), selecting it if needed.
+ *
+ * @return The default backend identifier.
+ */
+aes_backend_t aes_get_default_backend(void);
+
+/**
+ * @brief Encrypts a single 16-byte block with an initialized context.
+ *
+ * @param[in]  ctx A pointer to a context prepared by aes_ctx_init().
+ * @param[in]  plaintext A pointer to the 16-byte plaintext block.
+ * @param[out] ciphertext A pointer to the 16-byte output block. May alias plaintext.
+ * @return AES_SUCCESS on success, or an appropriate aes_error_t on failure.
+ */
+aes_error_t aes_ctx_encrypt(const aes_ctx_t* ctx, const uint8_t* plaintext, uint8_t* ciphertext);
+
+/**
+ * @brief Decrypts a single 16-byte block with an initialized context.
+ *
+ * @param[in]  ctx A pointer to a context prepared by aes_ctx_init().
+ * @param[in]  ciphertext A pointer to the 16-byte ciphertext block.
+ * @param[out] plaintext A pointer to the 16-byte output block. May alias ciphertext.
+ * @return AES_SUCCESS on success, or an appropriate aes_error_t on failure.
+ */
+aes_error_t aes_ctx_decrypt(const aes_ctx_t* ctx, const uint8_t* ciphertext, uint8_t* plaintext);
+
+/**
+ * @brief Encrypts consecutive blocks independently (ECB) with an initialized context.
+ *
+ * @details Handing the backend many blocks at once lets it keep several
+ * blocks in flight (AES-NI) or fill its parallel lanes (bitslice).
+ *
+ * @param[in]  ctx A pointer to a context prepared by aes_ctx_init().
+ * @param[in]  in A pointer to the input blocks.
+ * @param[out] out A pointer to the output buffer. May alias in.
+ * @param[in]  length The number of bytes, a multiple of AES_BLOCK_SIZE.
+ * @return AES_SUCCESS on success, AES_ERROR_INVALID_LENGTH if length is not a
+ * multiple of the block size, or another aes_error_t on failure.
+ */
+aes_error_t aes_ecb_encrypt(const aes_ctx_t* ctx, const uint8_t* in, uint8_t* out, size_t length);
+
+/**
+ * @brief Decrypts consecutive blocks independently (ECB) with an initialized context.
+ *
+ * @param[in]  ctx A pointer to a context prepared by aes_ctx_init().
+ * @param[in]  in A pointer to the input blocks.
+ * @param[out] out A pointer to the output buffer. May alias in.
+ * @param[in]  length The number of bytes, a multiple of AES_BLOCK_SIZE.
+ * @return AES_SUCCESS on success, AES_ERROR_INVALID_LENGTH if length is not a
+ * multiple of the block size, or another aes_error_t on failure.
+ */
+aes_error_t aes_ecb_decrypt(const aes_ctx_t* ctx, const uint8_t* in, uint8_t* out, size_t length);
+
+/**
+ * @brief aes_ecb_encrypt() over scatter-gather lists.
+ *
+ * @details Segments may have any length; a block that straddles a segment
+ * boundary in either list is assembled in a 16-byte buffer, and every other
+ * run of whole blocks is encrypted directly in the caller's memory. For
+ * in-place operation out may describe the same bytes as in, however
+ * segmented; no other overlap is allowed.
+ *
+ * @param[in]  ctx A pointer to a context prepared by aes_ctx_init().
+ * @param[in]  in The input segments.
+ * @param[in]  in_count The number of input segments.
+ * @param[in]  out The output segments, holding at least as many bytes as in. May describe the same memory as in.
+ * @param[in]  out_count The number of output segments.
+ * @return AES_SUCCESS on success, AES_ERROR_INVALID_LENGTH if the input is
+ * not a multiple of the block size or the output is too short, or another
+ * aes_error_t on failure.
+ */
+aes_error_t aes_ecb_encrypt_iov(const aes_ctx_t* ctx, const aes_iovec_t* in, size_t in_count, const aes_iovec_t* out,
+                                size_t out_count);
+
+/**
+ * @brief aes_ecb_decrypt() over scatter-gather lists, as aes_ecb_encrypt_iov().
+ *
+ * @param[in]  ctx A pointer to a context prepared by aes_ctx_init().
+ * @param[in]  in The input segments.
+ * @param[in]  in_count The number of input segments.
+ * @param[in]  out The output segments, holding at least as many bytes as in. May describe the same memory as in.
+ * @param[in]  out_count The number of output segments.
+ * @return AES_SUCCESS on success, AES_ERROR_INVALID_LENGTH if the input is
+ * not a multiple of the block size or the output is too short, or another
+ * aes_error_t on failure.
+ */
+aes_error_t aes_ecb_decrypt_iov(const aes_ctx_t* ctx, const aes_iovec_t* in, size_t in_count, const aes_iovec_t* out,
+                                size_t out_count);
+
+/**
+ * @brief Encrypts many single blocks, each under its own key: out block i is
+ * in block i encrypted with ctxs[i].
+ *
+ * @details Blocks whose contexts share a backend and key size are interleaved
+ * across the backend's lanes (eight in flight for AES-NI, eight bitsliced
+ * lanes with per-lane round keys), so the aggregate rate approaches that of
+ * a bulk mode even though every key sees a single block. Mixed contexts are
+ * processed in runs of compatible neighbours.
+ *
+ * @param[in]  ctxs An array of num_blocks initialized contexts; entries may repeat.
+ * @param[in]  in A pointer to num_blocks input blocks.
+ * @param[out] out A pointer to num_blocks output blocks. May alias in.
+ * @param[in]  num_blocks The number of blocks (and contexts).
+ * @return AES_SUCCESS on success, or AES_ERROR_INVALID_ARGUMENT if a pointer
+ * or context is NULL or uninitialized.
+ */
+aes_error_t aes_multi_encrypt(const aes_ctx_t* const* ctxs, const uint8_t* in, uint8_t* out, size_t num_blocks);
+
+/**
+ * @brief Decrypts many single blocks, each under its own key: out block i is
+ * in block i decrypted with ctxs[i].
+ *
+ * @param[in]  ctxs An array of num_blocks initialized contexts; entries may repeat.
+ * @param[in]  in A pointer to num_blocks input blocks.
+ * @param[out] out A pointer to num_blocks output blocks. May alias in.
+ * @param[in]  num_blocks The number of blocks (and contexts).
+ * @return AES_SUCCESS on success, or AES_ERROR_INVALID_ARGUMENT if a pointer
+ * or context is NULL or uninitialized.
+ */
+aes_error_t aes_multi_decrypt(const aes_ctx_t* const* ctxs, const uint8_t* in, uint8_t* out, size_t num_blocks);
+
+/**
+ * @brief Encrypts many single blocks under raw keys, expanding each key
+ * internally: out block i is in block i encrypted with key i.
+ *
+ * @details The keys are expanded with the default backend a batch at a time
+ * and the blocks then go through aes_multi_encrypt(), so no key schedule
+ * outlives the call.
+ *
+ * @param[in]  keys num_blocks keys of key_size bytes each, back to back.
+ * @param[in]  key_size The size of every key.
+ * @param[in]  in A pointer to num_blocks input blocks.
+ * @param[out] out A pointer to num_blocks output blocks. May alias in.
+ * @param[in]  num_blocks The number of blocks (and keys).
+ * @return AES_SUCCESS on success, or an aes_error_t on failure.
+ */
+aes_error_t aes_multi_encrypt_keys(const uint8_t* keys, aes_key_size_t key_size, const uint8_t* in, uint8_t* out,
+                                   size_t num_blocks);
+
+/**
+ * @brief Securely wipes the key material held by a context.
+ *
+ * @param[in,out] ctx A pointer to the context to clear. NULL is ignored.
+ */
+void aes_ctx_clear(aes_ctx_t* ctx);
+
+/* ============================================================================
+ * Modes of Operation
+ * ========================================================================= */
+
+/**
+ * @brief Encrypts or decrypts a buffer of any length in CTR mode.
+ *
+ * @details The counter block is treated as a single 128-bit big-endian
+ * counter. On return it holds the counter following the last block used, so a
+ * message can be processed in several calls as long as every call except the
+ * last passes a multiple of AES_BLOCK_SIZE bytes. CTR is its own inverse.
+ *
+ * @param[in]     ctx A pointer to a context prepared by aes_ctx_init().
+ * @param[in,out] iv The 16-byte initial counter block; advanced on return.
+ * @param[in]     in A pointer to the input data.
+ * @param[out]    out A pointer to the output buffer. May equal in.
+ * @param[in]     length The number of bytes to process.
+ * @return AES_SUCCESS on success, or an appropriate aes_error_t on failure.
+ */
+aes_error_t aes_ctr_xcrypt(const aes_ctx_t* ctx, uint8_t* iv, const uint8_t* in, uint8_t* out, size_t length);
+
+/**
+ * @brief CTR mode with an explicit counter field width.
+ *
+ * @details Identical to aes_ctr_xcrypt() except that only the low width bits
+ * of the counter block increment (wrapping within that field).
+ *
+ * @param[in]     ctx A pointer to a context prepared by aes_ctx_init().
+ * @param[in,out] counter The 16-byte counter block; advanced on return.
+ * @param[in]     width The width of the incrementing counter field.
+ * @param[in]     in A pointer to the input data.
+ * @param[out]    out A pointer to the output buffer. May equal in.
+ * @param[in]     length The number of bytes to process.
+ * @return AES_SUCCESS on success, or an appropriate aes_error_t on failure.
+ */
+aes_error_t aes_ctr_xcrypt_ex(const aes_ctx_t* ctx, uint8_t* counter, aes_ctr_width_t width, const uint8_t* in,
+                              uint8_t* out, size_t length);
+
+/**
+ * @brief aes_ctr_xcrypt_ex() over scatter-gather lists.
+ *
+ * @details The whole input is one CTR message, processed without copying it
+ * to a contiguous buffer as described for aes_ecb_encrypt_iov().
+ *
+ * @param[in]     ctx A pointer to a context prepared by aes_ctx_init().
+ * @param[in,out] counter The 16-byte counter block; advanced on return.
+ * @param[in]     width The width of the incrementing counter field.
+ * @param[in]     in The input segments.
+ * @param[in]     in_count The number of input segments.
+ * @param[in]     out The output segments, holding at least as many bytes as in. May describe the same memory as in.
+ * @param[in]     out_count The number of output segments.
+ * @return AES_SUCCESS on success, AES_ERROR_INVALID_LENGTH if the output is
+ * too short, or another aes_error_t on failure.
+ */
+aes_error_t aes_ctr_xcrypt_iov(const aes_ctx_t* ctx, uint8_t* counter, aes_ctr_width_t width, const aes_iovec_t* in,
+                               size_t in_count, const aes_iovec_t* out, size_t out_count);
+
+/**
+ * @brief Encrypts whole blocks in CBC mode, without padding.
+ *
+ * @details On return iv holds the last ciphertext block, which is the
+ * chaining value for the next call, so a message can be encrypted in chunks.
+ *
+ * @param[in]     ctx A pointer to a context prepared by aes_ctx_init().
+ * @param[in,out] iv The 16-byte IV; replaced by the chaining value on return.
+ * @param[in]     in A pointer to the plaintext.
+ * @param[out]    out A pointer to the ciphertext buffer. May equal in.
+ * @param[in]     length The number of bytes, a multiple of AES_BLOCK_SIZE.
+ * @return AES_SUCCESS on success, AES_ERROR_INVALID_LENGTH if length is not a
+ * multiple of the block size, or another aes_error_t on failure.
+ */
+aes_error_t aes_cbc_encrypt(const aes_ctx_t* ctx, uint8_t* iv, const uint8_t* in, uint8_t* out, size_t length);
+
+/**
+ * @brief Decrypts whole blocks in CBC mode, without padding.
+ *
+ * @details Unlike encryption, the block decryptions are independent, so they
+ * run several blocks per backend call before the XOR chain is applied. On
+ * return iv holds the last ciphertext block consumed, ready for the next chunk.
+ *
+ * @param[in]     ctx A pointer to a context prepared by aes_ctx_init().
+ * @param[in,out] iv The 16-byte IV; replaced by the chaining value on return.
+ * @param[in]     in A pointer to the ciphertext.
+ * @param[out]    out A pointer to the plaintext buffer. May equal in.
+ * @param[in]     length The number of bytes, a multiple of AES_BLOCK_SIZE.
+ * @return AES_SUCCESS on success, AES_ERROR_INVALID_LENGTH if length is not a
+ * multiple of the block size, or another aes_error_t on failure.
+ */
+aes_error_t aes_cbc_decrypt(const aes_ctx_t* ctx, uint8_t* iv, const uint8_t* in, uint8_t* out, size_t length);
+
+/**
+ * @brief Encrypts many independent CBC streams side by side.
+ *
+ * @details Each stream is encrypted exactly as aes_cbc_encrypt() would
+ * encrypt it. A single stream is serial, every block waiting for the one
+ * before it; here up to eight streams occupy lanes that advance one block
+ * each per step through the multi-key kernels behind aes_multi_encrypt(), so
+ * the backend's pipeline is filled across streams instead. Streams may differ
+ * in key, key size and length: a lane whose stream ends takes the next stream
+ * in the array before the next step. The streams' buffers and IVs must not
+ * overlap one another. All streams are validated before any is processed.
+ *
+ * @param[in,out] streams The streams; each stream's iv is updated on return.
+ * @param[in]     count The number of streams.
+ * @return AES_SUCCESS on success, AES_ERROR_INVALID_LENGTH if a stream's
+ * length is not a multiple of the block size, or another aes_error_t on failure.
+ */
+aes_error_t aes_cbc_encrypt_multi(const aes_cbc_stream_t* streams, size_t count);
+
+/**
+ * @brief aes_cbc_encrypt() over scatter-gather lists, as aes_ecb_encrypt_iov().
+ *
+ * @param[in]     ctx A pointer to a context prepared by aes_ctx_init().
+ * @param[in,out] iv The 16-byte IV; replaced by the chaining value on return.
+ * @param[in]     in The input segments.
+ * @param[in]     in_count The number of input segments.
+ * @param[in]     out The output segments, holding at least as many bytes as in. May describe the same memory as in.
+ * @param[in]     out_count The number of output segments.
+ * @return AES_SUCCESS on success, AES_ERROR_INVALID_LENGTH if the input is
+ * not a multiple of the block size or the output is too short, or another
+ * aes_error_t on failure.
+ */
+aes_error_t aes_cbc_encrypt_iov(const aes_ctx_t* ctx, uint8_t* iv, const aes_iovec_t* in, size_t in_count,
+                                const aes_iovec_t* out, size_t out_count);
+
+/**
+ * @brief aes_cbc_decrypt() over scatter-gather lists, as aes_ecb_encrypt_iov().
+ *
+ * @param[in]     ctx A pointer to a context prepared by aes_ctx_init().
+ * @param[in,out] iv The 16-byte IV; replaced by the chaining value on return.
+ * @param[in]     in The input segments.
+ * @param[in]     in_count The number of input segments.
+ * @param[in]     out The output segments, holding at least as many bytes as in. May describe the same memory as in.
+ * @param[in]     out_count The number of output segments.
+ * @return AES_SUCCESS on success, AES_ERROR_INVALID_LENGTH if the input is
+ * not a multiple of the block size or the output is too short, or another
+ * aes_error_t on failure.
+ */
+aes_error_t aes_cbc_decrypt_iov(const aes_ctx_t* ctx, uint8_t* iv, const aes_iovec_t* in, size_t in_count,
+                                const aes_iovec_t* out, size_t out_count);
+
+/**
+ * @brief Encrypts the final chunk of a CBC message with PKCS#7 padding.
+ *
+ * @details Between 1 and AES_BLOCK_SIZE padding bytes are appended, so the
+ * ciphertext is length rounded down to a whole block plus one block. Earlier
+ * chunks of a streamed message go through aes_cbc_encrypt().
+ *
+ * @param[in]     ctx A pointer to a context prepared by aes_ctx_init().
+ * @param[in,out] iv The 16-byte IV or chaining value; updated on return.
+ * @param[in]     in A pointer to the plaintext.
+ * @param[in]     length The number of plaintext bytes.
+ * @param[out]    out A pointer to the ciphertext buffer. May equal in.
+ * @param[in]     out_size The capacity of out in bytes.
+ * @param[out]    out_length Receives the ciphertext length.
+ * @return AES_SUCCESS on success, AES_ERROR_INVALID_LENGTH if out is too
+ * small, or another aes_error_t on failure.
+ */
+aes_error_t aes_cbc_encrypt_pkcs7(const aes_ctx_t* ctx, uint8_t* iv, const uint8_t* in, size_t length, uint8_t* out,
+                                  size_t out_size, size_t* out_length);
+
+/**
+ * @brief Decrypts the final chunk of a CBC message and strips PKCS#7 padding.
+ *
+ * @details The padding is checked without branching on its content. out
+ * must hold length bytes; only the first *out_length of them are plaintext.
+ *
+ * @param[in]     ctx A pointer to a context prepared by aes_ctx_init().
+ * @param[in,out] iv The 16-byte IV or chaining value; updated on return.
+ * @param[in]     in A pointer to the ciphertext.
+ * @param[in]     length The number of bytes, a nonzero multiple of AES_BLOCK_SIZE.
+ * @param[out]    out A pointer to the plaintext buffer. May equal in.
+ * @param[out]    out_length Receives the plaintext length without padding.
+ * @return AES_SUCCESS on success, AES_ERROR_INVALID_PADDING if the padding is
+ * malformed, AES_ERROR_INVALID_LENGTH for a bad length, or another aes_error_t.
+ */
+aes_error_t aes_cbc_decrypt_pkcs7(const aes_ctx_t* ctx, uint8_t* iv, const uint8_t* in, size_t length, uint8_t* out,
+                                  size_t* out_length);
+
+/**
+ * @brief Initializes an XTS-AES context (IEEE 1619).
+ *
+ * @details As NIST SP 800-38E and FIPS 140 require, the data and tweak keys
+ * must differ; the halves are compared in constant time.
+ *
+ * @param[out] xts A pointer to the context to initialize.
+ * @param[in]  key The concatenated data and tweak keys, 2 * key_size bytes.
+ * @param[in]  key_size The size of each half: AES_KEY_SIZE_128 or AES_KEY_SIZE_256.
+ * @param[in]  backend The block cipher backend, or AES_BACKEND_AUTO for the default.
+ * @return AES_SUCCESS on success, AES_ERROR_UNSUPPORTED_KEY_SIZE for AES-192
+ * (not defined for XTS), AES_ERROR_INVALID_ARGUMENT if the two halves of key
+ * are equal, or another aes_error_t on failure.
+ */
+aes_error_t aes_xts_init(aes_xts_ctx_t* xts, const uint8_t* key, aes_key_size_t key_size, aes_backend_t backend);
+
+/**
+ * @brief Encrypts one data unit in XTS mode.
+ *
+ * @details A final partial block is handled with ciphertext stealing, so the
+ * ciphertext has the same length as the plaintext.
+ *
+ * @param[in]  xts A pointer to a context prepared by aes_xts_init().
+ * @param[in]  tweak The 16-byte tweak, e.g. the little-endian sector number.
+ * @param[in]  in A pointer to the plaintext.
+ * @param[out] out A pointer to the ciphertext buffer. May equal in.
+ * @param[in]  length The data unit length in bytes, at least AES_BLOCK_SIZE.
+ * @return AES_SUCCESS on success, AES_ERROR_INVALID_LENGTH if length is
+ * shorter than a block, or another aes_error_t on failure.
+ */
+aes_error_t aes_xts_encrypt(const aes_xts_ctx_t* xts, const uint8_t* tweak, const uint8_t* in, uint8_t* out,
+                            size_t length);
+
+/**
+ * @brief Decrypts one data unit in XTS mode.
+ *
+ * @param[in]  xts A pointer to a context prepared by aes_xts_init().
+ * @param[in]  tweak The 16-byte tweak used for encryption.
+ * @param[in]  in A pointer to the ciphertext.
+ * @param[out] out A pointer to the plaintext buffer. May equal in.
+ * @param[in]  length The data unit length in bytes, at least AES_BLOCK_SIZE.
+ * @return AES_SUCCESS on success, AES_ERROR_INVALID_LENGTH if length is
+ * shorter than a block, or another aes_error_t on failure.
+ */
+aes_error_t aes_xts_decrypt(const aes_xts_ctx_t* xts, const uint8_t* tweak, const uint8_t* in, uint8_t* out,
+                            size_t length);
+
+/**
+ * @brief Encrypts consecutive sectors, each one an XTS data unit.
+ *
+ * @details Sector i of the buffer uses the tweak sector + i, encoded as a
+ * 128-bit little-endian integer. The sector tweaks are encrypted in batches,
+ * and within a sector each block's tweak is derived from the previous one by a
+ * multiplication by x rather than from scratch.
+ *
+ * @param[in]  xts A pointer to a context prepared by aes_xts_init().
+ * @param[in]  sector The number of the first sector.
+ * @param[in]  sector_size The sector size in bytes (e.g. 512 or 4096), at least AES_BLOCK_SIZE.
+ * @param[in]  in A pointer to num_sectors * sector_size bytes of plaintext.
+ * @param[out] out A pointer to the ciphertext buffer. May equal in.
+ * @param[in]  num_sectors The number of sectors.
+ * @return AES_SUCCESS on success, AES_ERROR_INVALID_LENGTH for a sector size
+ * shorter than a block, or another aes_error_t on failure.
+ */
+aes_error_t aes_xts_encrypt_sectors(const aes_xts_ctx_t* xts, uint64_t sector, size_t sector_size, const uint8_t* in,
+                                    uint8_t* out, size_t num_sectors);
+
+/**
+ * @brief Decrypts consecutive sectors encrypted with aes_xts_encrypt_sectors().
+ *
+ * @param[in]  xts A pointer to a context prepared by aes_xts_init().
+ * @param[in]  sector The number of the first sector.
+ * @param[in]  sector_size The sector size in bytes, at least AES_BLOCK_SIZE.
+ * @param[in]  in A pointer to num_sectors * sector_size bytes of ciphertext.
+ * @param[out] out A pointer to the plaintext buffer. May equal in.
+ * @param[in]  num_sectors The number of sectors.
+ * @return AES_SUCCESS on success, AES_ERROR_INVALID_LENGTH for a sector size
+ * shorter than a block, or another aes_error_t on failure.
+ */
+aes_error_t aes_xts_decrypt_sectors(const aes_xts_ctx_t* xts, uint64_t sector, size_t sector_size, const uint8_t* in,
+                                    uint8_t* out, size_t num_sectors);
+
+/**
+ * @brief Securely wipes the key material held by an XTS context.
+ *
+ * @param[in,out] xts A pointer to the context to clear. NULL is ignored.
+ */
+void aes_xts_clear(aes_xts_ctx_t* xts);
+
+/**
+ * @brief Initializes a GCM context for a key.
+ *
+ * @details The block cipher backend is chosen as by aes_ctx_init_backend().
+ * On x86 CPUs with PCLMULQDQ, the AES-NI backend also enables a fused
+ * CTR+GHASH kernel; every other backend uses a 4-bit table GHASH.
+ *
+ * @param[out] gcm A pointer to the context to initialize.
+ * @param[in]  key A pointer to the AES key.
+ * @param[in]  key_size The size of the key (128, 192, or 256 bits).
+ * @param[in]  backend The block cipher backend, or AES_BACKEND_AUTO for the default.
+ * @return AES_SUCCESS on success, or an appropriate aes_error_t on failure.
+ */
+aes_error_t aes_gcm_init(aes_gcm_ctx_t* gcm, const uint8_t* key, aes_key_size_t key_size, aes_backend_t backend);
+
+/**
+ * @brief Encrypts and authenticates a message with AES-GCM (NIST SP 800-38D).
+ *
+ * @details A 12-byte IV is used directly as the counter nonce; IVs of any
+ * other length are hashed into the initial counter block. The tag may be
+ * truncated to 16, 15, 14, 13, 12, 8 or 4 bytes. An IV must never be reused
+ * with the same key.
+ *
+ * @param[in]  gcm A pointer to a context prepared by aes_gcm_init().
+ * @param[in]  iv A pointer to the IV.
+ * @param[in]  iv_len The IV length in bytes, at least 1.
+ * @param[in]  aad A pointer to the additional authenticated data. May be NULL if aad_len is 0.
+ * @param[in]  aad_len The length of the additional authenticated data.
+ * @param[in]  in A pointer to the plaintext.
+ * @param[out] out A pointer to the ciphertext buffer, length bytes. May equal in.
+ * @param[in]  length The number of bytes to encrypt.
+ * @param[out] tag Receives the authentication tag.
+ * @param[in]  tag_len The tag length in bytes.
+ * @return AES_SUCCESS on success, AES_ERROR_INVALID_LENGTH for an unsupported
+ * tag, IV or message length, or another aes_error_t on failure.
+ */
+aes_error_t aes_gcm_seal(const aes_gcm_ctx_t* gcm, const uint8_t* iv, size_t iv_len, const uint8_t* aad,
+                         size_t aad_len, const uint8_t* in, uint8_t* out, size_t length, uint8_t* tag, size_t tag_len);
+
+/**
+ * @brief Verifies and decrypts a message sealed with aes_gcm_seal().
+ *
+ * @details The tag is compared in constant time. If it does not match, the
+ * output buffer is wiped and AES_ERROR_AUTHENTICATION_FAILED is returned, so
+ * unauthenticated plaintext is never released.
+ *
+ * @param[in]  gcm A pointer to a context prepared by aes_gcm_init().
+ * @param[in]  iv A pointer to the IV.
+ * @param[in]  iv_len The IV length in bytes, at least 1.
+ * @param[in]  aad A pointer to the additional authenticated data. May be NULL if aad_len is 0.
+ * @param[in]  aad_len The length of the additional authenticated data.
+ * @param[in]  in A pointer to the ciphertext.
+ * @param[out] out A pointer to the plaintext buffer, length bytes. May equal in.
+ * @param[in]  length The number of bytes to decrypt.
+ * @param[in]  tag A pointer to the received authentication tag.
+ * @param[in]  tag_len The tag length in bytes.
+ * @return AES_SUCCESS if the tag verified, AES_ERROR_AUTHENTICATION_FAILED if
+ * it did not, or another aes_error_t on failure.
+ */
+aes_error_t aes_gcm_open(const aes_gcm_ctx_t* gcm, const uint8_t* iv, size_t iv_len, const uint8_t* aad,
+                         size_t aad_len, const uint8_t* in, uint8_t* out, size_t length, const uint8_t* tag,
+                         size_t tag_len);
+
+/**
+ * @brief aes_gcm_seal() over scatter-gather lists for the message.
+ *
+ * @details The message is encrypted and hashed without copying it to a
+ * contiguous buffer, as described for aes_ecb_encrypt_iov(); the AAD is
+ * contiguous.
+ *
+ * @param[in]  gcm A pointer to a context prepared by aes_gcm_init().
+ * @param[in]  iv A pointer to the IV.
+ * @param[in]  iv_len The IV length in bytes, at least 1.
+ * @param[in]  aad A pointer to the additional authenticated data. May be NULL if aad_len is 0.
+ * @param[in]  aad_len The length of the additional authenticated data.
+ * @param[in]  in The input segments.
+ * @param[in]  in_count The number of input segments.
+ * @param[in]  out The output segments, holding at least as many bytes as in. May describe the same memory as in.
+ * @param[in]  out_count The number of output segments.
+ * @param[out] tag Receives the authentication tag.
+ * @param[in]  tag_len The tag length in bytes.
+ * @return As for aes_gcm_seal().
+ */
+aes_error_t aes_gcm_seal_iov(const aes_gcm_ctx_t* gcm, const uint8_t* iv, size_t iv_len, const uint8_t* aad,
+                             size_t aad_len, const aes_iovec_t* in, size_t in_count, const aes_iovec_t* out,
+                             size_t out_count, uint8_t* tag, size_t tag_len);
+
+/**
+ * @brief aes_gcm_open() over scatter-gather lists for the message.
+ *
+ * @details If the tag does not verify, every output byte is wiped.
+ *
+ * @param[in]  gcm A pointer to a context prepared by aes_gcm_init().
+ * @param[in]  iv A pointer to the IV.
+ * @param[in]  iv_len The IV length in bytes, at least 1.
+ * @param[in]  aad A pointer to the additional authenticated data. May be NULL if aad_len is 0.
+ * @param[in]  aad_len The length of the additional authenticated data.
+ * @param[in]  in The input segments.
+ * @param[in]  in_count The number of input segments.
+ * @param[in]  out The output segments, holding at least as many bytes as in. May describe the same memory as in.
+ * @param[in]  out_count The number of output segments.
+ * @param[in]  tag A pointer to the received authentication tag.
+ * @param[in]  tag_len The tag length in bytes.
+ * @return As for aes_gcm_open().
+ */
+aes_error_t aes_gcm_open_iov(const aes_gcm_ctx_t* gcm, const uint8_t* iv, size_t iv_len, const uint8_t* aad,
+                             size_t aad_len, const aes_iovec_t* in, size_t in_count, const aes_iovec_t* out,
+                             size_t out_count, const uint8_t* tag, size_t tag_len);
+
+/**
+ * @brief Securely wipes the key material held by a GCM context.
+ *
+ * @param[in,out] gcm A pointer to the context to clear. NULL is ignored.
+ */
+void aes_gcm_clear(aes_gcm_ctx_t* gcm);
+
+/**
+ * @brief Initializes an OCB3 context for a key.
+ *
+ * @details The block cipher backend is chosen as by aes_ctx_init_backend(),
+ * and the offset table L_*, L_$, L_0, L_1, ... is derived once here.
+ *
+ * @param[out] ocb A pointer to the context to initialize.
+ * @param[in]  key A pointer to the AES key.
+ * @param[in]  key_size The size of the key (128, 192, or 256 bits).
+ * @param[in]  backend The block cipher backend, or AES_BACKEND_AUTO for the default.
+ * @return AES_SUCCESS on success, or an appropriate aes_error_t on failure.
+ */
+aes_error_t aes_ocb_init(aes_ocb_ctx_t* ocb, const uint8_t* key, aes_key_size_t key_size, aes_backend_t backend);
+
+/**
+ * @brief Encrypts and authenticates a message with OCB3 (RFC 7253).
+ *
+ * @details One pass over the data with one block cipher call per block; the
+ * blocks are run through the backend several at a time. The nonce is 1 to 15
+ * bytes (RFC 7253 recommends 12) and must never be reused with the same key.
+ * The tag length, 1 to 16 bytes, is bound into the computation, so a tag
+ * cannot be shortened after the fact.
+ *
+ * @param[in]  ocb A pointer to a context prepared by aes_ocb_init().
+ * @param[in]  nonce A pointer to the nonce.
+ * @param[in]  nonce_len The nonce length in bytes, 1 to 15.
+ * @param[in]  aad A pointer to the additional authenticated data. May be NULL if aad_len is 0.
+ * @param[in]  aad_len The length of the additional authenticated data.
+ * @param[in]  in A pointer to the plaintext.
+ * @param[out] out A pointer to the ciphertext buffer, length bytes. May equal in.
+ * @param[in]  length The number of bytes to encrypt.
+ * @param[out] tag Receives the authentication tag.
+ * @param[in]  tag_len The tag length in bytes.
+ * @return AES_SUCCESS on success, AES_ERROR_INVALID_LENGTH for an unsupported
+ * nonce or tag length, or another aes_error_t on failure.
+ */
+aes_error_t aes_ocb_seal(const aes_ocb_ctx_t* ocb, const uint8_t* nonce, size_t nonce_len, const uint8_t* aad,
+                         size_t aad_len, const uint8_t* in, uint8_t* out, size_t length, uint8_t* tag, size_t tag_len);
+
+/**
+ * @brief Verifies and decrypts a message sealed with aes_ocb_seal().
+ *
+ * @details Blocks are decrypted with the backend's inverse cipher. The tag is
+ * compared in constant time; if it does not match, the output buffer is wiped
+ * and AES_ERROR_AUTHENTICATION_FAILED is returned.
+ *
+ * @param[in]  ocb A pointer to a context prepared by aes_ocb_init().
+ * @param[in]  nonce A pointer to the nonce.
+ * @param[in]  nonce_len The nonce length in bytes, 1 to 15.
+ * @param[in]  aad A pointer to the additional authenticated data. May be NULL if aad_len is 0.
+ * @param[in]  aad_len The length of the additional authenticated data.
+ * @param[in]  in A pointer to the ciphertext.
+ * @param[out] out A pointer to the plaintext buffer, length bytes. May equal in.
+ * @param[in]  length The number of bytes to decrypt.
+ * @param[in]  tag A pointer to the received authentication tag.
+ * @param[in]  tag_len The tag length in bytes.
+ * @return AES_SUCCESS if the tag verified, AES_ERROR_AUTHENTICATION_FAILED if
+ * it did not, or another aes_error_t on failure.
+ */
+aes_error_t aes_ocb_open(const aes_ocb_ctx_t* ocb, const uint8_t* nonce, size_t nonce_len, const uint8_t* aad,
+                         size_t aad_len, const uint8_t* in, uint8_t* out, size_t length, const uint8_t* tag,
+                         size_t tag_len);
+
+/**
+ * @brief Securely wipes the key material held by an OCB context.
+ *
+ * @param[in,out] ocb A pointer to the context to clear. NULL is ignored.
+ */
+void aes_ocb_clear(aes_ocb_ctx_t* ocb);
+
+/* ============================================================================
+ * Message Authentication
+ * ========================================================================= */
+
+/**
+ * @brief Initializes a CMAC context for a key and starts the first message.
+ *
+ * @details Derives the subkeys K1 and K2 from E(K, 0^128) by doubling in
+ * GF(2^128). The block cipher backend is chosen as by aes_ctx_init_backend().
+ *
+ * @param[out] cmac A pointer to the context to initialize.
+ * @param[in]  key A pointer to the AES key.
+ * @param[in]  key_size The size of the key (128, 192, or 256 bits).
+ * @param[in]  backend The block cipher backend, or AES_BACKEND_AUTO for the default.
+ * @return AES_SUCCESS on success, or an appropriate aes_error_t on failure.
+ */
+aes_error_t aes_cmac_init(aes_cmac_ctx_t* cmac, const uint8_t* key, aes_key_size_t key_size, aes_backend_t backend);
+
+/**
+ * @brief Feeds message bytes to a CMAC computation.
+ *
+ * @details The message may be split at any byte boundary; the tag depends
+ * only on the concatenation.
+ *
+ * @param[in,out] cmac A pointer to a context prepared by aes_cmac_init().
+ * @param[in]     data A pointer to the message bytes. May be NULL if length is 0.
+ * @param[in]     length The number of bytes.
+ * @return AES_SUCCESS on success, or AES_ERROR_INVALID_ARGUMENT.
+ */
+aes_error_t aes_cmac_update(aes_cmac_ctx_t* cmac, const uint8_t* data, size_t length);
+
+/**
+ * @brief Completes a CMAC computation and starts the next message.
+ *
+ * @param[in,out] cmac A pointer to a context prepared by aes_cmac_init().
+ * @param[out]    tag Receives the tag.
+ * @param[in]     tag_len The tag length in bytes, 1 to AES_BLOCK_SIZE; the tag is truncated to its leftmost bytes.
+ * @return AES_SUCCESS on success, AES_ERROR_INVALID_LENGTH for an unsupported
+ * tag length, or AES_ERROR_INVALID_ARGUMENT.
+ */
+aes_error_t aes_cmac_final(aes_cmac_ctx_t* cmac, uint8_t* tag, size_t tag_len);
+
+/**
+ * @brief Completes a CMAC computation and compares the result with a received tag.
+ *
+ * @details The comparison runs in constant time. Like aes_cmac_final(), it
+ * starts the next message.
+ *
+ * @param[in,out] cmac A pointer to a context prepared by aes_cmac_init().
+ * @param[in]     tag A pointer to the received tag.
+ * @param[in]     tag_len The tag length in bytes, 1 to AES_BLOCK_SIZE.
+ * @return AES_SUCCESS if the tag verified, AES_ERROR_AUTHENTICATION_FAILED if
+ * it did not, or another aes_error_t on failure.
+ */
+aes_error_t aes_cmac_verify(aes_cmac_ctx_t* cmac, const uint8_t* tag, size_t tag_len);
+
+/**
+ * @brief Securely wipes the key material and message state of a CMAC context.
+ *
+ * @param[in,out] cmac A pointer to the context to clear. NULL is ignored.
+ */
+void aes_cmac_clear(aes_cmac_ctx_t* cmac);
+
+/**
+ * @brief Initializes a PMAC context for a key and starts the first message.
+ *
+ * @details Precomputes L = E(K, 0^128), its multiples L.x^i for the block
+ * offsets and L.x^-1. The block cipher backend is chosen as by
+ * aes_ctx_init_backend().
+ *
+ * @param[out] pmac A pointer to the context to initialize.
+ * @param[in]  key A pointer to the AES key.
+ * @param[in]  key_size The size of the key (128, 192, or 256 bits).
+ * @param[in]  backend The block cipher backend, or AES_BACKEND_AUTO for the default.
+ * @return AES_SUCCESS on success, or an appropriate aes_error_t on failure.
+ */
+aes_error_t aes_pmac_init(aes_pmac_ctx_t* pmac, const uint8_t* key, aes_key_size_t key_size, aes_backend_t backend);
+
+/**
+ * @brief Feeds message bytes to a PMAC computation.
+ *
+ * @param[in,out] pmac A pointer to a context prepared by aes_pmac_init().
+ * @param[in]     data A pointer to the message bytes. May be NULL if length is 0.
+ * @param[in]     length The number of bytes.
+ * @return AES_SUCCESS on success, or AES_ERROR_INVALID_ARGUMENT.
+ */
+aes_error_t aes_pmac_update(aes_pmac_ctx_t* pmac, const uint8_t* data, size_t length);
+
+/**
+ * @brief Completes a PMAC computation and starts the next message.
+ *
+ * @param[in,out] pmac A pointer to a context prepared by aes_pmac_init().
+ * @param[out]    tag Receives the tag.
+ * @param[in]     tag_len The tag length in bytes, 1 to AES_BLOCK_SIZE; the tag is truncated to its leftmost bytes.
+ * @return AES_SUCCESS on success, AES_ERROR_INVALID_LENGTH for an unsupported
+ * tag length, or AES_ERROR_INVALID_ARGUMENT.
+ */
+aes_error_t aes_pmac_final(aes_pmac_ctx_t* pmac, uint8_t* tag, size_t tag_len);
+
+/**
+ * @brief Completes a PMAC computation and compares the result with a received tag in constant time.
+ *
+ * @param[in,out] pmac A pointer to a context prepared by aes_pmac_init().
+ * @param[in]     tag A pointer to the received tag.
+ * @param[in]     tag_len The tag length in bytes, 1 to AES_BLOCK_SIZE.
+ * @return AES_SUCCESS if the tag verified, AES_ERROR_AUTHENTICATION_FAILED if
+ * it did not, or another aes_error_t on failure.
+ */
+aes_error_t aes_pmac_verify(aes_pmac_ctx_t* pmac, const uint8_t* tag, size_t tag_len);
+
+/**
+ * @brief Securely wipes the key material and message state of a PMAC context.
+ *
+ * @param[in,out] pmac A pointer to the context to clear. NULL is ignored.
+ */
+void aes_pmac_clear(aes_pmac_ctx_t* pmac);
+
+/* ============================================================================
+ * Random Number Generation
+ * ========================================================================= */
+
+/**
+ * @brief Instantiates a CTR_DRBG from the entropy source.
+ *
+ * @details Draws AES_DRBG_SEED_SIZE bytes from entropy, which must deliver
+ * full entropy, and mixes in the optional personalization string. The
+ * callback is kept for the automatic reseeds. After fork(), parent and child
+ * would generate the same output until one of them calls aes_drbg_reseed().
+ *
+ * @param[out] drbg A pointer to the context to instantiate.
+ * @param[in]  entropy The entropy source.
+ * @param[in]  entropy_arg The argument passed to entropy.
+ * @param[in]  personalization An optional personalization string. May be NULL if personalization_len is 0.
+ * @param[in]  personalization_len Its length, at most AES_DRBG_SEED_SIZE.
+ * @param[in]  backend The block cipher backend, or AES_BACKEND_AUTO for the default.
+ * @return AES_SUCCESS on success, AES_ERROR_ENTROPY_FAILED if the source
+ * failed, or another aes_error_t on failure.
+ */
+aes_error_t aes_drbg_init(aes_drbg_ctx_t* drbg, aes_drbg_entropy_fn entropy, void* entropy_arg,
+                          const uint8_t* personalization, size_t personalization_len, aes_backend_t backend);
+
+/**
+ * @brief Reseeds a CTR_DRBG with fresh entropy and discards buffered output.
+ *
+ * @param[in,out] drbg An instantiated context.
+ * @param[in] additional Optional additional input. May be NULL if additional_len is 0.
+ * @param[in] additional_len Its length, at most AES_DRBG_SEED_SIZE.
+ * @return AES_SUCCESS on success, AES_ERROR_ENTROPY_FAILED if the source
+ * failed, or another aes_error_t on failure.
+ */
+aes_error_t aes_drbg_reseed(aes_drbg_ctx_t* drbg, const uint8_t* additional, size_t additional_len);
+
+/**
+ * @brief Fills a buffer with random bytes.
+ *
+ * @details Small requests are copied out of the context's buffer, which is
+ * refilled AES_DRBG_BUFFER_SIZE bytes at a time with bulk CTR output, and the
+ * copied bytes are wiped from it. Requests of at least AES_DRBG_BUFFER_SIZE
+ * bytes are generated directly into out. The DRBG reseeds itself from its
+ * entropy source when the reseed interval is reached.
+ *
+ * @param[in,out] drbg An instantiated context.
+ * @param[out] out Receives length random bytes.
+ * @param[in] length The number of bytes to generate.
+ * @return AES_SUCCESS on success, AES_ERROR_ENTROPY_FAILED if a reseed
+ * failed (out is then wiped), or AES_ERROR_INVALID_ARGUMENT.
+ */
+aes_error_t aes_drbg_generate(aes_drbg_ctx_t* drbg, uint8_t* out, size_t length);
+
+/**
+ * @brief Runs one SP 800-90A generate call, bypassing the buffer.
+ *
+ * @details The key and counter are updated before returning, so the output
+ * cannot be recovered from the context afterwards. Use this for additional
+ * input, or when buffered output must not stay in memory.
+ *
+ * @param[in,out] drbg An instantiated context.
+ * @param[in] additional Optional additional input. May be NULL if additional_len is 0.
+ * @param[in] additional_len Its length, at most AES_DRBG_SEED_SIZE.
+ * @param[out] out Receives length random bytes.
+ * @param[in] length The number of bytes to generate, at most AES_DRBG_MAX_REQUEST.
+ * @return AES_SUCCESS on success, AES_ERROR_INVALID_LENGTH for an oversized
+ * request or input, AES_ERROR_ENTROPY_FAILED if a reseed failed, or
+ * AES_ERROR_INVALID_ARGUMENT.
+ */
+aes_error_t aes_drbg_generate_direct(aes_drbg_ctx_t* drbg, const uint8_t* additional, size_t additional_len,
+                                     uint8_t* out, size_t length);
+
+/**
+ * @brief Securely wipes a CTR_DRBG context, including its buffered output.
+ *
+ * @param[in,out] drbg A pointer to the context to clear. NULL is ignored.
+ */
+void aes_drbg_clear(aes_drbg_ctx_t* drbg);
+
+/**
+ * @brief Fills a buffer with random bytes from the calling thread's own CTR_DRBG.
+ *
+ * @details Each thread's instance is created on its first call, seeded from
+ * entropy, and used by that thread alone, so no call takes a lock. The
+ * callback given on the call that creates the instance is kept for its
+ * reseeds. Where POSIX threads are available the instance is wiped and freed
+ * when the thread exits; aes_drbg_thread_clear() does so explicitly.
+ *
+ * @param[in] entropy The entropy source.
+ * @param[in] entropy_arg The argument passed to entropy.
+ * @param[out] out Receives length random bytes.
+ * @param[in] length The number of bytes to generate.
+ * @return AES_SUCCESS on success, AES_ERROR_MEMORY_ALLOCATION_FAILED or
+ * AES_ERROR_ENTROPY_FAILED if the instance could not be created, or another
+ * error from aes_drbg_generate().
+ */
+aes_error_t aes_drbg_thread_generate(aes_drbg_entropy_fn entropy, void* entropy_arg, uint8_t* out, size_t length);
+
+/** @brief Wipes and frees the calling thread's CTR_DRBG, if it has one. */
+void aes_drbg_thread_clear(void);
+
+/* ============================================================================
+ * Multi-threaded Engine
+ * ========================================================================= */
+
+/**
+ * @brief Creates an engine and starts its worker threads.
+ *
+ * @details Each operation submitted to the engine is split into chunks of
+ * chunk_size bytes that the workers and the calling thread claim until none
+ * are left. Every worker copies the read-only key schedule before it starts,
+ * so threads never share cache lines of the caller's context. Operations on
+ * one engine are serialized; create one engine per submitting thread for
+ * concurrent use. On builds without POSIX threads the engine runs every
+ * operation on the calling thread.
+ *
+ * @param[out] engine Receives the new engine.
+ * @param[in]  config The configuration, or NULL for the defaults.
+ * @return AES_SUCCESS on success, AES_ERROR_MEMORY_ALLOCATION_FAILED if the
+ * engine or its threads could not be created, or AES_ERROR_INVALID_ARGUMENT
+ * for an invalid configuration.
+ */
+aes_error_t aes_engine_create(aes_engine_t** engine, const aes_engine_config_t* config);
+
+/**
+ * @brief Stops the worker threads and frees the engine.
+ *
+ * @param[in] engine The engine to destroy. NULL is ignored.
+ */
+void aes_engine_destroy(aes_engine_t* engine);
+
+/**
+ * @brief Returns the number of threads an engine uses, including the caller.
+ *
+ * @param[in] engine An engine created by aes_engine_create().
+ * @return The thread count, or 0 if engine is NULL.
+ */
+unsigned aes_engine_num_threads(const aes_engine_t* engine);
+
+/**
+ * @brief Multi-threaded aes_ecb_encrypt().
+ *
+ * @param[in]  engine An engine created by aes_engine_create().
+ * @param[in]  ctx A pointer to a context prepared by aes_ctx_init().
+ * @param[in]  in A pointer to the input blocks.
+ * @param[out] out A pointer to the output buffer. May equal in.
+ * @param[in]  length The number of bytes, a multiple of AES_BLOCK_SIZE.
+ * @return AES_SUCCESS on success, or an appropriate aes_error_t on failure.
+ */
+aes_error_t aes_engine_ecb_encrypt(aes_engine_t* engine, const aes_ctx_t* ctx, const uint8_t* in, uint8_t* out,
+                                   size_t length);
+
+/**
+ * @brief Multi-threaded aes_ecb_decrypt().
+ *
+ * @param[in]  engine An engine created by aes_engine_create().
+ * @param[in]  ctx A pointer to a context prepared by aes_ctx_init().
+ * @param[in]  in A pointer to the input blocks.
+ * @param[out] out A pointer to the output buffer. May equal in.
+ * @param[in]  length The number of bytes, a multiple of AES_BLOCK_SIZE.
+ * @return AES_SUCCESS on success, or an appropriate aes_error_t on failure.
+ */
+aes_error_t aes_engine_ecb_decrypt(aes_engine_t* engine, const aes_ctx_t* ctx, const uint8_t* in, uint8_t* out,
+                                   size_t length);
+
+/**
+ * @brief Multi-threaded aes_ctr_xcrypt_ex().
+ *
+ * @details Each chunk starts from the counter advanced by its block offset, so
+ * the result and the final counter are identical to the single-threaded call.
+ *
+ * @param[in]     engine An engine created by aes_engine_create().
+ * @param[in]     ctx A pointer to a context prepared by aes_ctx_init().
+ * @param[in,out] counter The 16-byte counter block; advanced on return.
+ * @param[in]     width The width of the incrementing counter field.
+ * @param[in]     in A pointer to the input data.
+ * @param[out]    out A pointer to the output buffer. May equal in.
+ * @param[in]     length The number of bytes to process.
+ * @return AES_SUCCESS on success, or an appropriate aes_error_t on failure.
+ */
+aes_error_t aes_engine_ctr_xcrypt(aes_engine_t* engine, const aes_ctx_t* ctx, uint8_t* counter, aes_ctr_width_t width,
+                                  const uint8_t* in, uint8_t* out, size_t length);
+
+/**
+ * @brief Multi-threaded aes_cbc_decrypt().
+ *
+ * @details The ciphertext block preceding each chunk is captured before any
+ * thread starts, so in-place decryption is safe.
+ *
+ * @param[in]     engine An engine created by aes_engine_create().
+ * @param[in]     ctx A pointer to a context prepared by aes_ctx_init().
+ * @param[in,out] iv The 16-byte IV; replaced by the chaining value on return.
+ * @param[in]     in A pointer to the ciphertext.
+ * @param[out]    out A pointer to the plaintext buffer. May equal in.
+ * @param[in]     length The number of bytes, a multiple of AES_BLOCK_SIZE.
+ * @return AES_SUCCESS on success, or an appropriate aes_error_t on failure.
+ */
+aes_error_t aes_engine_cbc_decrypt(aes_engine_t* engine, const aes_ctx_t* ctx, uint8_t* iv, const uint8_t* in,
+                                   uint8_t* out, size_t length);
+
+/**
+ * @brief Multi-threaded aes_xts_encrypt_sectors().
+ *
+ * @details Chunks are rounded to whole sectors.
+ *
+ * @param[in]  engine An engine created by aes_engine_create().
+ * @param[in]  xts A pointer to a context prepared by aes_xts_init().
+ * @param[in]  sector The number of the first sector.
+ * @param[in]  sector_size The sector size in bytes, at least AES_BLOCK_SIZE.
+ * @param[in]  in A pointer to num_sectors * sector_size bytes of plaintext.
+ * @param[out] out A pointer to the ciphertext buffer. May equal in.
+ * @param[in]  num_sectors The number of sectors.
+ * @return AES_SUCCESS on success, or an appropriate aes_error_t on failure.
+ */
+aes_error_t aes_engine_xts_encrypt_sectors(aes_engine_t* engine, const aes_xts_ctx_t* xts, uint64_t sector,
+                                           size_t sector_size, const uint8_t* in, uint8_t* out, size_t num_sectors);
+
+/**
+ * @brief Multi-threaded aes_xts_decrypt_sectors().
+ *
+ * @param[in]  engine An engine created by aes_engine_create().
+ * @param[in]  xts A pointer to a context prepared by aes_xts_init().
+ * @param[in]  sector The number of the first sector.
+ * @param[in]  sector_size The sector size in bytes, at least AES_BLOCK_SIZE.
+ * @param[in]  in A pointer to num_sectors * sector_size bytes of ciphertext.
+ * @param[out] out A pointer to the plaintext buffer. May equal in.
+ * @param[in]  num_sectors The number of sectors.
+ * @return AES_SUCCESS on success, or an appropriate aes_error_t on failure.
+ */
+aes_error_t aes_engine_xts_decrypt_sectors(aes_engine_t* engine, const aes_xts_ctx_t* xts, uint64_t sector,
+                                           size_t sector_size, const uint8_t* in, uint8_t* out, size_t num_sectors);
+
+/**
+ * @brief Multi-threaded aes_pmac_update().
+ *
+ * @details Whole blocks are split across the threads, each of which sums
+ * its chunk from the chunk's block index alone; the partial sums are XORed
+ * together, so the context ends up exactly as after aes_pmac_update(). Calls
+ * may be mixed freely with aes_pmac_update() on the same message.
+ *
+ * @param[in]     engine An engine created by aes_engine_create().
+ * @param[in,out] pmac A pointer to a context prepared by aes_pmac_init().
+ * @param[in]     data A pointer to the message bytes. May be NULL if length is 0.
+ * @param[in]     length The number of bytes.
+ * @return AES_SUCCESS on success, or AES_ERROR_INVALID_ARGUMENT.
+ */
+aes_error_t aes_engine_pmac_update(aes_engine_t* engine, aes_pmac_ctx_t* pmac, const uint8_t* data, size_t length);
+
+/* ============================================================================
+ * Keyring
+ * ========================================================================= */
+
+/**
+ * @brief Creates a keyring with room for capacity keys.
+ *
+ * @details A keyring expands each registered key once, encryption and
+ * decryption schedules together, into its own cache-line-aligned context.
+ * Any number of threads may look keys up concurrently without taking a lock:
+ * a lookup is a single atomic load inside a read-side section, which only
+ * touches a per-thread counter. Adding and removing keys is serialized, and
+ * removal waits until no read-side section that could still see the key is
+ * open, then wipes and frees it (epoch-based reclamation).
+ *
+ * @param[out] keyring Receives the new keyring.
+ * @param[in]  capacity The maximum number of keys held at once, at least 1.
+ * @return AES_SUCCESS on success, AES_ERROR_INVALID_ARGUMENT for a zero
+ * capacity, or AES_ERROR_MEMORY_ALLOCATION_FAILED.
+ */
+aes_error_t aes_keyring_create(aes_keyring_t** keyring, size_t capacity);
+
+/**
+ * @brief Wipes every key and frees the keyring.
+ *
+ * @details No other thread may use the keyring during or after this call.
+ *
+ * @param[in] keyring The keyring to destroy. NULL is ignored.
+ */
+void aes_keyring_destroy(aes_keyring_t* keyring);
+
+/**
+ * @brief Expands a key and registers it.
+ *
+ * @param[in]  keyring A keyring created by aes_keyring_create().
+ * @param[in]  key A pointer to the raw key.
+ * @param[in]  key_size The size of the key.
+ * @param[in]  backend The backend to expand for, or AES_BACKEND_AUTO.
+ * @param[out] handle Receives the handle of the key.
+ * @return AES_SUCCESS on success, AES_ERROR_KEYRING_FULL if every slot is in
+ * use, or another aes_error_t on failure.
+ */
+aes_error_t aes_keyring_add(aes_keyring_t* keyring, const uint8_t* key, aes_key_size_t key_size,
+                            aes_backend_t backend, aes_key_handle_t* handle);
+
+/**
+ * @brief Unregisters a key, then wipes and frees it once no reader can still use it.
+ *
+ * @details Blocks until every read-side section that began before the key was
+ * unpublished has ended, so it must not be called from inside a read-side
+ * section. Lookups that start after the call begins return NULL.
+ *
+ * @param[in] keyring A keyring created by aes_keyring_create().
+ * @param[in] handle The handle returned by aes_keyring_add().
+ * @return AES_SUCCESS on success, or AES_ERROR_KEY_NOT_FOUND if the handle is
+ * unknown or already removed.
+ */
+aes_error_t aes_keyring_remove(aes_keyring_t* keyring, aes_key_handle_t handle);
+
+/**
+ * @brief Begins a read-side section, during which looked-up contexts stay valid.
+ *
+ * @details Sections may nest and are cheap: two atomic operations on a
+ * counter shared only with the threads that hash to the same stripe.
+ *
+ * @param[in] keyring A keyring created by aes_keyring_create().
+ * @return A token to pass to aes_keyring_read_end().
+ */
+unsigned aes_keyring_read_begin(aes_keyring_t* keyring);
+
+/**
+ * @brief Ends a read-side section begun by aes_keyring_read_begin().
+ *
+ * @param[in] keyring The keyring.
+ * @param[in] token The token returned by the matching aes_keyring_read_begin().
+ */
+void aes_keyring_read_end(aes_keyring_t* keyring, unsigned token);
+
+/**
+ * @brief Looks up the context of a registered key.
+ *
+ * @details Must be called inside a read-side section. The context may be used
+ * with every aes_ctx_t function until the section ends, and must not be
+ * modified or cleared.
+ *
+ * @param[in] keyring A keyring created by aes_keyring_create().
+ * @param[in] handle The handle returned by aes_keyring_add().
+ * @return The context, or NULL if the handle is unknown or was removed.
+ */
+const aes_ctx_t* aes_keyring_lookup(const aes_keyring_t* keyring, aes_key_handle_t handle);
+
+/**
+ * @brief aes_ecb_encrypt() under a registered key, inside its own read-side section.
+ *
+ * @param[in]  keyring A keyring created by aes_keyring_create().
+ * @param[in]  handle The handle returned by aes_keyring_add().
+ * @param[in]  in A pointer to the input blocks.
+ * @param[out] out A pointer to the output buffer. May alias in.
+ * @param[in]  length The number of bytes, a multiple of AES_BLOCK_SIZE.
+ * @return AES_SUCCESS on success, AES_ERROR_KEY_NOT_FOUND for an unknown
+ * handle, or another aes_error_t on failure.
+ */
+aes_error_t aes_keyring_ecb_encrypt(aes_keyring_t* keyring, aes_key_handle_t handle, const uint8_t* in, uint8_t* out,
+                                    size_t length);
+
+/**
+ * @brief aes_ecb_decrypt() under a registered key, inside its own read-side section.
+ *
+ * @param[in]  keyring A keyring created by aes_keyring_create().
+ * @param[in]  handle The handle returned by aes_keyring_add().
+ * @param[in]  in A pointer to the input blocks.
+ * @param[out] out A pointer to the output buffer. May alias in.
+ * @param[in]  length The number of bytes, a multiple of AES_BLOCK_SIZE.
+ * @return AES_SUCCESS on success, AES_ERROR_KEY_NOT_FOUND for an unknown
+ * handle, or another aes_error_t on failure.
+ */
+aes_error_t aes_keyring_ecb_decrypt(aes_keyring_t* keyring, aes_key_handle_t handle, const uint8_t* in, uint8_t* out,
+                                    size_t length);
+
+/* ============================================================================
+ * Encrypted Archives
+ * ========================================================================= */
+
+/**
+ * @brief Returns the size of the archive described by info.
+ *
+ * @details An archive is laid out as the AES_ARCHIVE_HEADER_SIZE-byte header,
+ * then the ciphertext of every chunk back to back (so plaintext byte X is
+ * ciphertext byte AES_ARCHIVE_HEADER_SIZE + X), then the index: one
+ * AES_ARCHIVE_TAG_SIZE-byte tag per chunk. Every chunk is chunk_size bytes
+ * except the last, which holds the remainder; an empty archive has one empty
+ * chunk, so its header is still authenticated.
+ *
+ * @param[in] info The archive parameters.
+ * @return The size in bytes, or 0 if info is NULL or invalid.
+ */
+uint64_t aes_archive_size(const aes_archive_info_t* info);
+
+/**
+ * @brief Parses the header of an archive.
+ *
+ * @details Checks the header's structure and that size matches it, but not
+ * its authenticity, which no chunk can be opened without. Use info->key_id to
+ * find the key for aes_archive_init().
+ *
+ * @param[out] info Receives the archive parameters.
+ * @param[in]  archive The whole archive, e.g. a read-only mapping of the file.
+ * @param[in]  size The size of archive in bytes.
+ * @return AES_SUCCESS on success, AES_ERROR_INVALID_FORMAT if archive is not
+ * an archive of this size, or AES_ERROR_INVALID_ARGUMENT.
+ */
+aes_error_t aes_archive_read_info(aes_archive_info_t* info, const uint8_t* archive, size_t size);
+
+/**
+ * @brief Prepares an archive context for writing or reading.
+ *
+ * @details To write, fill info with a fresh random nonce_base: two archives
+ * under one key with the same nonce base reuse chunk nonces. To read, pass the
+ * info returned by aes_archive_read_info().
+ *
+ * @param[out] archive The context to initialize.
+ * @param[in]  info The archive parameters; info->key_size is the size of key.
+ * @param[in]  key A pointer to the raw key.
+ * @param[in]  backend The backend to use, or AES_BACKEND_AUTO for the default.
+ * @return AES_SUCCESS on success, AES_ERROR_INVALID_FORMAT for invalid
+ * parameters, or another aes_error_t on failure.
+ */
+aes_error_t aes_archive_init(aes_archive_ctx_t* archive, const aes_archive_info_t* info, const uint8_t* key,
+                             aes_backend_t backend);
+
+/**
+ * @brief Encrypts a whole plaintext into an archive.
+ *
+ * @details Each chunk is sealed independently, with the header and the
+ * chunk's index as additional data, so chunks can be opened in any order and
+ * none can be moved, reordered or spliced in from another archive. With an
+ * engine, the chunks are sealed on its threads.
+ *
+ * @param[in]  archive A context prepared by aes_archive_init().
+ * @param[in]  engine An engine to spread the chunks over, or NULL for the calling thread.
+ * @param[in]  in The plaintext, archive->info.length bytes. May be NULL if the length is 0.
+ * @param[out] out Receives the archive, aes_archive_size() bytes, e.g. a writable mapping of the file.
+ * @return AES_SUCCESS on success, or AES_ERROR_INVALID_ARGUMENT.
+ */
+aes_error_t aes_archive_seal(const aes_archive_ctx_t* archive, aes_engine_t* engine, const uint8_t* in,
+                             uint8_t* out);
+
+/**
+ * @brief Verifies and decrypts a byte range of an archive.
+ *
+ * @details Only the chunks overlapping [offset, offset + length) are read,
+ * so on a mapping only their pages and index entries are faulted in. Chunks
+ * that lie wholly inside the range are opened straight into out; the first
+ * and last may be partial and are opened into a scratch buffer. With an
+ * engine, the chunks are opened on its threads. If any chunk fails to verify,
+ * out is wiped and AES_ERROR_AUTHENTICATION_FAILED is returned.
+ *
+ * @param[in]  archive A context prepared by aes_archive_init() from this archive's header.
+ * @param[in]  engine An engine to spread the chunks over, or NULL for the calling thread.
+ * @param[in]  data The whole archive, as passed to aes_archive_read_info().
+ * @param[in]  size The size of data in bytes.
+ * @param[in]  offset The first plaintext byte to decrypt.
+ * @param[out] out Receives the plaintext, length bytes.
+ * @param[in]  length The number of bytes to decrypt.
+ * @return AES_SUCCESS on success, AES_ERROR_INVALID_LENGTH if the range ends
+ * past the plaintext, AES_ERROR_AUTHENTICATION_FAILED, or another aes_error_t
+ * on failure.
+ */
+aes_error_t aes_archive_read(const aes_archive_ctx_t* archive, aes_engine_t* engine, const uint8_t* data, size_t size,
+                             uint64_t offset, uint8_t* out, size_t length);
+
+/**
+ * @brief Securely wipes the key material held by an archive context.
+ *
+ * @param[in,out] archive The context to clear. NULL is ignored.
+ */
+void aes_archive_clear(aes_archive_ctx_t* archive);
+
+/* ============================================================================
+ * Job Manager
+ * ========================================================================= */
+
+/**
+ * @brief Creates a job manager and starts its thread.
+ *
+ * @details Any number of threads may submit jobs concurrently: a submission
+ * is a push onto a lock-free multi-producer, single-consumer queue and takes
+ * no lock. The manager's thread moves queued jobs into its lanes and, once
+ * every lane is busy or the oldest waiting job has waited max_latency_us,
+ * runs them as a batch: each step encrypts or decrypts the next block of
+ * every lane through the multi-key kernels behind aes_multi_encrypt(), so
+ * jobs under different keys and in different modes share the backend's
+ * pipeline. A lane that finishes its job is refilled from the queue before
+ * the next step. Create several managers to spread the work over more
+ * threads. On builds without POSIX threads, aes_job_submit() runs a batch on
+ * the calling thread whenever enough jobs are queued to fill the lanes, and
+ * aes_job_manager_flush() runs the rest.
+ *
+ * @param[out] manager Receives the new manager.
+ * @param[in]  config The configuration, or NULL for the defaults.
+ * @return AES_SUCCESS on success, AES_ERROR_INVALID_ARGUMENT for an invalid
+ * configuration, or AES_ERROR_MEMORY_ALLOCATION_FAILED if the manager or its
+ * thread could not be created.
+ */
+aes_error_t aes_job_manager_create(aes_job_manager_t** manager, const aes_job_manager_config_t* config);
+
+/**
+ * @brief Completes every submitted job, stops the thread and frees the manager.
+ *
+ * @details No job may be submitted once destruction has begun.
+ *
+ * @param[in] manager The manager to destroy. NULL is ignored.
+ */
+void aes_job_manager_destroy(aes_job_manager_t* manager);
+
+/**
+ * @brief Queues a job.
+ *
+ * @details The job is checked here, so a job that is accepted always
+ * completes. A job of length 0 completes before the call returns.
+ *
+ * @param[in]     manager A manager created by aes_job_manager_create().
+ * @param[in,out] job The job; owned by the manager until it completes.
+ * @return AES_SUCCESS if the job was queued, AES_ERROR_INVALID_LENGTH for a
+ * length the mode does not accept, or AES_ERROR_INVALID_ARGUMENT.
+ */
+aes_error_t aes_job_submit(aes_job_manager_t* manager, aes_job_t* job);
+
+/**
+ * @brief Runs every queued job without waiting for the lanes to fill, and
+ * returns once every job submitted before the call has completed.
+ *
+ * @param[in] manager A manager created by aes_job_manager_create().
+ * @return AES_SUCCESS, or AES_ERROR_INVALID_ARGUMENT if manager is NULL.
+ */
+aes_error_t aes_job_manager_flush(aes_job_manager_t* manager);
+
+/**
+ * @brief Reports whether a submitted job has completed.
+ *
+ * @details Once it returns 1 the job's output, IV and counter are visible to
+ * the calling thread. Jobs with a callback are never marked done.
+ *
+ * @param[in] job A submitted job.
+ * @return 1 if the job is complete, 0 otherwise.
+ */
+int aes_job_done(const aes_job_t* job);
+
+/* ============================================================================
+ * Statistics
+ * ========================================================================= */
+
+/**
+ * @brief Reports whether the statistics layer is compiled in.
+ *
+ * @details It is built only when the library is configured with
+ * AES_ENABLE_STATS. Otherwise no call site records anything and the
+ * functions below only report empty statistics.
+ *
+ * @return 1 if counters are recorded, 0 otherwise.
+ */
+int aes_stats_enabled(void);
+
+/**
+ * @brief Sums the counters of every thread, including threads that have exited.
+ *
+ * @details Each thread counts into its own storage with plain stores, so
+ * recording never takes a lock or a contended cache line; the snapshot takes
+ * a lock only to walk the list of threads. Counts that a running thread
+ * records during the walk may or may not be included. Operations split by
+ * the engine are counted once per chunk, on the thread that ran it.
+ *
+ * @param[out] stats Receives the totals; all zero if statistics are not compiled in.
+ * @return AES_SUCCESS, or AES_ERROR_INVALID_ARGUMENT if stats is NULL.
+ */
+aes_error_t aes_stats_snapshot(aes_stats_t* stats);
+
+/**
+ * @brief Enables cycle-sampled timing of the counted operations.
+ *
+ * @details Each thread reads the timestamp counter around one call in every
+ * interval calls. Timing is off by default.
+ *
+ * @param[in] interval Calls per sample; 0 turns timing off and 1 times every call.
+ */
+void aes_stats_set_sample_interval(unsigned interval);
+
+/**
+ * @brief Installs a hook that receives every sampled measurement.
+ *
+ * @param[in] hook The hook, which must stay valid until it is replaced; NULL removes it.
+ */
+void aes_stats_set_hook(const aes_stats_hook_t* hook);
+
 /**
  * @brief Converts an AES error code to a human-readable string.
  *
@@ -8,148 +8,87 @@
  * the FIPS-197 specification.
  */
 
-#include "../include/aes.h"
+#include "aes_internal.h"
+#include <stdatomic.h>
 #include <stddef.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 // Internal constants for the AES implementation.
-#define BITS_PER_BYTE 8
 #define WORD_SIZE 4
 
-// Number of rounds for each key size.
-#define AES_ROUNDS_128 10
-#define AES_ROUNDS_192 12
-#define AES_ROUNDS_256 14
-
-// Galois Field (GF(2^8)) constants for the MixColumns step.
-#define GF_REDUCING_POLYNOMIAL 0x1B // Irreducible polynomial for AES: x^8 + x^4 + x^3 + x + 1
-#define GF_MSB_MASK 0x80
-
-/* --------------------------------------------------------------------------
- * S-Box and Inverse S-Box Lookup Tables
- * -------------------------------------------------------------------------- */
-
-//! The AES Substitution Box (S-Box)
-static const uint8_t sbox[256] = {
-    // 0     1     2     3     4     5     6     7     8     9     A     B     C     D     E     F
-    0x63, 0x7c, 0x77, 0x7b, 0xf2, 0x6b, 0x6f, 0xc5, 0x30, 0x01, 0x67, 0x2b, 0xfe, 0xd7, 0xab, 0x76,  // 0
-    0xca, 0x82, 0xc9, 0x7d, 0xfa, 0x59, 0x47, 0xf0, 0xad, 0xd4, 0xa2, 0xaf, 0x9c, 0xa4, 0x72, 0xc0,  // 1
-    0xb7, 0xfd, 0x93, 0x26, 0x36, 0x3f, 0xf7, 0xcc, 0x34, 0xa5, 0xe5, 0xf1, 0x71, 0xd8, 0x31, 0x15,  // 2
-    0x04, 0xc7, 0x23, 0xc3, 0x18, 0x96, 0x05, 0x9a, 0x07, 0x12, 0x80, 0xe2, 0xeb, 0x27, 0xb2, 0x75,  // 3
-    0x09, 0x83, 0x2c, 0x1a, 0x1b, 0x6e, 0x5a, 0xa0, 0x52, 0x3b, 0xd6, 0xb3, 0x29, 0xe3, 0x2f, 0x84,  // 4
-    0x53, 0xd1, 0x00, 0xed, 0x20, 0xfc, 0xb1, 0x5b, 0x6a, 0xcb, 0xbe, 0x39, 0x4a, 0x4c, 0x58, 0xcf,  // 5
-    0xd0, 0xef, 0xaa, 0xfb, 0x43, 0x4d, 0x33, 0x85, 0x45, 0xf9, 0x02, 0x7f, 0x50, 0x3c, 0x9f, 0xa8,  // 6
-    0x51, 0xa3, 0x40, 0x8f, 0x92, 0x9d, 0x38, 0xf5, 0xbc, 0xb6, 0xda, 0x21, 0x10, 0xff, 0xf3, 0xd2,  // 7
-    0xcd, 0x0c, 0x13, 0xec, 0x5f, 0x97, 0x44, 0x17, 0xc4, 0xa7, 0x7e, 0x3d, 0x64, 0x5d, 0x19, 0x73,  // 8
-    0x60, 0x81, 0x4f, 0xdc, 0x22, 0x2a, 0x90, 0x88, 0x46, 0xee, 0xb8, 0x14, 0xde, 0x5e, 0x0b, 0xdb,  // 9
-    0xe0, 0x32, 0x3a, 0x0a, 0x49, 0x06, 0x24, 0x5c, 0xc2, 0xd3, 0xac, 0x62, 0x91, 0x95, 0xe4, 0x79,  // A
-    0xe7, 0xc8, 0x37, 0x6d, 0x8d, 0xd5, 0x4e, 0xa9, 0x6c, 0x56, 0xf4, 0xea, 0x65, 0x7a, 0xae, 0x08,  // B
-    0xba, 0x78, 0x25, 0x2e, 0x1c, 0xa6, 0xb4, 0xc6, 0xe8, 0xdd, 0x74, 0x1f, 0x4b, 0xbd, 0x8b, 0x8a,  // C
-    0x70, 0x3e, 0xb5, 0x66, 0x48, 0x03, 0xf6, 0x0e, 0x61, 0x35, 0x57, 0xb9, 0x86, 0xc1, 0x1d, 0x9e,  // D
-    0xe1, 0xf8, 0x98, 0x11, 0x69, 0xd9, 0x8e, 0x94, 0x9b, 0x1e, 0x87, 0xe9, 0xce, 0x55, 0x28, 0xdf,  // E
-    0x8c, 0xa1, 0x89, 0x0d, 0xbf, 0xe6, 0x42, 0x68, 0x41, 0x99, 0x2d, 0x0f, 0xb0, 0x54, 0xbb, 0x16}; // F
-
-//! The AES Inverse Substitution Box (InvS-Box)
-static const uint8_t rsbox[256] = {
-    // 0     1     2     3     4     5     6     7     8     9     A     B     C     D     E     F
-    0x52, 0x09, 0x6a, 0xd5, 0x30, 0x36, 0xa5, 0x38, 0xbf, 0x40, 0xa3, 0x9e, 0x81, 0xf3, 0xd7, 0xfb, // 0
-    0x7c, 0xe3, 0x39, 0x82, 0x9b, 0x2f, 0xff, 0x87, 0x34, 0x8e, 0x43, 0x44, 0xc4, 0xde, 0xe9, 0xcb, // 1
-    0x54, 0x7b, 0x94, 0x32, 0xa6, 0xc2, 0x23, 0x3d, 0xee, 0x4c, 0x95, 0x0b, 0x42, 0xfa, 0xc3, 0x4e, // 2
-    0x08, 0x2e, 0xa1, 0x66, 0x28, 0xd9, 0x24, 0xb2, 0x76, 0x5b, 0xa2, 0x49, 0x6d, 0x8b, 0xd1, 0x25, // 3
-    0x72, 0xf8, 0xf6, 0x64, 0x86, 0x68, 0x98, 0x16, 0xd4, 0xa4, 0x5c, 0xcc, 0x5d, 0x65, 0xb6, 0x92, // 4
-    0x6c, 0x70, 0x48, 0x50, 0xfd, 0xed, 0xb9, 0xda, 0x5e, 0x15, 0x46, 0x57, 0xa7, 0x8d, 0x9d, 0x84, // 5
-    0x90, 0xd8, 0xab, 0x00, 0x8c, 0xbc, 0xd3, 0x0a, 0xf7, 0xe4, 0x58, 0x05, 0xb8, 0xb3, 0x45, 0x06, // 6
-    0xd0, 0x2c, 0x1e, 0x8f, 0xca, 0x3f, 0x0f, 0x02, 0xc1, 0xaf, 0xbd, 0x03, 0x01, 0x13, 0x8a, 0x6b, // 7
-    0x3a, 0x91, 0x11, 0x41, 0x4f, 0x67, 0xdc, 0xea, 0x97, 0xf2, 0xcf, 0xce, 0xf0, 0xb4, 0xe6, 0x73, // 8
-    0x96, 0xac, 0x74, 0x22, 0xe7, 0xad, 0x35, 0x85, 0xe2, 0xf9, 0x37, 0xe8, 0x1c, 0x75, 0xdf, 0x6e, // 9
-    0x47, 0xf1, 0x1a, 0x71, 0x1d, 0x29, 0xc5, 0x89, 0x6f, 0xb7, 0x62, 0x0e, 0xaa, 0x18, 0xbe, 0x1b, // A
-    0xfc, 0x56, 0x3e, 0x4b, 0xc6, 0xd2, 0x79, 0x20, 0x9a, 0xdb, 0xc0, 0xfe, 0x78, 0xcd, 0x5a, 0xf4, // B
-    0x1f, 0xdd, 0xa8, 0x33, 0x88, 0x07, 0xc7, 0x31, 0xb1, 0x12, 0x10, 0x59, 0x27, 0x80, 0xec, 0x5f, // C
-    0x60, 0x51, 0x7f, 0xa9, 0x19, 0xb5, 0x4a, 0x0d, 0x2d, 0xe5, 0x7a, 0x9f, 0x93, 0xc9, 0x9c, 0xef, // D
-    0xa0, 0xe0, 0x3b, 0x4d, 0xae, 0x2a, 0xf5, 0xb0, 0xc8, 0xeb, 0xbb, 0x3c, 0x83, 0x53, 0x99, 0x61, // E
-    0x17, 0x2b, 0x04, 0x7e, 0xba, 0x77, 0xd6, 0x26, 0xe1, 0x69, 0x14, 0x63, 0x55, 0x21, 0x0c, 0x7d, // F
-};
-
-//! The Round Constant (Rcon) table used in the key schedule.
-static const uint8_t rcon[] = {0x00, 0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80, 0x1b, 0x36,
-                               0x6c, 0xd8, 0xab, 0x4d, 0x9a, 0x2f, 0x5e, 0xbc, 0x63, 0xc6, 0x97,
-                               0x35, 0x6a, 0xd4, 0xb3, 0x7d, 0xfa, 0xef, 0xc5, 0x91, 0x39};
-
-/**
- * @brief Securely erases a region of memory.
- * @param[in,out] ptr A pointer to the memory to be zeroed.
- * @param[in] n The number of bytes to zero.
- */
-static void secure_zero_memory(void* ptr, size_t n)
+void secure_zero_memory(void* ptr, size_t n)
 {
     if (!ptr || n == 0)
         return;
 
+#if defined(__GNUC__) || defined(__clang__)
+    // A full-width memset; the empty asm that may read the memory keeps it from being elided.
+    memset(ptr, 0, n);
+    __asm__ __volatile__("" : : "r"(ptr) : "memory");
+#else
     volatile uint8_t* vptr = (volatile uint8_t*)ptr;
 
     while (n--)
         *vptr++ = 0;
+#endif
 }
 
-/**
- * @brief Performs a cyclic left shift on a 4-byte word.
- * @param[in,out] word A pointer to a 4-byte array to be rotated.
- */
-static void word_rotate_left(uint8_t* word)
-{
-    uint8_t temp = word[0];
-    word[0]      = word[1];
-    word[1]      = word[2];
-    word[2]      = word[3];
-    word[3]      = temp;
-}
-
-/**
- * @brief The core transformation for the key expansion schedule.
- * @param[in,out] word The word to be transformed.
- * @param[in] iteration The current Rcon iteration.
- */
-static void key_schedule_core(uint8_t* word, uint8_t iteration)
+/** @brief Applies the S-box to each byte of a big-endian schedule word. */
+static inline uint32_t sub_word_be(uint32_t word)
 {
-    word_rotate_left(word);
-
-    for (uint8_t i = 0; i < WORD_SIZE; ++i)
-        word[i] = sbox[word[i]];
-
-    word[0] ^= rcon[iteration];
+    return ((uint32_t)aes_sbox[word >> 24] << 24) | ((uint32_t)aes_sbox[(word >> 16) & 0xff] << 16) |
+           ((uint32_t)aes_sbox[(word >> 8) & 0xff] << 8) | (uint32_t)aes_sbox[word & 0xff];
 }
 
 void aes_expand_key(uint8_t* expanded_key, const uint8_t* key, aes_key_size_t key_size, size_t expanded_key_size)
 {
-    size_t  current_size   = (size_t)key_size;
-    uint8_t rcon_iteration = 1;
-    uint8_t temp_word[WORD_SIZE];
+    const size_t   key_words   = (size_t)key_size / WORD_SIZE;
+    const size_t   total_words = expanded_key_size / WORD_SIZE;
+    const uint8_t* rcon        = aes_rcon + 1;
 
-    for (size_t i = 0; i < current_size; i++)
-        expanded_key[i] = key[i];
+    memcpy(expanded_key, key, (size_t)key_size);
 
-    while (current_size < expanded_key_size)
+    // Each pass produces one key length of words, so the word's position in
+    // the key stride is the inner index rather than a modulus. temp always
+    // holds the previous word, in big-endian order so RotWord is a left rotation.
+    for (size_t i = key_words; i < total_words; i += key_words)
     {
-        for (size_t i = 0; i < WORD_SIZE; i++)
-            temp_word[i] = expanded_key[current_size - WORD_SIZE + i];
-
-        if (current_size % (size_t)key_size == 0)
+        uint32_t temp = load_be32(expanded_key + WORD_SIZE * (i - 1));
+        temp          = sub_word_be((temp << 8) | (temp >> 24)) ^ ((uint32_t)*rcon++ << 24);
+        for (size_t j = 0; j < key_words && i + j < total_words; j++)
         {
-            key_schedule_core(temp_word, rcon_iteration++);
+            if (j == 4 && key_words > 6)
+                temp = sub_word_be(temp);
+            temp ^= load_be32(expanded_key + WORD_SIZE * (i + j - key_words));
+            store_be32(expanded_key + WORD_SIZE * (i + j), temp);
         }
+    }
+}
 
-        if (key_size == AES_KEY_SIZE_256 && (current_size % (size_t)key_size) == AES_BLOCK_SIZE)
-        {
-            for (size_t i = 0; i < WORD_SIZE; i++)
-                temp_word[i] = sbox[temp_word[i]];
-        }
+void aes_expand_key_words(uint32_t* words, const uint8_t* key, size_t key_words, size_t total_words,
+                          aes_sub_word_fn sub_word)
+{
+    const uint8_t* rcon = aes_rcon + 1;
+
+    for (size_t i = 0; i < key_words; i++)
+        words[i] = (uint32_t)key[4 * i] | ((uint32_t)key[4 * i + 1] << 8) | ((uint32_t)key[4 * i + 2] << 16) |
+                   ((uint32_t)key[4 * i + 3] << 24);
 
-        for (size_t i = 0; i < WORD_SIZE; i++)
+    // Strided like aes_expand_key(); temp always holds the previous word.
+    for (size_t i = key_words; i < total_words; i += key_words)
+    {
+        // RotWord moves byte 0 to the top; in little-endian packing that is a right rotation.
+        uint32_t temp = sub_word(words[i - 1]);
+        temp          = ((temp >> 8) | (temp << 24)) ^ *rcon++;
+        for (size_t j = 0; j < key_words && i + j < total_words; j++)
         {
-            expanded_key[current_size] = expanded_key[current_size - (size_t)key_size] ^ temp_word[i];
-            current_size++;
+            if (j == 4 && key_words > 6)
+                temp = sub_word(temp);
+            temp ^= words[i + j - key_words];
+            words[i + j] = temp;
         }
     }
 }
@@ -159,7 +98,7 @@ static void sub_bytes(aes_state_t* state)
 {
     for (int r = 0; r < AES_STATE_DIM; ++r)
         for (int c = 0; c < AES_STATE_DIM; ++c)
-            (*state)[r][c] = sbox[(*state)[r][c]];
+            (*state)[r][c] = aes_sbox[(*state)[r][c]];
 }
 
 /** @brief Applies the Inverse SubBytes transformation to the state. */
@@ -167,7 +106,7 @@ static void inv_sub_bytes(aes_state_t* state)
 {
     for (int r = 0; r < AES_STATE_DIM; ++r)
         for (int c = 0; c < AES_STATE_DIM; ++c)
-            (*state)[r][c] = rsbox[(*state)[r][c]];
+            (*state)[r][c] = aes_rsbox[(*state)[r][c]];
 }
 
 /** @brief Applies the ShiftRows transformation to the state. */
@@ -224,33 +163,8 @@ static void inv_shift_rows(aes_state_t* state)
     (*state)[3][2] = temp;
 }
 
-/**
- * @brief Performs multiplication in the Galois Field GF(2^8).
- * @param a The first operand.
- * @param b The second operand.
- * @return The result of (a * b) in GF(2^8).
- */
-static uint8_t galois_mul(uint8_t a, uint8_t b)
-{
-    uint8_t p = 0;
-    for (int i = 0; i < BITS_PER_BYTE; i++)
-    {
-        if (b & 1)
-            p ^= a;
-
-        uint8_t hi_bit_set = a & GF_MSB_MASK;
-        a <<= 1;
-
-        if (hi_bit_set)
-            a ^= GF_REDUCING_POLYNOMIAL;
-
-        b >>= 1;
-    }
-    return p;
-}
-
 /** @brief Applies the MixColumns transformation to the state. */
-static void mix_columns(aes_state_t* state)
+static inline void mix_columns(aes_state_t* state)
 {
     uint8_t t[AES_STATE_DIM];
     for (int c = 0; c < AES_STATE_DIM; ++c)
@@ -258,27 +172,32 @@ static void mix_columns(aes_state_t* state)
         for (int r = 0; r < AES_STATE_DIM; ++r)
             t[r] = (*state)[r][c];
 
-        (*state)[0][c] = galois_mul(t[0], 2) ^ galois_mul(t[1], 3) ^ t[2] ^ t[3];
-        (*state)[1][c] = t[0] ^ galois_mul(t[1], 2) ^ galois_mul(t[2], 3) ^ t[3];
-        (*state)[2][c] = t[0] ^ t[1] ^ galois_mul(t[2], 2) ^ galois_mul(t[3], 3);
-        (*state)[3][c] = galois_mul(t[0], 3) ^ t[1] ^ t[2] ^ galois_mul(t[3], 2);
+        (*state)[0][c] = aes_galois_mul(t[0], 2) ^ aes_galois_mul(t[1], 3) ^ t[2] ^ t[3];
+        (*state)[1][c] = t[0] ^ aes_galois_mul(t[1], 2) ^ aes_galois_mul(t[2], 3) ^ t[3];
+        (*state)[2][c] = t[0] ^ t[1] ^ aes_galois_mul(t[2], 2) ^ aes_galois_mul(t[3], 3);
+        (*state)[3][c] = aes_galois_mul(t[0], 3) ^ t[1] ^ t[2] ^ aes_galois_mul(t[3], 2);
     }
 }
 
-/** @brief Applies the Inverse MixColumns transformation to the state. */
-static void inv_mix_columns(aes_state_t* state)
+/**
+ * @brief Applies the Inverse MixColumns transformation to the state.
+ * @details InvMixColumns factors as MixColumns after multiplying each column
+ * by the circulant matrix circ({05}, {00}, {04}, {00}), which needs only two
+ * {04} products per column instead of sixteen general multiplications.
+ */
+static inline void inv_mix_columns(aes_state_t* state)
 {
-    uint8_t t[AES_STATE_DIM];
     for (int c = 0; c < AES_STATE_DIM; ++c)
     {
-        for (int r = 0; r < AES_STATE_DIM; ++r)
-            t[r] = (*state)[r][c];
+        uint8_t u = aes_galois_mul((*state)[0][c] ^ (*state)[2][c], 4);
+        uint8_t v = aes_galois_mul((*state)[1][c] ^ (*state)[3][c], 4);
 
-        (*state)[0][c] = galois_mul(t[0], 14) ^ galois_mul(t[1], 11) ^ galois_mul(t[2], 13) ^ galois_mul(t[3], 9);
-        (*state)[1][c] = galois_mul(t[0], 9) ^ galois_mul(t[1], 14) ^ galois_mul(t[2], 11) ^ galois_mul(t[3], 13);
-        (*state)[2][c] = galois_mul(t[0], 13) ^ galois_mul(t[1], 9) ^ galois_mul(t[2], 14) ^ galois_mul(t[3], 11);
-        (*state)[3][c] = galois_mul(t[0], 11) ^ galois_mul(t[1], 13) ^ galois_mul(t[2], 9) ^ galois_mul(t[3], 14);
+        (*state)[0][c] ^= u;
+        (*state)[1][c] ^= v;
+        (*state)[2][c] ^= u;
+        (*state)[3][c] ^= v;
     }
+    mix_columns(state);
 }
 
 /**
@@ -299,7 +218,7 @@ static void add_round_key(aes_state_t* state, const uint8_t* round_key)
  * @param[in] expanded_key The pre-computed key schedule.
  * @param[in] num_rounds The number of rounds for the given key size.
  */
-static void cipher_encrypt_block(aes_state_t* state, const uint8_t* expanded_key, uint16_t num_rounds)
+static inline void cipher_encrypt_block(aes_state_t* state, const uint8_t* expanded_key, const uint16_t num_rounds)
 {
     add_round_key(state, expanded_key);
     for (uint16_t round = 1; round < num_rounds; round++)
@@ -315,114 +234,462 @@ static void cipher_encrypt_block(aes_state_t* state, const uint8_t* expanded_key
 }
 
 /**
- * @brief The main AES decryption cipher loop.
+ * @brief The main AES decryption cipher loop, in the equivalent inverse cipher
+ * form of FIPS-197 section 5.3.5.
+ * @details The rounds have the same shape as encryption: substitution, row
+ * shift, column mix, then the round key. This works because the decryption
+ * schedule already has InvMixColumns applied to its middle round keys.
  * @param[in,out] state The 16-byte state to be decrypted.
- * @param[in] expanded_key The pre-computed key schedule.
+ * @param[in] dec_key The decryption key schedule, in the order it is used.
  * @param[in] num_rounds The number of rounds for the given key size.
  */
-static void cipher_decrypt_block(aes_state_t* state, const uint8_t* expanded_key, uint16_t num_rounds)
+static inline void cipher_decrypt_block(aes_state_t* state, const uint8_t* dec_key, const uint16_t num_rounds)
 {
-    add_round_key(state, expanded_key + (AES_BLOCK_SIZE * num_rounds));
-    for (uint16_t round = num_rounds; round > 1; round--)
+    add_round_key(state, dec_key);
+    for (uint16_t round = 1; round < num_rounds; round++)
     {
-        inv_shift_rows(state);
         inv_sub_bytes(state);
-        add_round_key(state, expanded_key + (AES_BLOCK_SIZE * (round - 1)));
+        inv_shift_rows(state);
         inv_mix_columns(state);
+        add_round_key(state, dec_key + (AES_BLOCK_SIZE * round));
     }
-    inv_shift_rows(state);
     inv_sub_bytes(state);
-    add_round_key(state, expanded_key);
+    inv_shift_rows(state);
+    add_round_key(state, dec_key + (AES_BLOCK_SIZE * num_rounds));
 }
 
-aes_error_t aes_encrypt(const uint8_t* plaintext, uint8_t* ciphertext, const uint8_t* key, aes_key_size_t key_size)
+/**
+ * @brief Maps a key size to the number of cipher rounds.
+ * @param[in] key_size The size of the key.
+ * @param[out] num_rounds Receives the number of rounds.
+ * @return AES_SUCCESS, or AES_ERROR_UNSUPPORTED_KEY_SIZE for an unknown key size.
+ */
+static aes_error_t key_size_to_rounds(aes_key_size_t key_size, uint16_t* num_rounds)
 {
-    if (!plaintext || !ciphertext || !key)
-        return AES_ERROR_UNSUPPORTED_KEY_SIZE;
-
-    uint16_t num_rounds;
     switch (key_size)
     {
         case AES_KEY_SIZE_128:
-            num_rounds = AES_ROUNDS_128;
-            break;
+            *num_rounds = AES_ROUNDS_128;
+            return AES_SUCCESS;
         case AES_KEY_SIZE_192:
-            num_rounds = AES_ROUNDS_192;
-            break;
+            *num_rounds = AES_ROUNDS_192;
+            return AES_SUCCESS;
         case AES_KEY_SIZE_256:
-            num_rounds = AES_ROUNDS_256;
-            break;
+            *num_rounds = AES_ROUNDS_256;
+            return AES_SUCCESS;
         default:
             return AES_ERROR_UNSUPPORTED_KEY_SIZE;
     }
+}
 
-    size_t   expanded_key_size = (size_t)AES_BLOCK_SIZE * (num_rounds + 1);
-    uint8_t* expanded_key      = (uint8_t*)malloc(expanded_key_size);
-    if (!expanded_key)
-        return AES_ERROR_MEMORY_ALLOCATION_FAILED;
-
-    aes_expand_key(expanded_key, key, key_size, expanded_key_size);
-
-    aes_state_t state;
+/** @brief Loads a 16-byte block into the column-major state matrix. */
+static void load_state(aes_state_t* state, const uint8_t* block)
+{
     for (int r = 0; r < AES_STATE_DIM; ++r)
         for (int c = 0; c < AES_STATE_DIM; ++c)
-            state[r][c] = plaintext[r + AES_STATE_DIM * c];
-
-    cipher_encrypt_block(&state, expanded_key, num_rounds);
+            (*state)[r][c] = block[r + AES_STATE_DIM * c];
+}
 
+/** @brief Stores the column-major state matrix into a 16-byte block. */
+static void store_state(uint8_t* block, aes_state_t* state)
+{
     for (int r = 0; r < AES_STATE_DIM; ++r)
         for (int c = 0; c < AES_STATE_DIM; ++c)
-            ciphertext[r + AES_STATE_DIM * c] = state[r][c];
+            block[r + AES_STATE_DIM * c] = (*state)[r][c];
+}
 
-    secure_zero_memory(expanded_key, expanded_key_size);
-    free(expanded_key);
-    return AES_SUCCESS;
+/** @brief Encrypts consecutive blocks with the byte-wise reference transforms. */
+static inline void reference_encrypt(const aes_ctx_t* ctx, const uint8_t* in, uint8_t* out, size_t num_blocks,
+                                     const uint16_t num_rounds)
+{
+    aes_state_t state;
+    for (size_t i = 0; i < num_blocks; i++)
+    {
+        load_state(&state, in + i * AES_BLOCK_SIZE);
+        cipher_encrypt_block(&state, (const uint8_t*)ctx->round_keys, num_rounds);
+        store_state(out + i * AES_BLOCK_SIZE, &state);
+    }
+    secure_zero_memory(&state, sizeof(state));
 }
 
-aes_error_t aes_decrypt(const uint8_t* ciphertext, uint8_t* plaintext, const uint8_t* key, aes_key_size_t key_size)
+/** @brief Decrypts consecutive blocks with the byte-wise reference transforms. */
+static inline void reference_decrypt(const aes_ctx_t* ctx, const uint8_t* in, uint8_t* out, size_t num_blocks,
+                                     const uint16_t num_rounds)
 {
-    if (!ciphertext || !plaintext || !key)
-        return AES_ERROR_UNSUPPORTED_KEY_SIZE;
+    aes_state_t state;
+    for (size_t i = 0; i < num_blocks; i++)
+    {
+        load_state(&state, in + i * AES_BLOCK_SIZE);
+        cipher_decrypt_block(&state, (const uint8_t*)ctx->dec_round_keys, num_rounds);
+        store_state(out + i * AES_BLOCK_SIZE, &state);
+    }
+    secure_zero_memory(&state, sizeof(state));
+}
 
-    uint16_t num_rounds;
-    switch (key_size)
+AES_DEFINE_ROUND_KERNELS(reference)
+
+/**
+ * @brief Expands the key into the reference backend's byte-wise FIPS-197 schedule.
+ * @details The decryption schedule is the encryption schedule in reverse
+ * round order, with InvMixColumns applied to every round key but the first
+ * and last.
+ */
+static void reference_expand_key(aes_ctx_t* ctx, const uint8_t* key)
+{
+    const uint8_t* enc = (const uint8_t*)ctx->round_keys;
+    uint8_t*       dec = (uint8_t*)ctx->dec_round_keys;
+    uint16_t       nr  = ctx->num_rounds;
+    aes_state_t    state;
+
+    aes_expand_key((uint8_t*)ctx->round_keys, key, ctx->key_size, (size_t)AES_BLOCK_SIZE * (nr + 1U));
+    if (ctx->usage != AES_KEY_USAGE_ENCRYPT)
     {
-        case AES_KEY_SIZE_128:
-            num_rounds = AES_ROUNDS_128;
-            break;
-        case AES_KEY_SIZE_192:
-            num_rounds = AES_ROUNDS_192;
-            break;
-        case AES_KEY_SIZE_256:
-            num_rounds = AES_ROUNDS_256;
-            break;
-        default:
-            return AES_ERROR_UNSUPPORTED_KEY_SIZE;
+        for (uint16_t round = 0; round <= nr; round++)
+        {
+            load_state(&state, enc + AES_BLOCK_SIZE * (nr - round));
+            if (round != 0 && round != nr)
+                inv_mix_columns(&state);
+            store_state(dec + AES_BLOCK_SIZE * round, &state);
+        }
+        secure_zero_memory(&state, sizeof(state));
     }
 
-    size_t   expanded_key_size = (size_t)AES_BLOCK_SIZE * (num_rounds + 1);
-    uint8_t* expanded_key      = (uint8_t*)malloc(expanded_key_size);
-    if (!expanded_key)
-        return AES_ERROR_MEMORY_ALLOCATION_FAILED;
+    reference_select_kernels(ctx);
+}
 
-    aes_expand_key(expanded_key, key, key_size, expanded_key_size);
+const aes_backend_ops_t aes_backend_reference = {
+    AES_BACKEND_REFERENCE, "reference", 0, reference_expand_key, reference_encrypt_blocks,
+    reference_decrypt_blocks, NULL, NULL, NULL, NULL, NULL, NULL,
+};
 
-    aes_state_t state;
-    for (int r = 0; r < AES_STATE_DIM; ++r)
-        for (int c = 0; c < AES_STATE_DIM; ++c)
-            state[r][c] = ciphertext[r + AES_STATE_DIM * c];
+//! Every backend compiled into the library, in order of preference for automatic selection.
+static const aes_backend_ops_t* const all_backends[] = {
+#ifdef AES_ARCH_X86
+    &aes_backend_aesni,
+    &aes_backend_vpaes,
+#endif
+    &aes_backend_ttable,
+    &aes_backend_bitslice,
+    &aes_backend_reference,
+};
 
-    cipher_decrypt_block(&state, expanded_key, num_rounds);
+#define BACKEND_COUNT (sizeof(all_backends) / sizeof(all_backends[0]))
 
-    for (int r = 0; r < AES_STATE_DIM; ++r)
-        for (int c = 0; c < AES_STATE_DIM; ++c)
-            plaintext[r + AES_STATE_DIM * c] = state[r][c];
+//! The backend used for AES_BACKEND_AUTO, chosen once on first use.
+static _Atomic(const aes_backend_ops_t*) default_backend;
 
-    secure_zero_memory(expanded_key, expanded_key_size);
-    free(expanded_key);
+/**
+ * @brief Resolves a backend identifier to its dispatch table.
+ * @param[in] backend The requested backend (not AES_BACKEND_AUTO).
+ * @return The dispatch table, or NULL if the backend is not compiled in.
+ */
+static const aes_backend_ops_t* backend_ops(aes_backend_t backend)
+{
+    for (size_t i = 0; i < BACKEND_COUNT; i++)
+        if (all_backends[i]->id == backend)
+            return all_backends[i];
+    return NULL;
+}
+
+/** @brief Reports whether the running CPU has every feature a backend needs. */
+static int backend_runs_here(const aes_backend_ops_t* ops)
+{
+    return (ops->cpu_features & ~aes_cpu_features()) == 0;
+}
+
+/**
+ * @brief Picks the default backend for this process.
+ * @details The AES_BACKEND environment variable may name a backend to force,
+ * e.g. for testing; it is ignored if the backend cannot run on this CPU.
+ * Otherwise the fastest backend the CPU supports is chosen.
+ * @return The selected dispatch table.
+ */
+static const aes_backend_ops_t* detect_default_backend(void)
+{
+    const char* forced = getenv(AES_BACKEND_ENV);
+    if (forced)
+    {
+        for (size_t i = 0; i < BACKEND_COUNT; i++)
+            if (strcmp(forced, all_backends[i]->name) == 0 && backend_runs_here(all_backends[i]))
+                return all_backends[i];
+    }
+
+    for (size_t i = 0; i < BACKEND_COUNT; i++)
+        if (backend_runs_here(all_backends[i]))
+            return all_backends[i];
+
+    return &aes_backend_reference;
+}
+
+/** @brief Returns the default backend, selecting it on first use. */
+static const aes_backend_ops_t* get_default_backend(void)
+{
+    const aes_backend_ops_t* ops = atomic_load_explicit(&default_backend, memory_order_acquire);
+    if (!ops)
+    {
+        ops = detect_default_backend();
+        atomic_store_explicit(&default_backend, ops, memory_order_release);
+    }
+    return ops;
+}
+
+int aes_backend_is_supported(aes_backend_t backend)
+{
+    if (backend == AES_BACKEND_AUTO)
+        return 1;
+
+    const aes_backend_ops_t* ops = backend_ops(backend);
+    return ops && backend_runs_here(ops);
+}
+
+aes_error_t aes_set_default_backend(aes_backend_t backend)
+{
+    const aes_backend_ops_t* ops;
+    if (backend == AES_BACKEND_AUTO)
+    {
+        ops = detect_default_backend();
+    }
+    else
+    {
+        ops = backend_ops(backend);
+        if (!ops || !backend_runs_here(ops))
+            return AES_ERROR_UNSUPPORTED_BACKEND;
+    }
+
+    atomic_store_explicit(&default_backend, ops, memory_order_release);
     return AES_SUCCESS;
 }
 
+aes_backend_t aes_get_default_backend(void)
+{
+    return get_default_backend()->id;
+}
+
+/**
+ * @brief Checks the parameters shared by the context initializers.
+ * @param[in] backend The requested backend, or AES_BACKEND_AUTO.
+ * @param[in] key_size The key size.
+ * @param[in] usage The requested directions.
+ * @param[out] ops Receives the backend's dispatch table.
+ * @param[out] num_rounds Receives the round count.
+ * @return AES_SUCCESS, or the error to report.
+ */
+static aes_error_t init_check(aes_backend_t backend, aes_key_size_t key_size, aes_key_usage_t usage,
+                              const aes_backend_ops_t** ops, uint16_t* num_rounds)
+{
+    *ops = backend == AES_BACKEND_AUTO ? get_default_backend() : backend_ops(backend);
+    if (!*ops || (usage != AES_KEY_USAGE_BOTH && usage != AES_KEY_USAGE_ENCRYPT && usage != AES_KEY_USAGE_DECRYPT))
+        return AES_ERROR_INVALID_ARGUMENT;
+    if (!backend_runs_here(*ops))
+        return AES_ERROR_UNSUPPORTED_BACKEND;
+    return key_size_to_rounds(key_size, num_rounds);
+}
+
+/** @brief Sets the context fields that expand_key reads. */
+static void init_fields(aes_ctx_t* ctx, const aes_backend_ops_t* ops, aes_key_size_t key_size, uint16_t num_rounds,
+                        aes_key_usage_t usage)
+{
+    ctx->num_rounds     = num_rounds;
+    ctx->key_size       = key_size;
+    ctx->usage          = usage;
+    ctx->backend        = ops;
+    ctx->encrypt_blocks = ops->encrypt_blocks;
+    ctx->decrypt_blocks = ops->decrypt_blocks;
+}
+
+aes_error_t aes_ctx_init_ex(aes_ctx_t* ctx, const uint8_t* key, aes_key_size_t key_size, aes_backend_t backend,
+                            aes_key_usage_t usage)
+{
+    if (!ctx || !key)
+        return AES_ERROR_INVALID_ARGUMENT;
+
+    const aes_backend_ops_t* ops;
+    uint16_t                 num_rounds;
+    aes_error_t              result = init_check(backend, key_size, usage, &ops, &num_rounds);
+    if (result != AES_SUCCESS)
+        return result;
+
+    init_fields(ctx, ops, key_size, num_rounds, usage);
+    AES_STATS_BEGIN(start);
+    ops->expand_key(ctx, key);
+    AES_STATS_RECORD(AES_STATS_KEY_EXPANSION, ops->id, 0, start);
+    return AES_SUCCESS;
+}
+
+aes_error_t aes_ctx_init_batch(aes_ctx_t* ctxs, const uint8_t* keys, aes_key_size_t key_size, size_t count,
+                               aes_backend_t backend, aes_key_usage_t usage)
+{
+    if (count && (!ctxs || !keys))
+        return AES_ERROR_INVALID_ARGUMENT;
+
+    const aes_backend_ops_t* ops;
+    uint16_t                 num_rounds;
+    aes_error_t              result = init_check(backend, key_size, usage, &ops, &num_rounds);
+    if (result != AES_SUCCESS)
+        return result;
+
+    for (size_t i = 0; i < count; i++)
+        init_fields(&ctxs[i], ops, key_size, num_rounds, usage);
+
+    if (ops->expand_keys && count)
+        ops->expand_keys(ctxs, keys, count);
+    else
+        for (size_t i = 0; i < count; i++)
+            ops->expand_key(&ctxs[i], keys + i * (size_t)key_size);
+
+    // Counted per key; the keys of a batch are not timed individually.
+    for (size_t i = 0; i < count; i++)
+        AES_STATS_RECORD(AES_STATS_KEY_EXPANSION, ops->id, 0, 0);
+    return AES_SUCCESS;
+}
+
+aes_error_t aes_ctx_init_backend(aes_ctx_t* ctx, const uint8_t* key, aes_key_size_t key_size, aes_backend_t backend)
+{
+    return aes_ctx_init_ex(ctx, key, key_size, backend, AES_KEY_USAGE_BOTH);
+}
+
+aes_error_t aes_ctx_init(aes_ctx_t* ctx, const uint8_t* key, aes_key_size_t key_size)
+{
+    return aes_ctx_init_backend(ctx, key, key_size, AES_BACKEND_AUTO);
+}
+
+aes_backend_t aes_ctx_get_backend(const aes_ctx_t* ctx)
+{
+    return (ctx && ctx->backend) ? ctx->backend->id : AES_BACKEND_AUTO;
+}
+
+const char* aes_backend_name(aes_backend_t backend)
+{
+    const aes_backend_ops_t* ops = backend == AES_BACKEND_AUTO ? NULL : backend_ops(backend);
+    return ops ? ops->name : "auto";
+}
+
+aes_error_t aes_ctx_encrypt(const aes_ctx_t* ctx, const uint8_t* plaintext, uint8_t* ciphertext)
+{
+    if (!ctx_can_encrypt(ctx) || !plaintext || !ciphertext)
+        return AES_ERROR_INVALID_ARGUMENT;
+
+    ctx->encrypt_blocks(ctx, plaintext, ciphertext, 1);
+    return AES_SUCCESS;
+}
+
+aes_error_t aes_ctx_decrypt(const aes_ctx_t* ctx, const uint8_t* ciphertext, uint8_t* plaintext)
+{
+    if (!ctx_can_decrypt(ctx) || !ciphertext || !plaintext)
+        return AES_ERROR_INVALID_ARGUMENT;
+
+    ctx->decrypt_blocks(ctx, ciphertext, plaintext, 1);
+    return AES_SUCCESS;
+}
+
+aes_error_t aes_ecb_encrypt(const aes_ctx_t* ctx, const uint8_t* in, uint8_t* out, size_t length)
+{
+    if (!ctx_can_encrypt(ctx) || (length && (!in || !out)))
+        return AES_ERROR_INVALID_ARGUMENT;
+    if (length % AES_BLOCK_SIZE != 0)
+        return AES_ERROR_INVALID_LENGTH;
+
+    AES_STATS_BEGIN(start);
+    ctx->encrypt_blocks(ctx, in, out, length / AES_BLOCK_SIZE);
+    AES_STATS_RECORD(AES_STATS_ECB, ctx->backend->id, length, start);
+    return AES_SUCCESS;
+}
+
+aes_error_t aes_ecb_decrypt(const aes_ctx_t* ctx, const uint8_t* in, uint8_t* out, size_t length)
+{
+    if (!ctx_can_decrypt(ctx) || (length && (!in || !out)))
+        return AES_ERROR_INVALID_ARGUMENT;
+    if (length % AES_BLOCK_SIZE != 0)
+        return AES_ERROR_INVALID_LENGTH;
+
+    AES_STATS_BEGIN(start);
+    ctx->decrypt_blocks(ctx, in, out, length / AES_BLOCK_SIZE);
+    AES_STATS_RECORD(AES_STATS_ECB, ctx->backend->id, length, start);
+    return AES_SUCCESS;
+}
+
+/** @brief aes_iov_step_fn over whole blocks: arg is the context. */
+static void ecb_encrypt_step(void* arg, const uint8_t* in, uint8_t* out, size_t length)
+{
+    const aes_ctx_t* ctx = arg;
+    ctx->encrypt_blocks(ctx, in, out, length / AES_BLOCK_SIZE);
+}
+
+/** @brief aes_iov_step_fn over whole blocks: arg is the context. */
+static void ecb_decrypt_step(void* arg, const uint8_t* in, uint8_t* out, size_t length)
+{
+    const aes_ctx_t* ctx = arg;
+    ctx->decrypt_blocks(ctx, in, out, length / AES_BLOCK_SIZE);
+}
+
+/**
+ * @brief Runs ECB over scatter-gather lists.
+ * @return AES_SUCCESS or the validation error.
+ */
+static aes_error_t ecb_iov(const aes_ctx_t* ctx, int encrypt, const aes_iovec_t* in, size_t in_count,
+                           const aes_iovec_t* out, size_t out_count, aes_iov_step_fn step)
+{
+    size_t length;
+
+    if (encrypt ? !ctx_can_encrypt(ctx) : !ctx_can_decrypt(ctx))
+        return AES_ERROR_INVALID_ARGUMENT;
+    aes_error_t result = aes_iov_check(in, in_count, out, out_count, &length);
+    if (result != AES_SUCCESS)
+        return result;
+    if (length % AES_BLOCK_SIZE != 0)
+        return AES_ERROR_INVALID_LENGTH;
+
+    AES_STATS_BEGIN(start);
+    aes_iov_process(in, out, length, step, (void*)ctx);
+    AES_STATS_RECORD(AES_STATS_ECB, ctx->backend->id, length, start);
+    return AES_SUCCESS;
+}
+
+aes_error_t aes_ecb_encrypt_iov(const aes_ctx_t* ctx, const aes_iovec_t* in, size_t in_count, const aes_iovec_t* out,
+                                size_t out_count)
+{
+    return ecb_iov(ctx, 1, in, in_count, out, out_count, ecb_encrypt_step);
+}
+
+aes_error_t aes_ecb_decrypt_iov(const aes_ctx_t* ctx, const aes_iovec_t* in, size_t in_count, const aes_iovec_t* out,
+                                size_t out_count)
+{
+    return ecb_iov(ctx, 0, in, in_count, out, out_count, ecb_decrypt_step);
+}
+
+void aes_ctx_clear(aes_ctx_t* ctx)
+{
+    secure_zero_memory(ctx, ctx ? sizeof(*ctx) : 0);
+}
+
+aes_error_t aes_encrypt(const uint8_t* plaintext, uint8_t* ciphertext, const uint8_t* key, aes_key_size_t key_size)
+{
+    if (!plaintext || !ciphertext || !key)
+        return AES_ERROR_UNSUPPORTED_KEY_SIZE;
+
+    aes_ctx_t   ctx;
+    aes_error_t result = aes_ctx_init_ex(&ctx, key, key_size, AES_BACKEND_AUTO, AES_KEY_USAGE_ENCRYPT);
+    if (result == AES_SUCCESS)
+        result = aes_ctx_encrypt(&ctx, plaintext, ciphertext);
+
+    aes_ctx_clear(&ctx);
+    return result;
+}
+
+aes_error_t aes_decrypt(const uint8_t* ciphertext, uint8_t* plaintext, const uint8_t* key, aes_key_size_t key_size)
+{
+    if (!ciphertext || !plaintext || !key)
+        return AES_ERROR_UNSUPPORTED_KEY_SIZE;
+
+    aes_ctx_t   ctx;
+    aes_error_t result = aes_ctx_init_ex(&ctx, key, key_size, AES_BACKEND_AUTO, AES_KEY_USAGE_DECRYPT);
+    if (result == AES_SUCCESS)
+        result = aes_ctx_decrypt(&ctx, ciphertext, plaintext);
+
+    aes_ctx_clear(&ctx);
+    return result;
+}
+
 const char* aes_error_to_string(aes_error_t error_code)
 {
     switch (error_code)
@@ -433,6 +700,24 @@ const char* aes_error_to_string(aes_error_t error_code)
             return "Unsupported key size";
         case AES_ERROR_MEMORY_ALLOCATION_FAILED:
             return "Memory allocation failed";
+        case AES_ERROR_INVALID_ARGUMENT:
+            return "Invalid argument";
+        case AES_ERROR_UNSUPPORTED_BACKEND:
+            return "Backend not supported on this CPU";
+        case AES_ERROR_INVALID_LENGTH:
+            return "Invalid data length";
+        case AES_ERROR_AUTHENTICATION_FAILED:
+            return "Authentication failed";
+        case AES_ERROR_INVALID_PADDING:
+            return "Invalid padding";
+        case AES_ERROR_KEYRING_FULL:
+            return "Keyring is full";
+        case AES_ERROR_KEY_NOT_FOUND:
+            return "Key not found";
+        case AES_ERROR_ENTROPY_FAILED:
+            return "Entropy source failed";
+        case AES_ERROR_INVALID_FORMAT:
+            return "Invalid archive format";
         default:
             return "An unknown error occurred";
     }
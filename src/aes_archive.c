@@ -0,0 +1,325 @@
+/**
+ * @file aes_archive.c
+ * @brief Seekable encrypted archives: fixed-size, independently authenticated
+ * chunks with a tag index.
+ *
+ * @details The plaintext is cut into chunk_size pieces, each sealed with GCM
+ * or OCB under its own nonce (the nonce base with the chunk index XORed into
+ * its last eight bytes) and with the header and the chunk index as additional
+ * data. The header records the total length, so a chunk's size, position and
+ * number are all authenticated by its tag; truncating, extending or
+ * reordering the archive makes the affected chunks fail to open.
+ *
+ * Ciphertext is stored without gaps, at the same offset as its plaintext, and
+ * the tags are gathered into an index at the end of the archive. Reading a
+ * byte range therefore touches the range's ciphertext, one index entry per
+ * chunk and the header, and nothing else. Chunks are independent, so both
+ * sealing and reading hand one chunk per index to aes_engine_for_each().
+ *
+ * Header layout (all integers big-endian):
+ *
+ *     0   "AESA"          4  version        5  mode         6  key size   7  zero
+ *     8   chunk size (4)  12 key id (8)     20 nonce base (12)
+ *     32  plaintext length (8)              40 zero (24)
+ */
+
+#include "aes_internal.h"
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define ARCHIVE_MAGIC   "AESA"
+#define ARCHIVE_VERSION 1
+
+// Additional data per chunk: the header followed by the chunk index.
+#define ARCHIVE_AAD_SIZE (AES_ARCHIVE_HEADER_SIZE + 8)
+
+/**
+ * @brief Returns the number of chunks of a valid archive.
+ * @details The last chunk holds the remainder, and an empty archive has one
+ * empty chunk so that its header is still authenticated.
+ */
+static uint64_t archive_num_chunks(const aes_archive_info_t* info)
+{
+    return info->length ? (info->length - 1) / info->chunk_size + 1 : 1;
+}
+
+/** @brief Checks the parameters of an archive, without its length. */
+static int archive_params_valid(const aes_archive_info_t* info)
+{
+    return (info->mode == AES_ARCHIVE_MODE_GCM || info->mode == AES_ARCHIVE_MODE_OCB) &&
+           (info->key_size == AES_KEY_SIZE_128 || info->key_size == AES_KEY_SIZE_192 ||
+            info->key_size == AES_KEY_SIZE_256) &&
+           info->chunk_size != 0 && info->chunk_size % AES_BLOCK_SIZE == 0;
+}
+
+uint64_t aes_archive_size(const aes_archive_info_t* info)
+{
+    if (!info || !archive_params_valid(info))
+        return 0;
+
+    uint64_t index = archive_num_chunks(info) * AES_ARCHIVE_TAG_SIZE;
+    if (info->length > UINT64_MAX - AES_ARCHIVE_HEADER_SIZE - index)
+        return 0;
+    return AES_ARCHIVE_HEADER_SIZE + info->length + index;
+}
+
+/** @brief Serializes the parameters into a header. */
+static void archive_encode_header(const aes_archive_info_t* info, uint8_t* header)
+{
+    memset(header, 0, AES_ARCHIVE_HEADER_SIZE);
+    memcpy(header, ARCHIVE_MAGIC, 4);
+    header[4] = ARCHIVE_VERSION;
+    header[5] = (uint8_t)info->mode;
+    header[6] = (uint8_t)info->key_size;
+    store_be32(header + 8, info->chunk_size);
+    store_be64(header + 12, info->key_id);
+    memcpy(header + 20, info->nonce_base, AES_ARCHIVE_NONCE_SIZE);
+    store_be64(header + 32, info->length);
+}
+
+aes_error_t aes_archive_read_info(aes_archive_info_t* info, const uint8_t* archive, size_t size)
+{
+    static const uint8_t zeros[AES_ARCHIVE_HEADER_SIZE - 40] = {0};
+
+    if (!info || !archive)
+        return AES_ERROR_INVALID_ARGUMENT;
+    if (size < AES_ARCHIVE_HEADER_SIZE || memcmp(archive, ARCHIVE_MAGIC, 4) != 0 || archive[4] != ARCHIVE_VERSION ||
+        archive[7] != 0 || memcmp(archive + 40, zeros, sizeof(zeros)) != 0)
+        return AES_ERROR_INVALID_FORMAT;
+
+    info->mode       = (aes_archive_mode_t)archive[5];
+    info->key_size   = (aes_key_size_t)archive[6];
+    info->chunk_size = load_be32(archive + 8);
+    info->key_id     = load_be64(archive + 12);
+    memcpy(info->nonce_base, archive + 20, AES_ARCHIVE_NONCE_SIZE);
+    info->length = load_be64(archive + 32);
+
+    if (aes_archive_size(info) != size)
+        return AES_ERROR_INVALID_FORMAT;
+    return AES_SUCCESS;
+}
+
+aes_error_t aes_archive_init(aes_archive_ctx_t* archive, const aes_archive_info_t* info, const uint8_t* key,
+                             aes_backend_t backend)
+{
+    if (!archive || !info || !key)
+        return AES_ERROR_INVALID_ARGUMENT;
+    if (aes_archive_size(info) == 0)
+        return AES_ERROR_INVALID_FORMAT;
+
+    aes_error_t result = info->mode == AES_ARCHIVE_MODE_GCM
+                             ? aes_gcm_init(&archive->gcm, key, info->key_size, backend)
+                             : aes_ocb_init(&archive->ocb, key, info->key_size, backend);
+    if (result != AES_SUCCESS)
+        return result;
+
+    archive->info       = *info;
+    archive->num_chunks = archive_num_chunks(info);
+    archive_encode_header(info, archive->header);
+    return AES_SUCCESS;
+}
+
+void aes_archive_clear(aes_archive_ctx_t* archive)
+{
+    if (archive)
+        secure_zero_memory(archive, sizeof(*archive));
+}
+
+/** @brief Derives the nonce and additional data of a chunk. */
+static void archive_chunk_params(const aes_archive_ctx_t* archive, uint64_t index, uint8_t* nonce, uint8_t* aad)
+{
+    memcpy(nonce, archive->info.nonce_base, AES_ARCHIVE_NONCE_SIZE);
+    for (int i = 0; i < 8; i++)
+        nonce[AES_ARCHIVE_NONCE_SIZE - 1 - i] ^= (uint8_t)(index >> (8 * i));
+
+    memcpy(aad, archive->header, AES_ARCHIVE_HEADER_SIZE);
+    store_be64(aad + AES_ARCHIVE_HEADER_SIZE, index);
+}
+
+/** @brief Returns the plaintext length of a chunk. */
+static size_t archive_chunk_length(const aes_archive_ctx_t* archive, uint64_t index)
+{
+    uint64_t offset = index * archive->info.chunk_size;
+    uint64_t rest   = archive->info.length - offset;
+    return (size_t)(rest < archive->info.chunk_size ? rest : archive->info.chunk_size);
+}
+
+/** @brief Seals one chunk; in and out may be NULL for an empty chunk. */
+static void archive_seal_chunk(const aes_archive_ctx_t* archive, uint64_t index, const uint8_t* in, uint8_t* out,
+                               size_t length, uint8_t* tag)
+{
+    uint8_t nonce[AES_ARCHIVE_NONCE_SIZE];
+    uint8_t aad[ARCHIVE_AAD_SIZE];
+
+    archive_chunk_params(archive, index, nonce, aad);
+    if (archive->info.mode == AES_ARCHIVE_MODE_GCM)
+        aes_gcm_seal(&archive->gcm, nonce, sizeof(nonce), aad, sizeof(aad), in, out, length, tag,
+                     AES_ARCHIVE_TAG_SIZE);
+    else
+        aes_ocb_seal(&archive->ocb, nonce, sizeof(nonce), aad, sizeof(aad), in, out, length, tag,
+                     AES_ARCHIVE_TAG_SIZE);
+}
+
+/**
+ * @brief Opens one chunk.
+ * @return AES_SUCCESS, or AES_ERROR_AUTHENTICATION_FAILED with out wiped.
+ */
+static aes_error_t archive_open_chunk(const aes_archive_ctx_t* archive, uint64_t index, const uint8_t* in,
+                                      uint8_t* out, size_t length, const uint8_t* tag)
+{
+    uint8_t nonce[AES_ARCHIVE_NONCE_SIZE];
+    uint8_t aad[ARCHIVE_AAD_SIZE];
+
+    archive_chunk_params(archive, index, nonce, aad);
+    if (archive->info.mode == AES_ARCHIVE_MODE_GCM)
+        return aes_gcm_open(&archive->gcm, nonce, sizeof(nonce), aad, sizeof(aad), in, out, length, tag,
+                            AES_ARCHIVE_TAG_SIZE);
+    return aes_ocb_open(&archive->ocb, nonce, sizeof(nonce), aad, sizeof(aad), in, out, length, tag,
+                        AES_ARCHIVE_TAG_SIZE);
+}
+
+/* ============================================================================
+ * Sealing
+ * ========================================================================= */
+
+//! The arguments shared by the chunks of one aes_archive_seal() call.
+typedef struct
+{
+    const aes_archive_ctx_t* archive;
+    const uint8_t*           in;
+    uint8_t*                 out;
+} archive_seal_job_t;
+
+/** @brief aes_engine_task_fn that seals chunk index. */
+static void archive_seal_task(void* arg, size_t index)
+{
+    const archive_seal_job_t* job     = arg;
+    const aes_archive_ctx_t*  archive = job->archive;
+    size_t                    offset  = index * (size_t)archive->info.chunk_size;
+    size_t                    length  = archive_chunk_length(archive, index);
+    uint8_t*                  tags    = job->out + AES_ARCHIVE_HEADER_SIZE + (size_t)archive->info.length;
+
+    archive_seal_chunk(archive, index, length ? job->in + offset : NULL,
+                       length ? job->out + AES_ARCHIVE_HEADER_SIZE + offset : NULL, length,
+                       tags + index * AES_ARCHIVE_TAG_SIZE);
+}
+
+aes_error_t aes_archive_seal(const aes_archive_ctx_t* archive, aes_engine_t* engine, const uint8_t* in, uint8_t* out)
+{
+    if (!archive || !archive->num_chunks || !out || (archive->info.length && !in))
+        return AES_ERROR_INVALID_ARGUMENT;
+#if SIZE_MAX < UINT64_MAX
+    if (aes_archive_size(&archive->info) > SIZE_MAX)
+        return AES_ERROR_INVALID_LENGTH;
+#endif
+
+    archive_seal_job_t job = {archive, in, out};
+    memcpy(out, archive->header, AES_ARCHIVE_HEADER_SIZE);
+    aes_engine_for_each(engine, (size_t)archive->num_chunks, (size_t)archive->info.length, archive_seal_task, &job);
+    return AES_SUCCESS;
+}
+
+/* ============================================================================
+ * Random-Access Reads
+ * ========================================================================= */
+
+//! The arguments shared by the chunks of one aes_archive_read() call.
+typedef struct
+{
+    const aes_archive_ctx_t* archive;
+    const uint8_t*           data;    /**< The whole archive. */
+    uint64_t                 offset;  /**< The first plaintext byte wanted. */
+    uint8_t*                 out;     /**< Receives the wanted bytes. */
+    size_t                   length;  /**< The number of bytes wanted. */
+    uint64_t                 first;   /**< The index of the first chunk of the range. */
+    uint8_t*                 scratch; /**< Two chunks, for a partial first and last chunk. */
+    atomic_int               failed;  /**< Set when any chunk fails to verify. */
+} archive_read_job_t;
+
+/** @brief aes_engine_task_fn that opens the i-th chunk of the range. */
+static void archive_read_task(void* arg, size_t i)
+{
+    archive_read_job_t*      job        = arg;
+    const aes_archive_ctx_t* archive    = job->archive;
+    uint64_t                 index      = job->first + i;
+    uint64_t                 start      = index * archive->info.chunk_size;
+    size_t                   length     = archive_chunk_length(archive, index);
+    const uint8_t*           ciphertext = job->data + AES_ARCHIVE_HEADER_SIZE + start;
+    const uint8_t*           tag        = job->data + AES_ARCHIVE_HEADER_SIZE + archive->info.length +
+                               index * AES_ARCHIVE_TAG_SIZE;
+
+    // Whole chunks inside the range decrypt in place in out; the ends go through scratch.
+    uint64_t end = job->offset + job->length;
+    if (start >= job->offset && start + length <= end)
+    {
+        if (archive_open_chunk(archive, index, ciphertext, job->out + (start - job->offset), length, tag) !=
+            AES_SUCCESS)
+            atomic_store_explicit(&job->failed, 1, memory_order_relaxed);
+        return;
+    }
+
+    uint8_t* plaintext = job->scratch + (start < job->offset ? 0 : archive->info.chunk_size);
+    if (archive_open_chunk(archive, index, ciphertext, plaintext, length, tag) != AES_SUCCESS)
+    {
+        atomic_store_explicit(&job->failed, 1, memory_order_relaxed);
+        return;
+    }
+
+    uint64_t from = start > job->offset ? start : job->offset;
+    uint64_t to   = start + length < end ? start + length : end;
+    memcpy(job->out + (from - job->offset), plaintext + (from - start), (size_t)(to - from));
+}
+
+aes_error_t aes_archive_read(const aes_archive_ctx_t* archive, aes_engine_t* engine, const uint8_t* data, size_t size,
+                             uint64_t offset, uint8_t* out, size_t length)
+{
+    if (!archive || !archive->num_chunks || !data || (length && !out))
+        return AES_ERROR_INVALID_ARGUMENT;
+    if (aes_archive_size(&archive->info) != size)
+        return AES_ERROR_INVALID_FORMAT;
+    if (offset > archive->info.length || length > archive->info.length - offset)
+        return AES_ERROR_INVALID_LENGTH;
+    if (length == 0)
+        return AES_SUCCESS;
+
+    archive_read_job_t job;
+    uint64_t           chunk_size = archive->info.chunk_size;
+    uint64_t           last       = (offset + length - 1) / chunk_size;
+    job.archive                   = archive;
+    job.data                      = data;
+    job.offset                    = offset;
+    job.out                       = out;
+    job.length                    = length;
+    job.first                     = offset / chunk_size;
+    job.scratch                   = NULL;
+    atomic_init(&job.failed, 0);
+
+    // Only a range that starts or ends inside a chunk needs the scratch chunks.
+    uint64_t end = offset + length;
+    if (offset % chunk_size != 0 || (end % chunk_size != 0 && end != archive->info.length))
+    {
+        job.scratch = malloc(2 * (size_t)chunk_size);
+        if (!job.scratch)
+        {
+            AES_STATS_ALLOCATION_FAILED();
+            return AES_ERROR_MEMORY_ALLOCATION_FAILED;
+        }
+    }
+
+    aes_engine_for_each(engine, (size_t)(last - job.first + 1), length, archive_read_task, &job);
+
+    if (job.scratch)
+    {
+        secure_zero_memory(job.scratch, 2 * (size_t)chunk_size);
+        free(job.scratch);
+    }
+    if (atomic_load_explicit(&job.failed, memory_order_relaxed))
+    {
+        secure_zero_memory(out, length);
+        return AES_ERROR_AUTHENTICATION_FAILED;
+    }
+    return AES_SUCCESS;
+}
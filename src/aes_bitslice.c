@@ -0,0 +1,675 @@
+/**
+ * @file aes_bitslice.c
+ * @brief The constant-time bitsliced AES backend.
+ *
+ * @details Eight blocks are processed together. They are transposed into
+ * eight bit planes, where plane b holds bit b of every byte of every block, so
+ * the whole batch is sixteen 64-bit words. SubBytes becomes the Boyar-Peralta
+ * boolean circuit evaluated on the planes, and ShiftRows and MixColumns become
+ * rotations and shuffles of whole words. No memory access depends on key or
+ * data, and the key schedule uses the same circuit for SubWord. The
+ * multi-key entry points give each of the eight lanes its own round keys.
+ *
+ * Plane layout: word q[h][b] holds plane b of rows 2h (low 32 bits) and
+ * 2h + 1 (high 32 bits). Within a row, column c occupies bits 8c..8c+7 and
+ * bit 8c + k belongs to block k.
+ *
+ * Cost: the circuit always runs on a full batch, so one block costs as much
+ * as eight. The context keeps the compact 16-bit-per-plane schedule, because
+ * the broadcast form (128 bytes per round key, about 1.9 KB for AES-256) would
+ * not fit in aes_ctx_t's 480 bytes of round keys. Multi-batch calls broadcast
+ * it once per call, and single-batch calls add each key as it is broadcast.
+ *
+ * Unlike the other backends, the block kernels are not instantiated per key
+ * size through AES_DEFINE_ROUND_KERNELS: bs_encrypt and bs_decrypt take the
+ * round count at run time. Each round is dominated by two evaluations of the
+ * 113-gate S-box circuit, so a constant round count saves nothing
+ * measurable, while three copies of each cipher more than double the code.
+ */
+
+#include "aes_internal.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// Number of blocks processed per bitsliced batch.
+#define BS_LANES 8
+
+// Number of bit planes (bits per byte).
+#define BS_PLANES 8
+
+/** @brief The bitsliced state: two halves (row pairs) of eight planes each. */
+typedef uint64_t bs_state_t[2][BS_PLANES];
+
+/** @brief Rotates a 32-bit word right by n bits (0 < n < 32). */
+#define ROTR32(x, n) (((x) >> (n)) | ((x) << (32 - (n))))
+
+/**
+ * @brief Evaluates the AES S-box on eight bit planes with the Boyar-Peralta circuit.
+ * @param[in,out] q Planes 0 (least significant bit) to 7.
+ */
+static void bs_sbox(uint64_t* q)
+{
+    uint64_t x0 = q[7], x1 = q[6], x2 = q[5], x3 = q[4], x4 = q[3], x5 = q[2], x6 = q[1], x7 = q[0];
+    uint64_t y1, y2, y3, y4, y5, y6, y7, y8, y9, y10, y11, y12, y13, y14, y15, y16, y17, y18, y19, y20, y21;
+    uint64_t z0, z1, z2, z3, z4, z5, z6, z7, z8, z9, z10, z11, z12, z13, z14, z15, z16, z17;
+    uint64_t t0, t1, t2, t3, t4, t5, t6, t7, t8, t9, t10, t11, t12, t13, t14, t15, t16, t17, t18, t19, t20, t21;
+    uint64_t t22, t23, t24, t25, t26, t27, t28, t29, t30, t31, t32, t33, t34, t35, t36, t37, t38, t39, t40, t41;
+    uint64_t t42, t43, t44, t45, t46, t47, t48, t49, t50, t51, t52, t53, t54, t55, t56, t57, t58, t59, t60, t61;
+    uint64_t t62, t63, t64, t65, t66, t67;
+    uint64_t s0, s1, s2, s3, s4, s5, s6, s7;
+
+    // Top linear transformation.
+    y14 = x3 ^ x5;
+    y13 = x0 ^ x6;
+    y9  = x0 ^ x3;
+    y8  = x0 ^ x5;
+    t0  = x1 ^ x2;
+    y1  = t0 ^ x7;
+    y4  = y1 ^ x3;
+    y12 = y13 ^ y14;
+    y2  = y1 ^ x0;
+    y5  = y1 ^ x6;
+    y3  = y5 ^ y8;
+    t1  = x4 ^ y12;
+    y15 = t1 ^ x5;
+    y20 = t1 ^ x1;
+    y6  = y15 ^ x7;
+    y10 = y15 ^ t0;
+    y11 = y20 ^ y9;
+    y7  = x7 ^ y11;
+    y17 = y10 ^ y11;
+    y19 = y10 ^ y8;
+    y16 = t0 ^ y11;
+    y21 = y13 ^ y16;
+    y18 = x0 ^ y16;
+
+    // Non-linear section: inversion in GF(2^8).
+    t2  = y12 & y15;
+    t3  = y3 & y6;
+    t4  = t3 ^ t2;
+    t5  = y4 & x7;
+    t6  = t5 ^ t2;
+    t7  = y13 & y16;
+    t8  = y5 & y1;
+    t9  = t8 ^ t7;
+    t10 = y2 & y7;
+    t11 = t10 ^ t7;
+    t12 = y9 & y11;
+    t13 = y14 & y17;
+    t14 = t13 ^ t12;
+    t15 = y8 & y10;
+    t16 = t15 ^ t12;
+    t17 = t4 ^ t14;
+    t18 = t6 ^ t16;
+    t19 = t9 ^ t14;
+    t20 = t11 ^ t16;
+    t21 = t17 ^ y20;
+    t22 = t18 ^ y19;
+    t23 = t19 ^ y21;
+    t24 = t20 ^ y18;
+
+    t25 = t21 ^ t22;
+    t26 = t21 & t23;
+    t27 = t24 ^ t26;
+    t28 = t25 & t27;
+    t29 = t28 ^ t22;
+    t30 = t23 ^ t24;
+    t31 = t22 ^ t26;
+    t32 = t31 & t30;
+    t33 = t32 ^ t24;
+    t34 = t23 ^ t33;
+    t35 = t27 ^ t33;
+    t36 = t24 & t35;
+    t37 = t36 ^ t34;
+    t38 = t27 ^ t36;
+    t39 = t29 & t38;
+    t40 = t25 ^ t39;
+
+    t41 = t40 ^ t37;
+    t42 = t29 ^ t33;
+    t43 = t29 ^ t40;
+    t44 = t33 ^ t37;
+    t45 = t42 ^ t41;
+    z0  = t44 & y15;
+    z1  = t37 & y6;
+    z2  = t33 & x7;
+    z3  = t43 & y16;
+    z4  = t40 & y1;
+    z5  = t29 & y7;
+    z6  = t42 & y11;
+    z7  = t45 & y17;
+    z8  = t41 & y10;
+    z9  = t44 & y12;
+    z10 = t37 & y3;
+    z11 = t33 & y4;
+    z12 = t43 & y13;
+    z13 = t40 & y5;
+    z14 = t29 & y2;
+    z15 = t42 & y9;
+    z16 = t45 & y14;
+    z17 = t41 & y8;
+
+    // Bottom linear transformation.
+    t46 = z15 ^ z16;
+    t47 = z10 ^ z11;
+    t48 = z5 ^ z13;
+    t49 = z9 ^ z10;
+    t50 = z2 ^ z12;
+    t51 = z2 ^ z5;
+    t52 = z7 ^ z8;
+    t53 = z0 ^ z3;
+    t54 = z6 ^ z7;
+    t55 = z16 ^ z17;
+    t56 = z12 ^ t48;
+    t57 = t50 ^ t53;
+    t58 = z4 ^ t46;
+    t59 = z3 ^ t54;
+    t60 = t46 ^ t57;
+    t61 = z14 ^ t57;
+    t62 = t52 ^ t58;
+    t63 = t49 ^ t58;
+    t64 = z4 ^ t59;
+    t65 = t61 ^ t62;
+    t66 = z1 ^ t63;
+    s0  = t59 ^ t63;
+    s6  = t56 ^ ~t62;
+    s7  = t48 ^ ~t60;
+    t67 = t64 ^ t65;
+    s3  = t53 ^ t66;
+    s4  = t51 ^ t66;
+    s5  = t47 ^ t65;
+    s1  = t64 ^ ~s3;
+    s2  = t55 ^ ~t67;
+
+    q[7] = s0;
+    q[6] = s1;
+    q[5] = s2;
+    q[4] = s3;
+    q[3] = s4;
+    q[2] = s5;
+    q[1] = s6;
+    q[0] = s7;
+}
+
+/**
+ * @brief Applies the inverse affine transformation to eight bit planes.
+ * @details Computes A^-1(x ^ 0x63), which maps an S-box output back to the
+ * multiplicative inverse and is the first step of the inverse S-box.
+ */
+static void bs_inv_affine(uint64_t* q)
+{
+    uint64_t x[BS_PLANES];
+    memcpy(x, q, sizeof(x));
+    for (int i = 0; i < BS_PLANES; i++)
+        q[i] = x[(i + 2) % BS_PLANES] ^ x[(i + 5) % BS_PLANES] ^ x[(i + 7) % BS_PLANES];
+    q[0] = ~q[0];
+    q[2] = ~q[2];
+}
+
+/**
+ * @brief Evaluates the inverse S-box on eight bit planes.
+ * @details The S-box is inversion followed by the affine map A, so the
+ * inversion alone is A^-1(SBox(x) ^ 63) and InvSBox(y) is that applied to
+ * A^-1(y ^ 63). This reuses the forward circuit between two linear layers.
+ */
+static void bs_inv_sbox(uint64_t* q)
+{
+    bs_inv_affine(q);
+    bs_sbox(q);
+    bs_inv_affine(q);
+}
+
+/** @brief Multiplies every bitsliced byte of one half by {02}. */
+static void bs_xtime(uint64_t* out, const uint64_t* in)
+{
+    out[0] = in[7];
+    out[1] = in[0] ^ in[7];
+    out[2] = in[1];
+    out[3] = in[2] ^ in[7];
+    out[4] = in[3] ^ in[7];
+    out[5] = in[4];
+    out[6] = in[5];
+    out[7] = in[6];
+}
+
+/** @brief Rotates each 32-bit row of a word right by the given byte counts. */
+static inline uint64_t rotate_rows(uint64_t x, unsigned lo_bits, unsigned hi_bits)
+{
+    uint32_t lo = (uint32_t)x;
+    uint32_t hi = (uint32_t)(x >> 32);
+    if (lo_bits)
+        lo = ROTR32(lo, lo_bits);
+    if (hi_bits)
+        hi = ROTR32(hi, hi_bits);
+    return ((uint64_t)hi << 32) | lo;
+}
+
+/** @brief ShiftRows: row r moves left by r columns, i.e. its word rotates right by 8r bits. */
+static void bs_shift_rows(bs_state_t q)
+{
+    for (int b = 0; b < BS_PLANES; b++)
+    {
+        q[0][b] = rotate_rows(q[0][b], 0, 8);
+        q[1][b] = rotate_rows(q[1][b], 16, 24);
+    }
+}
+
+/** @brief InvShiftRows: the inverse rotations of bs_shift_rows(). */
+static void bs_inv_shift_rows(bs_state_t q)
+{
+    for (int b = 0; b < BS_PLANES; b++)
+    {
+        q[0][b] = rotate_rows(q[0][b], 0, 24);
+        q[1][b] = rotate_rows(q[1][b], 16, 8);
+    }
+}
+
+/**
+ * @brief MixColumns on the row-pair words.
+ * @details out_r = {02}(s_r ^ s_r+1) ^ s_r+1 ^ s_r+2 ^ s_r+3. With rows split
+ * across the two halves, the row rotations are 32-bit shuffles between them.
+ */
+static void bs_mix_columns(bs_state_t q)
+{
+    uint64_t t0[BS_PLANES], t1[BS_PLANES], m0[BS_PLANES], m1[BS_PLANES], u[BS_PLANES];
+
+    for (int b = 0; b < BS_PLANES; b++)
+    {
+        uint64_t a  = q[0][b];
+        uint64_t c  = q[1][b];
+        uint64_t a1 = (a >> 32) | (c << 32); // rows 1, 2
+        uint64_t c1 = (c >> 32) | (a << 32); // rows 3, 0
+        t0[b]       = a ^ a1;
+        t1[b]       = c ^ c1;
+        u[b]        = a1 ^ c1;
+    }
+    bs_xtime(m0, t0);
+    bs_xtime(m1, t1);
+    for (int b = 0; b < BS_PLANES; b++)
+    {
+        uint64_t a = q[0][b];
+        q[0][b]    = m0[b] ^ u[b] ^ q[1][b];
+        q[1][b]    = m1[b] ^ u[b] ^ a;
+    }
+}
+
+/**
+ * @brief InvMixColumns as MixColumns of a pre-multiplied state.
+ * @details InvMixColumns = MixColumns . circ({05}, {00}, {04}, {00}), where
+ * the right-hand factor is s_r ^ {04}(s_r ^ s_r+2) and rows r and r+2 sit at
+ * the same position of the two halves.
+ */
+static void bs_inv_mix_columns(bs_state_t q)
+{
+    uint64_t t[BS_PLANES], x2[BS_PLANES], x4[BS_PLANES];
+
+    for (int b = 0; b < BS_PLANES; b++)
+        t[b] = q[0][b] ^ q[1][b];
+    bs_xtime(x2, t);
+    bs_xtime(x4, x2);
+    for (int b = 0; b < BS_PLANES; b++)
+    {
+        q[0][b] ^= x4[b];
+        q[1][b] ^= x4[b];
+    }
+    bs_mix_columns(q);
+}
+
+/** @brief XORs a bitsliced round key into the state. */
+static void bs_add_round_key(bs_state_t q, bs_state_t k)
+{
+    for (int h = 0; h < 2; h++)
+        for (int b = 0; b < BS_PLANES; b++)
+            q[h][b] ^= k[h][b];
+}
+
+/**
+ * @brief Transposes an 8x8 bit matrix held in a 64-bit word.
+ * @details Bit j of byte i moves to bit i of byte j. The transform is its own inverse.
+ */
+static inline uint64_t transpose8x8(uint64_t x)
+{
+    uint64_t t;
+    t = (x ^ (x >> 7)) & 0x00AA00AA00AA00AAULL;
+    x = x ^ t ^ (t << 7);
+    t = (x ^ (x >> 14)) & 0x0000CCCC0000CCCCULL;
+    x = x ^ t ^ (t << 14);
+    t = (x ^ (x >> 28)) & 0x00000000F0F0F0F0ULL;
+    x = x ^ t ^ (t << 28);
+    return x;
+}
+
+/** @brief Transposes eight consecutive blocks into bit planes. */
+static void bs_pack(bs_state_t q, const uint8_t* in)
+{
+    memset(q, 0, sizeof(bs_state_t));
+    for (int c = 0; c < AES_STATE_DIM; c++)
+    {
+        for (int r = 0; r < AES_STATE_DIM; r++)
+        {
+            uint64_t bytes = 0;
+            for (int k = 0; k < BS_LANES; k++)
+                bytes |= (uint64_t)in[k * AES_BLOCK_SIZE + c * AES_STATE_DIM + r] << (8 * k);
+
+            uint64_t planes = transpose8x8(bytes);
+            unsigned shift  = (unsigned)(32 * (r & 1) + 8 * c);
+            for (int b = 0; b < BS_PLANES; b++)
+                q[r >> 1][b] |= ((planes >> (8 * b)) & 0xff) << shift;
+        }
+    }
+}
+
+/** @brief Transposes bit planes back into eight consecutive blocks. */
+static void bs_unpack(uint8_t* out, bs_state_t q)
+{
+    for (int c = 0; c < AES_STATE_DIM; c++)
+    {
+        for (int r = 0; r < AES_STATE_DIM; r++)
+        {
+            uint64_t planes = 0;
+            unsigned shift  = (unsigned)(32 * (r & 1) + 8 * c);
+            for (int b = 0; b < BS_PLANES; b++)
+                planes |= ((q[r >> 1][b] >> shift) & 0xff) << (8 * b);
+
+            uint64_t bytes = transpose8x8(planes);
+            for (int k = 0; k < BS_LANES; k++)
+                out[k * AES_BLOCK_SIZE + c * AES_STATE_DIM + r] = (uint8_t)(bytes >> (8 * k));
+        }
+    }
+}
+
+/** @brief Widens a 4-bit column mask into a 32-bit row with 0xff in each selected column byte. */
+static inline uint64_t spread_columns(unsigned nibble)
+{
+    return (uint64_t)((((nibble & 0xfU) * 0x00204081U) & 0x01010101U) * 0xffU);
+}
+
+/**
+ * @brief Broadcasts one plane of a compact round key to all eight lanes.
+ * @details The schedule stores, for round key i and plane b, a 16-bit mask
+ * whose bit 4r + c is bit b of key byte (r, c); word 4i + b/2 of the schedule
+ * holds the masks of planes b and b + 1. Every lane uses the same key,
+ * so each mask bit widens to a full byte of the plane.
+ * @return Word h, plane b of round key i.
+ */
+static inline uint64_t bs_key_plane(const aes_ctx_t* ctx, size_t i, int h, int b)
+{
+    unsigned m = (unsigned)(ctx->round_keys[i * WORD_COUNT_PER_BLOCK + (size_t)(b >> 1)] >> (16 * (b & 1) + 8 * h));
+    return spread_columns(m) | (spread_columns(m >> 4) << 32);
+}
+
+/** @brief Broadcasts all the compact round keys to all eight lanes. */
+static void bs_load_round_keys(bs_state_t* keys, const aes_ctx_t* ctx)
+{
+    for (size_t i = 0; i <= ctx->num_rounds; i++)
+        for (int h = 0; h < 2; h++)
+            for (int b = 0; b < BS_PLANES; b++)
+                keys[i][h][b] = bs_key_plane(ctx, i, h, b);
+}
+
+/**
+ * @brief Loads a different key into each lane: lane k takes the round keys of ctxs[k].
+ * @details Bit 8c + k of each row word belongs to lane k, so the broadcast
+ * schedule of each context is masked down to its lane. Unused lanes get zero keys.
+ */
+static void bs_load_round_keys_multi(bs_state_t* keys, const aes_ctx_t* const* ctxs, size_t count)
+{
+    bs_state_t lane_keys[AES_ROUNDS_256 + 1];
+    size_t     nr = ctxs[0]->num_rounds;
+
+    memset(keys, 0, (nr + 1) * sizeof(bs_state_t));
+    for (size_t k = 0; k < count; k++)
+    {
+        uint64_t lane = 0x0101010101010101ULL << k;
+        bs_load_round_keys(lane_keys, ctxs[k]);
+        for (size_t i = 0; i <= nr; i++)
+            for (int h = 0; h < 2; h++)
+                for (int b = 0; b < BS_PLANES; b++)
+                    keys[i][h][b] |= lane_keys[i][h][b] & lane;
+    }
+
+    secure_zero_memory(lane_keys, sizeof(lane_keys));
+}
+
+/** @brief Constant-time SubWord for the key schedule, via the S-box circuit. */
+static uint32_t bs_sub_word(uint32_t word)
+{
+    uint64_t q[BS_PLANES];
+    for (int b = 0; b < BS_PLANES; b++)
+    {
+        q[b] = 0;
+        for (int j = 0; j < 4; j++)
+            q[b] |= (uint64_t)((word >> (8 * j + b)) & 1U) << j;
+    }
+
+    bs_sbox(q);
+
+    uint32_t result = 0;
+    for (int b = 0; b < BS_PLANES; b++)
+        for (int j = 0; j < 4; j++)
+            result |= (uint32_t)((q[b] >> j) & 1U) << (8 * j + b);
+    return result;
+}
+
+/** @brief Expands the key in constant time and stores it as compact per-plane masks. */
+static void bitslice_expand_key(aes_ctx_t* ctx, const uint8_t* key)
+{
+    uint32_t words[AES_MAX_EXPANDED_KEY_SIZE / sizeof(uint32_t)];
+    size_t   num_words = (size_t)WORD_COUNT_PER_BLOCK * (ctx->num_rounds + 1U);
+
+    aes_expand_key_words(words, key, (size_t)ctx->key_size / 4, num_words, bs_sub_word);
+
+    memset(ctx->round_keys, 0, num_words * sizeof(uint32_t));
+    for (size_t i = 0; i <= ctx->num_rounds; i++)
+    {
+        for (int b = 0; b < BS_PLANES; b++)
+        {
+            uint32_t m = 0;
+            for (unsigned c = 0; c < AES_STATE_DIM; c++)
+                for (unsigned r = 0; r < AES_STATE_DIM; r++)
+                    m |= ((words[i * WORD_COUNT_PER_BLOCK + c] >> (8 * r + (unsigned)b)) & 1U) << (4 * r + c);
+            ctx->round_keys[i * WORD_COUNT_PER_BLOCK + (size_t)(b >> 1)] |= m << (16 * (b & 1));
+        }
+    }
+
+    secure_zero_memory(words, sizeof(words));
+}
+
+/**
+ * @brief XORs round key i into the state.
+ * @details With keys NULL the key is broadcast from the compact schedule of
+ * ctx as it is added, so a lone batch never stores or wipes the full
+ * broadcast schedule.
+ */
+static inline void bs_add_key(bs_state_t q, bs_state_t* keys, const aes_ctx_t* ctx, size_t i)
+{
+    if (keys != NULL)
+    {
+        bs_add_round_key(q, keys[i]);
+        return;
+    }
+    for (int h = 0; h < 2; h++)
+        for (int b = 0; b < BS_PLANES; b++)
+            q[h][b] ^= bs_key_plane(ctx, i, h, b);
+}
+
+/** @brief Runs the forward cipher on one packed batch, with keys from keys or, if NULL, from ctx. */
+static void bs_encrypt(bs_state_t q, bs_state_t* keys, const aes_ctx_t* ctx, size_t num_rounds)
+{
+    bs_add_key(q, keys, ctx, 0);
+    for (size_t round = 1; round < num_rounds; round++)
+    {
+        bs_sbox(q[0]);
+        bs_sbox(q[1]);
+        bs_shift_rows(q);
+        bs_mix_columns(q);
+        bs_add_key(q, keys, ctx, round);
+    }
+    bs_sbox(q[0]);
+    bs_sbox(q[1]);
+    bs_shift_rows(q);
+    bs_add_key(q, keys, ctx, num_rounds);
+}
+
+/** @brief Runs the inverse cipher on one packed batch, with keys from keys or, if NULL, from ctx. */
+static void bs_decrypt(bs_state_t q, bs_state_t* keys, const aes_ctx_t* ctx, size_t num_rounds)
+{
+    bs_add_key(q, keys, ctx, num_rounds);
+    for (size_t round = num_rounds; round > 1; round--)
+    {
+        bs_inv_shift_rows(q);
+        bs_inv_sbox(q[0]);
+        bs_inv_sbox(q[1]);
+        bs_add_key(q, keys, ctx, round - 1);
+        bs_inv_mix_columns(q);
+    }
+    bs_inv_shift_rows(q);
+    bs_inv_sbox(q[0]);
+    bs_inv_sbox(q[1]);
+    bs_add_key(q, keys, ctx, 0);
+}
+
+/**
+ * @brief Runs a bitsliced cipher over any number of blocks.
+ * @details Full batches are transformed directly; a final partial batch is
+ * padded to eight blocks in a scratch buffer. When the call spans more than
+ * one batch, the broadcast schedule is built once and shared by all of them.
+ * A call that fits in a single batch (one block, or a short CTR or GCM
+ * remainder) takes the narrow path instead and broadcasts each round key as
+ * it is added, skipping the stored schedule and its wipe.
+ */
+static void bs_process_blocks(const aes_ctx_t* ctx, const uint8_t* in, uint8_t* out, size_t num_blocks,
+                              void (*cipher)(bs_state_t, bs_state_t*, const aes_ctx_t*, size_t))
+{
+    bs_state_t  keys[AES_ROUNDS_256 + 1];
+    bs_state_t* schedule = NULL;
+    bs_state_t  q;
+    uint8_t     tail[BS_LANES * AES_BLOCK_SIZE];
+
+    if (num_blocks > BS_LANES)
+    {
+        bs_load_round_keys(keys, ctx);
+        schedule = keys;
+    }
+
+    for (; num_blocks >= BS_LANES; num_blocks -= BS_LANES)
+    {
+        bs_pack(q, in);
+        cipher(q, schedule, ctx, ctx->num_rounds);
+        bs_unpack(out, q);
+        in += BS_LANES * AES_BLOCK_SIZE;
+        out += BS_LANES * AES_BLOCK_SIZE;
+    }
+
+    if (num_blocks > 0)
+    {
+        memset(tail, 0, sizeof(tail));
+        memcpy(tail, in, num_blocks * AES_BLOCK_SIZE);
+        bs_pack(q, tail);
+        cipher(q, schedule, ctx, ctx->num_rounds);
+        bs_unpack(tail, q);
+        memcpy(out, tail, num_blocks * AES_BLOCK_SIZE);
+        secure_zero_memory(tail, sizeof(tail));
+    }
+
+    if (schedule != NULL)
+        secure_zero_memory(keys, sizeof(keys));
+    secure_zero_memory(q, sizeof(q));
+}
+
+/** @brief Encrypts consecutive blocks, eight per bitsliced batch. */
+static void bitslice_encrypt_blocks(const aes_ctx_t* ctx, const uint8_t* in, uint8_t* out, size_t num_blocks)
+{
+    bs_process_blocks(ctx, in, out, num_blocks, bs_encrypt);
+}
+
+/** @brief Decrypts consecutive blocks, eight per bitsliced batch. */
+static void bitslice_decrypt_blocks(const aes_ctx_t* ctx, const uint8_t* in, uint8_t* out, size_t num_blocks)
+{
+    bs_process_blocks(ctx, in, out, num_blocks, bs_decrypt);
+}
+
+/**
+ * @brief Runs a bitsliced cipher with block i under ctxs[i], eight keys per batch.
+ */
+static void bs_process_multi(const aes_ctx_t* const* ctxs, const uint8_t* in, uint8_t* out, size_t num_blocks,
+                             void (*cipher)(bs_state_t, bs_state_t*, const aes_ctx_t*, size_t))
+{
+    bs_state_t keys[AES_ROUNDS_256 + 1];
+    bs_state_t q;
+    uint8_t    batch[BS_LANES * AES_BLOCK_SIZE];
+    size_t     nr = ctxs[0]->num_rounds;
+
+    while (num_blocks > 0)
+    {
+        size_t n = num_blocks < BS_LANES ? num_blocks : BS_LANES;
+
+        bs_load_round_keys_multi(keys, ctxs, n);
+        memset(batch, 0, sizeof(batch));
+        memcpy(batch, in, n * AES_BLOCK_SIZE);
+        bs_pack(q, batch);
+        cipher(q, keys, NULL, nr);
+        bs_unpack(batch, q);
+        memcpy(out, batch, n * AES_BLOCK_SIZE);
+
+        ctxs += n;
+        in += n * AES_BLOCK_SIZE;
+        out += n * AES_BLOCK_SIZE;
+        num_blocks -= n;
+    }
+
+    secure_zero_memory(keys, sizeof(keys));
+    secure_zero_memory(q, sizeof(q));
+    secure_zero_memory(batch, sizeof(batch));
+}
+
+/** @brief Encrypts block i under ctxs[i], eight keys per bitsliced batch. */
+static void bitslice_encrypt_multi(const aes_ctx_t* const* ctxs, const uint8_t* in, uint8_t* out, size_t num_blocks)
+{
+    bs_process_multi(ctxs, in, out, num_blocks, bs_encrypt);
+}
+
+/** @brief Decrypts block i under ctxs[i], eight keys per bitsliced batch. */
+static void bitslice_decrypt_multi(const aes_ctx_t* const* ctxs, const uint8_t* in, uint8_t* out, size_t num_blocks)
+{
+    bs_process_multi(ctxs, in, out, num_blocks, bs_decrypt);
+}
+
+/**
+ * @brief CBC-encrypts num_blocks blocks of each of n streams, stream l in lane l.
+ * @details The lanes' round keys are merged once for the whole run, and each
+ * step encrypts the next block of every stream in one bitsliced batch.
+ */
+static void bitslice_cbc_encrypt_multi(const aes_ctx_t* const* ctxs, uint8_t* ivs, const uint8_t* const* in,
+                                       uint8_t* const* out, size_t n, size_t num_blocks)
+{
+    bs_state_t keys[AES_ROUNDS_256 + 1];
+    bs_state_t q;
+    uint8_t    batch[BS_LANES * AES_BLOCK_SIZE] = {0};
+    size_t     nr = ctxs[0]->num_rounds;
+
+    bs_load_round_keys_multi(keys, ctxs, n);
+    memcpy(batch, ivs, n * AES_BLOCK_SIZE);
+    for (size_t j = 0; j < num_blocks; j++)
+    {
+        size_t offset = j * AES_BLOCK_SIZE;
+        for (size_t l = 0; l < n; l++)
+            xor_bytes(batch + l * AES_BLOCK_SIZE, batch + l * AES_BLOCK_SIZE, in[l] + offset, AES_BLOCK_SIZE);
+        bs_pack(q, batch);
+        bs_encrypt(q, keys, NULL, nr);
+        bs_unpack(batch, q);
+        for (size_t l = 0; l < n; l++)
+            memcpy(out[l] + offset, batch + l * AES_BLOCK_SIZE, AES_BLOCK_SIZE);
+    }
+    memcpy(ivs, batch, n * AES_BLOCK_SIZE);
+
+    secure_zero_memory(keys, sizeof(keys));
+    secure_zero_memory(q, sizeof(q));
+    secure_zero_memory(batch, sizeof(batch));
+}
+
+const aes_backend_ops_t aes_backend_bitslice = {
+    AES_BACKEND_BITSLICE, "bitslice", 0, bitslice_expand_key, bitslice_encrypt_blocks, bitslice_decrypt_blocks,
+    NULL, NULL, bitslice_encrypt_multi, bitslice_decrypt_multi, NULL, bitslice_cbc_encrypt_multi,
+};
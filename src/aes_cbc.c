@@ -0,0 +1,331 @@
+/**
+ * @file aes_cbc.c
+ * @brief Cipher block chaining (CBC) mode, with and without PKCS#7 padding.
+ *
+ * @details CBC encryption feeds each ciphertext block into the next cipher
+ * input, so it runs one block at a time. Decryption has no such dependency:
+ * the cipher runs on ciphertext blocks that are all known in advance, so up to
+ * CBC_BATCH_BLOCKS of them are decrypted in one backend call (keeping the
+ * AES-NI lanes and the bitsliced batches full) before the XOR chain is applied.
+ * Independent encryption streams fill those lanes instead: the multi-stream
+ * driver runs up to AES_CBC_MULTI_LANES streams in lock-step, through the
+ * backend's multi-stream kernel or one multi-key call per block, refilling a
+ * lane as soon as its stream ends.
+ */
+
+#include "aes_internal.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// Blocks decrypted per backend call, matching the CTR batch.
+#define CBC_BATCH_BLOCKS AES_CTR_BATCH_BLOCKS
+
+/**
+ * @brief Encrypts whole blocks, chaining from and updating iv.
+ * @param[in] ctx An initialized context.
+ * @param[in,out] iv The chaining value.
+ * @param[in] in The plaintext blocks.
+ * @param[out] out The ciphertext blocks; may equal in.
+ * @param[in] num_blocks The number of blocks.
+ */
+static void cbc_encrypt_blocks(const aes_ctx_t* ctx, uint8_t* iv, const uint8_t* in, uint8_t* out, size_t num_blocks)
+{
+    uint8_t block[AES_BLOCK_SIZE];
+
+    memcpy(block, iv, sizeof(block));
+    for (size_t i = 0; i < num_blocks; i++, in += AES_BLOCK_SIZE, out += AES_BLOCK_SIZE)
+    {
+        xor_bytes(block, block, in, AES_BLOCK_SIZE);
+        ctx->encrypt_blocks(ctx, block, block, 1);
+        memcpy(out, block, sizeof(block));
+    }
+    memcpy(iv, block, sizeof(block));
+}
+
+/**
+ * @brief Decrypts whole blocks in batches, chaining from and updating iv.
+ * @details Within a batch the XOR chain runs from the last block to the
+ * first, so in-place output never overwrites a ciphertext block that a later
+ * XOR still needs.
+ * @param[in] ctx An initialized context.
+ * @param[in,out] iv The chaining value.
+ * @param[in] in The ciphertext blocks.
+ * @param[out] out The plaintext blocks; may equal in.
+ * @param[in] num_blocks The number of blocks.
+ */
+static void cbc_decrypt_blocks(const aes_ctx_t* ctx, uint8_t* iv, const uint8_t* in, uint8_t* out, size_t num_blocks)
+{
+    uint8_t decrypted[CBC_BATCH_BLOCKS * AES_BLOCK_SIZE];
+    uint8_t next_iv[AES_BLOCK_SIZE];
+
+    while (num_blocks > 0)
+    {
+        size_t count = num_blocks < CBC_BATCH_BLOCKS ? num_blocks : CBC_BATCH_BLOCKS;
+
+        ctx->decrypt_blocks(ctx, in, decrypted, count);
+        memcpy(next_iv, in + (count - 1) * AES_BLOCK_SIZE, sizeof(next_iv));
+
+        for (size_t i = count; i-- > 1;)
+            xor_bytes(out + i * AES_BLOCK_SIZE, decrypted + i * AES_BLOCK_SIZE, in + (i - 1) * AES_BLOCK_SIZE,
+                      AES_BLOCK_SIZE);
+        xor_bytes(out, decrypted, iv, AES_BLOCK_SIZE);
+        memcpy(iv, next_iv, sizeof(next_iv));
+
+        in += count * AES_BLOCK_SIZE;
+        out += count * AES_BLOCK_SIZE;
+        num_blocks -= count;
+    }
+
+    secure_zero_memory(decrypted, sizeof(decrypted));
+}
+
+aes_error_t aes_cbc_encrypt(const aes_ctx_t* ctx, uint8_t* iv, const uint8_t* in, uint8_t* out, size_t length)
+{
+    if (!ctx_can_encrypt(ctx) || !iv || (length && (!in || !out)))
+        return AES_ERROR_INVALID_ARGUMENT;
+    if (length % AES_BLOCK_SIZE != 0)
+        return AES_ERROR_INVALID_LENGTH;
+
+    AES_STATS_BEGIN(start);
+    cbc_encrypt_blocks(ctx, iv, in, out, length / AES_BLOCK_SIZE);
+    AES_STATS_RECORD(AES_STATS_CBC, ctx->backend->id, length, start);
+    return AES_SUCCESS;
+}
+
+aes_error_t aes_cbc_decrypt(const aes_ctx_t* ctx, uint8_t* iv, const uint8_t* in, uint8_t* out, size_t length)
+{
+    if (!ctx_can_decrypt(ctx) || !iv || (length && (!in || !out)))
+        return AES_ERROR_INVALID_ARGUMENT;
+    if (length % AES_BLOCK_SIZE != 0)
+        return AES_ERROR_INVALID_LENGTH;
+
+    AES_STATS_BEGIN(start);
+    cbc_decrypt_blocks(ctx, iv, in, out, length / AES_BLOCK_SIZE);
+    AES_STATS_RECORD(AES_STATS_CBC, ctx->backend->id, length, start);
+    return AES_SUCCESS;
+}
+
+/**
+ * @brief Encrypts validated streams, up to AES_CBC_MULTI_LANES at a time.
+ * @details state holds each lane's chaining value. Each pass runs every lane
+ * until the shortest stream ends: through the backend's multi-stream kernel
+ * when all lanes share it and a round count, and otherwise one block per lane
+ * per multi-key call. A lane whose stream ends is replaced by the last lane,
+ * and free lanes are refilled from the array before the next pass.
+ * @param[in] streams The streams.
+ * @param[in] count The number of streams.
+ */
+static void cbc_encrypt_multi(const aes_cbc_stream_t* streams, size_t count)
+{
+    const aes_ctx_t*        ctxs[AES_CBC_MULTI_LANES];
+    const aes_cbc_stream_t* lane[AES_CBC_MULTI_LANES];
+    const uint8_t*          in[AES_CBC_MULTI_LANES];
+    uint8_t*                out[AES_CBC_MULTI_LANES];
+    size_t                  left[AES_CBC_MULTI_LANES];
+    uint8_t                 state[AES_CBC_MULTI_LANES * AES_BLOCK_SIZE];
+    size_t                  active = 0, next = 0;
+
+    for (;;)
+    {
+        while (active < AES_CBC_MULTI_LANES && next < count)
+        {
+            const aes_cbc_stream_t* stream = &streams[next++];
+            if (stream->length == 0)
+                continue;
+            ctxs[active] = stream->ctx;
+            lane[active] = stream;
+            in[active]   = stream->in;
+            out[active]  = stream->out;
+            left[active] = stream->length / AES_BLOCK_SIZE;
+            memcpy(state + active * AES_BLOCK_SIZE, stream->iv, AES_BLOCK_SIZE);
+            active++;
+        }
+        if (active == 0)
+            break;
+
+        const aes_backend_ops_t* backend = ctxs[0]->backend;
+        size_t                   run     = left[0];
+        int                      fused   = backend->cbc_encrypt_multi != NULL;
+        for (size_t i = 1; i < active; i++)
+        {
+            run   = left[i] < run ? left[i] : run;
+            fused = fused && ctxs[i]->backend == backend && ctxs[i]->num_rounds == ctxs[0]->num_rounds;
+        }
+
+        if (fused)
+        {
+            backend->cbc_encrypt_multi(ctxs, state, in, out, active, run);
+        }
+        else
+        {
+            run = 1;
+            for (size_t i = 0; i < active; i++)
+                xor_bytes(state + i * AES_BLOCK_SIZE, state + i * AES_BLOCK_SIZE, in[i], AES_BLOCK_SIZE);
+            aes_multi_blocks(ctxs, 1, state, state, active);
+            for (size_t i = 0; i < active; i++)
+                memcpy(out[i], state + i * AES_BLOCK_SIZE, AES_BLOCK_SIZE);
+        }
+
+        // Finish each lane in reverse, so a finished lane can take the last one.
+        for (size_t i = active; i-- > 0;)
+        {
+            in[i] += run * AES_BLOCK_SIZE;
+            out[i] += run * AES_BLOCK_SIZE;
+            left[i] -= run;
+            if (left[i] > 0)
+                continue;
+
+            // Each stream counts as one CBC call, untimed: its blocks run interleaved with other streams'.
+            memcpy(lane[i]->iv, state + i * AES_BLOCK_SIZE, AES_BLOCK_SIZE);
+            AES_STATS_RECORD(AES_STATS_CBC, lane[i]->ctx->backend->id, lane[i]->length, 0);
+            if (i != --active)
+            {
+                ctxs[i] = ctxs[active];
+                lane[i] = lane[active];
+                in[i]   = in[active];
+                out[i]  = out[active];
+                left[i] = left[active];
+                memcpy(state + i * AES_BLOCK_SIZE, state + active * AES_BLOCK_SIZE, AES_BLOCK_SIZE);
+            }
+        }
+    }
+
+    secure_zero_memory(state, sizeof(state));
+}
+
+aes_error_t aes_cbc_encrypt_multi(const aes_cbc_stream_t* streams, size_t count)
+{
+    if (count && !streams)
+        return AES_ERROR_INVALID_ARGUMENT;
+    for (size_t i = 0; i < count; i++)
+    {
+        const aes_cbc_stream_t* stream = &streams[i];
+        if (!ctx_can_encrypt(stream->ctx) || !stream->iv || (stream->length && (!stream->in || !stream->out)))
+            return AES_ERROR_INVALID_ARGUMENT;
+        if (stream->length % AES_BLOCK_SIZE != 0)
+            return AES_ERROR_INVALID_LENGTH;
+    }
+
+    cbc_encrypt_multi(streams, count);
+    return AES_SUCCESS;
+}
+
+//! The state of a scatter-gather CBC operation.
+typedef struct
+{
+    const aes_ctx_t* ctx; /**< The key schedule. */
+    uint8_t*         iv;  /**< The caller's chaining value, updated as runs are processed. */
+} cbc_iov_t;
+
+/** @brief aes_iov_step_fn over whole blocks: arg is a cbc_iov_t. */
+static void cbc_encrypt_step(void* arg, const uint8_t* in, uint8_t* out, size_t length)
+{
+    cbc_iov_t* state = arg;
+    cbc_encrypt_blocks(state->ctx, state->iv, in, out, length / AES_BLOCK_SIZE);
+}
+
+/** @brief aes_iov_step_fn over whole blocks: arg is a cbc_iov_t. */
+static void cbc_decrypt_step(void* arg, const uint8_t* in, uint8_t* out, size_t length)
+{
+    cbc_iov_t* state = arg;
+    cbc_decrypt_blocks(state->ctx, state->iv, in, out, length / AES_BLOCK_SIZE);
+}
+
+/**
+ * @brief Runs CBC over scatter-gather lists.
+ * @return AES_SUCCESS or the validation error.
+ */
+static aes_error_t cbc_iov(const aes_ctx_t* ctx, int encrypt, uint8_t* iv, const aes_iovec_t* in, size_t in_count,
+                           const aes_iovec_t* out, size_t out_count, aes_iov_step_fn step)
+{
+    size_t length;
+
+    if ((encrypt ? !ctx_can_encrypt(ctx) : !ctx_can_decrypt(ctx)) || !iv)
+        return AES_ERROR_INVALID_ARGUMENT;
+    aes_error_t result = aes_iov_check(in, in_count, out, out_count, &length);
+    if (result != AES_SUCCESS)
+        return result;
+    if (length % AES_BLOCK_SIZE != 0)
+        return AES_ERROR_INVALID_LENGTH;
+
+    AES_STATS_BEGIN(start);
+    cbc_iov_t state = {ctx, iv};
+    aes_iov_process(in, out, length, step, &state);
+    AES_STATS_RECORD(AES_STATS_CBC, ctx->backend->id, length, start);
+    return AES_SUCCESS;
+}
+
+aes_error_t aes_cbc_encrypt_iov(const aes_ctx_t* ctx, uint8_t* iv, const aes_iovec_t* in, size_t in_count,
+                                const aes_iovec_t* out, size_t out_count)
+{
+    return cbc_iov(ctx, 1, iv, in, in_count, out, out_count, cbc_encrypt_step);
+}
+
+aes_error_t aes_cbc_decrypt_iov(const aes_ctx_t* ctx, uint8_t* iv, const aes_iovec_t* in, size_t in_count,
+                                const aes_iovec_t* out, size_t out_count)
+{
+    return cbc_iov(ctx, 0, iv, in, in_count, out, out_count, cbc_decrypt_step);
+}
+
+aes_error_t aes_cbc_encrypt_pkcs7(const aes_ctx_t* ctx, uint8_t* iv, const uint8_t* in, size_t length, uint8_t* out,
+                                  size_t out_size, size_t* out_length)
+{
+    if (!ctx_can_encrypt(ctx) || !iv || !out || !out_length || (length && !in))
+        return AES_ERROR_INVALID_ARGUMENT;
+
+    size_t whole = length / AES_BLOCK_SIZE;
+    size_t rest  = length % AES_BLOCK_SIZE;
+    if (out_size < (whole + 1) * AES_BLOCK_SIZE)
+        return AES_ERROR_INVALID_LENGTH;
+
+    AES_STATS_BEGIN(start);
+
+    // Read the tail before the whole blocks are written, in case out == in.
+    uint8_t last[AES_BLOCK_SIZE];
+    if (rest)
+        memcpy(last, in + whole * AES_BLOCK_SIZE, rest);
+    memset(last + rest, (int)(AES_BLOCK_SIZE - rest), AES_BLOCK_SIZE - rest);
+
+    cbc_encrypt_blocks(ctx, iv, in, out, whole);
+    cbc_encrypt_blocks(ctx, iv, last, out + whole * AES_BLOCK_SIZE, 1);
+    *out_length = (whole + 1) * AES_BLOCK_SIZE;
+
+    secure_zero_memory(last, sizeof(last));
+    AES_STATS_RECORD(AES_STATS_CBC, ctx->backend->id, *out_length, start);
+    return AES_SUCCESS;
+}
+
+aes_error_t aes_cbc_decrypt_pkcs7(const aes_ctx_t* ctx, uint8_t* iv, const uint8_t* in, size_t length, uint8_t* out,
+                                  size_t* out_length)
+{
+    if (!ctx_can_decrypt(ctx) || !iv || !in || !out || !out_length)
+        return AES_ERROR_INVALID_ARGUMENT;
+    if (length == 0 || length % AES_BLOCK_SIZE != 0)
+        return AES_ERROR_INVALID_LENGTH;
+
+    AES_STATS_BEGIN(start);
+    cbc_decrypt_blocks(ctx, iv, in, out, length / AES_BLOCK_SIZE);
+    AES_STATS_RECORD(AES_STATS_CBC, ctx->backend->id, length, start);
+
+    // Validate the padding without branching on the plaintext: bad becomes 1
+    // if the pad value is outside 1..16 or any covered byte differs from it.
+    const uint8_t* last = out + length - AES_BLOCK_SIZE;
+    uint32_t       pad  = last[AES_BLOCK_SIZE - 1];
+    uint32_t       bad  = ((pad - 1) >> 31) | (((uint32_t)AES_BLOCK_SIZE - pad) >> 31);
+    for (uint32_t i = 0; i < AES_BLOCK_SIZE; i++)
+    {
+        uint32_t covered = (i - pad) >> 31;
+        uint32_t differs = ((last[AES_BLOCK_SIZE - 1 - i] ^ pad) + 0xff) >> 8;
+        bad |= covered & differs;
+    }
+
+    if (bad)
+    {
+        secure_zero_memory(out, length);
+        return AES_ERROR_INVALID_PADDING;
+    }
+
+    *out_length = length - pad;
+    return AES_SUCCESS;
+}
@@ -0,0 +1,68 @@
+/**
+ * @file aes_cpu.c
+ * @brief Runtime detection of the CPU features used by the optimized backends.
+ */
+
+#include "aes_internal.h"
+#include <stdatomic.h>
+
+#ifdef AES_ARCH_X86
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+// Marks the cached feature mask as valid, so a CPU without any of the
+// features is not detected again on every call.
+#define AES_CPU_DETECTED (1U << 31)
+
+// CPUID leaf 1 ECX feature bits.
+#define CPUID_1_ECX_PCLMUL (1U << 1)
+#define CPUID_1_ECX_SSSE3  (1U << 9)
+#define CPUID_1_ECX_SSE41  (1U << 19)
+#define CPUID_1_ECX_AESNI  (1U << 25)
+
+static atomic_uint cached_features;
+
+/**
+ * @brief Queries CPUID leaf 1 and translates the relevant bits.
+ * @return A mask of AES_CPU_* bits.
+ */
+static unsigned detect_features(void)
+{
+    unsigned features = 0;
+#ifdef AES_ARCH_X86
+    unsigned ecx;
+#ifdef _MSC_VER
+    int regs[4];
+    __cpuid(regs, 1);
+    ecx = (unsigned)regs[2];
+#else
+    unsigned eax, ebx, edx;
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+        return 0;
+#endif
+    if (ecx & CPUID_1_ECX_SSSE3)
+        features |= AES_CPU_SSSE3;
+    if (ecx & CPUID_1_ECX_SSE41)
+        features |= AES_CPU_SSE41;
+    if (ecx & CPUID_1_ECX_AESNI)
+        features |= AES_CPU_AESNI;
+    if (ecx & CPUID_1_ECX_PCLMUL)
+        features |= AES_CPU_PCLMUL;
+#endif
+    return features;
+}
+
+unsigned aes_cpu_features(void)
+{
+    unsigned features = atomic_load_explicit(&cached_features, memory_order_relaxed);
+    if (!(features & AES_CPU_DETECTED))
+    {
+        features = detect_features() | AES_CPU_DETECTED;
+        atomic_store_explicit(&cached_features, features, memory_order_relaxed);
+    }
+    return features & ~AES_CPU_DETECTED;
+}
@@ -0,0 +1,127 @@
+/**
+ * @file aes_ctr.c
+ * @brief Counter (CTR) mode over the active block cipher backend.
+ *
+ * @details Backends with a fused CTR kernel (AES-NI) generate, encrypt and
+ * XOR counter blocks entirely in registers. For the others, keystream is
+ * produced AES_CTR_BATCH_BLOCKS counter blocks at a time through the backend's
+ * multi-block entry point, so every backend sees enough independent blocks to
+ * keep its pipeline or parallel lanes busy. The counter is the big-endian
+ * integer in the low 32, 64 or 128 bits of the counter block and wraps within
+ * that field.
+ */
+
+#include "aes_internal.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+/**
+ * @brief Writes consecutive counter blocks and advances the counter.
+ * @param[out] blocks Receives count counter blocks.
+ * @param[in,out] counter The next counter block; advanced by count.
+ * @param[in] width The width of the incrementing field.
+ * @param[in] count The number of blocks to write.
+ */
+static void fill_counter_blocks(uint8_t* blocks, uint8_t* counter, aes_ctr_width_t width, size_t count)
+{
+    uint64_t hi = load_be64(counter);
+    uint64_t lo = load_be64(counter + 8);
+
+    for (size_t i = 0; i < count; i++, blocks += AES_BLOCK_SIZE)
+    {
+        store_be64(blocks, hi);
+        store_be64(blocks + 8, lo);
+        ctr_increment(&hi, &lo, width);
+    }
+
+    store_be64(counter, hi);
+    store_be64(counter + 8, lo);
+}
+
+void aes_ctr_process(const aes_ctx_t* ctx, uint8_t* counter, aes_ctr_width_t width, const uint8_t* in, uint8_t* out,
+                     size_t length)
+{
+    uint8_t keystream[AES_CTR_BATCH_BLOCKS * AES_BLOCK_SIZE];
+
+    if (ctx->backend->ctr_blocks && length >= AES_BLOCK_SIZE)
+    {
+        size_t whole = length / AES_BLOCK_SIZE;
+        ctx->backend->ctr_blocks(ctx, counter, width, in, out, whole);
+        in += whole * AES_BLOCK_SIZE;
+        out += whole * AES_BLOCK_SIZE;
+        length -= whole * AES_BLOCK_SIZE;
+    }
+
+    while (length > 0)
+    {
+        size_t blocks = (length + AES_BLOCK_SIZE - 1) / AES_BLOCK_SIZE;
+        if (blocks > AES_CTR_BATCH_BLOCKS)
+            blocks = AES_CTR_BATCH_BLOCKS;
+
+        fill_counter_blocks(keystream, counter, width, blocks);
+        ctx->encrypt_blocks(ctx, keystream, keystream, blocks);
+
+        size_t chunk = blocks * AES_BLOCK_SIZE < length ? blocks * AES_BLOCK_SIZE : length;
+        xor_bytes(out, in, keystream, chunk);
+        in += chunk;
+        out += chunk;
+        length -= chunk;
+    }
+
+    secure_zero_memory(keystream, sizeof(keystream));
+}
+
+aes_error_t aes_ctr_xcrypt_ex(const aes_ctx_t* ctx, uint8_t* counter, aes_ctr_width_t width, const uint8_t* in,
+                              uint8_t* out, size_t length)
+{
+    if (!ctx_can_encrypt(ctx) || !counter || (length && (!in || !out)))
+        return AES_ERROR_INVALID_ARGUMENT;
+    if (width != AES_CTR_WIDTH_32 && width != AES_CTR_WIDTH_64 && width != AES_CTR_WIDTH_128)
+        return AES_ERROR_INVALID_ARGUMENT;
+
+    AES_STATS_BEGIN(start);
+    aes_ctr_process(ctx, counter, width, in, out, length);
+    AES_STATS_RECORD(AES_STATS_CTR, ctx->backend->id, length, start);
+    return AES_SUCCESS;
+}
+
+aes_error_t aes_ctr_xcrypt(const aes_ctx_t* ctx, uint8_t* iv, const uint8_t* in, uint8_t* out, size_t length)
+{
+    return aes_ctr_xcrypt_ex(ctx, iv, AES_CTR_WIDTH_128, in, out, length);
+}
+
+//! The state of a scatter-gather CTR operation.
+typedef struct
+{
+    const aes_ctx_t* ctx;     /**< The key schedule. */
+    uint8_t*         counter; /**< The caller's counter block, advanced as runs are processed. */
+    aes_ctr_width_t  width;   /**< The width of the incrementing counter field. */
+} ctr_iov_t;
+
+/** @brief aes_iov_step_fn: arg is a ctr_iov_t. */
+static void ctr_step(void* arg, const uint8_t* in, uint8_t* out, size_t length)
+{
+    ctr_iov_t* state = arg;
+    aes_ctr_process(state->ctx, state->counter, state->width, in, out, length);
+}
+
+aes_error_t aes_ctr_xcrypt_iov(const aes_ctx_t* ctx, uint8_t* counter, aes_ctr_width_t width, const aes_iovec_t* in,
+                               size_t in_count, const aes_iovec_t* out, size_t out_count)
+{
+    size_t length;
+
+    if (!ctx_can_encrypt(ctx) || !counter)
+        return AES_ERROR_INVALID_ARGUMENT;
+    if (width != AES_CTR_WIDTH_32 && width != AES_CTR_WIDTH_64 && width != AES_CTR_WIDTH_128)
+        return AES_ERROR_INVALID_ARGUMENT;
+    aes_error_t result = aes_iov_check(in, in_count, out, out_count, &length);
+    if (result != AES_SUCCESS)
+        return result;
+
+    AES_STATS_BEGIN(start);
+    ctr_iov_t state = {ctx, counter, width};
+    aes_iov_process(in, out, length, ctr_step, &state);
+    AES_STATS_RECORD(AES_STATS_CTR, ctx->backend->id, length, start);
+    return AES_SUCCESS;
+}
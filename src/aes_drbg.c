@@ -0,0 +1,301 @@
+/**
+ * @file aes_drbg.c
+ * @brief CTR_DRBG (NIST SP 800-90A, section 10.2) on AES-256.
+ *
+ * @details The state is an AES-256 key and a 128-bit counter V. A generate
+ * call is CTR keystream from V + 1, followed by an update that replaces the
+ * key and V with three more keystream blocks, so output already returned
+ * cannot be recomputed from the state left behind. No derivation function is
+ * used: the entropy source is required to deliver full entropy, and seed
+ * material is the entropy input XORed with the caller's input.
+ *
+ * Keystream comes from the same bulk CTR path as aes_ctr_xcrypt_ex(). To keep
+ * the per-call key expansion and update off the path of small requests, the
+ * context refills a buffer of AES_DRBG_BUFFER_SIZE bytes with one generate
+ * call and serves requests from it with a copy, wiping what it hands out.
+ */
+
+#include "aes_internal.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef AES_HAVE_PTHREADS
+#include <pthread.h>
+#endif
+
+// Generate calls between reseeds; SP 800-90A allows up to 2^48.
+#define DRBG_RESEED_INTERVAL (UINT64_C(1) << 20)
+
+/* ============================================================================
+ * SP 800-90A Functions
+ * ========================================================================= */
+
+/**
+ * @brief CTR_DRBG_Update: replaces the key and V with keystream XORed with provided data.
+ * @param[in,out] drbg The context.
+ * @param[in] provided AES_DRBG_SEED_SIZE bytes, or NULL for zeros.
+ */
+static void drbg_update(aes_drbg_ctx_t* drbg, const uint8_t* provided)
+{
+    uint8_t temp[AES_DRBG_SEED_SIZE] = {0};
+
+    aes_ctr_process(&drbg->cipher, drbg->counter, AES_CTR_WIDTH_128, temp, temp, sizeof(temp));
+    if (provided)
+        xor_bytes(temp, temp, provided, sizeof(temp));
+
+    // Re-expanding under the same backend cannot fail.
+    aes_ctx_init_ex(&drbg->cipher, temp, AES_KEY_SIZE_256, drbg->cipher.backend->id, AES_KEY_USAGE_ENCRYPT);
+    memcpy(drbg->counter, temp + AES_KEY_SIZE_256, AES_BLOCK_SIZE);
+    ctr_add(drbg->counter, AES_CTR_WIDTH_128, 1);
+
+    secure_zero_memory(temp, sizeof(temp));
+}
+
+/**
+ * @brief Mixes fresh entropy and optional input into the state (instantiate and reseed).
+ * @return AES_SUCCESS, or AES_ERROR_ENTROPY_FAILED if the source failed.
+ */
+static aes_error_t drbg_seed(aes_drbg_ctx_t* drbg, const uint8_t* input, size_t input_len)
+{
+    uint8_t seed[AES_DRBG_SEED_SIZE];
+
+    if (drbg->entropy(drbg->entropy_arg, seed, sizeof(seed)) != 0)
+    {
+        secure_zero_memory(seed, sizeof(seed));
+        return AES_ERROR_ENTROPY_FAILED;
+    }
+    if (input_len > 0)
+        xor_bytes(seed, seed, input, input_len);
+
+    drbg_update(drbg, seed);
+    drbg->reseed_counter = 1;
+
+    secure_zero_memory(seed, sizeof(seed));
+    return AES_SUCCESS;
+}
+
+/**
+ * @brief CTR_DRBG_Generate: one request of at most AES_DRBG_MAX_REQUEST bytes.
+ * @return AES_SUCCESS, or AES_ERROR_ENTROPY_FAILED if a due reseed failed.
+ */
+static aes_error_t drbg_generate(aes_drbg_ctx_t* drbg, const uint8_t* additional, size_t additional_len,
+                                 uint8_t* out, size_t length)
+{
+    uint8_t input[AES_DRBG_SEED_SIZE] = {0};
+
+    // A due reseed consumes the additional input.
+    if (drbg->reseed_counter > DRBG_RESEED_INTERVAL)
+    {
+        aes_error_t result = drbg_seed(drbg, additional, additional_len);
+        if (result != AES_SUCCESS)
+            return result;
+        additional_len = 0;
+    }
+    if (additional_len > 0)
+    {
+        memcpy(input, additional, additional_len);
+        drbg_update(drbg, input);
+    }
+
+    memset(out, 0, length);
+    aes_ctr_process(&drbg->cipher, drbg->counter, AES_CTR_WIDTH_128, out, out, length);
+    drbg_update(drbg, additional_len > 0 ? input : NULL);
+    drbg->reseed_counter++;
+
+    secure_zero_memory(input, sizeof(input));
+    return AES_SUCCESS;
+}
+
+/** @brief Copies length buffered bytes out and wipes them from the buffer. */
+static void drbg_take(aes_drbg_ctx_t* drbg, uint8_t* out, size_t length)
+{
+    uint8_t* start = drbg->buffer + AES_DRBG_BUFFER_SIZE - drbg->available;
+
+    memcpy(out, start, length);
+    secure_zero_memory(start, length);
+    drbg->available -= length;
+}
+
+/* ============================================================================
+ * Public Interface
+ * ========================================================================= */
+
+aes_error_t aes_drbg_init(aes_drbg_ctx_t* drbg, aes_drbg_entropy_fn entropy, void* entropy_arg,
+                          const uint8_t* personalization, size_t personalization_len, aes_backend_t backend)
+{
+    static const uint8_t zero_key[AES_KEY_SIZE_256] = {0};
+
+    if (!drbg || !entropy || (personalization_len && !personalization))
+        return AES_ERROR_INVALID_ARGUMENT;
+    if (personalization_len > AES_DRBG_SEED_SIZE)
+        return AES_ERROR_INVALID_LENGTH;
+
+    // Instantiate from Key = 0, V = 0.
+    aes_error_t result = aes_ctx_init_ex(&drbg->cipher, zero_key, AES_KEY_SIZE_256, backend, AES_KEY_USAGE_ENCRYPT);
+    if (result != AES_SUCCESS)
+        return result;
+    memset(drbg->counter, 0, sizeof(drbg->counter));
+    drbg->counter[AES_BLOCK_SIZE - 1] = 1;
+    drbg->entropy     = entropy;
+    drbg->entropy_arg = entropy_arg;
+    drbg->available   = 0;
+
+    result = drbg_seed(drbg, personalization, personalization_len);
+    if (result != AES_SUCCESS)
+        aes_drbg_clear(drbg);
+    return result;
+}
+
+aes_error_t aes_drbg_reseed(aes_drbg_ctx_t* drbg, const uint8_t* additional, size_t additional_len)
+{
+    if (!drbg || !drbg->cipher.backend || (additional_len && !additional))
+        return AES_ERROR_INVALID_ARGUMENT;
+    if (additional_len > AES_DRBG_SEED_SIZE)
+        return AES_ERROR_INVALID_LENGTH;
+
+    secure_zero_memory(drbg->buffer, sizeof(drbg->buffer));
+    drbg->available = 0;
+    return drbg_seed(drbg, additional, additional_len);
+}
+
+aes_error_t aes_drbg_generate(aes_drbg_ctx_t* drbg, uint8_t* out, size_t length)
+{
+    if (!drbg || !drbg->cipher.backend || (length && !out))
+        return AES_ERROR_INVALID_ARGUMENT;
+
+    uint8_t*    first  = out;
+    size_t      total  = length;
+    aes_error_t result = AES_SUCCESS;
+
+    AES_STATS_BEGIN(start);
+
+    size_t take = drbg->available < length ? drbg->available : length;
+    drbg_take(drbg, out, take);
+    out += take;
+    length -= take;
+
+    // Large requests skip the buffer.
+    while (result == AES_SUCCESS && length >= AES_DRBG_BUFFER_SIZE)
+    {
+        size_t n = length < AES_DRBG_MAX_REQUEST ? length : AES_DRBG_MAX_REQUEST;
+        result   = drbg_generate(drbg, NULL, 0, out, n);
+        out += n;
+        length -= n;
+    }
+
+    if (result == AES_SUCCESS && length > 0)
+    {
+        result = drbg_generate(drbg, NULL, 0, drbg->buffer, AES_DRBG_BUFFER_SIZE);
+        if (result == AES_SUCCESS)
+        {
+            drbg->available = AES_DRBG_BUFFER_SIZE;
+            drbg_take(drbg, out, length);
+        }
+    }
+
+    if (result == AES_SUCCESS)
+        AES_STATS_RECORD(AES_STATS_DRBG, drbg->cipher.backend->id, total, start);
+    else
+        secure_zero_memory(first, total);
+    return result;
+}
+
+aes_error_t aes_drbg_generate_direct(aes_drbg_ctx_t* drbg, const uint8_t* additional, size_t additional_len,
+                                     uint8_t* out, size_t length)
+{
+    if (!drbg || !drbg->cipher.backend || (additional_len && !additional) || (length && !out))
+        return AES_ERROR_INVALID_ARGUMENT;
+    if (additional_len > AES_DRBG_SEED_SIZE || length > AES_DRBG_MAX_REQUEST)
+        return AES_ERROR_INVALID_LENGTH;
+
+    AES_STATS_BEGIN(start);
+    aes_error_t result = drbg_generate(drbg, additional, additional_len, out, length);
+    if (result == AES_SUCCESS)
+        AES_STATS_RECORD(AES_STATS_DRBG, drbg->cipher.backend->id, length, start);
+    else
+        secure_zero_memory(out, length);
+    return result;
+}
+
+void aes_drbg_clear(aes_drbg_ctx_t* drbg)
+{
+    secure_zero_memory(drbg, drbg ? sizeof(*drbg) : 0);
+}
+
+/* ============================================================================
+ * Per-Thread Instances
+ * ========================================================================= */
+
+//! The calling thread's instance, created on its first request.
+static _Thread_local aes_drbg_ctx_t* thread_drbg;
+
+/**
+ * @brief Wipes and frees the calling thread's instance.
+ * @details Also the thread_key destructor, which runs on the exiting thread;
+ * thread_drbg is reset so a later request from another destructor on that
+ * thread creates a new instance instead of using the freed one.
+ */
+static void thread_drbg_destroy(void* drbg)
+{
+    aes_drbg_clear(drbg);
+    free(drbg);
+    thread_drbg = NULL;
+}
+
+#ifdef AES_HAVE_PTHREADS
+//! Runs thread_drbg_destroy() on the instance of each exiting thread.
+static pthread_key_t  thread_key;
+static pthread_once_t thread_key_once = PTHREAD_ONCE_INIT;
+static int            thread_key_ready;
+
+/** @brief Creates thread_key, once per process. */
+static void thread_key_create(void)
+{
+    thread_key_ready = pthread_key_create(&thread_key, thread_drbg_destroy) == 0;
+}
+#endif
+
+aes_error_t aes_drbg_thread_generate(aes_drbg_entropy_fn entropy, void* entropy_arg, uint8_t* out, size_t length)
+{
+    if (!thread_drbg)
+    {
+        if (!entropy)
+            return AES_ERROR_INVALID_ARGUMENT;
+
+        aes_drbg_ctx_t* drbg = malloc(sizeof(*drbg));
+        if (!drbg)
+        {
+            AES_STATS_ALLOCATION_FAILED();
+            return AES_ERROR_MEMORY_ALLOCATION_FAILED;
+        }
+        aes_error_t result = aes_drbg_init(drbg, entropy, entropy_arg, NULL, 0, AES_BACKEND_AUTO);
+        if (result != AES_SUCCESS)
+        {
+            free(drbg);
+            return result;
+        }
+
+#ifdef AES_HAVE_PTHREADS
+        pthread_once(&thread_key_once, thread_key_create);
+        if (thread_key_ready)
+            pthread_setspecific(thread_key, drbg);
+#endif
+        thread_drbg = drbg;
+    }
+
+    return aes_drbg_generate(thread_drbg, out, length);
+}
+
+void aes_drbg_thread_clear(void)
+{
+    if (!thread_drbg)
+        return;
+
+#ifdef AES_HAVE_PTHREADS
+    if (thread_key_ready)
+        pthread_setspecific(thread_key, NULL);
+#endif
+    thread_drbg_destroy(thread_drbg);
+}
@@ -0,0 +1,677 @@
+/**
+ * @file aes_engine.c
+ * @brief Multi-threaded engine for the parallelizable modes.
+ *
+ * @details An engine owns a persistent pool of num_threads - 1 worker threads
+ * that sleep on a condition variable between operations. An operation is
+ * described by a job: the input is cut into chunk_size pieces, and the
+ * workers and the submitting thread claim chunk indices from an atomic
+ * counter until every chunk is done, so faster threads simply take more
+ * chunks. Each chunk is processed by the ordinary single-threaded mode
+ * function, starting from state derived from the chunk index alone: the CTR
+ * counter is advanced by the chunk's block offset, CBC decryption starts from
+ * the preceding ciphertext block (captured before the workers start, for
+ * in-place buffers), XTS chunks are whole runs of sectors, and PMAC chunks
+ * sum their blocks into a partial sum of their own that the caller XORs
+ * together once every chunk is done. Other modules can also hand the pool a
+ * callback per index (aes_engine_for_each()), as archives do per chunk.
+ */
+
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE // pthread_setaffinity_np()
+#endif
+
+#include "aes_internal.h"
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef AES_HAVE_PTHREADS
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#endif
+
+// Default chunk size: large enough to amortize the claim, small enough to stay in L2.
+#define ENGINE_DEFAULT_CHUNK_SIZE (128 * 1024)
+
+// Default size below which an operation stays on the calling thread.
+#define ENGINE_DEFAULT_MIN_PARALLEL_SIZE (1024 * 1024)
+
+// Upper bound on the thread count.
+#define ENGINE_MAX_THREADS 256
+
+//! The operations an engine can split across threads.
+typedef enum
+{
+    ENGINE_OP_ECB_ENCRYPT,
+    ENGINE_OP_ECB_DECRYPT,
+    ENGINE_OP_CTR,
+    ENGINE_OP_CBC_DECRYPT,
+    ENGINE_OP_XTS_ENCRYPT,
+    ENGINE_OP_XTS_DECRYPT,
+    ENGINE_OP_PMAC,
+    ENGINE_OP_TASK,
+} engine_op_t;
+
+//! One operation, shared read-only by every thread except for next_chunk.
+typedef struct
+{
+    engine_op_t           op;
+    const aes_ctx_t*      ctx;         /**< The cipher context for ECB, CTR, CBC and PMAC. */
+    const aes_xts_ctx_t*  xts;         /**< The context for XTS. */
+    const aes_pmac_ctx_t* pmac;        /**< The context for PMAC, for its offsets. */
+    const uint8_t*        in;          /**< The whole input. */
+    uint8_t*              out;         /**< The whole output; NULL for PMAC. */
+    size_t                length;      /**< The total number of bytes. */
+    size_t                chunk_size;  /**< Bytes per chunk; the last chunk may be shorter. */
+    size_t                num_chunks;  /**< The number of chunks. */
+    atomic_size_t         next_chunk;  /**< The next unclaimed chunk index. */
+    uint8_t               counter[AES_BLOCK_SIZE]; /**< CTR: the counter of the first block. */
+    aes_ctr_width_t       width;       /**< CTR: the counter field width. */
+    const uint8_t*        chain;       /**< CBC: the chaining block of every chunk. */
+    uint64_t              sector;      /**< XTS: the first sector number. */
+    size_t                sector_size; /**< XTS: the sector size. */
+    uint64_t              first_block; /**< PMAC: the message index of the first block, from 1. */
+    uint8_t*              sums;        /**< PMAC: the partial sum of every chunk. */
+    aes_engine_task_fn    task;        /**< TASK: called once per index; chunks are indices. */
+    void*                 task_arg;    /**< TASK: passed through to task. */
+} engine_job_t;
+
+struct aes_engine
+{
+    unsigned num_threads;       /**< Threads per operation, including the caller. */
+    size_t   chunk_size;        /**< Bytes per work item. */
+    size_t   min_parallel_size; /**< Smaller operations run on the caller alone. */
+    uint8_t* scratch;           /**< One block per chunk: CBC chaining blocks or PMAC partial sums. */
+    size_t   scratch_capacity;  /**< Capacity of scratch in blocks. */
+    engine_job_t job;           /**< The operation in progress. */
+#ifdef AES_HAVE_PTHREADS
+    pthread_mutex_t submit_lock;     /**< Serializes operations from concurrent callers. */
+    pthread_mutex_t lock;            /**< Protects the fields below. */
+    pthread_cond_t  wake;            /**< Signals a new generation or shutdown to workers. */
+    pthread_cond_t  idle;            /**< Signals the caller that all workers finished. */
+    uint64_t        generation;      /**< Incremented for every parallel operation. */
+    unsigned        busy_workers;    /**< Workers still processing the current generation. */
+    int             shutdown;        /**< Set by aes_engine_destroy(). */
+    unsigned        started_workers; /**< Worker threads successfully created. */
+    pthread_t*      threads;         /**< The worker threads. */
+    int*            affinity;        /**< The CPU of each worker, or -1. */
+#endif
+};
+
+/**
+ * @brief Processes one chunk of a job.
+ * @param[in] job The job.
+ * @param[in] ctx The caller's or the worker's copy of the cipher context.
+ * @param[in] xts The caller's or the worker's copy of the XTS context.
+ * @param[in] index The chunk index.
+ */
+static void process_chunk(const engine_job_t* job, const aes_ctx_t* ctx, const aes_xts_ctx_t* xts, size_t index)
+{
+    size_t         offset = index * job->chunk_size;
+    size_t         length = job->length - offset < job->chunk_size ? job->length - offset : job->chunk_size;
+    const uint8_t* in     = job->in + offset;
+    uint8_t*       out    = job->out ? job->out + offset : NULL;
+    uint8_t        block[AES_BLOCK_SIZE];
+
+    // CBC and XTS chunks go through public functions, which count themselves.
+    AES_STATS_BEGIN(start);
+    switch (job->op)
+    {
+        case ENGINE_OP_ECB_ENCRYPT:
+            ctx->encrypt_blocks(ctx, in, out, length / AES_BLOCK_SIZE);
+            AES_STATS_RECORD(AES_STATS_ECB, ctx->backend->id, length, start);
+            break;
+        case ENGINE_OP_ECB_DECRYPT:
+            ctx->decrypt_blocks(ctx, in, out, length / AES_BLOCK_SIZE);
+            AES_STATS_RECORD(AES_STATS_ECB, ctx->backend->id, length, start);
+            break;
+        case ENGINE_OP_CTR:
+            memcpy(block, job->counter, sizeof(block));
+            ctr_add(block, job->width, offset / AES_BLOCK_SIZE);
+            aes_ctr_process(ctx, block, job->width, in, out, length);
+            AES_STATS_RECORD(AES_STATS_CTR, ctx->backend->id, length, start);
+            break;
+        case ENGINE_OP_CBC_DECRYPT:
+            memcpy(block, job->chain + index * AES_BLOCK_SIZE, sizeof(block));
+            aes_cbc_decrypt(ctx, block, in, out, length);
+            break;
+        case ENGINE_OP_XTS_ENCRYPT:
+            aes_xts_encrypt_sectors(xts, job->sector + offset / job->sector_size, job->sector_size, in, out,
+                                    length / job->sector_size);
+            break;
+        case ENGINE_OP_XTS_DECRYPT:
+            aes_xts_decrypt_sectors(xts, job->sector + offset / job->sector_size, job->sector_size, in, out,
+                                    length / job->sector_size);
+            break;
+        case ENGINE_OP_PMAC:
+            aes_pmac_sum_blocks(job->pmac, ctx, job->first_block + offset / AES_BLOCK_SIZE, in,
+                                length / AES_BLOCK_SIZE, job->sums + index * AES_BLOCK_SIZE);
+            break;
+        case ENGINE_OP_TASK:
+            // Dispatched by run_chunks() before any chunk arithmetic.
+            break;
+    }
+
+    secure_zero_memory(block, sizeof(block));
+}
+
+/**
+ * @brief Claims and processes chunks until none are left.
+ * @param[in,out] job The job.
+ * @param[in] ctx The cipher context to use.
+ * @param[in] xts The XTS context to use.
+ */
+static void run_chunks(engine_job_t* job, const aes_ctx_t* ctx, const aes_xts_ctx_t* xts)
+{
+    size_t index;
+    while ((index = atomic_fetch_add_explicit(&job->next_chunk, 1, memory_order_relaxed)) < job->num_chunks)
+    {
+        if (job->op == ENGINE_OP_TASK)
+            job->task(job->task_arg, index);
+        else
+            process_chunk(job, ctx, xts, index);
+    }
+}
+
+#ifdef AES_HAVE_PTHREADS
+
+//! Per-worker start arguments.
+typedef struct
+{
+    aes_engine_t* engine;
+    unsigned      index;
+} engine_worker_arg_t;
+
+/**
+ * @brief Applies a worker's affinity hint, ignoring failures.
+ * @param[in] cpu The CPU to run on, or a negative value for no pinning.
+ */
+static void apply_affinity(int cpu)
+{
+#ifdef __linux__
+    if (cpu >= 0 && cpu < CPU_SETSIZE)
+    {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET((size_t)cpu, &set);
+        pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    }
+#else
+    (void)cpu;
+#endif
+}
+
+/**
+ * @brief The worker thread loop: wait for a generation, work it, report idle.
+ * @param[in] arg An engine_worker_arg_t, freed by the worker.
+ * @return NULL.
+ */
+static void* worker_main(void* arg)
+{
+    engine_worker_arg_t start  = *(engine_worker_arg_t*)arg;
+    aes_engine_t*       engine = start.engine;
+    uint64_t            seen   = 0;
+    aes_ctx_t           ctx;
+    aes_xts_ctx_t       xts;
+
+    free(arg);
+    apply_affinity(engine->affinity[start.index]);
+
+    for (;;)
+    {
+        pthread_mutex_lock(&engine->lock);
+        while (!engine->shutdown && engine->generation == seen)
+            pthread_cond_wait(&engine->wake, &engine->lock);
+        if (engine->shutdown)
+        {
+            pthread_mutex_unlock(&engine->lock);
+            break;
+        }
+        seen = engine->generation;
+        pthread_mutex_unlock(&engine->lock);
+
+        // Work from a private copy of the key schedule.
+        engine_job_t* job = &engine->job;
+        if (job->ctx)
+            memcpy(&ctx, job->ctx, sizeof(ctx));
+        if (job->xts)
+            memcpy(&xts, job->xts, sizeof(xts));
+        run_chunks(job, &ctx, &xts);
+
+        pthread_mutex_lock(&engine->lock);
+        if (--engine->busy_workers == 0)
+            pthread_cond_signal(&engine->idle);
+        pthread_mutex_unlock(&engine->lock);
+    }
+
+    secure_zero_memory(&ctx, sizeof(ctx));
+    secure_zero_memory(&xts, sizeof(xts));
+    return NULL;
+}
+
+/**
+ * @brief Runs the prepared job on the workers and the calling thread.
+ * @param[in,out] engine The engine, with submit_lock held.
+ */
+static void run_parallel(aes_engine_t* engine)
+{
+    pthread_mutex_lock(&engine->lock);
+    engine->generation++;
+    engine->busy_workers = engine->started_workers;
+    pthread_cond_broadcast(&engine->wake);
+    pthread_mutex_unlock(&engine->lock);
+
+    run_chunks(&engine->job, engine->job.ctx, engine->job.xts);
+
+    pthread_mutex_lock(&engine->lock);
+    while (engine->busy_workers > 0)
+        pthread_cond_wait(&engine->idle, &engine->lock);
+    pthread_mutex_unlock(&engine->lock);
+}
+
+#endif // AES_HAVE_PTHREADS
+
+/**
+ * @brief Makes room for one block per chunk in the engine's scratch buffer.
+ * @param[in,out] engine The engine, with submit_lock held.
+ * @param[in] num_blocks The number of blocks needed.
+ * @return AES_SUCCESS, or AES_ERROR_MEMORY_ALLOCATION_FAILED.
+ */
+static aes_error_t reserve_scratch(aes_engine_t* engine, size_t num_blocks)
+{
+    if (engine->scratch_capacity < num_blocks)
+    {
+        uint8_t* scratch = realloc(engine->scratch, num_blocks * AES_BLOCK_SIZE);
+        if (!scratch)
+        {
+            AES_STATS_ALLOCATION_FAILED();
+            return AES_ERROR_MEMORY_ALLOCATION_FAILED;
+        }
+        engine->scratch          = scratch;
+        engine->scratch_capacity = num_blocks;
+    }
+    return AES_SUCCESS;
+}
+
+/**
+ * @brief Splits the prepared job into chunks and runs it.
+ * @details Jobs below the size threshold, or on a single-threaded engine, run
+ * as one chunk on the calling thread.
+ * @param[in,out] engine The engine, with submit_lock held.
+ * @param[in] granule The unit chunks are rounded to (a block or a sector).
+ * @return AES_SUCCESS, or AES_ERROR_MEMORY_ALLOCATION_FAILED.
+ */
+static aes_error_t run_job(aes_engine_t* engine, size_t granule)
+{
+    engine_job_t* job      = &engine->job;
+    int           parallel = engine->num_threads > 1 && job->length >= engine->min_parallel_size;
+
+    job->chunk_size = parallel ? engine->chunk_size / granule * granule : job->length;
+    if (job->chunk_size < granule)
+        job->chunk_size = granule;
+    job->num_chunks = job->length ? (job->length + job->chunk_size - 1) / job->chunk_size : 0;
+    atomic_store_explicit(&job->next_chunk, 0, memory_order_relaxed);
+
+    if (job->op == ENGINE_OP_CBC_DECRYPT && job->num_chunks > 1)
+    {
+        // Every chunk after the first chains from the ciphertext block before
+        // it, which an in-place neighbour may overwrite: copy them all first.
+        if (reserve_scratch(engine, job->num_chunks) != AES_SUCCESS)
+            return AES_ERROR_MEMORY_ALLOCATION_FAILED;
+        memcpy(engine->scratch, job->chain, AES_BLOCK_SIZE);
+        for (size_t i = 1; i < job->num_chunks; i++)
+            memcpy(engine->scratch + i * AES_BLOCK_SIZE, job->in + i * job->chunk_size - AES_BLOCK_SIZE,
+                   AES_BLOCK_SIZE);
+        job->chain = engine->scratch;
+    }
+
+    if (job->op == ENGINE_OP_PMAC)
+    {
+        // Each chunk sums into a block of its own; the caller combines them.
+        if (reserve_scratch(engine, job->num_chunks) != AES_SUCCESS)
+            return AES_ERROR_MEMORY_ALLOCATION_FAILED;
+        memset(engine->scratch, 0, job->num_chunks * AES_BLOCK_SIZE);
+        job->sums = engine->scratch;
+    }
+
+#ifdef AES_HAVE_PTHREADS
+    if (job->num_chunks > 1)
+    {
+        run_parallel(engine);
+        return AES_SUCCESS;
+    }
+#endif
+
+    run_chunks(job, job->ctx, job->xts);
+    return AES_SUCCESS;
+}
+
+/**
+ * @brief Locks the engine and resets its job description.
+ * @param[in,out] engine The engine.
+ * @param[in] op The operation.
+ * @return The job to fill in.
+ */
+static engine_job_t* begin_job(aes_engine_t* engine, engine_op_t op)
+{
+#ifdef AES_HAVE_PTHREADS
+    pthread_mutex_lock(&engine->submit_lock);
+#endif
+    engine_job_t* job = &engine->job;
+    job->op           = op;
+    job->ctx          = NULL;
+    job->xts          = NULL;
+    job->pmac         = NULL;
+    job->out          = NULL;
+    job->chain        = NULL;
+    job->sums         = NULL;
+    job->task         = NULL;
+    return job;
+}
+
+/**
+ * @brief Unlocks the engine after a job.
+ * @param[in,out] engine The engine.
+ */
+static void end_job(aes_engine_t* engine)
+{
+#ifdef AES_HAVE_PTHREADS
+    pthread_mutex_unlock(&engine->submit_lock);
+#else
+    (void)engine;
+#endif
+}
+
+aes_error_t aes_engine_create(aes_engine_t** engine_out, const aes_engine_config_t* config)
+{
+    static const aes_engine_config_t defaults = {0, 0, 0, NULL};
+
+    if (!engine_out)
+        return AES_ERROR_INVALID_ARGUMENT;
+    *engine_out = NULL;
+    if (!config)
+        config = &defaults;
+    if (config->num_threads > ENGINE_MAX_THREADS || config->chunk_size % AES_BLOCK_SIZE != 0)
+        return AES_ERROR_INVALID_ARGUMENT;
+
+    aes_engine_t* engine = calloc(1, sizeof(*engine));
+    if (!engine)
+    {
+        AES_STATS_ALLOCATION_FAILED();
+        return AES_ERROR_MEMORY_ALLOCATION_FAILED;
+    }
+
+    engine->chunk_size        = config->chunk_size ? config->chunk_size : ENGINE_DEFAULT_CHUNK_SIZE;
+    engine->min_parallel_size = config->min_parallel_size ? config->min_parallel_size
+                                                          : ENGINE_DEFAULT_MIN_PARALLEL_SIZE;
+    engine->num_threads       = 1;
+
+#ifdef AES_HAVE_PTHREADS
+    unsigned num_threads = config->num_threads;
+    if (num_threads == 0)
+    {
+        long online = sysconf(_SC_NPROCESSORS_ONLN);
+        num_threads = online > 0 ? (unsigned)(online < ENGINE_MAX_THREADS ? online : ENGINE_MAX_THREADS) : 1;
+    }
+
+    pthread_mutex_init(&engine->submit_lock, NULL);
+    pthread_mutex_init(&engine->lock, NULL);
+    pthread_cond_init(&engine->wake, NULL);
+    pthread_cond_init(&engine->idle, NULL);
+
+    unsigned num_workers = num_threads - 1;
+    if (num_workers > 0)
+    {
+        engine->threads  = calloc(num_workers, sizeof(*engine->threads));
+        engine->affinity = calloc(num_workers, sizeof(*engine->affinity));
+        if (!engine->threads || !engine->affinity)
+        {
+            aes_engine_destroy(engine);
+            AES_STATS_ALLOCATION_FAILED();
+            return AES_ERROR_MEMORY_ALLOCATION_FAILED;
+        }
+    }
+
+    for (unsigned i = 0; i < num_workers; i++)
+    {
+        engine->affinity[i]      = config->cpu_affinity ? config->cpu_affinity[i] : -1;
+        engine_worker_arg_t* arg = malloc(sizeof(*arg));
+        if (!arg)
+        {
+            aes_engine_destroy(engine);
+            AES_STATS_ALLOCATION_FAILED();
+            return AES_ERROR_MEMORY_ALLOCATION_FAILED;
+        }
+        arg->engine = engine;
+        arg->index  = i;
+        if (pthread_create(&engine->threads[i], NULL, worker_main, arg) != 0)
+        {
+            free(arg);
+            aes_engine_destroy(engine);
+            AES_STATS_ALLOCATION_FAILED();
+            return AES_ERROR_MEMORY_ALLOCATION_FAILED;
+        }
+        engine->started_workers++;
+    }
+    engine->num_threads = num_threads;
+#endif
+
+    *engine_out = engine;
+    return AES_SUCCESS;
+}
+
+void aes_engine_destroy(aes_engine_t* engine)
+{
+    if (!engine)
+        return;
+
+#ifdef AES_HAVE_PTHREADS
+    pthread_mutex_lock(&engine->lock);
+    engine->shutdown = 1;
+    pthread_cond_broadcast(&engine->wake);
+    pthread_mutex_unlock(&engine->lock);
+
+    for (unsigned i = 0; i < engine->started_workers; i++)
+        pthread_join(engine->threads[i], NULL);
+
+    pthread_cond_destroy(&engine->idle);
+    pthread_cond_destroy(&engine->wake);
+    pthread_mutex_destroy(&engine->lock);
+    pthread_mutex_destroy(&engine->submit_lock);
+    free(engine->threads);
+    free(engine->affinity);
+#endif
+
+    secure_zero_memory(engine->scratch, engine->scratch_capacity * AES_BLOCK_SIZE);
+    free(engine->scratch);
+    free(engine);
+}
+
+unsigned aes_engine_num_threads(const aes_engine_t* engine)
+{
+    return engine ? engine->num_threads : 0;
+}
+
+/**
+ * @brief Shared implementation of the ECB entry points.
+ * @return AES_SUCCESS, or an error for invalid arguments.
+ */
+static aes_error_t engine_ecb(aes_engine_t* engine, engine_op_t op, const aes_ctx_t* ctx, const uint8_t* in,
+                              uint8_t* out, size_t length)
+{
+    if (!engine || (op == ENGINE_OP_ECB_ENCRYPT ? !ctx_can_encrypt(ctx) : !ctx_can_decrypt(ctx)) ||
+        (length && (!in || !out)))
+        return AES_ERROR_INVALID_ARGUMENT;
+    if (length % AES_BLOCK_SIZE != 0)
+        return AES_ERROR_INVALID_LENGTH;
+
+    engine_job_t* job = begin_job(engine, op);
+    job->ctx          = ctx;
+    job->in           = in;
+    job->out          = out;
+    job->length       = length;
+    aes_error_t result = run_job(engine, AES_BLOCK_SIZE);
+    end_job(engine);
+    return result;
+}
+
+aes_error_t aes_engine_ecb_encrypt(aes_engine_t* engine, const aes_ctx_t* ctx, const uint8_t* in, uint8_t* out,
+                                   size_t length)
+{
+    return engine_ecb(engine, ENGINE_OP_ECB_ENCRYPT, ctx, in, out, length);
+}
+
+aes_error_t aes_engine_ecb_decrypt(aes_engine_t* engine, const aes_ctx_t* ctx, const uint8_t* in, uint8_t* out,
+                                   size_t length)
+{
+    return engine_ecb(engine, ENGINE_OP_ECB_DECRYPT, ctx, in, out, length);
+}
+
+aes_error_t aes_engine_ctr_xcrypt(aes_engine_t* engine, const aes_ctx_t* ctx, uint8_t* counter, aes_ctr_width_t width,
+                                  const uint8_t* in, uint8_t* out, size_t length)
+{
+    if (!engine || !ctx_can_encrypt(ctx) || !counter || (length && (!in || !out)))
+        return AES_ERROR_INVALID_ARGUMENT;
+    if (width != AES_CTR_WIDTH_32 && width != AES_CTR_WIDTH_64 && width != AES_CTR_WIDTH_128)
+        return AES_ERROR_INVALID_ARGUMENT;
+
+    engine_job_t* job = begin_job(engine, ENGINE_OP_CTR);
+    job->ctx          = ctx;
+    job->in           = in;
+    job->out          = out;
+    job->length       = length;
+    job->width        = width;
+    memcpy(job->counter, counter, AES_BLOCK_SIZE);
+    aes_error_t result = run_job(engine, AES_BLOCK_SIZE);
+    end_job(engine);
+
+    // Like aes_ctr_xcrypt_ex(), a trailing partial block consumes a counter.
+    if (result == AES_SUCCESS)
+        ctr_add(counter, width, (length + AES_BLOCK_SIZE - 1) / AES_BLOCK_SIZE);
+    return result;
+}
+
+aes_error_t aes_engine_cbc_decrypt(aes_engine_t* engine, const aes_ctx_t* ctx, uint8_t* iv, const uint8_t* in,
+                                   uint8_t* out, size_t length)
+{
+    if (!engine || !ctx_can_decrypt(ctx) || !iv || (length && (!in || !out)))
+        return AES_ERROR_INVALID_ARGUMENT;
+    if (length % AES_BLOCK_SIZE != 0)
+        return AES_ERROR_INVALID_LENGTH;
+    if (length == 0)
+        return AES_SUCCESS;
+
+    uint8_t next_iv[AES_BLOCK_SIZE];
+    memcpy(next_iv, in + length - AES_BLOCK_SIZE, sizeof(next_iv));
+
+    engine_job_t* job = begin_job(engine, ENGINE_OP_CBC_DECRYPT);
+    job->ctx          = ctx;
+    job->in           = in;
+    job->out          = out;
+    job->length       = length;
+    job->chain        = iv;
+    aes_error_t result = run_job(engine, AES_BLOCK_SIZE);
+    end_job(engine);
+
+    if (result == AES_SUCCESS)
+        memcpy(iv, next_iv, sizeof(next_iv));
+    return result;
+}
+
+/**
+ * @brief Shared implementation of the XTS entry points.
+ * @return AES_SUCCESS, or an error for invalid arguments.
+ */
+static aes_error_t engine_xts(aes_engine_t* engine, engine_op_t op, const aes_xts_ctx_t* xts, uint64_t sector,
+                              size_t sector_size, const uint8_t* in, uint8_t* out, size_t num_sectors)
+{
+    if (!engine || !xts || !xts->data.backend || !xts->tweak.backend || (num_sectors && (!in || !out)))
+        return AES_ERROR_INVALID_ARGUMENT;
+    if (sector_size < AES_BLOCK_SIZE || (num_sectors && sector_size > SIZE_MAX / num_sectors))
+        return AES_ERROR_INVALID_LENGTH;
+
+    engine_job_t* job = begin_job(engine, op);
+    job->xts          = xts;
+    job->in           = in;
+    job->out          = out;
+    job->length       = num_sectors * sector_size;
+    job->sector       = sector;
+    job->sector_size  = sector_size;
+    aes_error_t result = run_job(engine, sector_size);
+    end_job(engine);
+    return result;
+}
+
+aes_error_t aes_engine_xts_encrypt_sectors(aes_engine_t* engine, const aes_xts_ctx_t* xts, uint64_t sector,
+                                           size_t sector_size, const uint8_t* in, uint8_t* out, size_t num_sectors)
+{
+    return engine_xts(engine, ENGINE_OP_XTS_ENCRYPT, xts, sector, sector_size, in, out, num_sectors);
+}
+
+aes_error_t aes_engine_xts_decrypt_sectors(aes_engine_t* engine, const aes_xts_ctx_t* xts, uint64_t sector,
+                                           size_t sector_size, const uint8_t* in, uint8_t* out, size_t num_sectors)
+{
+    return engine_xts(engine, ENGINE_OP_XTS_DECRYPT, xts, sector, sector_size, in, out, num_sectors);
+}
+
+/**
+ * @brief aes_pmac_sum_fn that splits the blocks across the engine's threads.
+ * @details If the partial sums cannot be allocated, the blocks are summed on
+ * the calling thread instead, so the update itself cannot fail.
+ */
+static void engine_pmac_sum(const aes_pmac_ctx_t* pmac, uint64_t first, const uint8_t* data, size_t num_blocks,
+                            uint8_t* sum, void* arg)
+{
+    aes_engine_t* engine = arg;
+    engine_job_t* job    = begin_job(engine, ENGINE_OP_PMAC);
+    job->ctx             = &pmac->cipher;
+    job->pmac            = pmac;
+    job->in              = data;
+    job->length          = num_blocks * AES_BLOCK_SIZE;
+    job->first_block     = first;
+    aes_error_t result   = run_job(engine, AES_BLOCK_SIZE);
+    for (size_t i = 0; result == AES_SUCCESS && i < job->num_chunks; i++)
+        xor_bytes(sum, sum, job->sums + i * AES_BLOCK_SIZE, AES_BLOCK_SIZE);
+    end_job(engine);
+
+    if (result != AES_SUCCESS)
+        aes_pmac_sum_blocks(pmac, &pmac->cipher, first, data, num_blocks, sum);
+}
+
+aes_error_t aes_engine_pmac_update(aes_engine_t* engine, aes_pmac_ctx_t* pmac, const uint8_t* data, size_t length)
+{
+    if (!engine || !pmac || !pmac->cipher.backend || (length && !data))
+        return AES_ERROR_INVALID_ARGUMENT;
+
+    AES_STATS_BEGIN(start);
+    aes_pmac_absorb(pmac, data, length, engine_pmac_sum, engine);
+    AES_STATS_RECORD(AES_STATS_MAC, pmac->cipher.backend->id, length, start);
+    return AES_SUCCESS;
+}
+
+void aes_engine_for_each(aes_engine_t* engine, size_t count, size_t bytes, aes_engine_task_fn task, void* arg)
+{
+#ifdef AES_HAVE_PTHREADS
+    if (engine && engine->num_threads > 1 && count > 1 && bytes >= engine->min_parallel_size)
+    {
+        engine_job_t* job = begin_job(engine, ENGINE_OP_TASK);
+        job->task         = task;
+        job->task_arg     = arg;
+        job->num_chunks   = count;
+        atomic_store_explicit(&job->next_chunk, 0, memory_order_relaxed);
+        run_parallel(engine);
+        end_job(engine);
+        return;
+    }
+#else
+    (void)engine;
+    (void)bytes;
+#endif
+
+    for (size_t i = 0; i < count; i++)
+        task(arg, i);
+}
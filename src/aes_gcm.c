@@ -0,0 +1,396 @@
+/**
+ * @file aes_gcm.c
+ * @brief Galois/Counter Mode (NIST SP 800-38D) authenticated encryption.
+ *
+ * @details Encryption is CTR mode with a 32-bit counter starting one past the
+ * initial counter block J0, and authentication is GHASH, a polynomial hash
+ * over GF(2^128) keyed by H = E(K, 0^128). The tag is E(K, J0) XOR the GHASH
+ * of the padded AAD, the padded ciphertext and their bit lengths.
+ *
+ * Two GHASH implementations are provided. With the AES-NI backend on a CPU
+ * with PCLMULQDQ, a fused kernel (aes_gcm_clmul.c) encrypts and hashes eight
+ * blocks per pass and reduces once per eight blocks. Otherwise GHASH uses
+ * Shoup's 4-bit table method, and the data is processed in chunks small
+ * enough to stay in L1 between the CTR pass and the hashing pass.
+ */
+
+#include "aes_internal.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// Bytes encrypted and then hashed per chunk on the table path.
+#define GCM_CHUNK_SIZE (AES_CTR_BATCH_BLOCKS * AES_BLOCK_SIZE)
+
+// SP 800-38D limits the plaintext to 2^39 - 256 bits.
+#define GCM_MAX_LENGTH ((UINT64_C(1) << 36) - 32)
+
+//! Reduction constants for the four bits shifted out of the 4-bit table multiply.
+static const uint16_t last4[16] = {0x0000, 0x1c20, 0x3840, 0x2460, 0x7080, 0x6ca0, 0x48c0, 0x54e0,
+                                   0xe100, 0xfd20, 0xd940, 0xc560, 0x9180, 0x8da0, 0xa9c0, 0xb5e0};
+
+/**
+ * @brief Builds the 4-bit GHASH tables: entry i holds i * H for every 4-bit i.
+ * @param[in,out] gcm The context whose tables are filled.
+ * @param[in] h The hash key H.
+ */
+static void ghash_table_init(aes_gcm_ctx_t* gcm, const uint8_t* h)
+{
+    uint64_t* hl = gcm->ghash_hl;
+    uint64_t* hh = gcm->ghash_hh;
+    uint64_t  vh = load_be64(h);
+    uint64_t  vl = load_be64(h + 8);
+
+    // Index 8 is H itself (bit order is reflected); halving gives 4, 2 and 1.
+    hl[0] = 0;
+    hh[0] = 0;
+    hl[8] = vl;
+    hh[8] = vh;
+    for (size_t i = 4; i > 0; i >>= 1)
+    {
+        uint64_t reduce = (vl & 1) * UINT64_C(0xe100000000000000);
+        vl              = (vh << 63) | (vl >> 1);
+        vh              = (vh >> 1) ^ reduce;
+        hl[i]           = vl;
+        hh[i]           = vh;
+    }
+
+    // The remaining entries are XOR combinations of the powers of two.
+    for (size_t i = 2; i <= 8; i *= 2)
+    {
+        for (size_t j = 1; j < i; j++)
+        {
+            hh[i + j] = hh[i] ^ hh[j];
+            hl[i + j] = hl[i] ^ hl[j];
+        }
+    }
+}
+
+/**
+ * @brief Multiplies the accumulator (xh, xl) by H with the 4-bit tables.
+ * @param[in] gcm A context with initialized tables.
+ * @param[in,out] xh The high (first) half of the accumulator.
+ * @param[in,out] xl The low (second) half of the accumulator.
+ */
+static void ghash_table_mult(const aes_gcm_ctx_t* gcm, uint64_t* xh, uint64_t* xl)
+{
+    const uint64_t* hl = gcm->ghash_hl;
+    const uint64_t* hh = gcm->ghash_hh;
+    uint64_t        zh = 0;
+    uint64_t        zl = 0;
+
+    // Horner's rule over the nibbles, last byte first and low nibble first.
+    for (int i = 15; i >= 0; i--)
+    {
+        uint8_t byte = (uint8_t)((i < 8 ? *xh : *xl) >> (56 - 8 * (i & 7)));
+
+        for (int shift = 0; shift <= 4; shift += 4)
+        {
+            size_t nibble = (size_t)(byte >> shift) & 0xf;
+            if (i != 15 || shift != 0)
+            {
+                size_t rem = (size_t)(zl & 0xf);
+                zl         = (zh << 60) | (zl >> 4);
+                zh         = (zh >> 4) ^ ((uint64_t)last4[rem] << 48);
+            }
+            zh ^= hh[nibble];
+            zl ^= hl[nibble];
+        }
+    }
+
+    *xh = zh;
+    *xl = zl;
+}
+
+/**
+ * @brief Absorbs whole blocks into the GHASH accumulator.
+ * @param[in] gcm An initialized context.
+ * @param[in,out] state The 16-byte accumulator.
+ * @param[in] data The blocks to absorb.
+ * @param[in] num_blocks The number of blocks.
+ */
+static void ghash_blocks(const aes_gcm_ctx_t* gcm, uint8_t* state, const uint8_t* data, size_t num_blocks)
+{
+#ifdef AES_ARCH_X86
+    if (gcm->use_clmul)
+    {
+        aes_gcm_clmul_ghash(gcm, state, data, num_blocks);
+        return;
+    }
+#endif
+
+    uint64_t xh = load_be64(state);
+    uint64_t xl = load_be64(state + 8);
+    for (size_t i = 0; i < num_blocks; i++, data += AES_BLOCK_SIZE)
+    {
+        xh ^= load_be64(data);
+        xl ^= load_be64(data + 8);
+        ghash_table_mult(gcm, &xh, &xl);
+    }
+    store_be64(state, xh);
+    store_be64(state + 8, xl);
+}
+
+/**
+ * @brief Absorbs a byte string, zero-padding its final partial block.
+ * @param[in] gcm An initialized context.
+ * @param[in,out] state The 16-byte accumulator.
+ * @param[in] data The bytes to absorb.
+ * @param[in] length The number of bytes.
+ */
+static void ghash_padded(const aes_gcm_ctx_t* gcm, uint8_t* state, const uint8_t* data, size_t length)
+{
+    size_t whole = length / AES_BLOCK_SIZE;
+    ghash_blocks(gcm, state, data, whole);
+
+    size_t rest = length % AES_BLOCK_SIZE;
+    if (rest)
+    {
+        uint8_t block[AES_BLOCK_SIZE] = {0};
+        memcpy(block, data + whole * AES_BLOCK_SIZE, rest);
+        ghash_blocks(gcm, state, block, 1);
+    }
+}
+
+/**
+ * @brief Absorbs the final block holding two 64-bit bit lengths.
+ * @param[in] gcm An initialized context.
+ * @param[in,out] state The 16-byte accumulator.
+ * @param[in] first The byte length placed in the first half.
+ * @param[in] second The byte length placed in the second half.
+ */
+static void ghash_lengths(const aes_gcm_ctx_t* gcm, uint8_t* state, uint64_t first, uint64_t second)
+{
+    uint8_t block[AES_BLOCK_SIZE];
+    store_be64(block, first * 8);
+    store_be64(block + 8, second * 8);
+    ghash_blocks(gcm, state, block, 1);
+}
+
+/**
+ * @brief Derives the pre-counter block J0 from the IV.
+ * @param[in] gcm An initialized context.
+ * @param[out] j0 Receives J0.
+ * @param[in] iv The IV.
+ * @param[in] iv_len The IV length in bytes.
+ */
+static void derive_j0(const aes_gcm_ctx_t* gcm, uint8_t* j0, const uint8_t* iv, size_t iv_len)
+{
+    if (iv_len == 12)
+    {
+        memcpy(j0, iv, 12);
+        store_be32(j0 + 12, 1);
+        return;
+    }
+
+    memset(j0, 0, AES_BLOCK_SIZE);
+    ghash_padded(gcm, j0, iv, iv_len);
+    ghash_lengths(gcm, j0, 0, iv_len);
+}
+
+/**
+ * @brief CTR-encrypts or decrypts and hashes the ciphertext in a single pass.
+ * @param[in] gcm An initialized context.
+ * @param[in] encrypt Nonzero to encrypt, zero to decrypt.
+ * @param[in,out] counter The counter block; advanced past the blocks used.
+ * @param[in,out] state The GHASH accumulator.
+ * @param[in] in The input data.
+ * @param[out] out The output buffer; may equal in.
+ * @param[in] length The number of bytes.
+ */
+static void gcm_crypt(const aes_gcm_ctx_t* gcm, int encrypt, uint8_t* counter, uint8_t* state, const uint8_t* in,
+                      uint8_t* out, size_t length)
+{
+#ifdef AES_ARCH_X86
+    if (gcm->use_clmul && length >= AES_BLOCK_SIZE)
+    {
+        size_t whole = length / AES_BLOCK_SIZE;
+        aes_gcm_clmul_crypt(gcm, encrypt, counter, state, in, out, whole);
+        in += whole * AES_BLOCK_SIZE;
+        out += whole * AES_BLOCK_SIZE;
+        length -= whole * AES_BLOCK_SIZE;
+    }
+#endif
+
+    while (length > 0)
+    {
+        size_t chunk = length < GCM_CHUNK_SIZE ? length : GCM_CHUNK_SIZE;
+
+        // The hash always covers the ciphertext: the input when decrypting
+        // (hashed first, so in-place operation is safe), the output otherwise.
+        if (!encrypt)
+            ghash_padded(gcm, state, in, chunk);
+        aes_ctr_process(&gcm->cipher, counter, AES_CTR_WIDTH_32, in, out, chunk);
+        if (encrypt)
+            ghash_padded(gcm, state, out, chunk);
+
+        in += chunk;
+        out += chunk;
+        length -= chunk;
+    }
+}
+
+//! The state of the bulk pass over the message.
+typedef struct
+{
+    const aes_gcm_ctx_t* gcm;     /**< The context. */
+    int                  encrypt; /**< Nonzero to encrypt, zero to decrypt. */
+    uint8_t*             counter; /**< The counter block. */
+    uint8_t*             state;   /**< The GHASH accumulator. */
+} gcm_iov_t;
+
+/**
+ * @brief aes_iov_step_fn over the message: arg is a gcm_iov_t.
+ *
+ * @details Every run but the last is whole blocks, so the GHASH padding and
+ * the partial keystream block only ever apply at the end of the message.
+ */
+static void gcm_step(void* arg, const uint8_t* in, uint8_t* out, size_t length)
+{
+    gcm_iov_t* pass = arg;
+    gcm_crypt(pass->gcm, pass->encrypt, pass->counter, pass->state, in, out, length);
+}
+
+/**
+ * @brief Runs the whole GCM computation for one message.
+ * @param[in] gcm An initialized context.
+ * @param[in] encrypt Nonzero to encrypt, zero to decrypt.
+ * @param[out] full_tag Receives the untruncated 16-byte tag.
+ * @param[out] length Receives the message length.
+ * @return AES_SUCCESS, or an error for invalid arguments.
+ */
+static aes_error_t gcm_process(const aes_gcm_ctx_t* gcm, int encrypt, const uint8_t* iv, size_t iv_len,
+                               const uint8_t* aad, size_t aad_len, const aes_iovec_t* in, size_t in_count,
+                               const aes_iovec_t* out, size_t out_count, size_t tag_len, uint8_t* full_tag,
+                               size_t* length)
+{
+    if (!gcm || !gcm->cipher.backend || !iv || (aad_len && !aad))
+        return AES_ERROR_INVALID_ARGUMENT;
+    aes_error_t result = aes_iov_check(in, in_count, out, out_count, length);
+    if (result != AES_SUCCESS)
+        return result;
+    if (iv_len == 0 || (uint64_t)*length > GCM_MAX_LENGTH)
+        return AES_ERROR_INVALID_LENGTH;
+    if (tag_len != 4 && tag_len != 8 && (tag_len < 12 || tag_len > AES_BLOCK_SIZE))
+        return AES_ERROR_INVALID_LENGTH;
+
+    uint8_t j0[AES_BLOCK_SIZE];
+    uint8_t counter[AES_BLOCK_SIZE];
+    uint8_t state[AES_BLOCK_SIZE] = {0};
+
+    AES_STATS_BEGIN(start);
+    derive_j0(gcm, j0, iv, iv_len);
+    memcpy(counter, j0, sizeof(counter));
+    store_be32(counter + 12, load_be32(j0 + 12) + 1);
+
+    ghash_padded(gcm, state, aad, aad_len);
+    gcm_iov_t pass = {gcm, encrypt, counter, state};
+    aes_iov_process(in, out, *length, gcm_step, &pass);
+    ghash_lengths(gcm, state, aad_len, *length);
+
+    gcm->cipher.encrypt_blocks(&gcm->cipher, j0, full_tag, 1);
+    xor_bytes(full_tag, full_tag, state, AES_BLOCK_SIZE);
+
+    secure_zero_memory(state, sizeof(state));
+    secure_zero_memory(counter, sizeof(counter));
+    AES_STATS_RECORD(AES_STATS_GCM, gcm->cipher.backend->id, *length, start);
+    return AES_SUCCESS;
+}
+
+aes_error_t aes_gcm_init(aes_gcm_ctx_t* gcm, const uint8_t* key, aes_key_size_t key_size, aes_backend_t backend)
+{
+    if (!gcm)
+        return AES_ERROR_INVALID_ARGUMENT;
+
+    aes_error_t result = aes_ctx_init_ex(&gcm->cipher, key, key_size, backend, AES_KEY_USAGE_ENCRYPT);
+    if (result != AES_SUCCESS)
+        return result;
+
+    uint8_t h[AES_BLOCK_SIZE] = {0};
+    gcm->cipher.encrypt_blocks(&gcm->cipher, h, h, 1);
+    ghash_table_init(gcm, h);
+
+    gcm->use_clmul = 0;
+    memset(gcm->ghash_h_powers, 0, sizeof(gcm->ghash_h_powers));
+#ifdef AES_ARCH_X86
+    const unsigned needed = AES_CPU_SSSE3 | AES_CPU_PCLMUL;
+    if (gcm->cipher.backend->id == AES_BACKEND_AESNI && (aes_cpu_features() & needed) == needed)
+    {
+        aes_gcm_clmul_init(gcm, h);
+        gcm->use_clmul = 1;
+    }
+#endif
+
+    secure_zero_memory(h, sizeof(h));
+    return AES_SUCCESS;
+}
+
+aes_error_t aes_gcm_seal(const aes_gcm_ctx_t* gcm, const uint8_t* iv, size_t iv_len, const uint8_t* aad,
+                         size_t aad_len, const uint8_t* in, uint8_t* out, size_t length, uint8_t* tag, size_t tag_len)
+{
+    aes_iovec_t in_iov  = {(void*)in, length};
+    aes_iovec_t out_iov = {out, length};
+    return aes_gcm_seal_iov(gcm, iv, iv_len, aad, aad_len, &in_iov, 1, &out_iov, 1, tag, tag_len);
+}
+
+aes_error_t aes_gcm_open(const aes_gcm_ctx_t* gcm, const uint8_t* iv, size_t iv_len, const uint8_t* aad,
+                         size_t aad_len, const uint8_t* in, uint8_t* out, size_t length, const uint8_t* tag,
+                         size_t tag_len)
+{
+    aes_iovec_t in_iov  = {(void*)in, length};
+    aes_iovec_t out_iov = {out, length};
+    return aes_gcm_open_iov(gcm, iv, iv_len, aad, aad_len, &in_iov, 1, &out_iov, 1, tag, tag_len);
+}
+
+aes_error_t aes_gcm_seal_iov(const aes_gcm_ctx_t* gcm, const uint8_t* iv, size_t iv_len, const uint8_t* aad,
+                             size_t aad_len, const aes_iovec_t* in, size_t in_count, const aes_iovec_t* out,
+                             size_t out_count, uint8_t* tag, size_t tag_len)
+{
+    uint8_t full_tag[AES_BLOCK_SIZE];
+    size_t  length;
+
+    if (!tag)
+        return AES_ERROR_INVALID_ARGUMENT;
+
+    aes_error_t result =
+        gcm_process(gcm, 1, iv, iv_len, aad, aad_len, in, in_count, out, out_count, tag_len, full_tag, &length);
+    if (result == AES_SUCCESS)
+        memcpy(tag, full_tag, tag_len);
+
+    secure_zero_memory(full_tag, sizeof(full_tag));
+    return result;
+}
+
+aes_error_t aes_gcm_open_iov(const aes_gcm_ctx_t* gcm, const uint8_t* iv, size_t iv_len, const uint8_t* aad,
+                             size_t aad_len, const aes_iovec_t* in, size_t in_count, const aes_iovec_t* out,
+                             size_t out_count, const uint8_t* tag, size_t tag_len)
+{
+    uint8_t full_tag[AES_BLOCK_SIZE];
+    size_t  length;
+
+    if (!tag)
+        return AES_ERROR_INVALID_ARGUMENT;
+
+    aes_error_t result =
+        gcm_process(gcm, 0, iv, iv_len, aad, aad_len, in, in_count, out, out_count, tag_len, full_tag, &length);
+    if (result != AES_SUCCESS)
+        return result;
+
+    // Constant-time comparison: accumulate every difference before deciding.
+    uint8_t diff = 0;
+    for (size_t i = 0; i < tag_len; i++)
+        diff |= (uint8_t)(full_tag[i] ^ tag[i]);
+
+    secure_zero_memory(full_tag, sizeof(full_tag));
+    if (diff != 0)
+    {
+        aes_iov_zero(out, length);
+        return AES_ERROR_AUTHENTICATION_FAILED;
+    }
+    return AES_SUCCESS;
+}
+
+void aes_gcm_clear(aes_gcm_ctx_t* gcm)
+{
+    secure_zero_memory(gcm, gcm ? sizeof(*gcm) : 0);
+}
@@ -0,0 +1,624 @@
+/**
+ * @file aes_internal.h
+ * @brief Internal interfaces shared between the AES library translation units.
+ *
+ * @details Nothing in this header is part of the public API. It describes the
+ * backend dispatch table that every block cipher implementation provides, and
+ * exposes the shared lookup tables and helpers of the reference core.
+ */
+
+#ifndef AES_INTERNAL_H
+#define AES_INTERNAL_H
+
+#include "../include/aes.h"
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// Number of rounds for each key size.
+#define AES_ROUNDS_128 10
+#define AES_ROUNDS_192 12
+#define AES_ROUNDS_256 14
+
+// Number of 32-bit words in one block or round key.
+#define WORD_COUNT_PER_BLOCK (AES_BLOCK_SIZE / 4)
+
+// Target architecture detection for the intrinsic-based backends.
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define AES_ARCH_X86 1
+#endif
+
+// CPU feature bits reported by aes_cpu_features().
+#define AES_CPU_SSSE3  (1U << 0) /**< Supplemental SSE3 (pshufb). */
+#define AES_CPU_SSE41  (1U << 1) /**< SSE4.1. */
+#define AES_CPU_AESNI  (1U << 2) /**< AES New Instructions. */
+#define AES_CPU_PCLMUL (1U << 3) /**< Carry-less multiplication (pclmulqdq). */
+
+/**
+ * @brief The dispatch table implemented by every block cipher backend.
+ * @details The backend owns the layout of aes_ctx_t::round_keys: expand_key
+ * writes it and only the same backend's block functions read it. The block
+ * functions process num_blocks consecutive 16-byte blocks and must tolerate
+ * in == out.
+ *
+ * Callers do not use encrypt_blocks and decrypt_blocks directly: context
+ * setup copies them into aes_ctx_t, and expand_key may replace them there
+ * with kernels specialized for ctx->num_rounds, so the key size is
+ * dispatched once per key instead of once per call.
+ */
+typedef struct aes_backend_ops
+{
+    aes_backend_t id;           /**< The public identifier of this backend. */
+    const char*   name;         /**< A short human-readable name. */
+    unsigned      cpu_features; /**< AES_CPU_* bits the host must report to use this backend. */
+
+    /**
+     * @brief Fills ctx->round_keys; ctx->num_rounds, ctx->key_size and ctx->usage are already set.
+     * @details May also install specialized kernels in ctx->encrypt_blocks and
+     * ctx->decrypt_blocks, and need not derive a schedule that ctx->usage excludes.
+     */
+    void (*expand_key)(aes_ctx_t* ctx, const uint8_t* key);
+
+    /** @brief Encrypts num_blocks consecutive blocks, for any number of rounds. */
+    void (*encrypt_blocks)(const aes_ctx_t* ctx, const uint8_t* in, uint8_t* out, size_t num_blocks);
+
+    /** @brief Decrypts num_blocks consecutive blocks, for any number of rounds. */
+    void (*decrypt_blocks)(const aes_ctx_t* ctx, const uint8_t* in, uint8_t* out, size_t num_blocks);
+
+    /**
+     * @brief Optional fused CTR kernel: XORs num_blocks whole blocks of keystream into in.
+     * @details Advances counter like aes_ctr_process(). NULL selects the generic
+     * path built on encrypt_blocks.
+     */
+    void (*ctr_blocks)(const aes_ctx_t* ctx, uint8_t* counter, aes_ctr_width_t width, const uint8_t* in,
+                       uint8_t* out, size_t num_blocks);
+
+    /**
+     * @brief Optional fused XTS kernel: processes num_blocks whole blocks under consecutive tweaks.
+     * @details tweak is the 16-byte encrypted tweak of the first block and is
+     * advanced past the last one. NULL selects the generic path in aes_xts.c.
+     */
+    void (*xts_blocks)(const aes_ctx_t* ctx, int encrypt, uint8_t* tweak, const uint8_t* in, uint8_t* out,
+                       size_t num_blocks);
+
+    /**
+     * @brief Optional multi-key kernels: block i is processed under ctxs[i].
+     * @details Every context uses this backend and the same number of rounds.
+     * NULL selects the generic path in aes_multi.c, one block per call.
+     */
+    void (*encrypt_multi)(const aes_ctx_t* const* ctxs, const uint8_t* in, uint8_t* out, size_t num_blocks);
+    void (*decrypt_multi)(const aes_ctx_t* const* ctxs, const uint8_t* in, uint8_t* out, size_t num_blocks);
+
+    /**
+     * @brief Optional batch key expansion: key i goes to ctxs[i], as by expand_key.
+     * @details Every context has the same key size and usage. NULL selects
+     * one expand_key call per key.
+     */
+    void (*expand_keys)(aes_ctx_t* ctxs, const uint8_t* keys, size_t count);
+
+    /**
+     * @brief Optional multi-stream CBC encryption: num_blocks blocks of each of
+     * n <= AES_CBC_MULTI_LANES streams, stream l under ctxs[l] from in[l] to
+     * out[l], chaining from and updating the 16 bytes at ivs + 16 * l.
+     * @details Every context uses this backend and the same number of rounds.
+     * NULL selects one multi-key step per block in aes_cbc.c.
+     */
+    void (*cbc_encrypt_multi)(const aes_ctx_t* const* ctxs, uint8_t* ivs, const uint8_t* const* in,
+                              uint8_t* const* out, size_t n, size_t num_blocks);
+} aes_backend_ops_t;
+
+/** @brief Reports whether ctx is initialized with an encryption schedule. */
+static inline int ctx_can_encrypt(const aes_ctx_t* ctx)
+{
+    return ctx && ctx->backend && ctx->usage != AES_KEY_USAGE_DECRYPT;
+}
+
+/** @brief Reports whether ctx is initialized with a decryption schedule. */
+static inline int ctx_can_decrypt(const aes_ctx_t* ctx)
+{
+    return ctx && ctx->backend && ctx->usage != AES_KEY_USAGE_ENCRYPT;
+}
+
+// Defines prefix_encrypt_blocks_bits and prefix_decrypt_blocks_bits, which pass a constant round count.
+#define AES_DEFINE_KERNELS_FOR_ROUNDS(prefix, bits, rounds)                                                           \
+    static void prefix##_encrypt_blocks_##bits(const aes_ctx_t* ctx, const uint8_t* in, uint8_t* out, size_t n)       \
+    {                                                                                                                  \
+        prefix##_encrypt(ctx, in, out, n, rounds);                                                                     \
+    }                                                                                                                  \
+    static void prefix##_decrypt_blocks_##bits(const aes_ctx_t* ctx, const uint8_t* in, uint8_t* out, size_t n)       \
+    {                                                                                                                  \
+        prefix##_decrypt(ctx, in, out, n, rounds);                                                                     \
+    }
+
+/**
+ * @brief Instantiates a backend's block kernels once per key size.
+ * @details The backend provides static inline prefix_encrypt and
+ * prefix_decrypt(ctx, in, out, num_blocks, rounds). This defines the generic
+ * prefix_encrypt_blocks and prefix_decrypt_blocks for its dispatch table, one
+ * pair per key size in which rounds is a compile-time constant (so the round
+ * structure and round key offsets fold away), and prefix_select_kernels(ctx),
+ * which installs the pair for ctx->num_rounds from expand_key.
+ */
+#define AES_DEFINE_ROUND_KERNELS(prefix)                                                                               \
+    static void prefix##_encrypt_blocks(const aes_ctx_t* ctx, const uint8_t* in, uint8_t* out, size_t n)              \
+    {                                                                                                                  \
+        prefix##_encrypt(ctx, in, out, n, ctx->num_rounds);                                                            \
+    }                                                                                                                  \
+    static void prefix##_decrypt_blocks(const aes_ctx_t* ctx, const uint8_t* in, uint8_t* out, size_t n)              \
+    {                                                                                                                  \
+        prefix##_decrypt(ctx, in, out, n, ctx->num_rounds);                                                            \
+    }                                                                                                                  \
+    AES_DEFINE_KERNELS_FOR_ROUNDS(prefix, 128, AES_ROUNDS_128)                                                         \
+    AES_DEFINE_KERNELS_FOR_ROUNDS(prefix, 192, AES_ROUNDS_192)                                                         \
+    AES_DEFINE_KERNELS_FOR_ROUNDS(prefix, 256, AES_ROUNDS_256)                                                         \
+    static void prefix##_select_kernels(aes_ctx_t* ctx)                                                                \
+    {                                                                                                                  \
+        switch (ctx->num_rounds)                                                                                       \
+        {                                                                                                              \
+            case AES_ROUNDS_128:                                                                                       \
+                ctx->encrypt_blocks = prefix##_encrypt_blocks_128;                                                     \
+                ctx->decrypt_blocks = prefix##_decrypt_blocks_128;                                                     \
+                break;                                                                                                 \
+            case AES_ROUNDS_192:                                                                                       \
+                ctx->encrypt_blocks = prefix##_encrypt_blocks_192;                                                     \
+                ctx->decrypt_blocks = prefix##_decrypt_blocks_192;                                                     \
+                break;                                                                                                 \
+            default:                                                                                                   \
+                ctx->encrypt_blocks = prefix##_encrypt_blocks_256;                                                     \
+                ctx->decrypt_blocks = prefix##_decrypt_blocks_256;                                                     \
+                break;                                                                                                 \
+        }                                                                                                              \
+    }
+
+extern const aes_backend_ops_t aes_backend_reference;
+extern const aes_backend_ops_t aes_backend_ttable;
+extern const aes_backend_ops_t aes_backend_bitslice;
+#ifdef AES_ARCH_X86
+extern const aes_backend_ops_t aes_backend_aesni;
+extern const aes_backend_ops_t aes_backend_vpaes;
+#endif
+
+/**
+ * @brief Detects the instruction set extensions of the running CPU.
+ * @details The CPUID query runs once; later calls return the cached result.
+ * @return A mask of AES_CPU_* bits, always 0 on non-x86 targets.
+ */
+unsigned aes_cpu_features(void);
+
+/* ============================================================================
+ * Statistics
+ *
+ * Call sites record through these macros, which expand to nothing unless the
+ * library is built with AES_ENABLE_STATS. A counted function opens with
+ * AES_STATS_BEGIN(start) once its arguments are validated and ends with
+ * AES_STATS_RECORD(); start holds a timestamp only on sampled calls.
+ * ========================================================================= */
+
+#ifdef AES_ENABLE_STATS
+//! Calls per timing sample, 0 while timing is off.
+extern atomic_uint aes_stats_interval;
+
+/** @brief Counts a call towards the next sample: returns the current timestamp if it is to be timed, else 0. */
+uint64_t aes_stats_sample(void);
+
+/** @brief Returns the current timestamp if this call is to be timed, 0 otherwise. */
+static inline uint64_t aes_stats_begin(void)
+{
+    return atomic_load_explicit(&aes_stats_interval, memory_order_relaxed) ? aes_stats_sample() : 0;
+}
+
+/**
+ * @brief Counts one completed call into the calling thread's counters.
+ * @param[in] op The operation.
+ * @param[in] backend The backend that ran it.
+ * @param[in] bytes The message bytes processed.
+ * @param[in] start The value aes_stats_begin() returned.
+ */
+void aes_stats_record(aes_stats_op_t op, aes_backend_t backend, size_t bytes, uint64_t start);
+
+/** @brief Counts one AES_ERROR_MEMORY_ALLOCATION_FAILED return. */
+void aes_stats_allocation_failed(void);
+
+#define AES_STATS_BEGIN(start)                      uint64_t start = aes_stats_begin()
+#define AES_STATS_RECORD(op, backend, bytes, start) aes_stats_record(op, backend, bytes, start)
+#define AES_STATS_ALLOCATION_FAILED()               aes_stats_allocation_failed()
+#else
+#define AES_STATS_BEGIN(start)                      ((void)0)
+#define AES_STATS_RECORD(op, backend, bytes, start) ((void)0)
+#define AES_STATS_ALLOCATION_FAILED()               ((void)0)
+#endif
+
+/* ============================================================================
+ * Lookup Tables
+ *
+ * The tables are not written by hand: aes_gen_tables derives them from
+ * aes_galois_mul() at build time, checks them, and writes aes_tables.c.
+ * ========================================================================= */
+
+//! The AES Substitution Box (S-Box), shared by all table-driven backends.
+extern const uint8_t aes_sbox[256];
+
+//! The AES Inverse Substitution Box (InvS-Box).
+extern const uint8_t aes_rsbox[256];
+
+//! The key schedule round constants: aes_rcon[i] = {02}^(i-1), aes_rcon[0] = 0.
+extern const uint8_t aes_rcon[32];
+
+//! Encryption round table: aes_te0[x] = {02}.S[x] || S[x] || S[x] || {03}.S[x].
+extern const uint32_t aes_te0[256];
+
+//! Decryption round table: aes_td0[x] = {0e}.IS[x] || {09}.IS[x] || {0d}.IS[x] || {0b}.IS[x].
+extern const uint32_t aes_td0[256];
+
+/**
+ * @brief Rows of aes_vpaes_tables, the 16-entry pshufb tables of the vector-permute backend.
+ * @details GF(2^8) is treated as GF(2^4)[u]/(u^2 + a.u + a) with GF(2^4) its
+ * own subfield, and a byte in the tower basis holds the two coordinates as
+ * nibbles. The _IO/_JO pairs are indexed by the two nibbles the inversion
+ * yields and are XORed together. See aes_vpaes.c for how they are used.
+ */
+enum
+{
+    AES_VPAES_INV,                        /**< 1/x in GF(2^4), with 1/0 = 0x80 (pshufb then yields 0). */
+    AES_VPAES_INVA,                       /**< a/x in GF(2^4), with a/0 = 0x80. */
+    AES_VPAES_IPT_LO,                     /**< Encryption input basis change, low nibble... */
+    AES_VPAES_IPT_HI,                     /**< ...and high nibble. */
+    AES_VPAES_SB1_IO, AES_VPAES_SB1_JO,   /**< S(x) ^ {63} in the encryption basis. */
+    AES_VPAES_SB2_IO, AES_VPAES_SB2_JO,   /**< {02}.(S(x) ^ {63}) in the encryption basis. */
+    AES_VPAES_SBO_IO, AES_VPAES_SBO_JO,   /**< S(x) ^ {63} in the standard basis, for the last round. */
+    AES_VPAES_DIPT_LO,                    /**< Decryption input basis change, low nibble... */
+    AES_VPAES_DIPT_HI,                    /**< ...and high nibble. */
+    AES_VPAES_DSB9_IO, AES_VPAES_DSB9_JO, /**< {09}.IS(x) in the decryption basis. */
+    AES_VPAES_DSBB_IO, AES_VPAES_DSBB_JO, /**< {0b}.IS(x) in the decryption basis. */
+    AES_VPAES_DSBD_IO, AES_VPAES_DSBD_JO, /**< {0d}.IS(x) in the decryption basis. */
+    AES_VPAES_DSBE_IO, AES_VPAES_DSBE_JO, /**< {0e}.IS(x) in the decryption basis. */
+    AES_VPAES_DSBO_IO, AES_VPAES_DSBO_JO, /**< IS(x) in the standard basis, for the last round. */
+    AES_VPAES_TABLE_COUNT
+};
+
+//! The vector-permute backend's nibble tables, indexed by the AES_VPAES_* rows.
+extern _Alignas(16) const uint8_t aes_vpaes_tables[AES_VPAES_TABLE_COUNT][16];
+
+// The AES field polynomial x^8 + x^4 + x^3 + x + 1, less its x^8 term.
+#define AES_GF_POLYNOMIAL 0x1B
+
+/**
+ * @brief Multiplies two elements of the AES field GF(2^8).
+ * @details This is the single definition of the field that every lookup table
+ * is generated from. It runs a fixed eight iterations, independent of the
+ * operand values.
+ * @param a The first operand.
+ * @param b The second operand.
+ * @return The product a * b in GF(2^8).
+ */
+static inline uint8_t aes_galois_mul(uint8_t a, uint8_t b)
+{
+    uint8_t p = 0;
+    for (int i = 0; i < 8; i++)
+    {
+        p ^= (uint8_t)(-(b & 1) & a);
+        a = (uint8_t)((a << 1) ^ (-(a >> 7) & AES_GF_POLYNOMIAL));
+        b >>= 1;
+    }
+    return p;
+}
+
+// Number of counter blocks encrypted per backend call in CTR-based modes.
+// Large enough to amortize per-call setup such as the bitsliced key broadcast.
+#define AES_CTR_BATCH_BLOCKS 32
+
+// CBC streams encrypted side by side: the AES-NI interleave and the bitsliced batch width.
+#define AES_CBC_MULTI_LANES 8
+
+/**
+ * @brief CTR keystream XOR without argument validation, for use by other modes.
+ * @param[in] ctx An initialized context.
+ * @param[in,out] counter The 16-byte counter block; advanced past the blocks used.
+ * @param[in] width The width of the incrementing counter field.
+ * @param[in] in The input data.
+ * @param[out] out The output buffer; may equal in.
+ * @param[in] length The number of bytes to process.
+ */
+void aes_ctr_process(const aes_ctx_t* ctx, uint8_t* counter, aes_ctr_width_t width, const uint8_t* in, uint8_t* out,
+                     size_t length);
+
+/**
+ * @brief Processes block i under ctxs[i], one run of compatible contexts at a time.
+ * @details Runs of neighbours that share a backend and a round count go to
+ * the backend's multi-key kernel, if it has one.
+ * @param[in] ctxs The validated contexts.
+ * @param[in] encrypt Nonzero to encrypt, zero to decrypt.
+ * @param[in] in The input blocks.
+ * @param[out] out The output blocks; may equal in.
+ * @param[in] num_blocks The number of blocks.
+ */
+void aes_multi_blocks(const aes_ctx_t* const* ctxs, int encrypt, const uint8_t* in, uint8_t* out, size_t num_blocks);
+
+/**
+ * @brief One contiguous step of a scatter-gather operation.
+ * @details Called with whole blocks, except for the final step of a message
+ * whose length is not a multiple of AES_BLOCK_SIZE; out may equal in.
+ */
+typedef void (*aes_iov_step_fn)(void* arg, const uint8_t* in, uint8_t* out, size_t length);
+
+/**
+ * @brief Validates an input and an output segment list.
+ * @param[out] length Receives the total input length.
+ * @return AES_SUCCESS, AES_ERROR_INVALID_ARGUMENT for a NULL list or segment
+ * base, or AES_ERROR_INVALID_LENGTH if the output is shorter than the input.
+ */
+aes_error_t aes_iov_check(const aes_iovec_t* in, size_t in_count, const aes_iovec_t* out, size_t out_count,
+                          size_t* length);
+
+/**
+ * @brief Runs length bytes of validated segment lists through step, passing
+ * whole-block runs directly and bouncing only blocks that straddle segments.
+ */
+void aes_iov_process(const aes_iovec_t* in, const aes_iovec_t* out, size_t length, aes_iov_step_fn step, void* arg);
+
+/** @brief Wipes the first length bytes described by a validated segment list. */
+void aes_iov_zero(const aes_iovec_t* iov, size_t length);
+
+/**
+ * @brief Sums whole PMAC blocks: XORs E(K, M_i ^ offset_i) into sum for consecutive block indices.
+ * @details Depends only on the starting index, so runs may be summed in any
+ * order and on any thread.
+ * @param[in] pmac The PMAC context, for its offset multiples.
+ * @param[in] cipher The key schedule to encrypt with: pmac->cipher or a private copy of it.
+ * @param[in] first The index of the first block within the message, counting from 1.
+ * @param[in] data The blocks.
+ * @param[in] num_blocks The number of blocks.
+ * @param[in,out] sum The 16-byte accumulator.
+ */
+void aes_pmac_sum_blocks(const aes_pmac_ctx_t* pmac, const aes_ctx_t* cipher, uint64_t first, const uint8_t* data,
+                         size_t num_blocks, uint8_t* sum);
+
+/** @brief A way of summing whole PMAC blocks with pmac->cipher, as aes_pmac_sum_blocks() does. */
+typedef void (*aes_pmac_sum_fn)(const aes_pmac_ctx_t* pmac, uint64_t first, const uint8_t* data, size_t num_blocks,
+                                uint8_t* sum, void* arg);
+
+/**
+ * @brief Feeds message bytes to a PMAC computation, handing whole-block runs to sum_blocks.
+ * @details The last block seen so far is always held back for
+ * aes_pmac_final(), which masks it differently. Arguments are not validated.
+ * @param[in,out] pmac An initialized context.
+ * @param[in] data The message bytes.
+ * @param[in] length The number of bytes.
+ * @param[in] sum_blocks Sums the runs of whole blocks into pmac->sigma.
+ * @param[in] arg Passed through to sum_blocks.
+ */
+void aes_pmac_absorb(aes_pmac_ctx_t* pmac, const uint8_t* data, size_t length, aes_pmac_sum_fn sum_blocks, void* arg);
+
+/** @brief One unit of work for aes_engine_for_each(). */
+typedef void (*aes_engine_task_fn)(void* arg, size_t index);
+
+/**
+ * @brief Calls task(arg, i) for every i below count, on the engine's threads.
+ * @details Indices are claimed in any order; each task must touch only its
+ * own output. Runs on the calling thread alone if engine is NULL, has one
+ * thread, or bytes is below its parallel threshold.
+ * @param[in,out] engine The engine, or NULL.
+ * @param[in] count The number of tasks.
+ * @param[in] bytes The total bytes the tasks process, for the threshold.
+ * @param[in] task The work of one index.
+ * @param[in] arg Passed through to task.
+ */
+void aes_engine_for_each(aes_engine_t* engine, size_t count, size_t bytes, aes_engine_task_fn task, void* arg);
+
+#ifdef AES_ARCH_X86
+/**
+ * @brief Precomputes the byte-reflected powers H^1..H^8 for the PCLMULQDQ GHASH.
+ * @param[in,out] gcm The context whose ghash_h_powers are filled.
+ * @param[in] h The hash key H = E(K, 0^128).
+ */
+void aes_gcm_clmul_init(aes_gcm_ctx_t* gcm, const uint8_t* h);
+
+/**
+ * @brief GHASH over whole blocks with PCLMULQDQ, eight blocks per reduction.
+ * @param[in] gcm A context with use_clmul set.
+ * @param[in,out] state The 16-byte GHASH accumulator.
+ * @param[in] data The blocks to absorb.
+ * @param[in] num_blocks The number of blocks.
+ */
+void aes_gcm_clmul_ghash(const aes_gcm_ctx_t* gcm, uint8_t* state, const uint8_t* data, size_t num_blocks);
+
+/**
+ * @brief Fused AES-NI CTR and PCLMULQDQ GHASH over whole blocks.
+ * @details The ciphertext (output when encrypting, input when decrypting) is
+ * absorbed into state while it is still in registers.
+ * @param[in] gcm A context with use_clmul set.
+ * @param[in] encrypt Nonzero to encrypt, zero to decrypt.
+ * @param[in,out] counter The 16-byte counter block; its low 32 bits advance.
+ * @param[in,out] state The 16-byte GHASH accumulator.
+ * @param[in] in The input blocks.
+ * @param[out] out The output blocks; may equal in.
+ * @param[in] num_blocks The number of blocks.
+ */
+void aes_gcm_clmul_crypt(const aes_gcm_ctx_t* gcm, int encrypt, uint8_t* counter, uint8_t* state, const uint8_t* in,
+                         uint8_t* out, size_t num_blocks);
+#endif
+
+/**
+ * @brief Applies the S-box to each of the four bytes of a word.
+ * @details Lets a backend plug its own (e.g. constant-time) S-box into the
+ * shared word-wise key schedule.
+ */
+typedef uint32_t (*aes_sub_word_fn)(uint32_t word);
+
+/**
+ * @brief Word-wise FIPS-197 key expansion with a pluggable SubWord.
+ * @details Words are packed little-endian (byte 0 in the low bits), so on
+ * little-endian hosts the output is byte-for-byte the aes_expand_key() schedule.
+ * @param[out] words The schedule, total_words long.
+ * @param[in] key The cipher key.
+ * @param[in] key_words The key length in 32-bit words (4, 6 or 8).
+ * @param[in] total_words The number of schedule words to produce.
+ * @param[in] sub_word The SubWord implementation.
+ */
+void aes_expand_key_words(uint32_t* words, const uint8_t* key, size_t key_words, size_t total_words,
+                          aes_sub_word_fn sub_word);
+
+/**
+ * @brief Securely erases a region of memory.
+ * @param[in,out] ptr A pointer to the memory to be zeroed.
+ * @param[in] n The number of bytes to zero.
+ */
+void secure_zero_memory(void* ptr, size_t n);
+
+/** @brief Loads a big-endian 32-bit word. */
+static inline uint32_t load_be32(const uint8_t* p)
+{
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | (uint32_t)p[3];
+}
+
+/** @brief Stores a 32-bit word in big-endian byte order. */
+static inline void store_be32(uint8_t* p, uint32_t v)
+{
+    p[0] = (uint8_t)(v >> 24);
+    p[1] = (uint8_t)(v >> 16);
+    p[2] = (uint8_t)(v >> 8);
+    p[3] = (uint8_t)v;
+}
+
+/** @brief Multiplies each of the four packed bytes by {02} in GF(2^8). */
+static inline uint32_t aes_xtime_word(uint32_t x)
+{
+    return ((x & 0x7f7f7f7fU) << 1) ^ (((x >> 7) & 0x01010101U) * 0x1bU);
+}
+
+/**
+ * @brief Applies InvMixColumns to one column packed with load_be32() (row 0 in the most significant byte).
+ * @details Used to build the equivalent-inverse-cipher decryption schedules.
+ */
+static inline uint32_t aes_inv_mix_column_word(uint32_t w)
+{
+    // InvMixColumns = MixColumns . circ({05}, {00}, {04}, {00}).
+    uint32_t u = w ^ aes_xtime_word(aes_xtime_word(w ^ ((w << 16) | (w >> 16))));
+    uint32_t r = (u << 8) | (u >> 24);
+    return aes_xtime_word(u ^ r) ^ r ^ ((u << 16) | (u >> 16)) ^ ((u << 24) | (u >> 8));
+}
+
+/** @brief Loads a big-endian 64-bit word. */
+static inline uint64_t load_be64(const uint8_t* p)
+{
+    return ((uint64_t)load_be32(p) << 32) | load_be32(p + 4);
+}
+
+/** @brief Stores a 64-bit word in big-endian byte order. */
+static inline void store_be64(uint8_t* p, uint64_t v)
+{
+    store_be32(p, (uint32_t)(v >> 32));
+    store_be32(p + 4, (uint32_t)v);
+}
+
+/** @brief Loads a little-endian 64-bit word. */
+static inline uint64_t load_le64(const uint8_t* p)
+{
+    uint64_t v = 0;
+    for (int i = 7; i >= 0; i--)
+        v = (v << 8) | p[i];
+    return v;
+}
+
+/** @brief Stores a 64-bit word in little-endian byte order. */
+static inline void store_le64(uint8_t* p, uint64_t v)
+{
+    for (int i = 0; i < 8; i++, v >>= 8)
+        p[i] = (uint8_t)v;
+}
+
+/**
+ * @brief Advances a counter held as two 64-bit halves of a big-endian block.
+ * @param[in,out] hi The high-order (nonce side) half.
+ * @param[in,out] lo The low-order half.
+ * @param[in] width The width of the incrementing field.
+ */
+static inline void ctr_increment(uint64_t* hi, uint64_t* lo, aes_ctr_width_t width)
+{
+    switch (width)
+    {
+        case AES_CTR_WIDTH_32:
+            *lo = (*lo & 0xffffffff00000000ULL) | (uint32_t)(*lo + 1);
+            break;
+        case AES_CTR_WIDTH_64:
+            (*lo)++;
+            break;
+        default:
+            if (++(*lo) == 0)
+                (*hi)++;
+            break;
+    }
+}
+
+/**
+ * @brief Advances a 16-byte counter block by a number of blocks.
+ * @param[in,out] counter The big-endian counter block.
+ * @param[in] width The width of the incrementing field, which wraps.
+ * @param[in] blocks The number of increments.
+ */
+static inline void ctr_add(uint8_t* counter, aes_ctr_width_t width, uint64_t blocks)
+{
+    uint64_t hi = load_be64(counter);
+    uint64_t lo = load_be64(counter + 8);
+
+    switch (width)
+    {
+        case AES_CTR_WIDTH_32:
+            lo = (lo & 0xffffffff00000000ULL) | (uint32_t)(lo + blocks);
+            break;
+        case AES_CTR_WIDTH_64:
+            lo += blocks;
+            break;
+        default:
+            lo += blocks;
+            hi += lo < blocks;
+            break;
+    }
+
+    store_be64(counter, hi);
+    store_be64(counter + 8, lo);
+}
+
+/**
+ * @brief XORs two byte strings: out = a ^ b.
+ * @details Works a machine word at a time; out may alias a or b.
+ */
+static inline void xor_bytes(uint8_t* out, const uint8_t* a, const uint8_t* b, size_t n)
+{
+    size_t i = 0;
+    for (; i + sizeof(uint64_t) <= n; i += sizeof(uint64_t))
+    {
+        uint64_t x, y;
+        memcpy(&x, a + i, sizeof(x));
+        memcpy(&y, b + i, sizeof(y));
+        x ^= y;
+        memcpy(out + i, &x, sizeof(x));
+    }
+    for (; i < n; i++)
+        out[i] = a[i] ^ b[i];
+}
+
+/**
+ * @brief Multiplies a big-endian element of GF(2^128) by x ("double" in
+ * RFC 4493 and RFC 7253), in constant time; out may equal in.
+ */
+static inline void aes_gf128_double(uint8_t* out, const uint8_t* in)
+{
+    uint8_t reduce = (uint8_t)(-(in[0] >> 7) & 0x87);
+
+    for (size_t i = 0; i < AES_BLOCK_SIZE - 1; i++)
+        out[i] = (uint8_t)((in[i] << 1) | (in[i + 1] >> 7));
+    out[AES_BLOCK_SIZE - 1] = (uint8_t)((in[AES_BLOCK_SIZE - 1] << 1) ^ reduce);
+}
+
+/** @brief Returns the number of trailing zero bits of a nonzero block index. */
+static inline unsigned aes_ntz64(uint64_t x)
+{
+    unsigned n = 0;
+    for (; !(x & 1); x >>= 1)
+        n++;
+    return n;
+}
+
+#endif // AES_INTERNAL_H
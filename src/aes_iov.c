@@ -0,0 +1,156 @@
+/**
+ * @file aes_iov.c
+ * @brief The scatter-gather driver behind the *_iov mode functions.
+ *
+ * @details The input and output segment lists are walked in step. Wherever
+ * both lists have a contiguous run of whole blocks at the current position,
+ * the run goes straight to the mode's contiguous kernel, in place on the
+ * caller's memory. Only a block that straddles a segment boundary on either
+ * side is gathered into a 16-byte stack buffer, processed, and scattered
+ * back, so no more than one block is ever copied at a time.
+ */
+
+#include "aes_internal.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+//! A position within a segment list.
+typedef struct
+{
+    const aes_iovec_t* iov;    /**< The segments. */
+    size_t             index;  /**< The current segment. */
+    size_t             offset; /**< The position within the current segment. */
+} iov_cursor_t;
+
+/**
+ * @brief Returns the contiguous bytes available at the cursor, skipping exhausted and empty segments.
+ * @param[in,out] cursor The cursor; moved to the next non-empty segment if needed.
+ * @param[out] ptr Receives the address of the first available byte.
+ * @return The number of bytes left in the current segment.
+ */
+static size_t cursor_span(iov_cursor_t* cursor, uint8_t** ptr)
+{
+    while (cursor->offset == cursor->iov[cursor->index].iov_len)
+    {
+        cursor->index++;
+        cursor->offset = 0;
+    }
+    *ptr = (uint8_t*)cursor->iov[cursor->index].iov_base + cursor->offset;
+    return cursor->iov[cursor->index].iov_len - cursor->offset;
+}
+
+/** @brief Copies length bytes at the cursor into block and advances the cursor. */
+static void cursor_gather(iov_cursor_t* cursor, uint8_t* block, size_t length)
+{
+    while (length > 0)
+    {
+        uint8_t* ptr;
+        size_t   n = cursor_span(cursor, &ptr);
+        if (n > length)
+            n = length;
+        memcpy(block, ptr, n);
+        cursor->offset += n;
+        block += n;
+        length -= n;
+    }
+}
+
+/** @brief Copies length bytes from block to the cursor and advances the cursor. */
+static void cursor_scatter(iov_cursor_t* cursor, const uint8_t* block, size_t length)
+{
+    while (length > 0)
+    {
+        uint8_t* ptr;
+        size_t   n = cursor_span(cursor, &ptr);
+        if (n > length)
+            n = length;
+        memcpy(ptr, block, n);
+        cursor->offset += n;
+        block += n;
+        length -= n;
+    }
+}
+
+/**
+ * @brief Validates a segment list and sums its length.
+ * @return AES_SUCCESS, or AES_ERROR_INVALID_ARGUMENT for a missing list or segment base.
+ */
+static aes_error_t iov_total(const aes_iovec_t* iov, size_t count, size_t* total)
+{
+    if (count > 0 && !iov)
+        return AES_ERROR_INVALID_ARGUMENT;
+
+    *total = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        if (iov[i].iov_len > 0 && !iov[i].iov_base)
+            return AES_ERROR_INVALID_ARGUMENT;
+        if (iov[i].iov_len > SIZE_MAX - *total)
+            return AES_ERROR_INVALID_LENGTH;
+        *total += iov[i].iov_len;
+    }
+    return AES_SUCCESS;
+}
+
+aes_error_t aes_iov_check(const aes_iovec_t* in, size_t in_count, const aes_iovec_t* out, size_t out_count,
+                          size_t* length)
+{
+    size_t      out_total;
+    aes_error_t result = iov_total(in, in_count, length);
+    if (result == AES_SUCCESS)
+        result = iov_total(out, out_count, &out_total);
+    if (result == AES_SUCCESS && out_total < *length)
+        result = AES_ERROR_INVALID_LENGTH;
+    return result;
+}
+
+void aes_iov_process(const aes_iovec_t* in, const aes_iovec_t* out, size_t length, aes_iov_step_fn step, void* arg)
+{
+    iov_cursor_t src = {in, 0, 0};
+    iov_cursor_t dst = {out, 0, 0};
+    uint8_t      block[AES_BLOCK_SIZE];
+
+    while (length > 0)
+    {
+        uint8_t* in_ptr;
+        uint8_t* out_ptr;
+        size_t   in_span  = cursor_span(&src, &in_ptr);
+        size_t   out_span = cursor_span(&dst, &out_ptr);
+        size_t   run      = in_span < out_span ? in_span : out_span;
+
+        // Whole blocks run in place; a contiguous tail ends the message as is.
+        if (run >= length)
+            run = length;
+        else
+            run -= run % AES_BLOCK_SIZE;
+
+        if (run > 0)
+        {
+            step(arg, in_ptr, out_ptr, run);
+            src.offset += run;
+            dst.offset += run;
+            length -= run;
+            continue;
+        }
+
+        // The next block straddles a segment boundary.
+        size_t n = length < AES_BLOCK_SIZE ? length : AES_BLOCK_SIZE;
+        cursor_gather(&src, block, n);
+        step(arg, block, block, n);
+        cursor_scatter(&dst, block, n);
+        length -= n;
+    }
+
+    secure_zero_memory(block, sizeof(block));
+}
+
+void aes_iov_zero(const aes_iovec_t* iov, size_t length)
+{
+    for (size_t i = 0; length > 0; i++)
+    {
+        size_t n = iov[i].iov_len < length ? iov[i].iov_len : length;
+        secure_zero_memory(iov[i].iov_base, n);
+        length -= n;
+    }
+}
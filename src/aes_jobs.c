@@ -0,0 +1,533 @@
+/**
+ * @file aes_jobs.c
+ * @brief The job manager: small jobs from many threads, batched into lanes.
+ *
+ * @details Submitting threads push jobs onto an intrusive multi-producer,
+ * single-consumer queue (Vyukov's): a push is one atomic exchange of the
+ * head and one store to the previous job's link, with no lock and no
+ * allocation, since the link lives in the job itself. Only the manager's
+ * thread pops. It keeps up to `lanes` jobs in flight, and a step takes the
+ * next block of every lane, prepares the cipher input for its mode (the
+ * chained plaintext for CBC encryption, the ciphertext for decryption, the
+ * counter block for CTR), runs the encrypting and the decrypting lanes
+ * through aes_multi_blocks(), and finishes each block for its mode. Jobs that
+ * run out of blocks complete and free their lanes, which are refilled from
+ * the queue before the next step.
+ *
+ * A batch starts when the lanes are full, when the first job admitted to idle
+ * lanes has waited max_latency_us, on a flush, or on destruction, and then
+ * runs until the lanes are empty. In between the thread sleeps on a condition
+ * variable; a producer only takes the lock to wake it when it is asleep and
+ * the queue holds enough jobs to fill its free lanes, or one job if it has
+ * none in flight.
+ */
+
+#include "aes_internal.h"
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifdef AES_HAVE_PTHREADS
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+// Default lane count: one block per AES-NI pipeline slot or bitsliced lane.
+#define JOBS_DEFAULT_LANES 8
+
+// Default wait for the lanes to fill, in microseconds.
+#define JOBS_DEFAULT_MAX_LATENCY_US 50
+
+//! A lane: the job it holds and the position of the job's next block.
+typedef struct
+{
+    aes_job_t* job;
+    size_t     offset;
+} job_lane_t;
+
+struct aes_job_manager
+{
+    aes_job_t* _Atomic head;      /**< The most recently pushed job; exchanged by producers. */
+    aes_job_t*         tail;      /**< The oldest queued job; consumer only. */
+    aes_job_t          stub;      /**< Keeps the queue non-empty between pops. */
+    atomic_size_t      submitted; /**< Jobs ever accepted, counted before they are pushed. */
+    atomic_size_t      popped;    /**< Jobs ever taken from the queue; written by the consumer. */
+    atomic_size_t      completed; /**< Jobs ever completed. */
+    unsigned           lanes;     /**< The batch width. */
+    unsigned           active;    /**< Jobs in flight, in lane[0] to lane[active - 1]. */
+    uint32_t           max_latency_us;
+    job_lane_t         lane[AES_JOB_MAX_LANES];
+#ifdef AES_HAVE_PTHREADS
+    pthread_mutex_t lock;          /**< Guards sleeping on wake and waiting on idle. */
+    pthread_cond_t  wake;          /**< Signals queued jobs, a flush or shutdown to the thread. */
+    pthread_cond_t  idle;          /**< Signals flush waiters that jobs completed. */
+    atomic_int      sleeping;      /**< The thread is waiting on wake. */
+    atomic_size_t   wake_at;       /**< The number of queued jobs worth waking the thread for. */
+    atomic_size_t   flush_target;  /**< The thread runs batches until this many jobs completed. */
+    atomic_uint     flush_waiters; /**< Threads waiting on idle. */
+    atomic_int      shutdown;      /**< Set by aes_job_manager_destroy(). */
+    int             started;       /**< The thread was created. */
+    pthread_t       thread;
+#endif
+};
+
+/* ============================================================================
+ * Queue
+ * ========================================================================= */
+
+/** @brief Appends a job to the queue; safe from any number of threads. */
+static void queue_push(aes_job_manager_t* manager, aes_job_t* job)
+{
+    atomic_store_explicit(&job->next, NULL, memory_order_relaxed);
+    aes_job_t* prev = atomic_exchange_explicit(&manager->head, job, memory_order_acq_rel);
+    atomic_store_explicit(&prev->next, job, memory_order_release);
+}
+
+/**
+ * @brief Takes the oldest job from the queue; consumer only.
+ * @return The job, or NULL if the queue is empty or its oldest job is still
+ * being linked in by a producer.
+ */
+static aes_job_t* queue_pop(aes_job_manager_t* manager)
+{
+    aes_job_t* tail = manager->tail;
+    aes_job_t* next = atomic_load_explicit(&tail->next, memory_order_acquire);
+
+    if (tail == &manager->stub)
+    {
+        if (!next)
+            return NULL;
+        manager->tail = tail = next;
+        next              = atomic_load_explicit(&tail->next, memory_order_acquire);
+    }
+    if (next)
+    {
+        manager->tail = next;
+        return tail;
+    }
+
+    // tail is the last linked job. Unless a producer has already exchanged
+    // the head past it, put the stub behind it so it can be handed out.
+    if (tail != atomic_load_explicit(&manager->head, memory_order_acquire))
+        return NULL;
+    queue_push(manager, &manager->stub);
+    next = atomic_load_explicit(&tail->next, memory_order_acquire);
+    if (!next)
+        return NULL;
+    manager->tail = next;
+    return tail;
+}
+
+/* ============================================================================
+ * Lanes
+ * ========================================================================= */
+
+/** @brief Reports whether a mode runs the block cipher in the decrypt direction. */
+static int job_decrypts(aes_job_mode_t mode)
+{
+    return mode == AES_JOB_ECB_DECRYPT || mode == AES_JOB_CBC_DECRYPT;
+}
+
+/** @brief Hands a finished job back to its owner. The job must not be touched afterwards. */
+static void job_complete(aes_job_t* job)
+{
+    // Jobs are counted under their mode, untimed: their blocks run interleaved with other jobs'.
+    AES_STATS_RECORD(job->mode == AES_JOB_CTR           ? AES_STATS_CTR
+                     : job->mode <= AES_JOB_ECB_DECRYPT ? AES_STATS_ECB
+                                                        : AES_STATS_CBC,
+                     job->ctx->backend->id, job->length, 0);
+    if (job->callback)
+        job->callback(job);
+    else
+        atomic_store_explicit(&job->done, 1, memory_order_release);
+}
+
+/** @brief Moves queued jobs into free lanes. */
+static void jobs_admit(aes_job_manager_t* manager)
+{
+    size_t popped = atomic_load_explicit(&manager->popped, memory_order_relaxed);
+    while (manager->active < manager->lanes)
+    {
+        aes_job_t* job = queue_pop(manager);
+        if (!job)
+            break;
+        manager->lane[manager->active].job    = job;
+        manager->lane[manager->active].offset = 0;
+        manager->active++;
+        popped++;
+    }
+    atomic_store_explicit(&manager->popped, popped, memory_order_relaxed);
+}
+
+/**
+ * @brief Advances every lane by one block and completes the jobs that end.
+ * @return The number of jobs completed.
+ */
+static unsigned jobs_step(aes_job_manager_t* manager)
+{
+    const aes_ctx_t* ctxs[2][AES_JOB_MAX_LANES];
+    uint8_t          input[2][AES_JOB_MAX_LANES * AES_BLOCK_SIZE];
+    uint8_t          output[2][AES_JOB_MAX_LANES * AES_BLOCK_SIZE];
+    size_t           count[2] = {0, 0};
+    size_t           slot[AES_JOB_MAX_LANES];
+    unsigned         finished = 0;
+
+    // Gather each lane's cipher input into the encrypt (0) or decrypt (1) set.
+    for (unsigned i = 0; i < manager->active; i++)
+    {
+        aes_job_t*     job  = manager->lane[i].job;
+        const uint8_t* in   = job->in + manager->lane[i].offset;
+        int            side = job_decrypts(job->mode);
+        uint8_t*       dst  = input[side] + count[side] * AES_BLOCK_SIZE;
+
+        slot[i]                   = count[side];
+        ctxs[side][count[side]++] = job->ctx;
+        switch (job->mode)
+        {
+            case AES_JOB_CBC_ENCRYPT:
+                xor_bytes(dst, in, job->iv, AES_BLOCK_SIZE);
+                break;
+            case AES_JOB_CTR:
+                memcpy(dst, job->iv, AES_BLOCK_SIZE);
+                break;
+            default:
+                memcpy(dst, in, AES_BLOCK_SIZE);
+                break;
+        }
+    }
+
+    aes_multi_blocks(ctxs[0], 1, input[0], output[0], count[0]);
+    aes_multi_blocks(ctxs[1], 0, input[1], output[1], count[1]);
+
+    // Finish each block in reverse, so a finished lane can take the last one.
+    for (unsigned i = manager->active; i-- > 0;)
+    {
+        job_lane_t*    lane   = &manager->lane[i];
+        aes_job_t*     job    = lane->job;
+        const uint8_t* in     = job->in + lane->offset;
+        uint8_t*       out    = job->out + lane->offset;
+        int            side   = job_decrypts(job->mode);
+        const uint8_t* src    = input[side] + slot[i] * AES_BLOCK_SIZE;
+        const uint8_t* result = output[side] + slot[i] * AES_BLOCK_SIZE;
+        size_t         n      = job->length - lane->offset;
+
+        if (n > AES_BLOCK_SIZE)
+            n = AES_BLOCK_SIZE;
+
+        switch (job->mode)
+        {
+            case AES_JOB_ECB_ENCRYPT:
+            case AES_JOB_ECB_DECRYPT:
+                memcpy(out, result, AES_BLOCK_SIZE);
+                break;
+            case AES_JOB_CBC_ENCRYPT:
+                memcpy(out, result, AES_BLOCK_SIZE);
+                memcpy(job->iv, result, AES_BLOCK_SIZE);
+                break;
+            case AES_JOB_CBC_DECRYPT:
+                xor_bytes(out, result, job->iv, AES_BLOCK_SIZE);
+                memcpy(job->iv, src, AES_BLOCK_SIZE);
+                break;
+            case AES_JOB_CTR:
+                xor_bytes(out, in, result, n);
+                ctr_add(job->iv, job->width, 1);
+                break;
+        }
+
+        lane->offset += n;
+        if (lane->offset == job->length)
+        {
+            *lane = manager->lane[--manager->active];
+            job_complete(job);
+            finished++;
+        }
+    }
+
+    secure_zero_memory(input, sizeof(input));
+    secure_zero_memory(output, sizeof(output));
+    return finished;
+}
+
+/** @brief Counts completed jobs and wakes any thread waiting in aes_job_manager_flush(). */
+static void jobs_count_completed(aes_job_manager_t* manager, unsigned finished)
+{
+    if (finished == 0)
+        return;
+    atomic_fetch_add(&manager->completed, finished);
+#ifdef AES_HAVE_PTHREADS
+    // A waiter registers before it checks completed, so one of us sees the other.
+    if (atomic_load(&manager->flush_waiters) > 0)
+    {
+        pthread_mutex_lock(&manager->lock);
+        pthread_cond_broadcast(&manager->idle);
+        pthread_mutex_unlock(&manager->lock);
+    }
+#endif
+}
+
+#ifdef AES_HAVE_PTHREADS
+
+/* ============================================================================
+ * Manager Thread
+ * ========================================================================= */
+
+/** @brief Sets deadline to max_latency_us from now. */
+static void deadline_start(const aes_job_manager_t* manager, struct timespec* deadline)
+{
+    timespec_get(deadline, TIME_UTC);
+    long nsec = deadline->tv_nsec + (long)(manager->max_latency_us % 1000000u) * 1000;
+    deadline->tv_sec += (time_t)(manager->max_latency_us / 1000000u) + nsec / 1000000000;
+    deadline->tv_nsec = nsec % 1000000000;
+}
+
+/** @brief Reports whether deadline has passed. */
+static int deadline_passed(const struct timespec* deadline)
+{
+    struct timespec now;
+    timespec_get(&now, TIME_UTC);
+    return now.tv_sec > deadline->tv_sec || (now.tv_sec == deadline->tv_sec && now.tv_nsec >= deadline->tv_nsec);
+}
+
+/** @brief Reports whether a flush or shutdown wants every queued job run now. */
+static int jobs_urgent(aes_job_manager_t* manager)
+{
+    return atomic_load(&manager->shutdown) ||
+           atomic_load(&manager->flush_target) > atomic_load(&manager->completed);
+}
+
+/**
+ * @brief Sleeps until a producer, a flush, shutdown or the deadline wakes the thread.
+ * @param[in,out] manager The manager.
+ * @param[in] deadline When jobs are in flight, the time their batch must start.
+ */
+static void jobs_sleep(aes_job_manager_t* manager, const struct timespec* deadline)
+{
+    size_t wake_at = manager->active ? manager->lanes - manager->active : 1;
+
+    pthread_mutex_lock(&manager->lock);
+    atomic_store_explicit(&manager->wake_at, wake_at, memory_order_relaxed);
+    atomic_store(&manager->sleeping, 1);
+    // Recheck after announcing the sleep: a producer that counted its job
+    // before this point was not woken by us and has to be seen here.
+    size_t queued = atomic_load(&manager->submitted) - atomic_load_explicit(&manager->popped, memory_order_relaxed);
+    if (queued < wake_at && !jobs_urgent(manager))
+    {
+        if (manager->active)
+            pthread_cond_timedwait(&manager->wake, &manager->lock, deadline);
+        else
+            pthread_cond_wait(&manager->wake, &manager->lock);
+    }
+    atomic_store(&manager->sleeping, 0);
+    pthread_mutex_unlock(&manager->lock);
+}
+
+/**
+ * @brief The manager thread: fill the lanes, run batches, sleep.
+ * @param[in] arg The manager.
+ * @return NULL.
+ */
+static void* manager_main(void* arg)
+{
+    aes_job_manager_t* manager  = arg;
+    struct timespec    deadline = {0, 0};
+    int                running  = 0;
+
+    for (;;)
+    {
+        unsigned was_active = manager->active;
+        jobs_admit(manager);
+        if (manager->active == 0)
+            running = 0;
+        else if (was_active == 0)
+            deadline_start(manager, &deadline);
+
+        // Once started, a batch runs until the lanes are empty, refilling
+        // them as jobs finish.
+        if (manager->active == manager->lanes ||
+            (manager->active > 0 && (running || jobs_urgent(manager) || deadline_passed(&deadline))))
+        {
+            running = 1;
+            jobs_count_completed(manager, jobs_step(manager));
+            continue;
+        }
+
+        // A producer has counted a job but not linked it in yet.
+        if (atomic_load(&manager->submitted) != atomic_load_explicit(&manager->popped, memory_order_relaxed))
+        {
+            sched_yield();
+            continue;
+        }
+        if (manager->active == 0 && atomic_load(&manager->shutdown))
+            break;
+        jobs_sleep(manager, &deadline);
+    }
+    return NULL;
+}
+
+#else // !AES_HAVE_PTHREADS
+
+/** @brief Runs batches on the calling thread until the queue and the lanes are empty. */
+static void jobs_drain(aes_job_manager_t* manager)
+{
+    for (;;)
+    {
+        jobs_admit(manager);
+        if (manager->active == 0)
+            break;
+        jobs_count_completed(manager, jobs_step(manager));
+    }
+}
+
+#endif // AES_HAVE_PTHREADS
+
+/* ============================================================================
+ * Public Functions
+ * ========================================================================= */
+
+aes_error_t aes_job_manager_create(aes_job_manager_t** manager_out, const aes_job_manager_config_t* config)
+{
+    static const aes_job_manager_config_t defaults = {0, 0};
+
+    if (!manager_out)
+        return AES_ERROR_INVALID_ARGUMENT;
+    if (!config)
+        config = &defaults;
+    if (config->lanes > AES_JOB_MAX_LANES)
+        return AES_ERROR_INVALID_ARGUMENT;
+
+    aes_job_manager_t* manager = calloc(1, sizeof(*manager));
+    if (!manager)
+    {
+        AES_STATS_ALLOCATION_FAILED();
+        return AES_ERROR_MEMORY_ALLOCATION_FAILED;
+    }
+
+    manager->lanes          = config->lanes ? config->lanes : JOBS_DEFAULT_LANES;
+    manager->max_latency_us = config->max_latency_us ? config->max_latency_us : JOBS_DEFAULT_MAX_LATENCY_US;
+    manager->tail           = &manager->stub;
+    atomic_init(&manager->head, &manager->stub);
+    atomic_init(&manager->stub.next, NULL);
+
+#ifdef AES_HAVE_PTHREADS
+    pthread_mutex_init(&manager->lock, NULL);
+    pthread_cond_init(&manager->wake, NULL);
+    pthread_cond_init(&manager->idle, NULL);
+    if (pthread_create(&manager->thread, NULL, manager_main, manager) != 0)
+    {
+        aes_job_manager_destroy(manager);
+        AES_STATS_ALLOCATION_FAILED();
+        return AES_ERROR_MEMORY_ALLOCATION_FAILED;
+    }
+    manager->started = 1;
+#endif
+
+    *manager_out = manager;
+    return AES_SUCCESS;
+}
+
+void aes_job_manager_destroy(aes_job_manager_t* manager)
+{
+    if (!manager)
+        return;
+
+#ifdef AES_HAVE_PTHREADS
+    if (manager->started)
+    {
+        pthread_mutex_lock(&manager->lock);
+        atomic_store(&manager->shutdown, 1);
+        pthread_cond_signal(&manager->wake);
+        pthread_mutex_unlock(&manager->lock);
+        pthread_join(manager->thread, NULL);
+    }
+
+    pthread_cond_destroy(&manager->idle);
+    pthread_cond_destroy(&manager->wake);
+    pthread_mutex_destroy(&manager->lock);
+#else
+    jobs_drain(manager);
+#endif
+
+    free(manager);
+}
+
+aes_error_t aes_job_submit(aes_job_manager_t* manager, aes_job_t* job)
+{
+    if (!manager || !job || (job->length && (!job->in || !job->out)))
+        return AES_ERROR_INVALID_ARGUMENT;
+    if (job_decrypts(job->mode) ? !ctx_can_decrypt(job->ctx) : !ctx_can_encrypt(job->ctx))
+        return AES_ERROR_INVALID_ARGUMENT;
+
+    switch (job->mode)
+    {
+        case AES_JOB_ECB_ENCRYPT:
+        case AES_JOB_ECB_DECRYPT:
+        case AES_JOB_CBC_ENCRYPT:
+        case AES_JOB_CBC_DECRYPT:
+            if (job->length % AES_BLOCK_SIZE != 0)
+                return AES_ERROR_INVALID_LENGTH;
+            break;
+        case AES_JOB_CTR:
+            if (job->width != AES_CTR_WIDTH_32 && job->width != AES_CTR_WIDTH_64 && job->width != AES_CTR_WIDTH_128)
+                return AES_ERROR_INVALID_ARGUMENT;
+            break;
+        default:
+            return AES_ERROR_INVALID_ARGUMENT;
+    }
+
+    if (job->length == 0)
+    {
+        job_complete(job);
+        return AES_SUCCESS;
+    }
+
+    atomic_store_explicit(&job->done, 0, memory_order_relaxed);
+    size_t submitted = atomic_fetch_add(&manager->submitted, 1) + 1;
+    queue_push(manager, job);
+
+#ifdef AES_HAVE_PTHREADS
+    // Pairs with jobs_sleep(): either it saw our count or we see it asleep.
+    if (atomic_load(&manager->sleeping) &&
+        submitted - atomic_load_explicit(&manager->popped, memory_order_relaxed) >=
+            atomic_load_explicit(&manager->wake_at, memory_order_relaxed))
+    {
+        pthread_mutex_lock(&manager->lock);
+        pthread_cond_signal(&manager->wake);
+        pthread_mutex_unlock(&manager->lock);
+    }
+#else
+    if (submitted - atomic_load_explicit(&manager->popped, memory_order_relaxed) >= manager->lanes)
+        jobs_drain(manager);
+#endif
+    return AES_SUCCESS;
+}
+
+aes_error_t aes_job_manager_flush(aes_job_manager_t* manager)
+{
+    if (!manager)
+        return AES_ERROR_INVALID_ARGUMENT;
+
+#ifdef AES_HAVE_PTHREADS
+    size_t target = atomic_load(&manager->submitted);
+
+    pthread_mutex_lock(&manager->lock);
+    atomic_fetch_add(&manager->flush_waiters, 1);
+    if (atomic_load(&manager->flush_target) < target)
+        atomic_store(&manager->flush_target, target);
+    pthread_cond_signal(&manager->wake);
+    while (atomic_load(&manager->completed) < target)
+        pthread_cond_wait(&manager->idle, &manager->lock);
+    atomic_fetch_sub(&manager->flush_waiters, 1);
+    pthread_mutex_unlock(&manager->lock);
+#else
+    jobs_drain(manager);
+#endif
+    return AES_SUCCESS;
+}
+
+int aes_job_done(const aes_job_t* job)
+{
+    return job && atomic_load_explicit(&job->done, memory_order_acquire);
+}
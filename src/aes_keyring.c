@@ -0,0 +1,340 @@
+/**
+ * @file aes_keyring.c
+ * @brief A shared store of expanded keys with lock-free lookup.
+ *
+ * @details Each key lives in its own cache-line-aligned entry, published in a
+ * slot array with a release store and found with a single acquire load. A
+ * handle carries the slot index (plus one) in its low 32 bits and the slot's
+ * generation in its high 32 bits, and the entry records its own handle, so a
+ * stale handle never resolves to a later key that reuses the slot.
+ *
+ * Reclamation is epoch based, with two reader counters per stripe selected by
+ * the parity of a global epoch. A reader increments the counter of the
+ * current parity and re-reads the epoch, retrying if it moved. A writer that
+ * has unpublished an entry advances the epoch and waits until the counters of
+ * the previous parity drain to zero: every reader that could have loaded the
+ * entry counted itself under that parity before the epoch moved, and every
+ * later reader loads the slot after the entry was unpublished. Threads are
+ * spread over the stripes, so readers rarely share a counter's cache line.
+ */
+
+#include "aes_internal.h"
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef AES_HAVE_PTHREADS
+#include <sched.h>
+#endif
+
+// Cache line size assumed for alignment and padding.
+#define KEYRING_CACHE_LINE 64
+
+// Number of reader counter stripes; threads are assigned round-robin.
+#define KEYRING_STRIPES 64
+
+// Largest capacity, so that slot index + 1 fits the low half of a handle.
+#define KEYRING_MAX_CAPACITY 0x7fffffffu
+
+//! One registered key.
+typedef struct
+{
+    aes_ctx_t        ctx;    /**< Both schedules, expanded once. */
+    aes_key_handle_t handle; /**< The handle this entry was registered under. */
+} keyring_entry_t;
+
+//! The reader counters of one stripe, on a cache line of their own.
+typedef struct
+{
+    _Alignas(KEYRING_CACHE_LINE) atomic_size_t count[2];
+} keyring_stripe_t;
+
+struct aes_keyring
+{
+    keyring_stripe_t stripes[KEYRING_STRIPES]; /**< Reader counters, by stripe and epoch parity. */
+    /** Advanced by every grace period. */
+    _Alignas(KEYRING_CACHE_LINE) atomic_size_t epoch;
+    atomic_flag                write_lock;  /**< Serializes add and remove. */
+    size_t                     capacity;    /**< The number of slots. */
+    size_t                     next_free;   /**< Where the next free-slot search starts. */
+    uint32_t*                  generations; /**< Per-slot generation, writer side only. */
+    _Atomic(keyring_entry_t*)* slots;       /**< The published entries. */
+};
+
+//! The stripe of the calling thread, assigned on its first read-side section.
+static _Thread_local unsigned thread_stripe = KEYRING_STRIPES;
+
+//! The next stripe to hand out.
+static atomic_uint next_stripe;
+
+/** @brief Returns the reader stripe of the calling thread. */
+static unsigned keyring_thread_stripe(void)
+{
+    if (thread_stripe == KEYRING_STRIPES)
+        thread_stripe = atomic_fetch_add_explicit(&next_stripe, 1, memory_order_relaxed) % KEYRING_STRIPES;
+    return thread_stripe;
+}
+
+/** @brief Yields the processor while waiting for a lock or a grace period. */
+static void keyring_pause(void)
+{
+#ifdef AES_HAVE_PTHREADS
+    sched_yield();
+#endif
+}
+
+/** @brief Acquires the writer lock. */
+static void keyring_write_lock(aes_keyring_t* keyring)
+{
+    while (atomic_flag_test_and_set_explicit(&keyring->write_lock, memory_order_acquire))
+        keyring_pause();
+}
+
+/** @brief Releases the writer lock. */
+static void keyring_write_unlock(aes_keyring_t* keyring)
+{
+    atomic_flag_clear_explicit(&keyring->write_lock, memory_order_release);
+}
+
+/**
+ * @brief Waits for a grace period: until every read-side section that began
+ * before the call has ended. Called with the writer lock held.
+ */
+static void keyring_synchronize(aes_keyring_t* keyring)
+{
+    size_t parity = atomic_fetch_add(&keyring->epoch, 1) & 1;
+
+    for (size_t i = 0; i < KEYRING_STRIPES; i++)
+    {
+        while (atomic_load(&keyring->stripes[i].count[parity]) != 0)
+            keyring_pause();
+    }
+}
+
+/** @brief Allocates a zeroed entry aligned to a cache line. */
+static keyring_entry_t* keyring_entry_alloc(void)
+{
+    size_t size = (sizeof(keyring_entry_t) + KEYRING_CACHE_LINE - 1) / KEYRING_CACHE_LINE * KEYRING_CACHE_LINE;
+#ifdef _MSC_VER
+    keyring_entry_t* entry = _aligned_malloc(size, KEYRING_CACHE_LINE);
+#else
+    keyring_entry_t* entry = aligned_alloc(KEYRING_CACHE_LINE, size);
+#endif
+    if (entry)
+        memset(entry, 0, sizeof(*entry));
+    return entry;
+}
+
+/** @brief Wipes and frees an entry. */
+static void keyring_entry_free(keyring_entry_t* entry)
+{
+    if (!entry)
+        return;
+    secure_zero_memory(entry, sizeof(*entry));
+#ifdef _MSC_VER
+    _aligned_free(entry);
+#else
+    free(entry);
+#endif
+}
+
+aes_error_t aes_keyring_create(aes_keyring_t** keyring, size_t capacity)
+{
+    if (!keyring || capacity == 0 || capacity > KEYRING_MAX_CAPACITY)
+        return AES_ERROR_INVALID_ARGUMENT;
+
+#ifdef _MSC_VER
+    aes_keyring_t* ring = _aligned_malloc(sizeof(*ring), KEYRING_CACHE_LINE);
+#else
+    aes_keyring_t* ring = aligned_alloc(KEYRING_CACHE_LINE, sizeof(*ring));
+#endif
+    if (!ring)
+    {
+        AES_STATS_ALLOCATION_FAILED();
+        return AES_ERROR_MEMORY_ALLOCATION_FAILED;
+    }
+
+    memset(ring, 0, sizeof(*ring));
+    for (size_t i = 0; i < KEYRING_STRIPES; i++)
+    {
+        atomic_init(&ring->stripes[i].count[0], 0);
+        atomic_init(&ring->stripes[i].count[1], 0);
+    }
+    atomic_init(&ring->epoch, 0);
+    atomic_flag_clear(&ring->write_lock);
+    ring->capacity    = capacity;
+    ring->generations = calloc(capacity, sizeof(*ring->generations));
+    ring->slots       = calloc(capacity, sizeof(*ring->slots));
+    if (!ring->generations || !ring->slots)
+    {
+        aes_keyring_destroy(ring);
+        AES_STATS_ALLOCATION_FAILED();
+        return AES_ERROR_MEMORY_ALLOCATION_FAILED;
+    }
+    for (size_t i = 0; i < capacity; i++)
+        atomic_init(&ring->slots[i], NULL);
+
+    *keyring = ring;
+    return AES_SUCCESS;
+}
+
+void aes_keyring_destroy(aes_keyring_t* keyring)
+{
+    if (!keyring)
+        return;
+
+    if (keyring->slots)
+    {
+        for (size_t i = 0; i < keyring->capacity; i++)
+            keyring_entry_free(atomic_load_explicit(&keyring->slots[i], memory_order_relaxed));
+    }
+    free(keyring->slots);
+    free(keyring->generations);
+#ifdef _MSC_VER
+    _aligned_free(keyring);
+#else
+    free(keyring);
+#endif
+}
+
+aes_error_t aes_keyring_add(aes_keyring_t* keyring, const uint8_t* key, aes_key_size_t key_size,
+                            aes_backend_t backend, aes_key_handle_t* handle)
+{
+    if (!keyring || !key || !handle)
+        return AES_ERROR_INVALID_ARGUMENT;
+
+    // Expand outside the lock; only the slot search is serialized.
+    keyring_entry_t* entry = keyring_entry_alloc();
+    if (!entry)
+    {
+        AES_STATS_ALLOCATION_FAILED();
+        return AES_ERROR_MEMORY_ALLOCATION_FAILED;
+    }
+    aes_error_t result = aes_ctx_init_backend(&entry->ctx, key, key_size, backend);
+    if (result != AES_SUCCESS)
+    {
+        keyring_entry_free(entry);
+        return result;
+    }
+
+    keyring_write_lock(keyring);
+    size_t index = keyring->capacity;
+    for (size_t n = 0; n < keyring->capacity; n++)
+    {
+        size_t i = (keyring->next_free + n) % keyring->capacity;
+        if (!atomic_load_explicit(&keyring->slots[i], memory_order_relaxed))
+        {
+            index = i;
+            break;
+        }
+    }
+    if (index == keyring->capacity)
+    {
+        keyring_write_unlock(keyring);
+        keyring_entry_free(entry);
+        return AES_ERROR_KEYRING_FULL;
+    }
+
+    // Generation 0 is skipped on wrap-around; a handle can only repeat after
+    // its slot has been reused 2^32 times.
+    uint32_t generation = ++keyring->generations[index];
+    if (generation == 0)
+        generation = ++keyring->generations[index];
+    entry->handle = ((aes_key_handle_t)generation << 32) | (aes_key_handle_t)(index + 1);
+    *handle       = entry->handle;
+
+    atomic_store_explicit(&keyring->slots[index], entry, memory_order_release);
+    keyring->next_free = (index + 1) % keyring->capacity;
+    keyring_write_unlock(keyring);
+    return AES_SUCCESS;
+}
+
+aes_error_t aes_keyring_remove(aes_keyring_t* keyring, aes_key_handle_t handle)
+{
+    size_t index = (size_t)(handle & 0xffffffffu) - 1;
+
+    if (!keyring)
+        return AES_ERROR_INVALID_ARGUMENT;
+    if ((handle & 0xffffffffu) == 0 || index >= keyring->capacity)
+        return AES_ERROR_KEY_NOT_FOUND;
+
+    keyring_write_lock(keyring);
+    keyring_entry_t* entry = atomic_load_explicit(&keyring->slots[index], memory_order_relaxed);
+    if (!entry || entry->handle != handle)
+    {
+        keyring_write_unlock(keyring);
+        return AES_ERROR_KEY_NOT_FOUND;
+    }
+
+    // Unpublish, wait out the readers that may hold the entry, then wipe it.
+    atomic_store(&keyring->slots[index], NULL);
+    keyring_synchronize(keyring);
+    keyring_write_unlock(keyring);
+
+    keyring_entry_free(entry);
+    return AES_SUCCESS;
+}
+
+unsigned aes_keyring_read_begin(aes_keyring_t* keyring)
+{
+    unsigned stripe = keyring_thread_stripe();
+
+    for (;;)
+    {
+        size_t epoch  = atomic_load(&keyring->epoch);
+        size_t parity = epoch & 1;
+        atomic_fetch_add(&keyring->stripes[stripe].count[parity], 1);
+        if (atomic_load(&keyring->epoch) == epoch)
+            return stripe * 2 + (unsigned)parity;
+        atomic_fetch_sub(&keyring->stripes[stripe].count[parity], 1);
+    }
+}
+
+void aes_keyring_read_end(aes_keyring_t* keyring, unsigned token)
+{
+    atomic_fetch_sub_explicit(&keyring->stripes[token / 2].count[token & 1], 1, memory_order_release);
+}
+
+const aes_ctx_t* aes_keyring_lookup(const aes_keyring_t* keyring, aes_key_handle_t handle)
+{
+    size_t index = (size_t)(handle & 0xffffffffu) - 1;
+
+    if (!keyring || (handle & 0xffffffffu) == 0 || index >= keyring->capacity)
+        return NULL;
+
+    const keyring_entry_t* entry = atomic_load_explicit(&keyring->slots[index], memory_order_acquire);
+    return entry && entry->handle == handle ? &entry->ctx : NULL;
+}
+
+/**
+ * @brief Runs ECB under a registered key inside a read-side section.
+ * @return AES_SUCCESS, AES_ERROR_KEY_NOT_FOUND or the error of the ECB call.
+ */
+static aes_error_t keyring_ecb(aes_keyring_t* keyring, aes_key_handle_t handle, int encrypt, const uint8_t* in,
+                               uint8_t* out, size_t length)
+{
+    if (!keyring)
+        return AES_ERROR_INVALID_ARGUMENT;
+
+    unsigned         token  = aes_keyring_read_begin(keyring);
+    const aes_ctx_t* ctx    = aes_keyring_lookup(keyring, handle);
+    aes_error_t      result = AES_ERROR_KEY_NOT_FOUND;
+    if (ctx)
+        result = encrypt ? aes_ecb_encrypt(ctx, in, out, length) : aes_ecb_decrypt(ctx, in, out, length);
+    aes_keyring_read_end(keyring, token);
+    return result;
+}
+
+aes_error_t aes_keyring_ecb_encrypt(aes_keyring_t* keyring, aes_key_handle_t handle, const uint8_t* in, uint8_t* out,
+                                    size_t length)
+{
+    return keyring_ecb(keyring, handle, 1, in, out, length);
+}
+
+aes_error_t aes_keyring_ecb_decrypt(aes_keyring_t* keyring, aes_key_handle_t handle, const uint8_t* in, uint8_t* out,
+                                    size_t length)
+{
+    return keyring_ecb(keyring, handle, 0, in, out, length);
+}
@@ -0,0 +1,388 @@
+/**
+ * @file aes_mac.c
+ * @brief CMAC (NIST SP 800-38B, RFC 4493) and PMAC message authentication.
+ *
+ * @details CMAC is a CBC-MAC whose last block is masked with one of two
+ * subkeys derived from L = E(K, 0^128) by doubling in GF(2^128). Every block
+ * depends on the previous one, so it runs one block cipher call at a time;
+ * the key schedule and the subkeys are derived once per context.
+ *
+ * PMAC (in its PMAC1 form) instead encrypts each block under its own offset,
+ * the Gray-code combination of the multiples L.x^i, and XORs the results
+ * together. A run of blocks can therefore be summed from its starting index
+ * alone: runs go through the backend's multi-block kernel in batches, and
+ * the engine splits long runs across threads.
+ *
+ * Both hold back the last block of the input seen so far, since the block
+ * that ends the message is masked differently.
+ */
+
+#include "aes_internal.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// Blocks encrypted per backend call on the PMAC bulk path.
+#define PMAC_BATCH_BLOCKS AES_CTR_BATCH_BLOCKS
+
+/* ============================================================================
+ * Shared Helpers
+ * ========================================================================= */
+
+/** @brief Multiplies a big-endian element of GF(2^128) by x^-1, in constant time; out may equal in. */
+static void gf128_halve(uint8_t* out, const uint8_t* in)
+{
+    // x^-1 = x^127 + x^6 + x + 1 modulo x^128 + x^7 + x^2 + x + 1.
+    uint8_t mask = (uint8_t)-(in[AES_BLOCK_SIZE - 1] & 1);
+
+    for (size_t i = AES_BLOCK_SIZE - 1; i > 0; i--)
+        out[i] = (uint8_t)((in[i] >> 1) | (in[i - 1] << 7));
+    out[0] = (uint8_t)((in[0] >> 1) ^ (mask & 0x80));
+    out[AES_BLOCK_SIZE - 1] ^= mask & 0x43;
+}
+
+/**
+ * @brief Pads a partial final block with a single 1 bit and zeros (10*).
+ * @param[in,out] block The block, of which the first length bytes are data.
+ * @param[in] length The number of data bytes, less than AES_BLOCK_SIZE.
+ */
+static void pad_block(uint8_t* block, size_t length)
+{
+    block[length] = 0x80;
+    memset(block + length + 1, 0, AES_BLOCK_SIZE - length - 1);
+}
+
+/**
+ * @brief Copies a tag out and wipes the full-length value.
+ * @return AES_SUCCESS.
+ */
+static aes_error_t emit_tag(uint8_t* full_tag, uint8_t* tag, size_t tag_len)
+{
+    memcpy(tag, full_tag, tag_len);
+    secure_zero_memory(full_tag, AES_BLOCK_SIZE);
+    return AES_SUCCESS;
+}
+
+/**
+ * @brief Compares a computed tag with a received one in constant time and wipes the computed one.
+ * @return AES_SUCCESS if they match, AES_ERROR_AUTHENTICATION_FAILED otherwise.
+ */
+static aes_error_t compare_tag(uint8_t* full_tag, const uint8_t* tag, size_t tag_len)
+{
+    // Accumulate every difference before deciding.
+    uint8_t diff = 0;
+    for (size_t i = 0; i < tag_len; i++)
+        diff |= (uint8_t)(full_tag[i] ^ tag[i]);
+
+    secure_zero_memory(full_tag, AES_BLOCK_SIZE);
+    return diff == 0 ? AES_SUCCESS : AES_ERROR_AUTHENTICATION_FAILED;
+}
+
+/**
+ * @brief Validates the arguments of the final and verify functions.
+ * @return AES_SUCCESS, AES_ERROR_INVALID_ARGUMENT or AES_ERROR_INVALID_LENGTH.
+ */
+static aes_error_t check_tag_args(const aes_ctx_t* cipher, const uint8_t* tag, size_t tag_len)
+{
+    if (!cipher->backend || !tag)
+        return AES_ERROR_INVALID_ARGUMENT;
+    if (tag_len == 0 || tag_len > AES_BLOCK_SIZE)
+        return AES_ERROR_INVALID_LENGTH;
+    return AES_SUCCESS;
+}
+
+/* ============================================================================
+ * CMAC
+ * ========================================================================= */
+
+/** @brief Starts a new message under the same key. */
+static void cmac_reset(aes_cmac_ctx_t* cmac)
+{
+    memset(cmac->state, 0, sizeof(cmac->state));
+    memset(cmac->buffer, 0, sizeof(cmac->buffer));
+    cmac->buffered = 0;
+}
+
+/**
+ * @brief Masks and encrypts the final block, then starts a new message.
+ * @param[in,out] cmac The context.
+ * @param[out] full_tag Receives the untruncated tag.
+ */
+static void cmac_finish(aes_cmac_ctx_t* cmac, uint8_t* full_tag)
+{
+    if (cmac->buffered == AES_BLOCK_SIZE)
+    {
+        xor_bytes(cmac->buffer, cmac->buffer, cmac->k1, AES_BLOCK_SIZE);
+    }
+    else
+    {
+        pad_block(cmac->buffer, cmac->buffered);
+        xor_bytes(cmac->buffer, cmac->buffer, cmac->k2, AES_BLOCK_SIZE);
+    }
+    xor_bytes(full_tag, cmac->state, cmac->buffer, AES_BLOCK_SIZE);
+    cmac->cipher.encrypt_blocks(&cmac->cipher, full_tag, full_tag, 1);
+    cmac_reset(cmac);
+}
+
+aes_error_t aes_cmac_init(aes_cmac_ctx_t* cmac, const uint8_t* key, aes_key_size_t key_size, aes_backend_t backend)
+{
+    if (!cmac)
+        return AES_ERROR_INVALID_ARGUMENT;
+
+    aes_error_t result = aes_ctx_init_ex(&cmac->cipher, key, key_size, backend, AES_KEY_USAGE_ENCRYPT);
+    if (result != AES_SUCCESS)
+        return result;
+
+    uint8_t l[AES_BLOCK_SIZE] = {0};
+    cmac->cipher.encrypt_blocks(&cmac->cipher, l, l, 1);
+    aes_gf128_double(cmac->k1, l);
+    aes_gf128_double(cmac->k2, cmac->k1);
+    secure_zero_memory(l, sizeof(l));
+
+    cmac_reset(cmac);
+    return AES_SUCCESS;
+}
+
+/** @brief Chains message bytes into the CMAC state, always holding the last block back. */
+static void cmac_absorb(aes_cmac_ctx_t* cmac, const uint8_t* data, size_t length)
+{
+    const aes_ctx_t* ctx = &cmac->cipher;
+
+    // Top up the held-back block; it is chained only once more input follows it.
+    if (cmac->buffered > 0)
+    {
+        size_t take = AES_BLOCK_SIZE - cmac->buffered < length ? AES_BLOCK_SIZE - cmac->buffered : length;
+        memcpy(cmac->buffer + cmac->buffered, data, take);
+        cmac->buffered += take;
+        data += take;
+        length -= take;
+        if (length == 0)
+            return;
+
+        xor_bytes(cmac->state, cmac->state, cmac->buffer, AES_BLOCK_SIZE);
+        ctx->encrypt_blocks(ctx, cmac->state, cmac->state, 1);
+        cmac->buffered = 0;
+    }
+
+    for (; length > AES_BLOCK_SIZE; data += AES_BLOCK_SIZE, length -= AES_BLOCK_SIZE)
+    {
+        xor_bytes(cmac->state, cmac->state, data, AES_BLOCK_SIZE);
+        ctx->encrypt_blocks(ctx, cmac->state, cmac->state, 1);
+    }
+
+    memcpy(cmac->buffer, data, length);
+    cmac->buffered = length;
+}
+
+aes_error_t aes_cmac_update(aes_cmac_ctx_t* cmac, const uint8_t* data, size_t length)
+{
+    if (!cmac || !cmac->cipher.backend || (length && !data))
+        return AES_ERROR_INVALID_ARGUMENT;
+    if (length == 0)
+        return AES_SUCCESS;
+
+    AES_STATS_BEGIN(start);
+    cmac_absorb(cmac, data, length);
+    AES_STATS_RECORD(AES_STATS_MAC, cmac->cipher.backend->id, length, start);
+    return AES_SUCCESS;
+}
+
+aes_error_t aes_cmac_final(aes_cmac_ctx_t* cmac, uint8_t* tag, size_t tag_len)
+{
+    uint8_t full_tag[AES_BLOCK_SIZE];
+
+    if (!cmac)
+        return AES_ERROR_INVALID_ARGUMENT;
+    aes_error_t result = check_tag_args(&cmac->cipher, tag, tag_len);
+    if (result != AES_SUCCESS)
+        return result;
+
+    cmac_finish(cmac, full_tag);
+    return emit_tag(full_tag, tag, tag_len);
+}
+
+aes_error_t aes_cmac_verify(aes_cmac_ctx_t* cmac, const uint8_t* tag, size_t tag_len)
+{
+    uint8_t full_tag[AES_BLOCK_SIZE];
+
+    if (!cmac)
+        return AES_ERROR_INVALID_ARGUMENT;
+    aes_error_t result = check_tag_args(&cmac->cipher, tag, tag_len);
+    if (result != AES_SUCCESS)
+        return result;
+
+    cmac_finish(cmac, full_tag);
+    return compare_tag(full_tag, tag, tag_len);
+}
+
+void aes_cmac_clear(aes_cmac_ctx_t* cmac)
+{
+    secure_zero_memory(cmac, cmac ? sizeof(*cmac) : 0);
+}
+
+/* ============================================================================
+ * PMAC
+ * ========================================================================= */
+
+/** @brief Starts a new message under the same key. */
+static void pmac_reset(aes_pmac_ctx_t* pmac)
+{
+    memset(pmac->sigma, 0, sizeof(pmac->sigma));
+    memset(pmac->buffer, 0, sizeof(pmac->buffer));
+    pmac->buffered   = 0;
+    pmac->num_blocks = 0;
+}
+
+/**
+ * @brief Folds in the final block, encrypts the sum, then starts a new message.
+ * @param[in,out] pmac The context.
+ * @param[out] full_tag Receives the untruncated tag.
+ */
+static void pmac_finish(aes_pmac_ctx_t* pmac, uint8_t* full_tag)
+{
+    if (pmac->buffered == AES_BLOCK_SIZE)
+        xor_bytes(pmac->buffer, pmac->buffer, pmac->l_inv, AES_BLOCK_SIZE);
+    else
+        pad_block(pmac->buffer, pmac->buffered);
+    xor_bytes(full_tag, pmac->sigma, pmac->buffer, AES_BLOCK_SIZE);
+    pmac->cipher.encrypt_blocks(&pmac->cipher, full_tag, full_tag, 1);
+    pmac_reset(pmac);
+}
+
+void aes_pmac_sum_blocks(const aes_pmac_ctx_t* pmac, const aes_ctx_t* cipher, uint64_t first, const uint8_t* data,
+                         size_t num_blocks, uint8_t* sum)
+{
+    uint8_t  batch[PMAC_BATCH_BLOCKS * AES_BLOCK_SIZE];
+    uint8_t  offset[AES_BLOCK_SIZE] = {0};
+    uint64_t index                  = first;
+
+    // The offset before block i is the XOR of L.x^b over the set bits b of the Gray code of i - 1.
+    uint64_t gray = (first - 1) ^ ((first - 1) >> 1);
+    for (size_t b = 0; gray != 0; b++, gray >>= 1)
+        if (gray & 1)
+            xor_bytes(offset, offset, pmac->l[b], AES_BLOCK_SIZE);
+
+    while (num_blocks > 0)
+    {
+        size_t n = num_blocks < PMAC_BATCH_BLOCKS ? num_blocks : PMAC_BATCH_BLOCKS;
+
+        for (size_t i = 0; i < n; i++, index++)
+        {
+            xor_bytes(offset, offset, pmac->l[aes_ntz64(index)], AES_BLOCK_SIZE);
+            xor_bytes(batch + i * AES_BLOCK_SIZE, data + i * AES_BLOCK_SIZE, offset, AES_BLOCK_SIZE);
+        }
+        cipher->encrypt_blocks(cipher, batch, batch, n);
+        for (size_t i = 0; i < n; i++)
+            xor_bytes(sum, sum, batch + i * AES_BLOCK_SIZE, AES_BLOCK_SIZE);
+
+        data += n * AES_BLOCK_SIZE;
+        num_blocks -= n;
+    }
+
+    secure_zero_memory(batch, sizeof(batch));
+    secure_zero_memory(offset, sizeof(offset));
+}
+
+/** @brief aes_pmac_sum_fn that sums on the calling thread. */
+static void sum_on_caller(const aes_pmac_ctx_t* pmac, uint64_t first, const uint8_t* data, size_t num_blocks,
+                          uint8_t* sum, void* arg)
+{
+    (void)arg;
+    aes_pmac_sum_blocks(pmac, &pmac->cipher, first, data, num_blocks, sum);
+}
+
+void aes_pmac_absorb(aes_pmac_ctx_t* pmac, const uint8_t* data, size_t length, aes_pmac_sum_fn sum_blocks, void* arg)
+{
+    if (length == 0)
+        return;
+
+    // Top up the held-back block; it is summed only once more input follows it.
+    if (pmac->buffered > 0)
+    {
+        size_t take = AES_BLOCK_SIZE - pmac->buffered < length ? AES_BLOCK_SIZE - pmac->buffered : length;
+        memcpy(pmac->buffer + pmac->buffered, data, take);
+        pmac->buffered += take;
+        data += take;
+        length -= take;
+        if (length == 0)
+            return;
+
+        aes_pmac_sum_blocks(pmac, &pmac->cipher, ++pmac->num_blocks, pmac->buffer, 1, pmac->sigma);
+        pmac->buffered = 0;
+    }
+
+    size_t num_blocks = (length - 1) / AES_BLOCK_SIZE;
+    if (num_blocks > 0)
+    {
+        sum_blocks(pmac, pmac->num_blocks + 1, data, num_blocks, pmac->sigma, arg);
+        pmac->num_blocks += num_blocks;
+        data += num_blocks * AES_BLOCK_SIZE;
+        length -= num_blocks * AES_BLOCK_SIZE;
+    }
+
+    memcpy(pmac->buffer, data, length);
+    pmac->buffered = length;
+}
+
+aes_error_t aes_pmac_init(aes_pmac_ctx_t* pmac, const uint8_t* key, aes_key_size_t key_size, aes_backend_t backend)
+{
+    if (!pmac)
+        return AES_ERROR_INVALID_ARGUMENT;
+
+    aes_error_t result = aes_ctx_init_ex(&pmac->cipher, key, key_size, backend, AES_KEY_USAGE_ENCRYPT);
+    if (result != AES_SUCCESS)
+        return result;
+
+    memset(pmac->l[0], 0, AES_BLOCK_SIZE);
+    pmac->cipher.encrypt_blocks(&pmac->cipher, pmac->l[0], pmac->l[0], 1);
+    for (size_t i = 1; i < AES_PMAC_L_COUNT; i++)
+        aes_gf128_double(pmac->l[i], pmac->l[i - 1]);
+    gf128_halve(pmac->l_inv, pmac->l[0]);
+
+    pmac_reset(pmac);
+    return AES_SUCCESS;
+}
+
+aes_error_t aes_pmac_update(aes_pmac_ctx_t* pmac, const uint8_t* data, size_t length)
+{
+    if (!pmac || !pmac->cipher.backend || (length && !data))
+        return AES_ERROR_INVALID_ARGUMENT;
+
+    AES_STATS_BEGIN(start);
+    aes_pmac_absorb(pmac, data, length, sum_on_caller, NULL);
+    AES_STATS_RECORD(AES_STATS_MAC, pmac->cipher.backend->id, length, start);
+    return AES_SUCCESS;
+}
+
+aes_error_t aes_pmac_final(aes_pmac_ctx_t* pmac, uint8_t* tag, size_t tag_len)
+{
+    uint8_t full_tag[AES_BLOCK_SIZE];
+
+    if (!pmac)
+        return AES_ERROR_INVALID_ARGUMENT;
+    aes_error_t result = check_tag_args(&pmac->cipher, tag, tag_len);
+    if (result != AES_SUCCESS)
+        return result;
+
+    pmac_finish(pmac, full_tag);
+    return emit_tag(full_tag, tag, tag_len);
+}
+
+aes_error_t aes_pmac_verify(aes_pmac_ctx_t* pmac, const uint8_t* tag, size_t tag_len)
+{
+    uint8_t full_tag[AES_BLOCK_SIZE];
+
+    if (!pmac)
+        return AES_ERROR_INVALID_ARGUMENT;
+    aes_error_t result = check_tag_args(&pmac->cipher, tag, tag_len);
+    if (result != AES_SUCCESS)
+        return result;
+
+    pmac_finish(pmac, full_tag);
+    return compare_tag(full_tag, tag, tag_len);
+}
+
+void aes_pmac_clear(aes_pmac_ctx_t* pmac)
+{
+    secure_zero_memory(pmac, pmac ? sizeof(*pmac) : 0);
+}
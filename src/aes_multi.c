@@ -0,0 +1,114 @@
+/**
+ * @file aes_multi.c
+ * @brief Batches of single blocks under many independent keys.
+ *
+ * @details The context array is split into runs of neighbours that share a
+ * backend and a round count. Each run goes to the backend's multi-key kernel,
+ * which interleaves the blocks across its lanes; backends without one fall
+ * back to one block per call.
+ */
+
+#include "aes_internal.h"
+#include <stddef.h>
+#include <stdint.h>
+
+// Keys expanded per batch by aes_multi_encrypt_keys().
+#define MULTI_KEY_BATCH 16
+
+void aes_multi_blocks(const aes_ctx_t* const* ctxs, int encrypt, const uint8_t* in, uint8_t* out, size_t num_blocks)
+{
+    while (num_blocks > 0)
+    {
+        const aes_backend_ops_t* backend = ctxs[0]->backend;
+        size_t                   run     = 1;
+        while (run < num_blocks && ctxs[run]->backend == backend && ctxs[run]->num_rounds == ctxs[0]->num_rounds)
+            run++;
+
+        void (*kernel)(const aes_ctx_t* const*, const uint8_t*, uint8_t*, size_t) =
+            encrypt ? backend->encrypt_multi : backend->decrypt_multi;
+        if (kernel)
+        {
+            kernel(ctxs, in, out, run);
+        }
+        else
+        {
+            for (size_t i = 0; i < run; i++)
+            {
+                const uint8_t* src = in + i * AES_BLOCK_SIZE;
+                uint8_t*       dst = out + i * AES_BLOCK_SIZE;
+                if (encrypt)
+                    ctxs[i]->encrypt_blocks(ctxs[i], src, dst, 1);
+                else
+                    ctxs[i]->decrypt_blocks(ctxs[i], src, dst, 1);
+            }
+        }
+
+        ctxs += run;
+        in += run * AES_BLOCK_SIZE;
+        out += run * AES_BLOCK_SIZE;
+        num_blocks -= run;
+    }
+}
+
+/**
+ * @brief Validates the arguments of the context-array entry points.
+ * @return AES_SUCCESS, or AES_ERROR_INVALID_ARGUMENT.
+ */
+static aes_error_t multi_check(const aes_ctx_t* const* ctxs, int encrypt, const uint8_t* in, const uint8_t* out,
+                               size_t num_blocks)
+{
+    if (num_blocks && (!ctxs || !in || !out))
+        return AES_ERROR_INVALID_ARGUMENT;
+    for (size_t i = 0; i < num_blocks; i++)
+    {
+        if (encrypt ? !ctx_can_encrypt(ctxs[i]) : !ctx_can_decrypt(ctxs[i]))
+            return AES_ERROR_INVALID_ARGUMENT;
+    }
+    return AES_SUCCESS;
+}
+
+aes_error_t aes_multi_encrypt(const aes_ctx_t* const* ctxs, const uint8_t* in, uint8_t* out, size_t num_blocks)
+{
+    aes_error_t result = multi_check(ctxs, 1, in, out, num_blocks);
+    if (result == AES_SUCCESS)
+        aes_multi_blocks(ctxs, 1, in, out, num_blocks);
+    return result;
+}
+
+aes_error_t aes_multi_decrypt(const aes_ctx_t* const* ctxs, const uint8_t* in, uint8_t* out, size_t num_blocks)
+{
+    aes_error_t result = multi_check(ctxs, 0, in, out, num_blocks);
+    if (result == AES_SUCCESS)
+        aes_multi_blocks(ctxs, 0, in, out, num_blocks);
+    return result;
+}
+
+aes_error_t aes_multi_encrypt_keys(const uint8_t* keys, aes_key_size_t key_size, const uint8_t* in, uint8_t* out,
+                                   size_t num_blocks)
+{
+    aes_ctx_t        ctxs[MULTI_KEY_BATCH];
+    const aes_ctx_t* ptrs[MULTI_KEY_BATCH];
+    aes_error_t      result = AES_SUCCESS;
+
+    if (num_blocks && (!keys || !in || !out))
+        return AES_ERROR_INVALID_ARGUMENT;
+
+    while (num_blocks > 0 && result == AES_SUCCESS)
+    {
+        size_t count = num_blocks < MULTI_KEY_BATCH ? num_blocks : MULTI_KEY_BATCH;
+
+        result = aes_ctx_init_batch(ctxs, keys, key_size, count, AES_BACKEND_AUTO, AES_KEY_USAGE_ENCRYPT);
+        for (size_t i = 0; i < count; i++)
+            ptrs[i] = &ctxs[i];
+        if (result == AES_SUCCESS)
+            aes_multi_blocks(ptrs, 1, in, out, count);
+
+        keys += count * (size_t)key_size;
+        in += count * AES_BLOCK_SIZE;
+        out += count * AES_BLOCK_SIZE;
+        num_blocks -= count;
+    }
+
+    secure_zero_memory(ctxs, sizeof(ctxs));
+    return result;
+}
@@ -0,0 +1,548 @@
+/**
+ * @file aes_ni.c
+ * @brief The x86 AES-NI hardware backend.
+ *
+ * @details Rounds are executed by aesenc/aesenclast and aesdec/aesdeclast,
+ * and the key schedule takes its S-box from aesenclast. Decryption uses the
+ * equivalent inverse cipher, so the decryption schedule is the encryption
+ * schedule in reverse with aesimc applied to the middle round keys. Multi-block
+ * calls keep eight independent blocks in flight to hide the round latency, as
+ * do the multi-key calls with a different key schedule per block, and CTR and
+ * XTS have fused kernels that derive their counters or tweaks in registers
+ * alongside the rounds. Batched key setup expands four schedules side by side.
+ *
+ * This translation unit is compiled with AES-NI code generation enabled; its
+ * functions are only reached after aes_cpu_features() has reported support.
+ */
+
+#include "aes_internal.h"
+
+#ifdef AES_ARCH_X86
+
+#include <stddef.h>
+#include <stdint.h>
+#include <wmmintrin.h>
+
+// Number of independent blocks interleaved by the multi-block loops.
+#define AESNI_LANES 8
+
+/**
+ * @brief Computes SubWord(RotWord(w)) ^ rcon for a word broadcast to all four dwords.
+ * @details aesenclast applies ShiftRows, SubBytes and an XOR with its key.
+ * ShiftRows moves bytes between columns, which changes nothing when every
+ * column holds the same word, so this is the schedule's S-box step. It
+ * replaces aeskeygenassist, which is microcoded on many cores with several
+ * times the latency and a fraction of the throughput of aesenclast.
+ */
+static inline __m128i keygen_assist(__m128i word, int rcon)
+{
+    __m128i rotated = _mm_or_si128(_mm_srli_epi32(word, 8), _mm_slli_epi32(word, 24));
+    return _mm_aesenclast_si128(rotated, _mm_set1_epi32(rcon));
+}
+
+/** @brief Completes one AES-128 schedule step from the broadcast keygen_assist() result. */
+static inline __m128i expand_128_step(__m128i key, __m128i assist)
+{
+    key    = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+    key    = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+    key    = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+    return _mm_xor_si128(key, assist);
+}
+
+/** @brief Computes the odd (SubWord without rotation) half-step of the AES-256 schedule. */
+static inline __m128i expand_256_odd_step(__m128i prev, __m128i key)
+{
+    __m128i assist = _mm_aesenclast_si128(_mm_shuffle_epi32(prev, 0xff), _mm_setzero_si128());
+    key            = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+    key            = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+    key            = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+    return _mm_xor_si128(key, assist);
+}
+
+/** @brief Completes one AES-192 schedule step, advancing the four low and two high key words. */
+static inline void expand_192_step(__m128i* lo, __m128i* hi, __m128i assist)
+{
+    __m128i key = *lo;
+    __m128i ext = *hi;
+
+    key    = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+    key    = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+    key    = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+    key    = _mm_xor_si128(key, assist);
+    ext    = _mm_xor_si128(ext, _mm_slli_si128(ext, 4));
+    ext    = _mm_xor_si128(ext, _mm_shuffle_epi32(key, 0xff));
+    *lo    = key;
+    *hi    = ext;
+}
+
+/** @brief Combines one 64-bit half of each register, as selected by _mm_shuffle_pd. */
+#define JOIN_64(lo, hi, imm) _mm_castpd_si128(_mm_shuffle_pd(_mm_castsi128_pd(lo), _mm_castsi128_pd(hi), (imm)))
+
+// The schedule macros advance every lane by one step before moving to the
+// next, so the aesenclast latency of one key overlaps the others.
+#define EXPAND_128(i, rcon)                                                                                            \
+    for (size_t l = 0; l < count; l++)                                                                                 \
+    rk[l][i] = expand_128_step(rk[l][(i)-1], keygen_assist(_mm_shuffle_epi32(rk[l][(i)-1], 0xff), (rcon)))
+
+#define EXPAND_192(i, rcon_a, rcon_b)                                                                                  \
+    for (size_t l = 0; l < count; l++)                                                                                 \
+    {                                                                                                                  \
+        __m128i prev = hi[l];                                                                                          \
+        expand_192_step(&lo[l], &hi[l], keygen_assist(_mm_shuffle_epi32(hi[l], 0x55), (rcon_a)));                      \
+        rk[l][i]     = JOIN_64(prev, lo[l], 0);                                                                        \
+        rk[l][i + 1] = JOIN_64(lo[l], hi[l], 1);                                                                       \
+        expand_192_step(&lo[l], &hi[l], keygen_assist(_mm_shuffle_epi32(hi[l], 0x55), (rcon_b)));                      \
+        rk[l][i + 2] = lo[l];                                                                                          \
+    }
+
+#define EXPAND_256(i, rcon)                                                                                            \
+    for (size_t l = 0; l < count; l++)                                                                                 \
+    {                                                                                                                  \
+        rk[l][i] = expand_128_step(rk[l][(i)-2], keygen_assist(_mm_shuffle_epi32(rk[l][(i)-1], 0xff), (rcon)));        \
+        if ((i) + 1 < 15)                                                                                              \
+            rk[l][(i) + 1] = expand_256_odd_step(rk[l][i], rk[l][(i)-1]);                                              \
+    }
+
+// Number of keys whose schedules are expanded side by side.
+#define AESNI_KEY_LANES 4
+
+/** @brief Encrypts consecutive blocks, eight at a time while enough remain. */
+static inline void aesni_encrypt(const aes_ctx_t* ctx, const uint8_t* in, uint8_t* out, size_t num_blocks,
+                                 const size_t nr)
+{
+    const __m128i* rk = (const __m128i*)ctx->round_keys;
+    __m128i        b[AESNI_LANES];
+
+    for (; num_blocks >= AESNI_LANES; num_blocks -= AESNI_LANES)
+    {
+        for (int l = 0; l < AESNI_LANES; l++)
+            b[l] = _mm_xor_si128(_mm_loadu_si128((const __m128i*)(in + l * AES_BLOCK_SIZE)), rk[0]);
+        for (size_t r = 1; r < nr; r++)
+        {
+            __m128i k = _mm_load_si128(rk + r);
+            for (int l = 0; l < AESNI_LANES; l++)
+                b[l] = _mm_aesenc_si128(b[l], k);
+        }
+        for (int l = 0; l < AESNI_LANES; l++)
+            _mm_storeu_si128((__m128i*)(out + l * AES_BLOCK_SIZE), _mm_aesenclast_si128(b[l], rk[nr]));
+        in += AESNI_LANES * AES_BLOCK_SIZE;
+        out += AESNI_LANES * AES_BLOCK_SIZE;
+    }
+
+    for (; num_blocks > 0; num_blocks--, in += AES_BLOCK_SIZE, out += AES_BLOCK_SIZE)
+    {
+        __m128i s = _mm_xor_si128(_mm_loadu_si128((const __m128i*)in), rk[0]);
+        for (size_t r = 1; r < nr; r++)
+            s = _mm_aesenc_si128(s, rk[r]);
+        _mm_storeu_si128((__m128i*)out, _mm_aesenclast_si128(s, rk[nr]));
+    }
+}
+
+/** @brief Decrypts consecutive blocks, eight at a time while enough remain. */
+static inline void aesni_decrypt(const aes_ctx_t* ctx, const uint8_t* in, uint8_t* out, size_t num_blocks,
+                                 const size_t nr)
+{
+    const __m128i* rk = (const __m128i*)ctx->dec_round_keys;
+    __m128i        b[AESNI_LANES];
+
+    for (; num_blocks >= AESNI_LANES; num_blocks -= AESNI_LANES)
+    {
+        for (int l = 0; l < AESNI_LANES; l++)
+            b[l] = _mm_xor_si128(_mm_loadu_si128((const __m128i*)(in + l * AES_BLOCK_SIZE)), rk[0]);
+        for (size_t r = 1; r < nr; r++)
+        {
+            __m128i k = _mm_load_si128(rk + r);
+            for (int l = 0; l < AESNI_LANES; l++)
+                b[l] = _mm_aesdec_si128(b[l], k);
+        }
+        for (int l = 0; l < AESNI_LANES; l++)
+            _mm_storeu_si128((__m128i*)(out + l * AES_BLOCK_SIZE), _mm_aesdeclast_si128(b[l], rk[nr]));
+        in += AESNI_LANES * AES_BLOCK_SIZE;
+        out += AESNI_LANES * AES_BLOCK_SIZE;
+    }
+
+    for (; num_blocks > 0; num_blocks--, in += AES_BLOCK_SIZE, out += AES_BLOCK_SIZE)
+    {
+        __m128i s = _mm_xor_si128(_mm_loadu_si128((const __m128i*)in), rk[0]);
+        for (size_t r = 1; r < nr; r++)
+            s = _mm_aesdec_si128(s, rk[r]);
+        _mm_storeu_si128((__m128i*)out, _mm_aesdeclast_si128(s, rk[nr]));
+    }
+}
+
+AES_DEFINE_ROUND_KERNELS(aesni)
+
+/**
+ * @brief Expands up to AESNI_KEY_LANES keys of one size into encryption schedules.
+ * @param rk The schedules, one row per key.
+ * @param keys The keys, back to back.
+ * @param key_size The size of every key.
+ * @param count The number of keys, at most AESNI_KEY_LANES.
+ */
+static inline void aesni_expand_schedules(__m128i rk[][AES_ROUNDS_256 + 1], const uint8_t* keys,
+                                          aes_key_size_t key_size, size_t count)
+{
+    __m128i lo[AESNI_KEY_LANES];
+    __m128i hi[AESNI_KEY_LANES];
+
+    switch (key_size)
+    {
+        case AES_KEY_SIZE_128:
+            for (size_t l = 0; l < count; l++)
+                rk[l][0] = _mm_loadu_si128((const __m128i*)(keys + l * AES_KEY_SIZE_128));
+            EXPAND_128(1, 0x01);
+            EXPAND_128(2, 0x02);
+            EXPAND_128(3, 0x04);
+            EXPAND_128(4, 0x08);
+            EXPAND_128(5, 0x10);
+            EXPAND_128(6, 0x20);
+            EXPAND_128(7, 0x40);
+            EXPAND_128(8, 0x80);
+            EXPAND_128(9, 0x1b);
+            EXPAND_128(10, 0x36);
+            break;
+        case AES_KEY_SIZE_192:
+            for (size_t l = 0; l < count; l++)
+            {
+                lo[l]    = _mm_loadu_si128((const __m128i*)(keys + l * AES_KEY_SIZE_192));
+                hi[l]    = _mm_loadl_epi64((const __m128i*)(keys + l * AES_KEY_SIZE_192 + AES_BLOCK_SIZE));
+                rk[l][0] = lo[l];
+            }
+            EXPAND_192(1, 0x01, 0x02);
+            EXPAND_192(4, 0x04, 0x08);
+            EXPAND_192(7, 0x10, 0x20);
+            EXPAND_192(10, 0x40, 0x80);
+            secure_zero_memory(lo, sizeof(lo));
+            secure_zero_memory(hi, sizeof(hi));
+            break;
+        default:
+            for (size_t l = 0; l < count; l++)
+            {
+                rk[l][0] = _mm_loadu_si128((const __m128i*)(keys + l * AES_KEY_SIZE_256));
+                rk[l][1] = _mm_loadu_si128((const __m128i*)(keys + l * AES_KEY_SIZE_256 + AES_BLOCK_SIZE));
+            }
+            EXPAND_256(2, 0x01);
+            EXPAND_256(4, 0x02);
+            EXPAND_256(6, 0x04);
+            EXPAND_256(8, 0x08);
+            EXPAND_256(10, 0x10);
+            EXPAND_256(12, 0x20);
+            EXPAND_256(14, 0x40);
+            break;
+    }
+}
+
+/** @brief Stores the schedules the context's usage needs, with aesimc for the decryption one. */
+static void aesni_store_schedule(aes_ctx_t* ctx, const __m128i* rk)
+{
+    __m128i* enc = (__m128i*)ctx->round_keys;
+    __m128i* dec = (__m128i*)ctx->dec_round_keys;
+    size_t   nr  = ctx->num_rounds;
+
+    if (ctx->usage != AES_KEY_USAGE_DECRYPT)
+    {
+        for (size_t i = 0; i <= nr; i++)
+            _mm_store_si128(enc + i, rk[i]);
+    }
+
+    if (ctx->usage != AES_KEY_USAGE_ENCRYPT)
+    {
+        _mm_store_si128(dec, rk[nr]);
+        for (size_t i = 1; i < nr; i++)
+            _mm_store_si128(dec + i, _mm_aesimc_si128(rk[nr - i]));
+        _mm_store_si128(dec + nr, rk[0]);
+    }
+
+    aesni_select_kernels(ctx);
+}
+
+/** @brief Expands the key with aesenclast and derives the aesimc decryption schedule. */
+static void aesni_expand_key(aes_ctx_t* ctx, const uint8_t* key)
+{
+    __m128i rk[1][AES_ROUNDS_256 + 1];
+
+    aesni_expand_schedules(rk, key, ctx->key_size, 1);
+    aesni_store_schedule(ctx, rk[0]);
+
+    secure_zero_memory(rk, sizeof(rk));
+}
+
+/** @brief Expands keys of one size for consecutive contexts, AESNI_KEY_LANES at a time. */
+static void aesni_expand_keys(aes_ctx_t* ctxs, const uint8_t* keys, size_t count)
+{
+    __m128i rk[AESNI_KEY_LANES][AES_ROUNDS_256 + 1];
+    size_t  key_size = (size_t)ctxs[0].key_size;
+
+    for (size_t i = 0; i < count; i += AESNI_KEY_LANES)
+    {
+        size_t lanes = count - i < AESNI_KEY_LANES ? count - i : AESNI_KEY_LANES;
+
+        aesni_expand_schedules(rk, keys + i * key_size, ctxs[0].key_size, lanes);
+        for (size_t l = 0; l < lanes; l++)
+            aesni_store_schedule(&ctxs[i + l], rk[l]);
+    }
+
+    secure_zero_memory(rk, sizeof(rk));
+}
+
+/** @brief Reverses the byte order of a 64-bit word. */
+static inline uint64_t bswap64(uint64_t x)
+{
+#ifdef _MSC_VER
+    return _byteswap_uint64(x);
+#else
+    return __builtin_bswap64(x);
+#endif
+}
+
+/** @brief Builds a counter block register from the big-endian counter halves. */
+static inline __m128i counter_block(uint64_t hi, uint64_t lo)
+{
+    return _mm_set_epi64x((long long)bswap64(lo), (long long)bswap64(hi));
+}
+
+/**
+ * @brief Fused CTR kernel: eight counter blocks are generated, encrypted and
+ * XORed with the input without leaving registers.
+ */
+static void aesni_ctr_blocks(const aes_ctx_t* ctx, uint8_t* counter, aes_ctr_width_t width, const uint8_t* in,
+                             uint8_t* out, size_t num_blocks)
+{
+    const __m128i* rk = (const __m128i*)ctx->round_keys;
+    size_t         nr = ctx->num_rounds;
+    uint64_t       hi = load_be64(counter);
+    uint64_t       lo = load_be64(counter + 8);
+    __m128i        b[AESNI_LANES];
+
+    for (; num_blocks >= AESNI_LANES; num_blocks -= AESNI_LANES)
+    {
+        for (int l = 0; l < AESNI_LANES; l++)
+        {
+            b[l] = _mm_xor_si128(counter_block(hi, lo), rk[0]);
+            ctr_increment(&hi, &lo, width);
+        }
+        for (size_t r = 1; r < nr; r++)
+        {
+            __m128i k = _mm_load_si128(rk + r);
+            for (int l = 0; l < AESNI_LANES; l++)
+                b[l] = _mm_aesenc_si128(b[l], k);
+        }
+        for (int l = 0; l < AESNI_LANES; l++)
+        {
+            __m128i data = _mm_loadu_si128((const __m128i*)(in + l * AES_BLOCK_SIZE));
+            _mm_storeu_si128((__m128i*)(out + l * AES_BLOCK_SIZE),
+                             _mm_xor_si128(data, _mm_aesenclast_si128(b[l], rk[nr])));
+        }
+        in += AESNI_LANES * AES_BLOCK_SIZE;
+        out += AESNI_LANES * AES_BLOCK_SIZE;
+    }
+
+    for (; num_blocks > 0; num_blocks--, in += AES_BLOCK_SIZE, out += AES_BLOCK_SIZE)
+    {
+        __m128i s = _mm_xor_si128(counter_block(hi, lo), rk[0]);
+        ctr_increment(&hi, &lo, width);
+        for (size_t r = 1; r < nr; r++)
+            s = _mm_aesenc_si128(s, rk[r]);
+        s = _mm_xor_si128(_mm_loadu_si128((const __m128i*)in), _mm_aesenclast_si128(s, rk[nr]));
+        _mm_storeu_si128((__m128i*)out, s);
+    }
+
+    store_be64(counter, hi);
+    store_be64(counter + 8, lo);
+}
+
+/** @brief Multiplies an XTS tweak by x: a one-bit left shift with the 0x87 feedback. */
+static inline __m128i xts_mul_alpha(__m128i tweak)
+{
+    // Each dword's carry moves to the next dword up; the top carry wraps to
+    // the bottom as the reduction constant.
+    __m128i carry = _mm_shuffle_epi32(_mm_srai_epi32(tweak, 31), 0x93);
+    carry         = _mm_and_si128(carry, _mm_set_epi32(1, 1, 1, 0x87));
+    return _mm_xor_si128(_mm_add_epi32(tweak, tweak), carry);
+}
+
+/**
+ * @brief Fused XTS kernel: eight tweaks are derived in registers and applied
+ * around eight interleaved block encryptions or decryptions.
+ */
+static void aesni_xts_blocks(const aes_ctx_t* ctx, int encrypt, uint8_t* tweak, const uint8_t* in, uint8_t* out,
+                             size_t num_blocks)
+{
+    const __m128i* rk = (const __m128i*)(encrypt ? ctx->round_keys : ctx->dec_round_keys);
+    size_t         nr = ctx->num_rounds;
+    __m128i        t  = _mm_loadu_si128((const __m128i*)tweak);
+    __m128i        b[AESNI_LANES], tw[AESNI_LANES];
+
+    for (; num_blocks >= AESNI_LANES; num_blocks -= AESNI_LANES)
+    {
+        for (int l = 0; l < AESNI_LANES; l++)
+        {
+            tw[l] = t;
+            t     = xts_mul_alpha(t);
+            b[l]  = _mm_xor_si128(_mm_loadu_si128((const __m128i*)(in + l * AES_BLOCK_SIZE)), tw[l]);
+            b[l]  = _mm_xor_si128(b[l], rk[0]);
+        }
+        if (encrypt)
+        {
+            for (size_t r = 1; r < nr; r++)
+            {
+                __m128i k = _mm_load_si128(rk + r);
+                for (int l = 0; l < AESNI_LANES; l++)
+                    b[l] = _mm_aesenc_si128(b[l], k);
+            }
+            for (int l = 0; l < AESNI_LANES; l++)
+                b[l] = _mm_aesenclast_si128(b[l], rk[nr]);
+        }
+        else
+        {
+            for (size_t r = 1; r < nr; r++)
+            {
+                __m128i k = _mm_load_si128(rk + r);
+                for (int l = 0; l < AESNI_LANES; l++)
+                    b[l] = _mm_aesdec_si128(b[l], k);
+            }
+            for (int l = 0; l < AESNI_LANES; l++)
+                b[l] = _mm_aesdeclast_si128(b[l], rk[nr]);
+        }
+        for (int l = 0; l < AESNI_LANES; l++)
+            _mm_storeu_si128((__m128i*)(out + l * AES_BLOCK_SIZE), _mm_xor_si128(b[l], tw[l]));
+        in += AESNI_LANES * AES_BLOCK_SIZE;
+        out += AESNI_LANES * AES_BLOCK_SIZE;
+    }
+
+    for (; num_blocks > 0; num_blocks--, in += AES_BLOCK_SIZE, out += AES_BLOCK_SIZE)
+    {
+        __m128i s = _mm_xor_si128(_mm_xor_si128(_mm_loadu_si128((const __m128i*)in), t), rk[0]);
+        for (size_t r = 1; r < nr; r++)
+            s = encrypt ? _mm_aesenc_si128(s, rk[r]) : _mm_aesdec_si128(s, rk[r]);
+        s = encrypt ? _mm_aesenclast_si128(s, rk[nr]) : _mm_aesdeclast_si128(s, rk[nr]);
+        _mm_storeu_si128((__m128i*)out, _mm_xor_si128(s, t));
+        t = xts_mul_alpha(t);
+    }
+
+    _mm_storeu_si128((__m128i*)tweak, t);
+}
+
+/**
+ * @brief Runs one group of n <= AESNI_LANES blocks, block l under schedule rk[l].
+ * @details Inlined with a constant n for full groups, so the lanes stay in
+ * registers. Each lane loads its own round key every round; the loads are
+ * independent of the aesenc chain, so the lanes overlap as in the single-key loop.
+ */
+static inline void aesni_multi_group(const __m128i* const* rk, size_t nr, int encrypt, const uint8_t* in, uint8_t* out,
+                                     size_t n)
+{
+    __m128i b[AESNI_LANES];
+
+    for (size_t l = 0; l < n; l++)
+        b[l] = _mm_xor_si128(_mm_loadu_si128((const __m128i*)(in + l * AES_BLOCK_SIZE)), rk[l][0]);
+    for (size_t r = 1; r < nr; r++)
+    {
+        for (size_t l = 0; l < n; l++)
+            b[l] = encrypt ? _mm_aesenc_si128(b[l], _mm_load_si128(rk[l] + r))
+                           : _mm_aesdec_si128(b[l], _mm_load_si128(rk[l] + r));
+    }
+    for (size_t l = 0; l < n; l++)
+    {
+        b[l] = encrypt ? _mm_aesenclast_si128(b[l], rk[l][nr]) : _mm_aesdeclast_si128(b[l], rk[l][nr]);
+        _mm_storeu_si128((__m128i*)(out + l * AES_BLOCK_SIZE), b[l]);
+    }
+}
+
+/** @brief Processes block i under ctxs[i], eight keys at a time while enough remain. */
+static inline void aesni_multi(const aes_ctx_t* const* ctxs, int encrypt, const uint8_t* in, uint8_t* out,
+                               size_t num_blocks)
+{
+    const __m128i* rk[AESNI_LANES];
+    size_t         nr = ctxs[0]->num_rounds;
+
+    while (num_blocks > 0)
+    {
+        size_t n = num_blocks < AESNI_LANES ? num_blocks : AESNI_LANES;
+
+        for (size_t l = 0; l < n; l++)
+            rk[l] = (const __m128i*)(encrypt ? ctxs[l]->round_keys : ctxs[l]->dec_round_keys);
+        if (n == AESNI_LANES)
+            aesni_multi_group(rk, nr, encrypt, in, out, AESNI_LANES);
+        else
+            aesni_multi_group(rk, nr, encrypt, in, out, n);
+
+        ctxs += n;
+        in += n * AES_BLOCK_SIZE;
+        out += n * AES_BLOCK_SIZE;
+        num_blocks -= n;
+    }
+}
+
+/** @brief Encrypts block i under ctxs[i], interleaving up to eight keys. */
+static void aesni_encrypt_multi(const aes_ctx_t* const* ctxs, const uint8_t* in, uint8_t* out, size_t num_blocks)
+{
+    aesni_multi(ctxs, 1, in, out, num_blocks);
+}
+
+/** @brief Decrypts block i under ctxs[i], interleaving up to eight keys. */
+static void aesni_decrypt_multi(const aes_ctx_t* const* ctxs, const uint8_t* in, uint8_t* out, size_t num_blocks)
+{
+    aesni_multi(ctxs, 0, in, out, num_blocks);
+}
+
+/**
+ * @brief CBC-encrypts num_blocks blocks of each of n <= AESNI_LANES streams,
+ * stream l under schedule rk[l].
+ * @details The chaining values stay in registers for the whole run; each
+ * step encrypts the next block of every stream, so the n dependency chains
+ * overlap in the pipeline as the independent blocks of ECB do.
+ */
+static inline void aesni_cbc_group(const __m128i* const* rk, size_t nr, uint8_t* ivs, const uint8_t* const* in,
+                                   uint8_t* const* out, size_t n, size_t num_blocks)
+{
+    __m128i c[AESNI_LANES];
+
+    for (size_t l = 0; l < n; l++)
+        c[l] = _mm_loadu_si128((const __m128i*)(ivs + l * AES_BLOCK_SIZE));
+    for (size_t j = 0; j < num_blocks; j++)
+    {
+        size_t offset = j * AES_BLOCK_SIZE;
+        for (size_t l = 0; l < n; l++)
+            c[l] = _mm_xor_si128(_mm_xor_si128(c[l], _mm_loadu_si128((const __m128i*)(in[l] + offset))), rk[l][0]);
+        for (size_t r = 1; r < nr; r++)
+        {
+            for (size_t l = 0; l < n; l++)
+                c[l] = _mm_aesenc_si128(c[l], _mm_load_si128(rk[l] + r));
+        }
+        for (size_t l = 0; l < n; l++)
+        {
+            c[l] = _mm_aesenclast_si128(c[l], rk[l][nr]);
+            _mm_storeu_si128((__m128i*)(out[l] + offset), c[l]);
+        }
+    }
+    for (size_t l = 0; l < n; l++)
+        _mm_storeu_si128((__m128i*)(ivs + l * AES_BLOCK_SIZE), c[l]);
+}
+
+/** @brief CBC-encrypts num_blocks blocks of each of n streams, interleaving the streams. */
+static void aesni_cbc_encrypt_multi(const aes_ctx_t* const* ctxs, uint8_t* ivs, const uint8_t* const* in,
+                                    uint8_t* const* out, size_t n, size_t num_blocks)
+{
+    const __m128i* rk[AESNI_LANES];
+
+    for (size_t l = 0; l < n; l++)
+        rk[l] = (const __m128i*)ctxs[l]->round_keys;
+    if (n == AESNI_LANES)
+        aesni_cbc_group(rk, ctxs[0]->num_rounds, ivs, in, out, AESNI_LANES, num_blocks);
+    else
+        aesni_cbc_group(rk, ctxs[0]->num_rounds, ivs, in, out, n, num_blocks);
+}
+
+const aes_backend_ops_t aes_backend_aesni = {
+    AES_BACKEND_AESNI, "aesni", AES_CPU_AESNI, aesni_expand_key, aesni_encrypt_blocks, aesni_decrypt_blocks,
+    aesni_ctr_blocks, aesni_xts_blocks, aesni_encrypt_multi, aesni_decrypt_multi, aesni_expand_keys,
+    aesni_cbc_encrypt_multi,
+};
+
+#else
+
+// ISO C forbids an empty translation unit.
+typedef int aes_ni_unavailable_t;
+
+#endif // AES_ARCH_X86
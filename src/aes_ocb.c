@@ -0,0 +1,284 @@
+/**
+ * @file aes_ocb.c
+ * @brief OCB3 (RFC 7253) authenticated encryption.
+ *
+ * @details Every block is encrypted once, under an offset that is XORed in
+ * before and after the cipher call, and the plaintext blocks are summed into
+ * a checksum that the tag encrypts. The offset for block i is the one for
+ * block i - 1 XORed with L_ntz(i), so a run of offsets costs one table
+ * lookup and one XOR per block, and the blocks themselves are independent:
+ * they go through the backend's multi-block kernel in batches, decryption
+ * through its inverse cipher. The associated data is hashed the same way.
+ */
+
+#include "aes_internal.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// Blocks per backend call: the widest interleave of the AES-NI and bitsliced kernels.
+#define OCB_BATCH_BLOCKS 8
+
+// RFC 7253 nonces are at most 120 bits.
+#define OCB_MAX_NONCE_LEN 15
+
+/**
+ * @brief Derives Offset_0 from the nonce and tag length (RFC 7253, section 4.2).
+ * @param[in] ocb An initialized context.
+ * @param[out] offset Receives the initial offset.
+ */
+static void ocb_initial_offset(const aes_ocb_ctx_t* ocb, const uint8_t* nonce, size_t nonce_len, size_t tag_len,
+                               uint8_t* offset)
+{
+    uint8_t block[AES_BLOCK_SIZE] = {0};
+    uint8_t stretch[AES_BLOCK_SIZE + 8];
+
+    // Nonce = num2str(TAGLEN mod 128, 7) || zeros || 1 || N.
+    block[0] = (uint8_t)(((tag_len * 8) % 128) << 1);
+    block[AES_BLOCK_SIZE - 1 - nonce_len] |= 1;
+    memcpy(block + AES_BLOCK_SIZE - nonce_len, nonce, nonce_len);
+
+    // The low six bits select where Offset_0 starts within Stretch = Ktop || (Ktop[1..64] xor Ktop[9..72]).
+    unsigned bottom = block[AES_BLOCK_SIZE - 1] & 0x3f;
+    block[AES_BLOCK_SIZE - 1] &= 0xc0;
+    ocb->cipher.encrypt_blocks(&ocb->cipher, block, stretch, 1);
+    xor_bytes(stretch + AES_BLOCK_SIZE, stretch, stretch + 1, 8);
+
+    unsigned byte_shift = bottom / 8;
+    unsigned bit_shift  = bottom % 8;
+    for (size_t i = 0; i < AES_BLOCK_SIZE; i++)
+    {
+        offset[i] = stretch[i + byte_shift];
+        if (bit_shift != 0)
+            offset[i] = (uint8_t)((offset[i] << bit_shift) | (stretch[i + byte_shift + 1] >> (8 - bit_shift)));
+    }
+
+    secure_zero_memory(stretch, sizeof(stretch));
+}
+
+/**
+ * @brief Pads a partial final block with a single 1 bit and zeros (10*).
+ * @param[out] block Receives the padded block.
+ * @param[in] data The data bytes.
+ * @param[in] length The number of data bytes, less than AES_BLOCK_SIZE.
+ */
+static void ocb_pad_block(uint8_t* block, const uint8_t* data, size_t length)
+{
+    memcpy(block, data, length);
+    block[length] = 0x80;
+    memset(block + length + 1, 0, AES_BLOCK_SIZE - length - 1);
+}
+
+/**
+ * @brief Computes HASH(K, A) over the associated data into sum.
+ * @param[in] ocb An initialized context.
+ * @param[out] sum Receives the hash.
+ */
+static void ocb_hash(const aes_ocb_ctx_t* ocb, const uint8_t* aad, size_t aad_len, uint8_t* sum)
+{
+    const aes_ctx_t* cipher = &ocb->cipher;
+    uint8_t          batch[OCB_BATCH_BLOCKS * AES_BLOCK_SIZE];
+    uint8_t          offset[AES_BLOCK_SIZE] = {0};
+    uint64_t         index                  = 0;
+
+    memset(sum, 0, AES_BLOCK_SIZE);
+    while (aad_len >= AES_BLOCK_SIZE)
+    {
+        size_t n = aad_len / AES_BLOCK_SIZE < OCB_BATCH_BLOCKS ? aad_len / AES_BLOCK_SIZE : OCB_BATCH_BLOCKS;
+
+        for (size_t i = 0; i < n; i++)
+        {
+            xor_bytes(offset, offset, ocb->l[aes_ntz64(++index)], AES_BLOCK_SIZE);
+            xor_bytes(batch + i * AES_BLOCK_SIZE, aad + i * AES_BLOCK_SIZE, offset, AES_BLOCK_SIZE);
+        }
+        cipher->encrypt_blocks(cipher, batch, batch, n);
+        for (size_t i = 0; i < n; i++)
+            xor_bytes(sum, sum, batch + i * AES_BLOCK_SIZE, AES_BLOCK_SIZE);
+
+        aad += n * AES_BLOCK_SIZE;
+        aad_len -= n * AES_BLOCK_SIZE;
+    }
+
+    if (aad_len > 0)
+    {
+        xor_bytes(offset, offset, ocb->l_star, AES_BLOCK_SIZE);
+        ocb_pad_block(batch, aad, aad_len);
+        xor_bytes(batch, batch, offset, AES_BLOCK_SIZE);
+        cipher->encrypt_blocks(cipher, batch, batch, 1);
+        xor_bytes(sum, sum, batch, AES_BLOCK_SIZE);
+    }
+
+    secure_zero_memory(batch, sizeof(batch));
+    secure_zero_memory(offset, sizeof(offset));
+}
+
+/**
+ * @brief Encrypts or decrypts the message and accumulates the plaintext checksum.
+ * @param[in] ocb An initialized context.
+ * @param[in] encrypt Nonzero to encrypt, zero to decrypt.
+ * @param[in,out] offset The running offset, Offset_0 on entry and the final offset on return.
+ * @param[out] checksum Receives the checksum of the (padded) plaintext.
+ */
+static void ocb_crypt(const aes_ocb_ctx_t* ocb, int encrypt, uint8_t* offset, uint8_t* checksum, const uint8_t* in,
+                      uint8_t* out, size_t length)
+{
+    const aes_ctx_t* cipher = &ocb->cipher;
+    uint8_t          batch[OCB_BATCH_BLOCKS * AES_BLOCK_SIZE];
+    uint8_t          offsets[OCB_BATCH_BLOCKS * AES_BLOCK_SIZE];
+    uint64_t         index = 0;
+
+    void (*blocks)(const aes_ctx_t*, const uint8_t*, uint8_t*, size_t) =
+        encrypt ? cipher->encrypt_blocks : cipher->decrypt_blocks;
+
+    memset(checksum, 0, AES_BLOCK_SIZE);
+    while (length >= AES_BLOCK_SIZE)
+    {
+        size_t n = length / AES_BLOCK_SIZE < OCB_BATCH_BLOCKS ? length / AES_BLOCK_SIZE : OCB_BATCH_BLOCKS;
+
+        // The plaintext is summed before out overwrites it, so in may equal out.
+        for (size_t i = 0; i < n; i++)
+        {
+            xor_bytes(offset, offset, ocb->l[aes_ntz64(++index)], AES_BLOCK_SIZE);
+            memcpy(offsets + i * AES_BLOCK_SIZE, offset, AES_BLOCK_SIZE);
+            if (encrypt)
+                xor_bytes(checksum, checksum, in + i * AES_BLOCK_SIZE, AES_BLOCK_SIZE);
+            xor_bytes(batch + i * AES_BLOCK_SIZE, in + i * AES_BLOCK_SIZE, offset, AES_BLOCK_SIZE);
+        }
+        blocks(cipher, batch, batch, n);
+        for (size_t i = 0; i < n; i++)
+        {
+            xor_bytes(out + i * AES_BLOCK_SIZE, batch + i * AES_BLOCK_SIZE, offsets + i * AES_BLOCK_SIZE,
+                      AES_BLOCK_SIZE);
+            if (!encrypt)
+                xor_bytes(checksum, checksum, out + i * AES_BLOCK_SIZE, AES_BLOCK_SIZE);
+        }
+
+        in += n * AES_BLOCK_SIZE;
+        out += n * AES_BLOCK_SIZE;
+        length -= n * AES_BLOCK_SIZE;
+    }
+
+    // A partial final block is XORed with a pad, in both directions.
+    if (length > 0)
+    {
+        uint8_t* pad  = batch;
+        uint8_t* last = batch + AES_BLOCK_SIZE;
+
+        xor_bytes(offset, offset, ocb->l_star, AES_BLOCK_SIZE);
+        cipher->encrypt_blocks(cipher, offset, pad, 1);
+        if (encrypt)
+            ocb_pad_block(last, in, length);
+        xor_bytes(out, in, pad, length);
+        if (!encrypt)
+            ocb_pad_block(last, out, length);
+        xor_bytes(checksum, checksum, last, AES_BLOCK_SIZE);
+    }
+
+    secure_zero_memory(batch, sizeof(batch));
+    secure_zero_memory(offsets, sizeof(offsets));
+}
+
+/**
+ * @brief Runs the whole OCB computation for one message.
+ * @param[in] ocb An initialized context.
+ * @param[in] encrypt Nonzero to encrypt, zero to decrypt.
+ * @param[out] full_tag Receives the untruncated 16-byte tag.
+ * @return AES_SUCCESS, or an error for invalid arguments.
+ */
+static aes_error_t ocb_process(const aes_ocb_ctx_t* ocb, int encrypt, const uint8_t* nonce, size_t nonce_len,
+                               const uint8_t* aad, size_t aad_len, const uint8_t* in, uint8_t* out, size_t length,
+                               size_t tag_len, uint8_t* full_tag)
+{
+    if (!ocb || !ocb->cipher.backend || !nonce || (aad_len && !aad) || (length && (!in || !out)))
+        return AES_ERROR_INVALID_ARGUMENT;
+    if (nonce_len == 0 || nonce_len > OCB_MAX_NONCE_LEN || tag_len == 0 || tag_len > AES_BLOCK_SIZE)
+        return AES_ERROR_INVALID_LENGTH;
+
+    uint8_t offset[AES_BLOCK_SIZE];
+    uint8_t checksum[AES_BLOCK_SIZE];
+    uint8_t hash[AES_BLOCK_SIZE];
+
+    AES_STATS_BEGIN(start);
+    ocb_initial_offset(ocb, nonce, nonce_len, tag_len, offset);
+    ocb_crypt(ocb, encrypt, offset, checksum, in, out, length);
+    ocb_hash(ocb, aad, aad_len, hash);
+
+    // Tag = E(Checksum xor Offset xor L_$) xor HASH(K, A).
+    xor_bytes(full_tag, checksum, offset, AES_BLOCK_SIZE);
+    xor_bytes(full_tag, full_tag, ocb->l_dollar, AES_BLOCK_SIZE);
+    ocb->cipher.encrypt_blocks(&ocb->cipher, full_tag, full_tag, 1);
+    xor_bytes(full_tag, full_tag, hash, AES_BLOCK_SIZE);
+
+    secure_zero_memory(offset, sizeof(offset));
+    secure_zero_memory(checksum, sizeof(checksum));
+    secure_zero_memory(hash, sizeof(hash));
+    AES_STATS_RECORD(AES_STATS_OCB, ocb->cipher.backend->id, length, start);
+    return AES_SUCCESS;
+}
+
+aes_error_t aes_ocb_init(aes_ocb_ctx_t* ocb, const uint8_t* key, aes_key_size_t key_size, aes_backend_t backend)
+{
+    if (!ocb)
+        return AES_ERROR_INVALID_ARGUMENT;
+
+    aes_error_t result = aes_ctx_init_backend(&ocb->cipher, key, key_size, backend);
+    if (result != AES_SUCCESS)
+        return result;
+
+    memset(ocb->l_star, 0, AES_BLOCK_SIZE);
+    ocb->cipher.encrypt_blocks(&ocb->cipher, ocb->l_star, ocb->l_star, 1);
+    aes_gf128_double(ocb->l_dollar, ocb->l_star);
+    aes_gf128_double(ocb->l[0], ocb->l_dollar);
+    for (size_t i = 1; i < AES_OCB_L_COUNT; i++)
+        aes_gf128_double(ocb->l[i], ocb->l[i - 1]);
+
+    return AES_SUCCESS;
+}
+
+aes_error_t aes_ocb_seal(const aes_ocb_ctx_t* ocb, const uint8_t* nonce, size_t nonce_len, const uint8_t* aad,
+                         size_t aad_len, const uint8_t* in, uint8_t* out, size_t length, uint8_t* tag, size_t tag_len)
+{
+    uint8_t full_tag[AES_BLOCK_SIZE];
+
+    if (!tag)
+        return AES_ERROR_INVALID_ARGUMENT;
+
+    aes_error_t result = ocb_process(ocb, 1, nonce, nonce_len, aad, aad_len, in, out, length, tag_len, full_tag);
+    if (result == AES_SUCCESS)
+        memcpy(tag, full_tag, tag_len);
+
+    secure_zero_memory(full_tag, sizeof(full_tag));
+    return result;
+}
+
+aes_error_t aes_ocb_open(const aes_ocb_ctx_t* ocb, const uint8_t* nonce, size_t nonce_len, const uint8_t* aad,
+                         size_t aad_len, const uint8_t* in, uint8_t* out, size_t length, const uint8_t* tag,
+                         size_t tag_len)
+{
+    uint8_t full_tag[AES_BLOCK_SIZE];
+
+    if (!tag)
+        return AES_ERROR_INVALID_ARGUMENT;
+
+    aes_error_t result = ocb_process(ocb, 0, nonce, nonce_len, aad, aad_len, in, out, length, tag_len, full_tag);
+    if (result != AES_SUCCESS)
+        return result;
+
+    // Constant-time comparison: accumulate every difference before deciding.
+    uint8_t diff = 0;
+    for (size_t i = 0; i < tag_len; i++)
+        diff |= (uint8_t)(full_tag[i] ^ tag[i]);
+
+    secure_zero_memory(full_tag, sizeof(full_tag));
+    if (diff != 0)
+    {
+        secure_zero_memory(out, length);
+        return AES_ERROR_AUTHENTICATION_FAILED;
+    }
+    return AES_SUCCESS;
+}
+
+void aes_ocb_clear(aes_ocb_ctx_t* ocb)
+{
+    secure_zero_memory(ocb, ocb ? sizeof(*ocb) : 0);
+}
@@ -0,0 +1,316 @@
+/**
+ * @file aes_stats.c
+ * @brief The optional statistics layer: per-thread counters, sampled timing
+ * and on-demand aggregation.
+ *
+ * @details Every thread that records gets its own block of counters, linked
+ * into a global list when the thread first records. Only the owning thread
+ * writes a block, with a relaxed load and store per counter, so recording
+ * costs a few uncontended adds and never a locked instruction; readers see
+ * each counter as a whole value because the counters are atomic. When a
+ * thread exits, its counts are folded into a retired total and its block is
+ * freed. A snapshot takes the list lock and sums the retired total and every
+ * live block.
+ *
+ * Timing reads the timestamp counter (rdtsc) on x86 and a nanosecond clock
+ * elsewhere, around one call in every sample interval per thread.
+ *
+ * Without AES_ENABLE_STATS only the public functions are built, and they
+ * report empty statistics.
+ */
+
+#include "aes_internal.h"
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef AES_ENABLE_STATS
+
+#ifdef AES_HAVE_PTHREADS
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#if defined(AES_ARCH_X86) && defined(_MSC_VER)
+#include <intrin.h>
+#elif defined(AES_ARCH_X86)
+#include <x86intrin.h>
+#else
+#include <time.h>
+#endif
+
+//! One aes_stats_counter_t, written by its owning thread only.
+typedef struct
+{
+    _Atomic uint64_t calls;
+    _Atomic uint64_t bytes;
+    _Atomic uint64_t blocks;
+    _Atomic uint64_t timed_calls;
+    _Atomic uint64_t timed_cycles;
+} stats_counter_t;
+
+//! The counters of one thread, by operation and backend; a snapshot sums them both ways.
+typedef struct stats_block
+{
+    stats_counter_t     counters[AES_STATS_OP_COUNT][AES_STATS_BACKEND_SLOTS];
+    _Atomic uint64_t    allocation_failures;
+    struct stats_block* prev; /**< List links, guarded by stats_lock. */
+    struct stats_block* next;
+} stats_block_t;
+
+//! Every live thread's block.
+static stats_block_t* stats_threads;
+
+//! The counts of exited threads, guarded by stats_lock.
+static aes_stats_t stats_retired;
+
+//! Guards stats_threads and stats_retired.
+static atomic_flag stats_lock = ATOMIC_FLAG_INIT;
+
+//! Calls per timing sample; 0 disables timing.
+atomic_uint aes_stats_interval;
+
+//! The installed timing hook, or NULL.
+static _Atomic(const aes_stats_hook_t*) stats_hook;
+
+//! The calling thread's block, created when it first records.
+static _Thread_local stats_block_t* thread_block;
+
+//! Calls the calling thread has made since its last timing sample.
+static _Thread_local unsigned thread_calls;
+
+/** @brief Acquires stats_lock. */
+static void stats_lock_acquire(void)
+{
+    while (atomic_flag_test_and_set_explicit(&stats_lock, memory_order_acquire))
+    {
+#ifdef AES_HAVE_PTHREADS
+        sched_yield();
+#endif
+    }
+}
+
+/** @brief Releases stats_lock. */
+static void stats_lock_release(void)
+{
+    atomic_flag_clear_explicit(&stats_lock, memory_order_release);
+}
+
+/** @brief Reads the timestamp counter, or a nanosecond clock off x86. */
+static uint64_t stats_clock(void)
+{
+#ifdef AES_ARCH_X86
+    return (uint64_t)__rdtsc();
+#else
+    struct timespec now;
+    timespec_get(&now, TIME_UTC);
+    return (uint64_t)now.tv_sec * 1000000000u + (uint64_t)now.tv_nsec;
+#endif
+}
+
+/** @brief Adds to a counter that only the calling thread writes. */
+static inline void stats_add(_Atomic uint64_t* counter, uint64_t n)
+{
+    atomic_store_explicit(counter, atomic_load_explicit(counter, memory_order_relaxed) + n, memory_order_relaxed);
+}
+
+/** @brief Adds one call to a counter. */
+static void stats_count(stats_counter_t* counter, size_t bytes, uint64_t cycles, int timed)
+{
+    stats_add(&counter->calls, 1);
+    stats_add(&counter->bytes, bytes);
+    stats_add(&counter->blocks, (bytes + AES_BLOCK_SIZE - 1) / AES_BLOCK_SIZE);
+    if (timed)
+    {
+        stats_add(&counter->timed_calls, 1);
+        stats_add(&counter->timed_cycles, cycles);
+    }
+}
+
+/** @brief Adds a thread's counter into a snapshot total. */
+static void stats_sum(aes_stats_counter_t* total, stats_counter_t* counter)
+{
+    total->calls += atomic_load_explicit(&counter->calls, memory_order_relaxed);
+    total->bytes += atomic_load_explicit(&counter->bytes, memory_order_relaxed);
+    total->blocks += atomic_load_explicit(&counter->blocks, memory_order_relaxed);
+    total->timed_calls += atomic_load_explicit(&counter->timed_calls, memory_order_relaxed);
+    total->timed_cycles += atomic_load_explicit(&counter->timed_cycles, memory_order_relaxed);
+}
+
+/** @brief Adds every counter of a thread's block into a snapshot. */
+static void stats_sum_block(aes_stats_t* stats, stats_block_t* block)
+{
+    for (size_t i = 0; i < AES_STATS_OP_COUNT; i++)
+    {
+        for (size_t j = 0; j < AES_STATS_BACKEND_SLOTS; j++)
+        {
+            stats_sum(&stats->ops[i], &block->counters[i][j]);
+            stats_sum(&stats->backends[j], &block->counters[i][j]);
+        }
+    }
+    stats->allocation_failures += atomic_load_explicit(&block->allocation_failures, memory_order_relaxed);
+}
+
+#ifdef AES_HAVE_PTHREADS
+/**
+ * @brief Folds an exiting thread's counts into the retired total and frees its block.
+ * @details Runs on the exiting thread, so thread_block is reset: an operation
+ * recorded from a later key destructor then registers a new block instead of
+ * writing to the freed one.
+ */
+static void stats_block_retire(void* arg)
+{
+    stats_block_t* block = arg;
+
+    stats_lock_acquire();
+    stats_sum_block(&stats_retired, block);
+    if (block->prev)
+        block->prev->next = block->next;
+    else
+        stats_threads = block->next;
+    if (block->next)
+        block->next->prev = block->prev;
+    stats_lock_release();
+
+    free(block);
+    thread_block = NULL;
+}
+
+//! Runs stats_block_retire() on the block of each exiting thread.
+static pthread_key_t  thread_key;
+static pthread_once_t thread_key_once = PTHREAD_ONCE_INIT;
+static int            thread_key_ready;
+
+/** @brief Creates thread_key, once per process. */
+static void thread_key_create(void)
+{
+    thread_key_ready = pthread_key_create(&thread_key, stats_block_retire) == 0;
+}
+#endif
+
+/**
+ * @brief Returns the calling thread's block, creating and registering it on first use.
+ * @return The block, or NULL if out of memory.
+ */
+static stats_block_t* stats_thread_block(void)
+{
+    if (thread_block)
+        return thread_block;
+
+    stats_block_t* block = calloc(1, sizeof(*block));
+    if (!block)
+        return NULL;
+
+    stats_lock_acquire();
+    block->next = stats_threads;
+    if (stats_threads)
+        stats_threads->prev = block;
+    stats_threads = block;
+    stats_lock_release();
+
+#ifdef AES_HAVE_PTHREADS
+    pthread_once(&thread_key_once, thread_key_create);
+    if (thread_key_ready)
+        pthread_setspecific(thread_key, block);
+#endif
+    thread_block = block;
+    return block;
+}
+
+uint64_t aes_stats_sample(void)
+{
+    unsigned interval = atomic_load_explicit(&aes_stats_interval, memory_order_relaxed);
+    if (interval == 0 || ++thread_calls < interval)
+        return 0;
+
+    thread_calls = 0;
+    uint64_t now = stats_clock();
+    return now ? now : 1;
+}
+
+void aes_stats_record(aes_stats_op_t op, aes_backend_t backend, size_t bytes, uint64_t start)
+{
+    uint64_t cycles = start ? stats_clock() - start : 0;
+
+    stats_block_t* block = stats_thread_block();
+    if (!block)
+        return;
+
+    if ((unsigned)backend < AES_STATS_BACKEND_SLOTS)
+        stats_count(&block->counters[op][backend], bytes, cycles, start != 0);
+
+    if (start)
+    {
+        const aes_stats_hook_t* hook = atomic_load_explicit(&stats_hook, memory_order_acquire);
+        if (hook && hook->callback)
+            hook->callback(hook->arg, op, backend, bytes, cycles);
+    }
+}
+
+void aes_stats_allocation_failed(void)
+{
+    stats_block_t* block = stats_thread_block();
+    if (block)
+        stats_add(&block->allocation_failures, 1);
+}
+
+int aes_stats_enabled(void)
+{
+    return 1;
+}
+
+aes_error_t aes_stats_snapshot(aes_stats_t* stats)
+{
+    if (!stats)
+        return AES_ERROR_INVALID_ARGUMENT;
+
+    stats_lock_acquire();
+    *stats = stats_retired;
+    for (stats_block_t* block = stats_threads; block; block = block->next)
+        stats_sum_block(stats, block);
+    stats_lock_release();
+
+    stats->default_backend = aes_get_default_backend();
+    return AES_SUCCESS;
+}
+
+void aes_stats_set_sample_interval(unsigned interval)
+{
+    atomic_store_explicit(&aes_stats_interval, interval, memory_order_relaxed);
+}
+
+void aes_stats_set_hook(const aes_stats_hook_t* hook)
+{
+    atomic_store_explicit(&stats_hook, hook, memory_order_release);
+}
+
+#else // !AES_ENABLE_STATS
+
+int aes_stats_enabled(void)
+{
+    return 0;
+}
+
+aes_error_t aes_stats_snapshot(aes_stats_t* stats)
+{
+    if (!stats)
+        return AES_ERROR_INVALID_ARGUMENT;
+
+    memset(stats, 0, sizeof(*stats));
+    stats->default_backend = aes_get_default_backend();
+    return AES_SUCCESS;
+}
+
+void aes_stats_set_sample_interval(unsigned interval)
+{
+    (void)interval;
+}
+
+void aes_stats_set_hook(const aes_stats_hook_t* hook)
+{
+    (void)hook;
+}
+
+#endif // AES_ENABLE_STATS
@@ -0,0 +1,179 @@
+/**
+ * @file aes_ttable.c
+ * @brief The 32-bit T-table AES backend.
+ *
+ * @details Each column of the state is held in one 32-bit word (row 0 in the
+ * most significant byte), so the whole state lives in four registers. One
+ * encryption round combines SubBytes, ShiftRows and MixColumns into sixteen
+ * lookups of a single 256-entry table whose entries are the S-box output
+ * multiplied by the MixColumns column {02, 01, 01, 03}; the other three
+ * columns of the matrix are byte rotations of the same entry. Decryption runs
+ * the FIPS-197 equivalent inverse cipher (section 5.3.5): InvMixColumns is
+ * applied to the middle round keys once at key setup, which lets each
+ * decryption round fuse InvSubBytes, InvShiftRows and InvMixColumns into
+ * sixteen lookups of a second table, exactly like an encryption round.
+ *
+ * Both directions are fully unrolled and instantiated once per key size, so
+ * every round key offset is a constant; the tables themselves are generated
+ * at build time by aes_gen_tables.
+ */
+
+#include "aes_internal.h"
+#include <stddef.h>
+#include <stdint.h>
+
+/** @brief Rotates a 32-bit word right by n bits (0 < n < 32). */
+#define ROTR32(x, n) (((x) >> (n)) | ((x) << (32 - (n))))
+
+/** @brief One column of a full encryption round: the four table lookups plus the round key. */
+#define TE_COLUMN(a, b, c, d, k)                                                                                       \
+    (aes_te0[(a) >> 24] ^ ROTR32(aes_te0[((b) >> 16) & 0xff], 8) ^ ROTR32(aes_te0[((c) >> 8) & 0xff], 16) ^          \
+     ROTR32(aes_te0[(d)&0xff], 24) ^ (k))
+
+/** @brief One column of the final round (SubBytes and ShiftRows only) plus the round key. */
+#define TE_FINAL_COLUMN(a, b, c, d, k)                                                                                 \
+    ((((uint32_t)aes_sbox[(a) >> 24] << 24) | ((uint32_t)aes_sbox[((b) >> 16) & 0xff] << 16) |                       \
+      ((uint32_t)aes_sbox[((c) >> 8) & 0xff] << 8) | (uint32_t)aes_sbox[(d)&0xff]) ^                                  \
+     (k))
+
+/** @brief One column of a full equivalent-inverse-cipher round: the four table lookups plus the round key. */
+#define TD_COLUMN(a, b, c, d, k)                                                                                       \
+    (aes_td0[(a) >> 24] ^ ROTR32(aes_td0[((b) >> 16) & 0xff], 8) ^ ROTR32(aes_td0[((c) >> 8) & 0xff], 16) ^          \
+     ROTR32(aes_td0[(d)&0xff], 24) ^ (k))
+
+/** @brief One column of the final decryption round (InvSubBytes and InvShiftRows only) plus the round key. */
+#define TD_FINAL_COLUMN(a, b, c, d, k)                                                                                 \
+    ((((uint32_t)aes_rsbox[(a) >> 24] << 24) | ((uint32_t)aes_rsbox[((b) >> 16) & 0xff] << 16) |                     \
+      ((uint32_t)aes_rsbox[((c) >> 8) & 0xff] << 8) | (uint32_t)aes_rsbox[(d)&0xff]) ^                                \
+     (k))
+
+/** @brief One full encryption round from state s to state t, with round key r. */
+#define TE_ROUND(t, s, r)                                                                                              \
+    do                                                                                                                 \
+    {                                                                                                                  \
+        t##0 = TE_COLUMN(s##0, s##1, s##2, s##3, rk[4 * (r)]);                                                         \
+        t##1 = TE_COLUMN(s##1, s##2, s##3, s##0, rk[4 * (r) + 1]);                                                     \
+        t##2 = TE_COLUMN(s##2, s##3, s##0, s##1, rk[4 * (r) + 2]);                                                     \
+        t##3 = TE_COLUMN(s##3, s##0, s##1, s##2, rk[4 * (r) + 3]);                                                     \
+    } while (0)
+
+/** @brief One full decryption round from state s to state t, with round key r of the decryption schedule. */
+#define TD_ROUND(t, s, r)                                                                                              \
+    do                                                                                                                 \
+    {                                                                                                                  \
+        t##0 = TD_COLUMN(s##0, s##3, s##2, s##1, rk[4 * (r)]);                                                         \
+        t##1 = TD_COLUMN(s##1, s##0, s##3, s##2, rk[4 * (r) + 1]);                                                     \
+        t##2 = TD_COLUMN(s##2, s##1, s##0, s##3, rk[4 * (r) + 2]);                                                     \
+        t##3 = TD_COLUMN(s##3, s##2, s##1, s##0, rk[4 * (r) + 3]);                                                     \
+    } while (0)
+
+/**
+ * @brief Applies rounds 1 to nr - 1 with all rounds unrolled, ping-ponging between s and t.
+ * @details Every key size has an odd number of middle rounds, so the state
+ * always ends in t. With a constant nr the key-size tests fold away.
+ */
+#define TABLE_MIDDLE_ROUNDS(ROUND, nr)                                                                                 \
+    do                                                                                                                 \
+    {                                                                                                                  \
+        ROUND(t, s, 1);                                                                                                \
+        ROUND(s, t, 2);                                                                                                \
+        ROUND(t, s, 3);                                                                                                \
+        ROUND(s, t, 4);                                                                                                \
+        ROUND(t, s, 5);                                                                                                \
+        ROUND(s, t, 6);                                                                                                \
+        ROUND(t, s, 7);                                                                                                \
+        ROUND(s, t, 8);                                                                                                \
+        ROUND(t, s, 9);                                                                                                \
+        if ((nr) > AES_ROUNDS_128)                                                                                     \
+        {                                                                                                              \
+            ROUND(s, t, 10);                                                                                           \
+            ROUND(t, s, 11);                                                                                           \
+        }                                                                                                              \
+        if ((nr) > AES_ROUNDS_192)                                                                                     \
+        {                                                                                                              \
+            ROUND(s, t, 12);                                                                                           \
+            ROUND(t, s, 13);                                                                                           \
+        }                                                                                                              \
+    } while (0)
+
+/** @brief Encrypts consecutive blocks with the fused T-table rounds. */
+static inline void ttable_encrypt(const aes_ctx_t* ctx, const uint8_t* in, uint8_t* out, size_t num_blocks,
+                                  const uint16_t nr)
+{
+    const uint32_t* rk = ctx->round_keys;
+
+    for (size_t n = 0; n < num_blocks; n++, in += AES_BLOCK_SIZE, out += AES_BLOCK_SIZE)
+    {
+        uint32_t s0 = load_be32(in) ^ rk[0];
+        uint32_t s1 = load_be32(in + 4) ^ rk[1];
+        uint32_t s2 = load_be32(in + 8) ^ rk[2];
+        uint32_t s3 = load_be32(in + 12) ^ rk[3];
+        uint32_t t0, t1, t2, t3;
+
+        TABLE_MIDDLE_ROUNDS(TE_ROUND, nr);
+
+        const uint32_t* last = rk + WORD_COUNT_PER_BLOCK * nr;
+        store_be32(out, TE_FINAL_COLUMN(t0, t1, t2, t3, last[0]));
+        store_be32(out + 4, TE_FINAL_COLUMN(t1, t2, t3, t0, last[1]));
+        store_be32(out + 8, TE_FINAL_COLUMN(t2, t3, t0, t1, last[2]));
+        store_be32(out + 12, TE_FINAL_COLUMN(t3, t0, t1, t2, last[3]));
+    }
+}
+
+/** @brief Decrypts consecutive blocks with the fused equivalent-inverse-cipher rounds. */
+static inline void ttable_decrypt(const aes_ctx_t* ctx, const uint8_t* in, uint8_t* out, size_t num_blocks,
+                                  const uint16_t nr)
+{
+    const uint32_t* rk = ctx->dec_round_keys;
+
+    for (size_t n = 0; n < num_blocks; n++, in += AES_BLOCK_SIZE, out += AES_BLOCK_SIZE)
+    {
+        uint32_t s0 = load_be32(in) ^ rk[0];
+        uint32_t s1 = load_be32(in + 4) ^ rk[1];
+        uint32_t s2 = load_be32(in + 8) ^ rk[2];
+        uint32_t s3 = load_be32(in + 12) ^ rk[3];
+        uint32_t t0, t1, t2, t3;
+
+        TABLE_MIDDLE_ROUNDS(TD_ROUND, nr);
+
+        const uint32_t* last = rk + WORD_COUNT_PER_BLOCK * nr;
+        store_be32(out, TD_FINAL_COLUMN(t0, t3, t2, t1, last[0]));
+        store_be32(out + 4, TD_FINAL_COLUMN(t1, t0, t3, t2, last[1]));
+        store_be32(out + 8, TD_FINAL_COLUMN(t2, t1, t0, t3, last[2]));
+        store_be32(out + 12, TD_FINAL_COLUMN(t3, t2, t1, t0, last[3]));
+    }
+}
+
+AES_DEFINE_ROUND_KERNELS(ttable)
+
+/**
+ * @brief Expands the key and stores each schedule word as a native 32-bit integer.
+ * @details The decryption schedule holds the round keys in the order
+ * decryption uses them, with InvMixColumns applied to all but the first and
+ * last, as the equivalent inverse cipher requires.
+ */
+static void ttable_expand_key(aes_ctx_t* ctx, const uint8_t* key)
+{
+    uint8_t* bytes     = (uint8_t*)ctx->round_keys;
+    size_t   nr        = ctx->num_rounds;
+    size_t   num_words = (size_t)WORD_COUNT_PER_BLOCK * (nr + 1U);
+
+    aes_expand_key(bytes, key, ctx->key_size, num_words * sizeof(uint32_t));
+    for (size_t i = 0; i < num_words; i++)
+        ctx->round_keys[i] = load_be32(bytes + i * sizeof(uint32_t));
+
+    for (size_t round = 0; round <= nr && ctx->usage != AES_KEY_USAGE_ENCRYPT; round++)
+    {
+        const uint32_t* ek = ctx->round_keys + WORD_COUNT_PER_BLOCK * (nr - round);
+        uint32_t*       dk = ctx->dec_round_keys + WORD_COUNT_PER_BLOCK * round;
+        for (size_t i = 0; i < WORD_COUNT_PER_BLOCK; i++)
+            dk[i] = (round == 0 || round == nr) ? ek[i] : aes_inv_mix_column_word(ek[i]);
+    }
+
+    ttable_select_kernels(ctx);
+}
+
+const aes_backend_ops_t aes_backend_ttable = {
+    AES_BACKEND_TTABLE, "ttable", 0, ttable_expand_key, ttable_encrypt_blocks,
+    ttable_decrypt_blocks, NULL, NULL, NULL, NULL, NULL, NULL,
+};
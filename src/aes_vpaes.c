@@ -0,0 +1,214 @@
+/**
+ * @file aes_vpaes.c
+ * @brief The constant-time SSSE3 vector-permute backend.
+ *
+ * @details The whole state lives in one XMM register and the S-box is
+ * evaluated with pshufb lookups into 16-entry tables, so no memory access
+ * depends on secret data. SubBytes is computed algebraically: GF(2^8) is
+ * viewed as a quadratic extension of its own subfield GF(2^4), each byte is
+ * held as its two subfield coordinates (one per nibble), and the inversion
+ * becomes a handful of nibble lookups and XORs. The two nibbles it yields
+ * index a table pair that undoes the representation and, at the same time,
+ * applies the affine map and the MixColumns or InvMixColumns coefficient.
+ *
+ * Encryption keeps the state in the tower basis between rounds; decryption
+ * keeps it in that basis composed with the inverse affine map, which lets
+ * every InvMixColumns product be read from the same kind of table. Both
+ * basis changes are linear, so they and the S-box constant {63} are folded
+ * into the round keys at setup, and the key schedule computes its own
+ * SubWord with the same lookups. The tables are derived and checked by
+ * aes_gen_tables; see aes_internal.h for their layout.
+ *
+ * This translation unit is compiled with SSSE3 code generation enabled; its
+ * functions are only reached after aes_cpu_features() has reported support.
+ */
+
+#include "aes_internal.h"
+
+#ifdef AES_ARCH_X86
+
+#include <stddef.h>
+#include <stdint.h>
+#include <tmmintrin.h>
+
+/** @brief Loads one row of aes_vpaes_tables. */
+#define VPAES_ROW(row) _mm_load_si128((const __m128i*)aes_vpaes_tables[row])
+
+/** @brief Applies a linear map given as low-nibble and high-nibble tables to every byte. */
+static inline __m128i vpaes_transform(__m128i x, __m128i lo, __m128i hi)
+{
+    const __m128i mask = _mm_set1_epi8(0x0f);
+    return _mm_xor_si128(_mm_shuffle_epi8(lo, _mm_and_si128(x, mask)),
+                         _mm_shuffle_epi8(hi, _mm_and_si128(_mm_srli_epi32(x, 4), mask)));
+}
+
+/**
+ * @brief Inverts every byte of a tower-basis state in GF(2^8).
+ * @details With i and k the two coordinates and j = i ^ k, the nibble
+ * lookups give io = 1/(1/i + a/k) + j and jo = 1/(1/j + a/k) + i, where
+ * pshufb's zeroing of indices with bit 7 set stands in for division by zero.
+ * Their inverses are linear in the inverse of the byte, so a table pair
+ * indexed by io and jo recovers it in any basis.
+ */
+static inline void vpaes_invert(__m128i x, __m128i* io, __m128i* jo)
+{
+    const __m128i mask = _mm_set1_epi8(0x0f);
+    const __m128i inv  = VPAES_ROW(AES_VPAES_INV);
+    __m128i       k    = _mm_and_si128(x, mask);
+    __m128i       i    = _mm_and_si128(_mm_srli_epi32(x, 4), mask);
+    __m128i       j    = _mm_xor_si128(i, k);
+    __m128i       ak   = _mm_shuffle_epi8(VPAES_ROW(AES_VPAES_INVA), k);
+    __m128i       iak  = _mm_xor_si128(_mm_shuffle_epi8(inv, i), ak);
+    __m128i       jak  = _mm_xor_si128(_mm_shuffle_epi8(inv, j), ak);
+
+    *io = _mm_xor_si128(_mm_shuffle_epi8(inv, iak), j);
+    *jo = _mm_xor_si128(_mm_shuffle_epi8(inv, jak), i);
+}
+
+/** @brief Looks up the _IO/_JO table pair starting at row with the indices from vpaes_invert(). */
+static inline __m128i vpaes_lookup(unsigned row, __m128i io, __m128i jo)
+{
+    return _mm_xor_si128(_mm_shuffle_epi8(VPAES_ROW(row), io), _mm_shuffle_epi8(VPAES_ROW(row + 1), jo));
+}
+
+/** @brief Rotates each column of the state by n rows: byte 4c + r takes byte 4c + (r + n) % 4. */
+#define VPAES_ROTATE(x, n)                                                                                             \
+    _mm_shuffle_epi8((x), _mm_setr_epi8(n % 4, (n + 1) % 4, (n + 2) % 4, (n + 3) % 4, 4 + n % 4, 4 + (n + 1) % 4,     \
+                                        4 + (n + 2) % 4, 4 + (n + 3) % 4, 8 + n % 4, 8 + (n + 1) % 4, 8 + (n + 2) % 4, \
+                                        8 + (n + 3) % 4, 12 + n % 4, 12 + (n + 1) % 4, 12 + (n + 2) % 4,               \
+                                        12 + (n + 3) % 4))
+
+/** @brief Encrypts one block; rk holds the folded encryption schedule. */
+static inline __m128i vpaes_encrypt_block(__m128i s, const __m128i* rk, size_t nr)
+{
+    const __m128i shift_rows = _mm_setr_epi8(0, 5, 10, 15, 4, 9, 14, 3, 8, 13, 2, 7, 12, 1, 6, 11);
+    __m128i       io, jo;
+
+    s = _mm_xor_si128(vpaes_transform(s, VPAES_ROW(AES_VPAES_IPT_LO), VPAES_ROW(AES_VPAES_IPT_HI)), rk[0]);
+    for (size_t r = 1; r < nr; r++)
+    {
+        vpaes_invert(_mm_shuffle_epi8(s, shift_rows), &io, &jo);
+        __m128i a = vpaes_lookup(AES_VPAES_SB1_IO, io, jo);
+        __m128i b = vpaes_lookup(AES_VPAES_SB2_IO, io, jo);
+
+        // MixColumns with a = S(x) and b = {02}.S(x): {02}.a_r ^ {03}.a_(r+1) ^ a_(r+2) ^ a_(r+3).
+        s = _mm_xor_si128(_mm_xor_si128(b, VPAES_ROTATE(_mm_xor_si128(a, b), 1)),
+                          _mm_xor_si128(VPAES_ROTATE(a, 2), VPAES_ROTATE(a, 3)));
+        s = _mm_xor_si128(s, rk[r]);
+    }
+    vpaes_invert(_mm_shuffle_epi8(s, shift_rows), &io, &jo);
+    return _mm_xor_si128(vpaes_lookup(AES_VPAES_SBO_IO, io, jo), rk[nr]);
+}
+
+/** @brief Decrypts one block with the equivalent inverse cipher; rk holds the folded decryption schedule. */
+static inline __m128i vpaes_decrypt_block(__m128i s, const __m128i* rk, size_t nr)
+{
+    const __m128i inv_shift_rows = _mm_setr_epi8(0, 13, 10, 7, 4, 1, 14, 11, 8, 5, 2, 15, 12, 9, 6, 3);
+    __m128i       io, jo;
+
+    s = _mm_xor_si128(vpaes_transform(s, VPAES_ROW(AES_VPAES_DIPT_LO), VPAES_ROW(AES_VPAES_DIPT_HI)), rk[0]);
+    for (size_t r = 1; r < nr; r++)
+    {
+        vpaes_invert(_mm_shuffle_epi8(s, inv_shift_rows), &io, &jo);
+
+        // InvMixColumns: {0e}.a_r ^ {0b}.a_(r+1) ^ {0d}.a_(r+2) ^ {09}.a_(r+3), one table pair per coefficient.
+        s = _mm_xor_si128(_mm_xor_si128(vpaes_lookup(AES_VPAES_DSBE_IO, io, jo),
+                                        VPAES_ROTATE(vpaes_lookup(AES_VPAES_DSBB_IO, io, jo), 1)),
+                          _mm_xor_si128(VPAES_ROTATE(vpaes_lookup(AES_VPAES_DSBD_IO, io, jo), 2),
+                                        VPAES_ROTATE(vpaes_lookup(AES_VPAES_DSB9_IO, io, jo), 3)));
+        s = _mm_xor_si128(s, rk[r]);
+    }
+    vpaes_invert(_mm_shuffle_epi8(s, inv_shift_rows), &io, &jo);
+    return _mm_xor_si128(vpaes_lookup(AES_VPAES_DSBO_IO, io, jo), rk[nr]);
+}
+
+/** @brief Encrypts consecutive blocks. */
+static inline void vpaes_encrypt(const aes_ctx_t* ctx, const uint8_t* in, uint8_t* out, size_t num_blocks,
+                                 const size_t nr)
+{
+    const __m128i* rk = (const __m128i*)ctx->round_keys;
+
+    for (size_t n = 0; n < num_blocks; n++, in += AES_BLOCK_SIZE, out += AES_BLOCK_SIZE)
+        _mm_storeu_si128((__m128i*)out, vpaes_encrypt_block(_mm_loadu_si128((const __m128i*)in), rk, nr));
+}
+
+/** @brief Decrypts consecutive blocks. */
+static inline void vpaes_decrypt(const aes_ctx_t* ctx, const uint8_t* in, uint8_t* out, size_t num_blocks,
+                                 const size_t nr)
+{
+    const __m128i* rk = (const __m128i*)ctx->dec_round_keys;
+
+    for (size_t n = 0; n < num_blocks; n++, in += AES_BLOCK_SIZE, out += AES_BLOCK_SIZE)
+        _mm_storeu_si128((__m128i*)out, vpaes_decrypt_block(_mm_loadu_si128((const __m128i*)in), rk, nr));
+}
+
+AES_DEFINE_ROUND_KERNELS(vpaes)
+
+/** @brief Applies SubWord to a 32-bit word with the same constant-time lookups as the rounds. */
+static uint32_t vpaes_sub_word(uint32_t word)
+{
+    __m128i x = vpaes_transform(_mm_cvtsi32_si128((int)word), VPAES_ROW(AES_VPAES_IPT_LO), VPAES_ROW(AES_VPAES_IPT_HI));
+    __m128i io, jo;
+
+    vpaes_invert(x, &io, &jo);
+    return (uint32_t)_mm_cvtsi128_si32(_mm_xor_si128(vpaes_lookup(AES_VPAES_SBO_IO, io, jo), _mm_set1_epi8(0x63)));
+}
+
+/**
+ * @brief Expands the key and folds the basis changes into both schedules.
+ * @details The middle encryption round keys become phi(k) ^ phi({63}), which
+ * cancels the {63} the S-box tables leave out, and the last one k ^ {63}
+ * since the final round ends in the standard basis. The decryption schedule
+ * is the equivalent inverse cipher's, with the decryption basis and its
+ * constant folded in the same way.
+ */
+static void vpaes_expand_key(aes_ctx_t* ctx, const uint8_t* key)
+{
+    __m128i* enc       = (__m128i*)ctx->round_keys;
+    __m128i* dec       = (__m128i*)ctx->dec_round_keys;
+    uint8_t* enc_bytes = (uint8_t*)ctx->round_keys;
+    uint8_t* dec_bytes = (uint8_t*)ctx->dec_round_keys;
+    size_t   nr        = ctx->num_rounds;
+    int      decrypts  = ctx->usage != AES_KEY_USAGE_ENCRYPT;
+
+    // The words are packed little-endian, so on x86 the schedule is in FIPS-197 byte order.
+    aes_expand_key_words(ctx->round_keys, key, (size_t)ctx->key_size / 4, WORD_COUNT_PER_BLOCK * (nr + 1),
+                         vpaes_sub_word);
+    for (size_t round = 0; round <= nr && decrypts; round++)
+    {
+        const uint8_t* ek = enc_bytes + AES_BLOCK_SIZE * (nr - round);
+        uint8_t*       dk = dec_bytes + AES_BLOCK_SIZE * round;
+        for (size_t i = 0; i < AES_BLOCK_SIZE; i += 4)
+            store_be32(dk + i, (round == 0 || round == nr) ? load_be32(ek + i)
+                                                           : aes_inv_mix_column_word(load_be32(ek + i)));
+    }
+
+    const __m128i ipt_lo    = VPAES_ROW(AES_VPAES_IPT_LO);
+    const __m128i ipt_hi    = VPAES_ROW(AES_VPAES_IPT_HI);
+    const __m128i dipt_lo   = VPAES_ROW(AES_VPAES_DIPT_LO);
+    const __m128i dipt_hi   = VPAES_ROW(AES_VPAES_DIPT_HI);
+    const __m128i s_const   = _mm_set1_epi8(0x63);
+    const __m128i enc_const = vpaes_transform(s_const, ipt_lo, ipt_hi);
+    const __m128i dec_const = vpaes_transform(s_const, dipt_lo, dipt_hi);
+
+    enc[0] = vpaes_transform(enc[0], ipt_lo, ipt_hi);
+    for (size_t r = 1; r < nr; r++)
+        enc[r] = _mm_xor_si128(vpaes_transform(enc[r], ipt_lo, ipt_hi), enc_const);
+    enc[nr] = _mm_xor_si128(enc[nr], s_const);
+    for (size_t r = 0; r < nr && decrypts; r++)
+        dec[r] = _mm_xor_si128(vpaes_transform(dec[r], dipt_lo, dipt_hi), dec_const);
+
+    vpaes_select_kernels(ctx);
+}
+
+const aes_backend_ops_t aes_backend_vpaes = {
+    AES_BACKEND_VPAES, "vpaes", AES_CPU_SSSE3, vpaes_expand_key, vpaes_encrypt_blocks, vpaes_decrypt_blocks,
+    NULL, NULL, NULL, NULL, NULL, NULL,
+};
+
+#else
+
+// ISO C forbids an empty translation unit.
+typedef int aes_vpaes_unavailable_t;
+
+#endif // AES_ARCH_X86
@@ -0,0 +1,263 @@
+/**
+ * @file aes_xts.c
+ * @brief XTS-AES (IEEE 1619) for storage sectors, with ciphertext stealing.
+ *
+ * @details Block j of a data unit is processed as E(K1, P ^ T_j) ^ T_j, where
+ * T_0 = E(K2, tweak) and T_(j+1) = T_j * x in GF(2^128) with XTS's
+ * little-endian bit order. Tweaks are generated incrementally into a buffer,
+ * and the whitened blocks then go through the backend's multi-block entry
+ * point XTS_BATCH_BLOCKS at a time. The sector API also encrypts the tweaks
+ * of up to XTS_BATCH_BLOCKS sectors in one backend call.
+ */
+
+#include "aes_internal.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// Blocks whitened and encrypted per backend call, matching the CTR batch.
+#define XTS_BATCH_BLOCKS AES_CTR_BATCH_BLOCKS
+
+/**
+ * @brief Multiplies a 16-byte tweak by x (the primitive element alpha).
+ * @param[in,out] tweak The tweak, a little-endian 128-bit polynomial.
+ */
+static void xts_mul_alpha(uint8_t* tweak)
+{
+    uint64_t lo    = load_le64(tweak);
+    uint64_t hi    = load_le64(tweak + 8);
+    uint64_t carry = hi >> 63;
+    store_le64(tweak, (lo << 1) ^ (carry * 0x87));
+    store_le64(tweak + 8, (hi << 1) | (lo >> 63));
+}
+
+/**
+ * @brief Processes whole blocks under consecutive tweaks.
+ * @details Uses the backend's fused kernel when it has one.
+ * @param[in] ctx The data key context.
+ * @param[in] encrypt Nonzero to encrypt, zero to decrypt.
+ * @param[in,out] tweak The 16-byte tweak of the first block; advanced past the last.
+ * @param[in] in The input blocks.
+ * @param[out] out The output blocks; may equal in.
+ * @param[in] num_blocks The number of blocks.
+ */
+static void xts_blocks(const aes_ctx_t* ctx, int encrypt, uint8_t* tweak, const uint8_t* in, uint8_t* out,
+                       size_t num_blocks)
+{
+    if (ctx->backend->xts_blocks)
+    {
+        ctx->backend->xts_blocks(ctx, encrypt, tweak, in, out, num_blocks);
+        return;
+    }
+
+    uint8_t  tweaks[XTS_BATCH_BLOCKS * AES_BLOCK_SIZE];
+    uint64_t lo = load_le64(tweak);
+    uint64_t hi = load_le64(tweak + 8);
+
+    while (num_blocks > 0)
+    {
+        size_t count = num_blocks < XTS_BATCH_BLOCKS ? num_blocks : XTS_BATCH_BLOCKS;
+        size_t bytes = count * AES_BLOCK_SIZE;
+
+        // T_(j+1) = T_j * x: a one-bit left shift with 0x87 folded back in.
+        for (size_t i = 0; i < count; i++)
+        {
+            store_le64(tweaks + i * AES_BLOCK_SIZE, lo);
+            store_le64(tweaks + i * AES_BLOCK_SIZE + 8, hi);
+            uint64_t carry = hi >> 63;
+            hi             = (hi << 1) | (lo >> 63);
+            lo             = (lo << 1) ^ (carry * 0x87);
+        }
+
+        // Whiten into the output, run the cipher there in place, whiten again.
+        xor_bytes(out, in, tweaks, bytes);
+        if (encrypt)
+            ctx->encrypt_blocks(ctx, out, out, count);
+        else
+            ctx->decrypt_blocks(ctx, out, out, count);
+        xor_bytes(out, out, tweaks, bytes);
+
+        in += bytes;
+        out += bytes;
+        num_blocks -= count;
+    }
+
+    store_le64(tweak, lo);
+    store_le64(tweak + 8, hi);
+    secure_zero_memory(tweaks, sizeof(tweaks));
+}
+
+/**
+ * @brief Processes one data unit, stealing ciphertext for a partial final block.
+ * @param[in] ctx The data key context.
+ * @param[in] encrypt Nonzero to encrypt, zero to decrypt.
+ * @param[in] encrypted_tweak T_0, the tweak already encrypted under the tweak key.
+ * @param[in] in The input data unit.
+ * @param[out] out The output buffer; may equal in.
+ * @param[in] length The data unit length, at least one block.
+ */
+static void xts_data_unit(const aes_ctx_t* ctx, int encrypt, const uint8_t* encrypted_tweak, const uint8_t* in,
+                          uint8_t* out, size_t length)
+{
+    uint8_t tweak[AES_BLOCK_SIZE];
+    size_t  whole = length / AES_BLOCK_SIZE;
+    size_t  rest  = length % AES_BLOCK_SIZE;
+
+    memcpy(tweak, encrypted_tweak, sizeof(tweak));
+    if (rest == 0)
+    {
+        xts_blocks(ctx, encrypt, tweak, in, out, whole);
+        secure_zero_memory(tweak, sizeof(tweak));
+        return;
+    }
+
+    xts_blocks(ctx, encrypt, tweak, in, out, whole - 1);
+
+    // tweak is now T_(m-1) for the last whole block; next becomes T_m.
+    const uint8_t* last_in  = in + (whole - 1) * AES_BLOCK_SIZE;
+    uint8_t*       last_out = out + (whole - 1) * AES_BLOCK_SIZE;
+    uint8_t        next[AES_BLOCK_SIZE], stolen[AES_BLOCK_SIZE], block[AES_BLOCK_SIZE];
+    memcpy(next, tweak, sizeof(next));
+    xts_mul_alpha(next);
+
+    // The last whole block is processed under T_(m-1) when encrypting and
+    // T_m when decrypting; its first rest bytes become the partial block and
+    // its tail pads the partial input, which is processed under the other tweak.
+    memcpy(stolen, last_in + AES_BLOCK_SIZE, rest);
+    xts_blocks(ctx, encrypt, encrypt ? tweak : next, last_in, block, 1);
+    memcpy(stolen + rest, block + rest, AES_BLOCK_SIZE - rest);
+    memcpy(last_out + AES_BLOCK_SIZE, block, rest);
+    xts_blocks(ctx, encrypt, encrypt ? next : tweak, stolen, last_out, 1);
+
+    secure_zero_memory(tweak, sizeof(tweak));
+    secure_zero_memory(next, sizeof(next));
+    secure_zero_memory(stolen, sizeof(stolen));
+    secure_zero_memory(block, sizeof(block));
+}
+
+/**
+ * @brief Validates arguments and processes consecutive sectors.
+ * @param[in] xts An initialized context.
+ * @param[in] encrypt Nonzero to encrypt, zero to decrypt.
+ * @param[in] sector The first sector number.
+ * @param[in] sector_size The sector size in bytes.
+ * @param[in] in The input sectors.
+ * @param[out] out The output buffer; may equal in.
+ * @param[in] num_sectors The number of sectors.
+ * @return AES_SUCCESS, or an error for invalid arguments.
+ */
+static aes_error_t xts_sectors(const aes_xts_ctx_t* xts, int encrypt, uint64_t sector, size_t sector_size,
+                               const uint8_t* in, uint8_t* out, size_t num_sectors)
+{
+    uint8_t  tweaks[XTS_BATCH_BLOCKS * AES_BLOCK_SIZE];
+    uint64_t sector_high = 0;
+
+    if (!xts || !xts->data.backend || !xts->tweak.backend || (num_sectors && (!in || !out)))
+        return AES_ERROR_INVALID_ARGUMENT;
+    if (sector_size < AES_BLOCK_SIZE)
+        return AES_ERROR_INVALID_LENGTH;
+
+    AES_STATS_BEGIN(start);
+    size_t remaining = num_sectors;
+
+    while (remaining > 0)
+    {
+        size_t count = remaining < XTS_BATCH_BLOCKS ? remaining : XTS_BATCH_BLOCKS;
+
+        for (size_t i = 0; i < count; i++)
+        {
+            store_le64(tweaks + i * AES_BLOCK_SIZE, sector + i);
+            store_le64(tweaks + i * AES_BLOCK_SIZE + 8, sector_high + (sector + i < sector));
+        }
+        xts->tweak.encrypt_blocks(&xts->tweak, tweaks, tweaks, count);
+
+        for (size_t i = 0; i < count; i++)
+        {
+            xts_data_unit(&xts->data, encrypt, tweaks + i * AES_BLOCK_SIZE, in, out, sector_size);
+            in += sector_size;
+            out += sector_size;
+        }
+
+        // The sector number is a 128-bit little-endian value.
+        sector_high += sector + count < sector;
+        sector += count;
+        remaining -= count;
+    }
+
+    secure_zero_memory(tweaks, sizeof(tweaks));
+    AES_STATS_RECORD(AES_STATS_XTS, xts->data.backend->id, num_sectors * sector_size, start);
+    return AES_SUCCESS;
+}
+
+/**
+ * @brief Validates arguments and processes one data unit with an explicit tweak.
+ * @return AES_SUCCESS, or an error for invalid arguments.
+ */
+static aes_error_t xts_single(const aes_xts_ctx_t* xts, int encrypt, const uint8_t* tweak, const uint8_t* in,
+                              uint8_t* out, size_t length)
+{
+    uint8_t encrypted_tweak[AES_BLOCK_SIZE];
+
+    if (!xts || !xts->data.backend || !xts->tweak.backend || !tweak || !in || !out)
+        return AES_ERROR_INVALID_ARGUMENT;
+    if (length < AES_BLOCK_SIZE)
+        return AES_ERROR_INVALID_LENGTH;
+
+    AES_STATS_BEGIN(start);
+    xts->tweak.encrypt_blocks(&xts->tweak, tweak, encrypted_tweak, 1);
+    xts_data_unit(&xts->data, encrypt, encrypted_tweak, in, out, length);
+    secure_zero_memory(encrypted_tweak, sizeof(encrypted_tweak));
+    AES_STATS_RECORD(AES_STATS_XTS, xts->data.backend->id, length, start);
+    return AES_SUCCESS;
+}
+
+aes_error_t aes_xts_init(aes_xts_ctx_t* xts, const uint8_t* key, aes_key_size_t key_size, aes_backend_t backend)
+{
+    if (!xts || !key)
+        return AES_ERROR_INVALID_ARGUMENT;
+    if (key_size != AES_KEY_SIZE_128 && key_size != AES_KEY_SIZE_256)
+        return AES_ERROR_UNSUPPORTED_KEY_SIZE;
+
+    // SP 800-38E requires distinct halves; accumulate every difference before deciding.
+    uint8_t diff = 0;
+    for (size_t i = 0; i < (size_t)key_size; i++)
+        diff |= (uint8_t)(key[i] ^ key[(size_t)key_size + i]);
+    if (diff == 0)
+        return AES_ERROR_INVALID_ARGUMENT;
+
+    aes_error_t result = aes_ctx_init_backend(&xts->data, key, key_size, backend);
+    if (result == AES_SUCCESS)
+        result = aes_ctx_init_ex(&xts->tweak, key + key_size, key_size, backend, AES_KEY_USAGE_ENCRYPT);
+    if (result != AES_SUCCESS)
+        aes_xts_clear(xts);
+    return result;
+}
+
+aes_error_t aes_xts_encrypt(const aes_xts_ctx_t* xts, const uint8_t* tweak, const uint8_t* in, uint8_t* out,
+                            size_t length)
+{
+    return xts_single(xts, 1, tweak, in, out, length);
+}
+
+aes_error_t aes_xts_decrypt(const aes_xts_ctx_t* xts, const uint8_t* tweak, const uint8_t* in, uint8_t* out,
+                            size_t length)
+{
+    return xts_single(xts, 0, tweak, in, out, length);
+}
+
+aes_error_t aes_xts_encrypt_sectors(const aes_xts_ctx_t* xts, uint64_t sector, size_t sector_size, const uint8_t* in,
+                                    uint8_t* out, size_t num_sectors)
+{
+    return xts_sectors(xts, 1, sector, sector_size, in, out, num_sectors);
+}
+
+aes_error_t aes_xts_decrypt_sectors(const aes_xts_ctx_t* xts, uint64_t sector, size_t sector_size, const uint8_t* in,
+                                    uint8_t* out, size_t num_sectors)
+{
+    return xts_sectors(xts, 0, sector, sector_size, in, out, num_sectors);
+}
+
+void aes_xts_clear(aes_xts_ctx_t* xts)
+{
+    secure_zero_memory(xts, xts ? sizeof(*xts) : 0);
+}
@@ -12,6 +12,8 @@
 #include <stdio.h>
 #include <string.h>
 
+#include "test_util.h"
+
 /* ============================================================================
  * Test Utilities
  * ========================================================================= */
@@ -88,6 +90,481 @@ static int run_fips_test_case(const char* test_name, const uint8_t* key, aes_key
     return 0;
 }
 
+/**
+ * @brief Runs a known answer test through the reusable context API.
+ * @details For every backend, the context is initialized once and then used
+ * for several encryptions and an in-place decryption, verifying that the
+ * schedule is not consumed or modified by use.
+ * @param[in] test_name A descriptive name for the test case.
+ * @param[in] key A pointer to the AES key.
+ * @param[in] key_size The size of the key.
+ * @param[in] plaintext The plaintext to be encrypted.
+ * @param[in] expected_ciphertext The known-correct ciphertext for verification.
+ * @return 0 on success, 1 on failure.
+ */
+static int run_ctx_test_case(const char* test_name, const uint8_t* key, aes_key_size_t key_size,
+                             const uint8_t* plaintext, const uint8_t* expected_ciphertext)
+{
+    aes_ctx_t ctx;
+    uint8_t   block[AES_BLOCK_SIZE];
+
+    for (size_t b = 0; b < TEST_BACKEND_COUNT; b++)
+    {
+        const char* name = aes_backend_name(test_backends[b]);
+        if (!aes_backend_is_supported(test_backends[b]))
+        {
+            printf("\nSKIP: %s backend is not supported on this CPU.\n", name);
+            continue;
+        }
+        printf("\n--- Running Test Case: %s (context, %s) ---\n", test_name, name);
+
+        aes_error_t result = aes_ctx_init_backend(&ctx, key, key_size, test_backends[b]);
+        if (result != AES_SUCCESS)
+        {
+            fprintf(stderr, "FAIL: aes_ctx_init_backend failed with error: %s\n", aes_error_to_string(result));
+            return 1;
+        }
+
+        for (int i = 0; i < 3; i++)
+        {
+            memset(block, 0, sizeof(block));
+            aes_ctx_encrypt(&ctx, plaintext, block);
+            if (memcmp(block, expected_ciphertext, AES_BLOCK_SIZE) != 0)
+            {
+                fprintf(stderr, "FAIL: Context ciphertext does not match on use %d.\n", i);
+                print_hex("Actual:", block, AES_BLOCK_SIZE);
+                aes_ctx_clear(&ctx);
+                return 1;
+            }
+        }
+
+        aes_ctx_decrypt(&ctx, block, block);
+        aes_ctx_clear(&ctx);
+        if (memcmp(block, plaintext, AES_BLOCK_SIZE) != 0)
+        {
+            fprintf(stderr, "FAIL: In-place context decryption does not match the plaintext.\n");
+            return 1;
+        }
+    }
+
+    if (aes_ctx_init(&ctx, key, (aes_key_size_t)20) != AES_ERROR_UNSUPPORTED_KEY_SIZE ||
+        aes_ctx_init(NULL, key, key_size) != AES_ERROR_INVALID_ARGUMENT)
+    {
+        fprintf(stderr, "FAIL: aes_ctx_init accepted invalid arguments.\n");
+        return 1;
+    }
+
+    printf("PASS: Test passed!\n");
+    return 0;
+}
+
+/**
+ * @brief Cross-checks every backend against the reference on pseudo-random data.
+ * @details Keys and blocks come from a fixed linear congruential generator so
+ * that failures are reproducible.
+ * @return 0 on success, 1 on failure.
+ */
+static int run_backend_cross_check(void)
+{
+    static const aes_key_size_t key_sizes[] = {AES_KEY_SIZE_128, AES_KEY_SIZE_192, AES_KEY_SIZE_256};
+    uint32_t                    seed        = 0x12345678U;
+    uint8_t                     key[32];
+    uint8_t                     block[AES_BLOCK_SIZE];
+    uint8_t                     expected[AES_BLOCK_SIZE];
+    uint8_t                     actual[AES_BLOCK_SIZE];
+    aes_ctx_t                   reference;
+    aes_ctx_t                   ctx;
+
+    printf("\n--- Running Test Case: backend cross-check ---\n");
+    for (int iteration = 0; iteration < 64; iteration++)
+    {
+        aes_key_size_t key_size = key_sizes[iteration % 3];
+        for (size_t i = 0; i < sizeof(key); i++)
+            key[i] = (uint8_t)((seed = seed * 1103515245U + 12345U) >> 16);
+        for (size_t i = 0; i < sizeof(block); i++)
+            block[i] = (uint8_t)((seed = seed * 1103515245U + 12345U) >> 16);
+
+        aes_ctx_init_backend(&reference, key, key_size, AES_BACKEND_REFERENCE);
+        aes_ctx_encrypt(&reference, block, expected);
+
+        for (size_t b = 0; b < TEST_BACKEND_COUNT; b++)
+        {
+            if (aes_ctx_init_backend(&ctx, key, key_size, test_backends[b]) != AES_SUCCESS)
+                continue;
+            aes_ctx_encrypt(&ctx, block, actual);
+            if (memcmp(actual, expected, AES_BLOCK_SIZE) != 0)
+            {
+                fprintf(stderr, "FAIL: %s encryption differs from the reference.\n",
+                        aes_backend_name(test_backends[b]));
+                return 1;
+            }
+            aes_ctx_decrypt(&ctx, actual, actual);
+            if (memcmp(actual, block, AES_BLOCK_SIZE) != 0)
+            {
+                fprintf(stderr, "FAIL: %s decryption does not round-trip.\n", aes_backend_name(test_backends[b]));
+                return 1;
+            }
+        }
+    }
+
+    aes_ctx_clear(&reference);
+    aes_ctx_clear(&ctx);
+    printf("PASS: Test passed!\n");
+    return 0;
+}
+
+/**
+ * @brief Checks multi-block ECB against single-block reference encryption.
+ * @details Lengths from 0 to 19 blocks cover full eight-block batches, a
+ * partial batch and the in-place case for every backend.
+ * @return 0 on success, 1 on failure.
+ */
+static int run_ecb_test(void)
+{
+    static const uint8_t key[AES_KEY_SIZE_256] = {0x60, 0x3d, 0xeb, 0x10, 0x15, 0xca, 0x71, 0xbe, 0x2b, 0x73, 0xae,
+                                                  0xf0, 0x85, 0x7d, 0x77, 0x81, 0x1f, 0x35, 0x2c, 0x07, 0x3b, 0x61,
+                                                  0x08, 0xd7, 0x2d, 0x98, 0x10, 0xa3, 0x09, 0x14, 0xdf, 0xf4};
+    uint8_t              plaintext[19 * AES_BLOCK_SIZE];
+    uint8_t              expected[sizeof(plaintext)];
+    uint8_t              buffer[sizeof(plaintext)];
+    aes_ctx_t            ctx;
+
+    printf("\n--- Running Test Case: multi-block ECB ---\n");
+    for (size_t i = 0; i < sizeof(plaintext); i++)
+        plaintext[i] = (uint8_t)(i * 7 + 3);
+
+    aes_ctx_init_backend(&ctx, key, AES_KEY_SIZE_256, AES_BACKEND_REFERENCE);
+    for (size_t i = 0; i < sizeof(plaintext); i += AES_BLOCK_SIZE)
+        aes_ctx_encrypt(&ctx, plaintext + i, expected + i);
+
+    for (size_t b = 0; b < TEST_BACKEND_COUNT; b++)
+    {
+        if (aes_ctx_init_backend(&ctx, key, AES_KEY_SIZE_256, test_backends[b]) != AES_SUCCESS)
+            continue;
+
+        for (size_t blocks = 0; blocks <= sizeof(plaintext) / AES_BLOCK_SIZE; blocks++)
+        {
+            size_t length = blocks * AES_BLOCK_SIZE;
+            memcpy(buffer, plaintext, length);
+            aes_ecb_encrypt(&ctx, buffer, buffer, length);
+            if (memcmp(buffer, expected, length) != 0)
+            {
+                fprintf(stderr, "FAIL: %s ECB encryption of %zu blocks is wrong.\n",
+                        aes_backend_name(test_backends[b]), blocks);
+                return 1;
+            }
+            aes_ecb_decrypt(&ctx, buffer, buffer, length);
+            if (memcmp(buffer, plaintext, length) != 0)
+            {
+                fprintf(stderr, "FAIL: %s ECB decryption of %zu blocks is wrong.\n",
+                        aes_backend_name(test_backends[b]), blocks);
+                return 1;
+            }
+        }
+    }
+
+    if (aes_ecb_encrypt(&ctx, plaintext, buffer, AES_BLOCK_SIZE + 1) != AES_ERROR_INVALID_LENGTH)
+    {
+        fprintf(stderr, "FAIL: ECB accepted a partial block.\n");
+        return 1;
+    }
+
+    aes_ctx_clear(&ctx);
+    printf("PASS: Test passed!\n");
+    return 0;
+}
+
+// Contexts in the multi-key test: several lane groups plus a partial one.
+#define NUM_KEYS 45
+
+/**
+ * @brief Checks the multi-key batch API against one aes_ctx_encrypt() per key.
+ * @details The contexts cycle through every backend and key size, so the
+ * batch splits into runs of every length, and the raw-key entry point covers
+ * more than one internal expansion batch. All calls run in place.
+ * @return 0 on success, 1 on failure.
+ */
+static int run_multi_key_test(void)
+{
+    static const aes_key_size_t key_sizes[] = {AES_KEY_SIZE_128, AES_KEY_SIZE_192, AES_KEY_SIZE_256};
+    static aes_ctx_t ctxs[NUM_KEYS];
+    const aes_ctx_t* ptrs[NUM_KEYS];
+    uint8_t          keys[NUM_KEYS * AES_KEY_SIZE_256];
+    uint8_t          plaintext[NUM_KEYS * AES_BLOCK_SIZE];
+    uint8_t          expected[sizeof(plaintext)];
+    uint8_t          buffer[sizeof(plaintext)];
+    size_t           n = 0;
+
+    printf("\n--- Running Test Case: multi-key batches ---\n");
+    for (size_t i = 0; i < sizeof(keys); i++)
+        keys[i] = (uint8_t)(i * 13 + 5);
+    for (size_t i = 0; i < sizeof(plaintext); i++)
+        plaintext[i] = (uint8_t)(i * 7 + 3);
+
+    // Runs of 1 to 9 contexts sharing a backend and key size.
+    for (size_t run = 1; n < NUM_KEYS; run = run % 9 + 1)
+    {
+        aes_backend_t  backend  = test_backends[(n / 3) % TEST_BACKEND_COUNT];
+        aes_key_size_t key_size = key_sizes[n % 3];
+        if (!aes_backend_is_supported(backend))
+            backend = AES_BACKEND_TTABLE;
+        for (size_t i = 0; i < run && n < NUM_KEYS; i++, n++)
+        {
+            aes_ctx_init_backend(&ctxs[n], keys + n * AES_KEY_SIZE_256, key_size, backend);
+            aes_ctx_encrypt(&ctxs[n], plaintext + n * AES_BLOCK_SIZE, expected + n * AES_BLOCK_SIZE);
+            ptrs[n] = &ctxs[n];
+        }
+    }
+
+    memcpy(buffer, plaintext, sizeof(buffer));
+    if (aes_multi_encrypt(ptrs, buffer, buffer, NUM_KEYS) != AES_SUCCESS ||
+        memcmp(buffer, expected, sizeof(buffer)) != 0)
+    {
+        fprintf(stderr, "FAIL: Multi-key encryption is wrong.\n");
+        return 1;
+    }
+    if (aes_multi_decrypt(ptrs, buffer, buffer, NUM_KEYS) != AES_SUCCESS ||
+        memcmp(buffer, plaintext, sizeof(buffer)) != 0)
+    {
+        fprintf(stderr, "FAIL: Multi-key decryption is wrong.\n");
+        return 1;
+    }
+
+    // Every backend on its own, for full and partial lane groups.
+    for (size_t b = 0; b < TEST_BACKEND_COUNT; b++)
+    {
+        if (!aes_backend_is_supported(test_backends[b]))
+            continue;
+        for (size_t i = 0; i < NUM_KEYS; i++)
+        {
+            aes_ctx_init_backend(&ctxs[i], keys + i * AES_KEY_SIZE_128, AES_KEY_SIZE_128, test_backends[b]);
+            aes_ctx_encrypt(&ctxs[i], plaintext + i * AES_BLOCK_SIZE, expected + i * AES_BLOCK_SIZE);
+        }
+        memcpy(buffer, plaintext, sizeof(buffer));
+        aes_multi_encrypt(ptrs, buffer, buffer, NUM_KEYS);
+        if (memcmp(buffer, expected, sizeof(buffer)) != 0)
+        {
+            fprintf(stderr, "FAIL: %s multi-key encryption is wrong.\n", aes_backend_name(test_backends[b]));
+            return 1;
+        }
+        aes_multi_decrypt(ptrs, buffer, buffer, NUM_KEYS);
+        if (memcmp(buffer, plaintext, sizeof(buffer)) != 0)
+        {
+            fprintf(stderr, "FAIL: %s multi-key decryption is wrong.\n", aes_backend_name(test_backends[b]));
+            return 1;
+        }
+    }
+
+    // Raw keys, laid out back to back at the key size.
+    for (size_t i = 0; i < NUM_KEYS; i++)
+    {
+        aes_ctx_init(&ctxs[i], keys + i * AES_KEY_SIZE_192, AES_KEY_SIZE_192);
+        aes_ctx_encrypt(&ctxs[i], plaintext + i * AES_BLOCK_SIZE, expected + i * AES_BLOCK_SIZE);
+    }
+    memcpy(buffer, plaintext, sizeof(buffer));
+    if (aes_multi_encrypt_keys(keys, AES_KEY_SIZE_192, buffer, buffer, NUM_KEYS) != AES_SUCCESS ||
+        memcmp(buffer, expected, sizeof(buffer)) != 0)
+    {
+        fprintf(stderr, "FAIL: Multi-key encryption with raw keys is wrong.\n");
+        return 1;
+    }
+
+    ptrs[NUM_KEYS / 2] = NULL;
+    if (aes_multi_encrypt(ptrs, buffer, buffer, NUM_KEYS) != AES_ERROR_INVALID_ARGUMENT ||
+        aes_multi_encrypt_keys(keys, (aes_key_size_t)20, buffer, buffer, 1) != AES_ERROR_UNSUPPORTED_KEY_SIZE)
+    {
+        fprintf(stderr, "FAIL: An invalid multi-key batch was accepted.\n");
+        return 1;
+    }
+
+    for (size_t i = 0; i < NUM_KEYS; i++)
+        aes_ctx_clear(&ctxs[i]);
+    printf("PASS: Test passed!\n");
+    return 0;
+}
+
+// Contexts in the batch initialization test: more than one four-key lane group plus a partial one.
+#define NUM_BATCH_KEYS 11
+
+/**
+ * @brief Checks aes_ctx_init_batch() against one aes_ctx_init_backend() per key.
+ * @details Every backend and key size is expanded in batches of 0 to
+ * NUM_BATCH_KEYS keys, and each context must encrypt and decrypt a block
+ * exactly as an individually initialized one does.
+ * @return 0 on success, 1 on failure.
+ */
+static int run_batch_init_test(void)
+{
+    static const aes_key_size_t key_sizes[] = {AES_KEY_SIZE_128, AES_KEY_SIZE_192, AES_KEY_SIZE_256};
+    static aes_ctx_t            ctxs[NUM_BATCH_KEYS];
+    aes_ctx_t                   single;
+    uint8_t                     keys[NUM_BATCH_KEYS * AES_KEY_SIZE_256];
+    uint8_t                     block[AES_BLOCK_SIZE] = {0};
+    uint8_t                     expected[AES_BLOCK_SIZE];
+    uint8_t                     actual[AES_BLOCK_SIZE];
+
+    printf("\n--- Running Test Case: batch key initialization ---\n");
+    for (size_t i = 0; i < sizeof(keys); i++)
+        keys[i] = (uint8_t)(i * 29 + 11);
+
+    for (size_t b = 0; b < TEST_BACKEND_COUNT; b++)
+    {
+        if (!aes_backend_is_supported(test_backends[b]))
+            continue;
+        for (size_t k = 0; k < 3; k++)
+        {
+            for (size_t count = 0; count <= NUM_BATCH_KEYS; count++)
+            {
+                if (aes_ctx_init_batch(ctxs, keys, key_sizes[k], count, test_backends[b], AES_KEY_USAGE_BOTH) !=
+                    AES_SUCCESS)
+                {
+                    fprintf(stderr, "FAIL: %s batch initialization failed.\n", aes_backend_name(test_backends[b]));
+                    return 1;
+                }
+                for (size_t i = 0; i < count; i++)
+                {
+                    block[0] = (uint8_t)i;
+                    aes_ctx_init_backend(&single, keys + i * key_sizes[k], key_sizes[k], test_backends[b]);
+                    aes_ctx_encrypt(&single, block, expected);
+                    aes_ctx_encrypt(&ctxs[i], block, actual);
+                    if (memcmp(actual, expected, AES_BLOCK_SIZE) != 0)
+                    {
+                        fprintf(stderr, "FAIL: %s batch key %zu of %zu encrypts wrongly.\n",
+                                aes_backend_name(test_backends[b]), i, count);
+                        return 1;
+                    }
+                    aes_ctx_decrypt(&ctxs[i], actual, actual);
+                    if (memcmp(actual, block, AES_BLOCK_SIZE) != 0)
+                    {
+                        fprintf(stderr, "FAIL: %s batch key %zu of %zu decrypts wrongly.\n",
+                                aes_backend_name(test_backends[b]), i, count);
+                        return 1;
+                    }
+                }
+            }
+        }
+    }
+
+    if (aes_ctx_init_batch(NULL, keys, AES_KEY_SIZE_128, 1, AES_BACKEND_AUTO, AES_KEY_USAGE_BOTH) !=
+            AES_ERROR_INVALID_ARGUMENT ||
+        aes_ctx_init_batch(ctxs, keys, (aes_key_size_t)20, 1, AES_BACKEND_AUTO, AES_KEY_USAGE_BOTH) !=
+            AES_ERROR_UNSUPPORTED_KEY_SIZE)
+    {
+        fprintf(stderr, "FAIL: An invalid batch was accepted.\n");
+        return 1;
+    }
+
+    for (size_t i = 0; i < NUM_BATCH_KEYS; i++)
+        aes_ctx_clear(&ctxs[i]);
+    aes_ctx_clear(&single);
+    printf("PASS: Test passed!\n");
+    return 0;
+}
+
+/**
+ * @brief Checks that single-direction contexts work one way and are rejected the other.
+ * @return 0 on success, 1 on failure.
+ */
+static int run_key_usage_test(void)
+{
+    static const uint8_t key[AES_KEY_SIZE_192] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12,
+                                                  13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24};
+    uint8_t              block[2 * AES_BLOCK_SIZE] = {0x42};
+    uint8_t              expected[sizeof(block)];
+    uint8_t              actual[sizeof(block)];
+    uint8_t              iv[AES_BLOCK_SIZE] = {0};
+    aes_ctx_t            both;
+    aes_ctx_t            ctx;
+
+    printf("\n--- Running Test Case: single-direction contexts ---\n");
+    for (size_t b = 0; b < TEST_BACKEND_COUNT; b++)
+    {
+        const char* name = aes_backend_name(test_backends[b]);
+        if (!aes_backend_is_supported(test_backends[b]))
+            continue;
+
+        aes_ctx_init_backend(&both, key, AES_KEY_SIZE_192, test_backends[b]);
+        aes_ecb_encrypt(&both, block, expected, sizeof(block));
+
+        if (aes_ctx_init_ex(&ctx, key, AES_KEY_SIZE_192, test_backends[b], AES_KEY_USAGE_ENCRYPT) != AES_SUCCESS ||
+            aes_ecb_encrypt(&ctx, block, actual, sizeof(block)) != AES_SUCCESS ||
+            memcmp(actual, expected, sizeof(block)) != 0)
+        {
+            fprintf(stderr, "FAIL: %s encrypt-only context encrypts wrongly.\n", name);
+            return 1;
+        }
+        if (aes_ctx_decrypt(&ctx, actual, actual) != AES_ERROR_INVALID_ARGUMENT ||
+            aes_cbc_decrypt(&ctx, iv, expected, actual, sizeof(block)) != AES_ERROR_INVALID_ARGUMENT)
+        {
+            fprintf(stderr, "FAIL: %s encrypt-only context was used to decrypt.\n", name);
+            return 1;
+        }
+
+        if (aes_ctx_init_ex(&ctx, key, AES_KEY_SIZE_192, test_backends[b], AES_KEY_USAGE_DECRYPT) != AES_SUCCESS ||
+            aes_ecb_decrypt(&ctx, expected, actual, sizeof(block)) != AES_SUCCESS ||
+            memcmp(actual, block, sizeof(block)) != 0)
+        {
+            fprintf(stderr, "FAIL: %s decrypt-only context decrypts wrongly.\n", name);
+            return 1;
+        }
+        if (aes_ctx_encrypt(&ctx, block, actual) != AES_ERROR_INVALID_ARGUMENT ||
+            aes_ctr_xcrypt(&ctx, iv, block, actual, sizeof(block)) != AES_ERROR_INVALID_ARGUMENT)
+        {
+            fprintf(stderr, "FAIL: %s decrypt-only context was used to encrypt.\n", name);
+            return 1;
+        }
+    }
+
+    if (aes_ctx_init_ex(&ctx, key, AES_KEY_SIZE_128, AES_BACKEND_AUTO, (aes_key_usage_t)7) !=
+        AES_ERROR_INVALID_ARGUMENT)
+    {
+        fprintf(stderr, "FAIL: An unknown key usage was accepted.\n");
+        return 1;
+    }
+
+    aes_ctx_clear(&both);
+    aes_ctx_clear(&ctx);
+    printf("PASS: Test passed!\n");
+    return 0;
+}
+
+/**
+ * @brief Verifies that the default backend can be overridden and restored.
+ * @return 0 on success, 1 on failure.
+ */
+static int run_default_backend_test(void)
+{
+    static const uint8_t key[AES_KEY_SIZE_128] = {0};
+    aes_ctx_t            ctx;
+    aes_backend_t        detected = aes_get_default_backend();
+
+    printf("\n--- Running Test Case: default backend selection (detected: %s) ---\n", aes_backend_name(detected));
+
+    if (aes_set_default_backend(AES_BACKEND_REFERENCE) != AES_SUCCESS ||
+        aes_ctx_init(&ctx, key, AES_KEY_SIZE_128) != AES_SUCCESS || aes_ctx_get_backend(&ctx) != AES_BACKEND_REFERENCE)
+    {
+        fprintf(stderr, "FAIL: Forcing the reference backend had no effect.\n");
+        return 1;
+    }
+
+    if (aes_set_default_backend(AES_BACKEND_AUTO) != AES_SUCCESS || aes_get_default_backend() != detected)
+    {
+        fprintf(stderr, "FAIL: Restoring automatic selection did not re-detect the backend.\n");
+        return 1;
+    }
+
+    if (!aes_backend_is_supported(AES_BACKEND_AESNI) &&
+        aes_set_default_backend(AES_BACKEND_AESNI) != AES_ERROR_UNSUPPORTED_BACKEND)
+    {
+        fprintf(stderr, "FAIL: An unsupported backend was accepted as the default.\n");
+        return 1;
+    }
+
+    aes_ctx_clear(&ctx);
+    printf("PASS: Test passed!\n");
+    return 0;
+}
+
 /* ============================================================================
  * Main Test Function
  * ========================================================================= */
@@ -108,6 +585,7 @@ int main(void)
     const uint8_t ciphertext128[] = {0x39, 0x25, 0x84, 0x1d, 0x02, 0xdc, 0x09, 0xfb,
                                      0xdc, 0x11, 0x85, 0x97, 0x19, 0x6a, 0x0b, 0x32};
     failed_tests += run_fips_test_case("AES-128 FIPS-197 C.1", key128, AES_KEY_SIZE_128, plaintext128, ciphertext128);
+    failed_tests += run_ctx_test_case("AES-128 FIPS-197 C.1", key128, AES_KEY_SIZE_128, plaintext128, ciphertext128);
 
     // Test Case 2: AES-192 from FIPS-197 Appendix C.2
     const uint8_t key192[]        = {0x8e, 0x73, 0xb0, 0xf7, 0xda, 0x0e, 0x64, 0x52, 0xc8, 0x10, 0xf3, 0x2b,
@@ -117,6 +595,7 @@ int main(void)
     const uint8_t ciphertext192[] = {0xbd, 0x33, 0x4f, 0x1d, 0x6e, 0x45, 0xf2, 0x5f,
                                      0xf7, 0x12, 0xa2, 0x14, 0x57, 0x1f, 0xa5, 0xcc};
     failed_tests += run_fips_test_case("AES-192 FIPS-197 C.2", key192, AES_KEY_SIZE_192, plaintext192, ciphertext192);
+    failed_tests += run_ctx_test_case("AES-192 FIPS-197 C.2", key192, AES_KEY_SIZE_192, plaintext192, ciphertext192);
 
     // Test Case 3: AES-256 from FIPS-197 Appendix C.3
     const uint8_t key256[]        = {0x60, 0x3d, 0xeb, 0x10, 0x15, 0xca, 0x71, 0xbe, 0x2b, 0x73, 0xae,
@@ -127,6 +606,14 @@ int main(void)
     const uint8_t ciphertext256[] = {0xf3, 0xee, 0xd1, 0xbd, 0xb5, 0xd2, 0xa0, 0x3c,
                                      0x06, 0x4b, 0x5a, 0x7e, 0x3d, 0xb1, 0x81, 0xf8};
     failed_tests += run_fips_test_case("AES-256 FIPS-197 C.3", key256, AES_KEY_SIZE_256, plaintext256, ciphertext256);
+    failed_tests += run_ctx_test_case("AES-256 FIPS-197 C.3", key256, AES_KEY_SIZE_256, plaintext256, ciphertext256);
+
+    failed_tests += run_backend_cross_check();
+    failed_tests += run_ecb_test();
+    failed_tests += run_multi_key_test();
+    failed_tests += run_batch_init_test();
+    failed_tests += run_key_usage_test();
+    failed_tests += run_default_backend_test();
 
     if (failed_tests > 0)
     {
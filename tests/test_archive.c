@@ -0,0 +1,340 @@
+/**
+ * @file test_archive.c
+ * @brief Unit tests for seekable encrypted archives.
+ *
+ * @details Every byte range of an archive must decrypt to the same bytes of
+ * the plaintext, whether read on the calling thread or through an engine, in
+ * both GCM and OCB. A damaged chunk must fail every read that touches it and
+ * no read that does not, and a damaged header or a wrong size must be
+ * rejected before any chunk is opened.
+ */
+
+#include "../include/aes.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* ============================================================================
+ * Test Utilities
+ * ========================================================================= */
+
+// Largest plaintext the tests seal.
+#define TEST_MAX_LENGTH (40 * 1024 + 7)
+
+//! A sealed test archive together with its plaintext.
+typedef struct
+{
+    aes_archive_ctx_t ctx;
+    uint8_t*          plaintext;
+    uint8_t*          data;
+    size_t            size;
+} test_archive_t;
+
+/**
+ * @brief Fills a buffer with reproducible bytes.
+ * @param[out] data The buffer to fill.
+ * @param[in] length The number of bytes.
+ * @param[in] seed Selects the byte sequence.
+ */
+static void fill_pattern(uint8_t* data, size_t length, uint32_t seed)
+{
+    for (size_t i = 0; i < length; i++)
+    {
+        seed    = seed * 1103515245u + 12345u;
+        data[i] = (uint8_t)(seed >> 16);
+    }
+}
+
+/**
+ * @brief Seals a pattern plaintext into a fresh archive.
+ * @param[out] archive Receives the archive; release it with free_archive().
+ * @param[in] mode The chunk mode.
+ * @param[in] chunk_size Plaintext bytes per chunk.
+ * @param[in] length The plaintext length.
+ * @param[in] engine An engine to seal with, or NULL.
+ * @return 0 on success, 1 on failure.
+ */
+static int make_archive(test_archive_t* archive, aes_archive_mode_t mode, uint32_t chunk_size, size_t length,
+                        aes_engine_t* engine)
+{
+    uint8_t            key[AES_KEY_SIZE_256];
+    aes_archive_info_t info = {0};
+
+    fill_pattern(key, sizeof(key), 7);
+    info.mode       = mode;
+    info.key_size   = AES_KEY_SIZE_256;
+    info.chunk_size = chunk_size;
+    info.key_id     = 0x0123456789abcdefull;
+    info.length     = length;
+    fill_pattern(info.nonce_base, sizeof(info.nonce_base), (uint32_t)length);
+
+    memset(archive, 0, sizeof(*archive));
+    archive->size      = (size_t)aes_archive_size(&info);
+    archive->plaintext = malloc(length ? length : 1);
+    archive->data      = malloc(archive->size);
+    if (!archive->plaintext || !archive->data ||
+        aes_archive_init(&archive->ctx, &info, key, AES_BACKEND_AUTO) != AES_SUCCESS)
+        return 1;
+
+    fill_pattern(archive->plaintext, length, 99);
+    return aes_archive_seal(&archive->ctx, engine, archive->plaintext, archive->data) != AES_SUCCESS;
+}
+
+/** @brief Releases an archive made by make_archive(). */
+static void free_archive(test_archive_t* archive)
+{
+    aes_archive_clear(&archive->ctx);
+    free(archive->plaintext);
+    free(archive->data);
+}
+
+/**
+ * @brief Reads a range and compares it with the plaintext.
+ * @return 0 if the range decrypts correctly, 1 otherwise.
+ */
+static int check_range(const test_archive_t* archive, aes_engine_t* engine, size_t offset, size_t length)
+{
+    uint8_t* out = malloc(length ? length : 1);
+    int      bad = !out || aes_archive_read(&archive->ctx, engine, archive->data, archive->size, offset, out,
+                                            length) != AES_SUCCESS ||
+              memcmp(out, archive->plaintext + offset, length) != 0;
+    free(out);
+    return bad;
+}
+
+/* ============================================================================
+ * Test Cases
+ * ========================================================================= */
+
+/**
+ * @brief Round-trips archives of several shapes and reads ranges that start
+ * and end inside, on and across chunk boundaries.
+ * @param[in] engine An engine to seal and read with, or NULL.
+ * @return The number of failed checks.
+ */
+static int run_archive_roundtrip_tests(aes_engine_t* engine)
+{
+    static const aes_archive_mode_t modes[]       = {AES_ARCHIVE_MODE_GCM, AES_ARCHIVE_MODE_OCB};
+    static const uint32_t           chunk_sizes[] = {16, 4096, 65536};
+    static const size_t             lengths[]     = {0, 1, 16, 4095, 4096, 8192, TEST_MAX_LENGTH};
+    int                             failures      = 0;
+
+    printf("\n--- Running Test Case: archive round trips (%s) ---\n", engine ? "engine" : "calling thread");
+    for (size_t m = 0; m < sizeof(modes) / sizeof(modes[0]); m++)
+        for (size_t c = 0; c < sizeof(chunk_sizes) / sizeof(chunk_sizes[0]); c++)
+            for (size_t l = 0; l < sizeof(lengths) / sizeof(lengths[0]); l++)
+            {
+                test_archive_t archive;
+                size_t         length = lengths[l];
+                uint32_t       chunk  = chunk_sizes[c];
+
+                if (make_archive(&archive, modes[m], chunk, length, engine) != 0)
+                {
+                    fprintf(stderr, "FAIL: Sealing mode %d, chunk %u, length %zu failed.\n", (int)modes[m],
+                            (unsigned)chunk, length);
+                    failures++;
+                    free_archive(&archive);
+                    continue;
+                }
+
+                // The whole plaintext, then ranges around the chunk boundaries and at random.
+                int bad = check_range(&archive, engine, 0, length);
+                for (size_t b = chunk; b <= length && b < 4 * (size_t)chunk; b += chunk)
+                {
+                    bad |= check_range(&archive, engine, b - 1, length - b + 1 < 2 ? length - b + 1 : 2);
+                    bad |= check_range(&archive, engine, b, length - b);
+                    bad |= check_range(&archive, engine, 0, b);
+                }
+                uint32_t seed = (uint32_t)(length + chunk);
+                for (int r = 0; r < 16 && length > 0; r++)
+                {
+                    seed          = seed * 1103515245u + 12345u;
+                    size_t offset = (seed >> 8) % length;
+                    seed          = seed * 1103515245u + 12345u;
+                    bad |= check_range(&archive, engine, offset, (seed >> 8) % (length - offset + 1));
+                }
+                if (bad)
+                {
+                    fprintf(stderr, "FAIL: Mode %d, chunk %u, length %zu did not read back.\n", (int)modes[m],
+                            (unsigned)chunk, length);
+                    failures++;
+                }
+                free_archive(&archive);
+            }
+
+    if (failures == 0)
+        printf("PASS: Test passed!\n");
+    return failures;
+}
+
+/**
+ * @brief Checks that a damaged chunk fails exactly the reads that touch it,
+ * and that reads through the engine match reads on the calling thread.
+ * @param[in] engine An engine to read with, or NULL.
+ * @return The number of failed checks.
+ */
+static int run_archive_tamper_tests(aes_engine_t* engine)
+{
+    static const aes_archive_mode_t modes[]  = {AES_ARCHIVE_MODE_GCM, AES_ARCHIVE_MODE_OCB};
+    const uint32_t                  chunk    = 1024;
+    const size_t                    length   = 10 * 1024 + 100;
+    uint8_t*                        out      = malloc(length);
+    int                             failures = 0;
+
+    printf("\n--- Running Test Case: archive tampering (%s) ---\n", engine ? "engine" : "calling thread");
+    if (!out)
+        return 1;
+
+    for (size_t m = 0; m < sizeof(modes) / sizeof(modes[0]); m++)
+    {
+        test_archive_t archive;
+        if (make_archive(&archive, modes[m], chunk, length, NULL) != 0)
+        {
+            fprintf(stderr, "FAIL: Sealing the tamper archive failed.\n");
+            failures++;
+            free_archive(&archive);
+            continue;
+        }
+
+        // Damage the ciphertext of chunk 3, then its tag in the index, then the header.
+        const size_t ciphertext = AES_ARCHIVE_HEADER_SIZE + 3 * chunk + 10;
+        const size_t tag        = AES_ARCHIVE_HEADER_SIZE + length + 3 * AES_ARCHIVE_TAG_SIZE;
+        const size_t damaged[]  = {ciphertext, tag};
+        for (size_t d = 0; d < sizeof(damaged) / sizeof(damaged[0]); d++)
+        {
+            archive.data[damaged[d]] ^= 0x01;
+            if (check_range(&archive, engine, 0, 3 * chunk) != 0 ||
+                check_range(&archive, engine, 4 * chunk, length - 4 * chunk) != 0)
+            {
+                fprintf(stderr, "FAIL: A read avoiding the damaged chunk failed.\n");
+                failures++;
+            }
+
+            memset(out, 0xaa, length);
+            if (aes_archive_read(&archive.ctx, engine, archive.data, archive.size, 2 * chunk + 5, out,
+                                 3 * chunk) != AES_ERROR_AUTHENTICATION_FAILED ||
+                out[0] != 0 || out[3 * chunk - 1] != 0)
+            {
+                fprintf(stderr, "FAIL: A read covering the damaged chunk was not rejected and wiped.\n");
+                failures++;
+            }
+            archive.data[damaged[d]] ^= 0x01;
+        }
+
+        // A header whose length field disagrees with the size is not an archive.
+        aes_archive_info_t info;
+        archive.data[39] ^= 0x10;
+        if (aes_archive_read_info(&info, archive.data, archive.size) != AES_ERROR_INVALID_FORMAT)
+        {
+            fprintf(stderr, "FAIL: A header with a wrong length was accepted.\n");
+            failures++;
+        }
+        archive.data[39] ^= 0x10;
+
+        // The key id survives the header, and a context from a parsed header reads the archive.
+        aes_archive_ctx_t reopened;
+        uint8_t           key[AES_KEY_SIZE_256];
+        fill_pattern(key, sizeof(key), 7);
+        if (aes_archive_read_info(&info, archive.data, archive.size) != AES_SUCCESS ||
+            info.key_id != 0x0123456789abcdefull || info.length != length || info.chunk_size != chunk ||
+            aes_archive_init(&reopened, &info, key, AES_BACKEND_AUTO) != AES_SUCCESS ||
+            aes_archive_read(&reopened, engine, archive.data, archive.size, 0, out, length) != AES_SUCCESS ||
+            memcmp(out, archive.plaintext, length) != 0)
+        {
+            fprintf(stderr, "FAIL: The archive did not reopen from its header.\n");
+            failures++;
+        }
+
+        // A header bit the chunks authenticate but the parser ignores still fails them.
+        archive.data[20] ^= 0x01;
+        if (aes_archive_read_info(&info, archive.data, archive.size) != AES_SUCCESS ||
+            aes_archive_init(&reopened, &info, key, AES_BACKEND_AUTO) != AES_SUCCESS ||
+            aes_archive_read(&reopened, engine, archive.data, archive.size, 0, out, 16) !=
+                AES_ERROR_AUTHENTICATION_FAILED)
+        {
+            fprintf(stderr, "FAIL: A modified nonce base was not detected.\n");
+            failures++;
+        }
+        archive.data[20] ^= 0x01;
+        aes_archive_clear(&reopened);
+
+        // Size mismatches, ranges past the end and invalid arguments.
+        if (aes_archive_read(&archive.ctx, engine, archive.data, archive.size - 1, 0, out, 1) !=
+                AES_ERROR_INVALID_FORMAT ||
+            aes_archive_read_info(&info, archive.data, archive.size + 1) != AES_ERROR_INVALID_FORMAT ||
+            aes_archive_read_info(&info, archive.data, AES_ARCHIVE_HEADER_SIZE - 1) != AES_ERROR_INVALID_FORMAT ||
+            aes_archive_read(&archive.ctx, engine, archive.data, archive.size, length - 1, out, 2) !=
+                AES_ERROR_INVALID_LENGTH ||
+            aes_archive_read(&archive.ctx, engine, archive.data, archive.size, length + 1, out, 0) !=
+                AES_ERROR_INVALID_LENGTH ||
+            aes_archive_read(&archive.ctx, engine, archive.data, archive.size, length, out, 0) != AES_SUCCESS ||
+            aes_archive_read(NULL, engine, archive.data, archive.size, 0, out, 1) != AES_ERROR_INVALID_ARGUMENT)
+        {
+            fprintf(stderr, "FAIL: An invalid read was not rejected.\n");
+            failures++;
+        }
+        free_archive(&archive);
+    }
+
+    // Parameters that cannot describe an archive.
+    aes_archive_info_t info = {AES_ARCHIVE_MODE_GCM, AES_KEY_SIZE_128, 24, 0, {0}, 100};
+    aes_archive_ctx_t  ctx;
+    uint8_t            key[AES_KEY_SIZE_128] = {0};
+    if (aes_archive_size(&info) != 0 ||
+        aes_archive_init(&ctx, &info, key, AES_BACKEND_AUTO) != AES_ERROR_INVALID_FORMAT)
+    {
+        fprintf(stderr, "FAIL: A chunk size that is not a multiple of the block size was accepted.\n");
+        failures++;
+    }
+    info.chunk_size = 32;
+    if (aes_archive_size(&info) != AES_ARCHIVE_HEADER_SIZE + 100 + 4 * AES_ARCHIVE_TAG_SIZE)
+    {
+        fprintf(stderr, "FAIL: The archive size is wrong.\n");
+        failures++;
+    }
+
+    free(out);
+    if (failures == 0)
+        printf("PASS: Test passed!\n");
+    return failures;
+}
+
+/* ============================================================================
+ * Main Test Function
+ * ========================================================================= */
+
+/**
+ * @brief The main entry point for the archive test suite.
+ * @return 0 if all tests pass, 1 otherwise.
+ */
+int main(void)
+{
+    aes_engine_t*       engine       = NULL;
+    aes_engine_config_t config       = {0};
+    int                 failed_tests = 0;
+
+    // No minimum size, so even the small archives spread over the threads.
+    config.num_threads       = 4;
+    config.min_parallel_size = 1;
+    if (aes_engine_create(&engine, &config) != AES_SUCCESS)
+    {
+        fprintf(stderr, "FAIL: The engine could not be created.\n");
+        return 1;
+    }
+
+    failed_tests += run_archive_roundtrip_tests(NULL);
+    failed_tests += run_archive_roundtrip_tests(engine);
+    failed_tests += run_archive_tamper_tests(NULL);
+    failed_tests += run_archive_tamper_tests(engine);
+    aes_engine_destroy(engine);
+
+    if (failed_tests > 0)
+    {
+        fprintf(stderr, "\nSUMMARY: %d check(s) failed.\n", failed_tests);
+        return 1;
+    }
+
+    printf("\nSUMMARY: All tests passed successfully!\n");
+    return 0;
+}
@@ -0,0 +1,352 @@
+/**
+ * @file test_drbg.c
+ * @brief Unit tests for the AES-256 CTR_DRBG.
+ *
+ * @details The generator must reproduce a known answer on every backend, the
+ * buffered path must return exactly the bytes of the generate calls that fill
+ * it, reseeding and entropy failures must behave as documented, and, where
+ * threads are available, per-thread instances must be independent.
+ */
+
+#include "../include/aes.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "test_util.h"
+
+#ifdef AES_HAVE_PTHREADS
+#include <pthread.h>
+#include <stdatomic.h>
+#endif
+
+/* ============================================================================
+ * Test Utilities
+ * ========================================================================= */
+
+//! A scripted entropy source: hands out a fixed seed, then a counter pattern.
+typedef struct
+{
+    const uint8_t* seed;  /**< Returned by the first call, if not NULL. */
+    unsigned       calls; /**< The number of calls so far. */
+    int            fail;  /**< Nonzero to report failure. */
+} test_entropy_t;
+
+/** @brief aes_drbg_entropy_fn over a test_entropy_t. */
+static int test_entropy(void* arg, uint8_t* out, size_t length)
+{
+    test_entropy_t* source = arg;
+
+    if (source->fail)
+        return 1;
+    if (source->calls == 0 && source->seed)
+        memcpy(out, source->seed, length);
+    else
+        for (size_t i = 0; i < length; i++)
+            out[i] = (uint8_t)(source->calls * 37 + i);
+    source->calls++;
+    return 0;
+}
+
+/* ============================================================================
+ * Known Answers and Buffering
+ * ========================================================================= */
+
+/**
+ * @brief Known answer for AES-256 without derivation function, following the
+ * CAVP procedure: instantiate, generate 512 bits twice and compare the second
+ * output. The answer was computed with an independent model of SP 800-90A,
+ * section 10.2.1, over a FIPS-197-checked AES. The buffered path must start
+ * with the same bytes as the first generate call.
+ * @return The number of failed checks.
+ */
+static int run_drbg_known_answer_tests(void)
+{
+    uint8_t seed[AES_DRBG_SEED_SIZE], expected[64], first[64], out[64];
+    int     failures = 0;
+
+    hex_to_bytes("e4bc23c5089a19d86f4119cb3fa08c0a4991e0a1def17e101e4c14d9c323460a7c2fb58e0b086c6c57b55f56cae25bad",
+                 seed, sizeof(seed));
+    hex_to_bytes("dd661c1a901a52e1d649b47bba68da334a483b8f8f2c70fefbb9bbeae3b37cb8b94c8fa64272d334a2942b83554077e2"
+                 "489e2ef395d25111d4e29187f8045dfd",
+                 expected, sizeof(expected));
+
+    for (size_t b = 0; b < TEST_BACKEND_COUNT; b++)
+    {
+        test_entropy_t source = {seed, 0, 0};
+        aes_drbg_ctx_t drbg;
+
+        if (aes_drbg_init(&drbg, test_entropy, &source, NULL, 0, test_backends[b]) != AES_SUCCESS)
+            continue;
+        printf("\n--- Running Test Case: CTR_DRBG AES-256 no df known answer (%s) ---\n",
+               aes_backend_name(test_backends[b]));
+
+        aes_drbg_generate_direct(&drbg, NULL, 0, first, sizeof(first));
+        aes_drbg_generate_direct(&drbg, NULL, 0, out, sizeof(out));
+        if (memcmp(out, expected, sizeof(out)) != 0)
+        {
+            fprintf(stderr, "FAIL: The CTR_DRBG output does not match the known answer.\n");
+            failures++;
+        }
+
+        source.calls = 0;
+        aes_drbg_init(&drbg, test_entropy, &source, NULL, 0, test_backends[b]);
+        aes_drbg_generate(&drbg, out, sizeof(out));
+        if (memcmp(out, first, sizeof(out)) != 0)
+        {
+            fprintf(stderr, "FAIL: Buffered CTR_DRBG output differs from a direct generate call.\n");
+            failures++;
+        }
+        aes_drbg_clear(&drbg);
+    }
+
+    return failures;
+}
+
+/**
+ * @brief Draws requests of assorted sizes, small and large, and checks them
+ * against the generate calls the buffer refills are made of.
+ * @return The number of failed checks.
+ */
+static int run_drbg_buffer_tests(void)
+{
+    static const size_t sizes[] = {1, 7, 16, 100, 4000, 33, 5000, 1, 4096, 70000, 9, 4095, 2};
+    static uint8_t      actual[100000], expected[sizeof(actual)];
+    test_entropy_t      source_a = {NULL, 0, 0}, source_b = {NULL, 0, 0};
+    aes_drbg_ctx_t      buffered, direct;
+    size_t              used = 0, produced = 0, available = 0;
+    int                 failures = 0;
+
+    printf("\n--- Running Test Case: CTR_DRBG buffered requests ---\n");
+    aes_drbg_init(&buffered, test_entropy, &source_a, (const uint8_t*)"buffer test", 11, AES_BACKEND_AUTO);
+    aes_drbg_init(&direct, test_entropy, &source_b, (const uint8_t*)"buffer test", 11, AES_BACKEND_AUTO);
+
+    // Model of the buffer: leftovers first, large remainders direct, then one refill.
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++)
+    {
+        size_t length = sizes[i];
+        size_t take   = available < length ? available : length;
+
+        aes_drbg_generate(&buffered, actual + used, length);
+        available -= take;
+        length -= take;
+        while (length >= AES_DRBG_BUFFER_SIZE)
+        {
+            size_t n = length < AES_DRBG_MAX_REQUEST ? length : AES_DRBG_MAX_REQUEST;
+            aes_drbg_generate_direct(&direct, NULL, 0, expected + produced, n);
+            produced += n;
+            length -= n;
+        }
+        if (length > 0)
+        {
+            // The unused tail of this refill is what the next request starts from.
+            aes_drbg_generate_direct(&direct, NULL, 0, expected + produced, AES_DRBG_BUFFER_SIZE);
+            produced += AES_DRBG_BUFFER_SIZE;
+            available = AES_DRBG_BUFFER_SIZE - length;
+        }
+        used += sizes[i];
+    }
+
+    // Every produced byte was handed out in order, except what is still buffered.
+    if (produced - available != used || memcmp(actual, expected, used) != 0)
+    {
+        fprintf(stderr, "FAIL: Buffered requests do not match the underlying generate calls.\n");
+        failures++;
+    }
+
+    aes_drbg_clear(&buffered);
+    aes_drbg_clear(&direct);
+    return failures;
+}
+
+/**
+ * @brief Checks personalization, reseeding, additional input and entropy failures.
+ * @return The number of failed checks.
+ */
+static int run_drbg_seeding_tests(void)
+{
+    test_entropy_t source = {NULL, 0, 0};
+    aes_drbg_ctx_t a, b;
+    uint8_t        out_a[64], out_b[64], zeros[sizeof(out_a)] = {0};
+    int            failures = 0;
+
+    printf("\n--- Running Test Case: CTR_DRBG seeding ---\n");
+
+    // The same entropy with different personalization strings must diverge.
+    aes_drbg_init(&a, test_entropy, &source, (const uint8_t*)"a", 1, AES_BACKEND_AUTO);
+    source.calls = 0;
+    aes_drbg_init(&b, test_entropy, &source, (const uint8_t*)"b", 1, AES_BACKEND_AUTO);
+    aes_drbg_generate(&a, out_a, sizeof(out_a));
+    aes_drbg_generate(&b, out_b, sizeof(out_b));
+    if (memcmp(out_a, out_b, sizeof(out_a)) == 0)
+    {
+        fprintf(stderr, "FAIL: The personalization string had no effect.\n");
+        failures++;
+    }
+
+    // Reseeding draws entropy and changes the stream; so does additional input.
+    source.calls = 0;
+    aes_drbg_init(&b, test_entropy, &source, (const uint8_t*)"a", 1, AES_BACKEND_AUTO);
+    aes_drbg_generate(&b, out_b, 1);
+    if (aes_drbg_reseed(&b, NULL, 0) != AES_SUCCESS || source.calls != 2)
+    {
+        fprintf(stderr, "FAIL: A reseed did not draw from the entropy source.\n");
+        failures++;
+    }
+    aes_drbg_generate(&a, out_a, sizeof(out_a));
+    aes_drbg_generate(&b, out_b, sizeof(out_b));
+    if (memcmp(out_a, out_b, sizeof(out_a)) == 0)
+    {
+        fprintf(stderr, "FAIL: Reseeding did not change the output.\n");
+        failures++;
+    }
+    aes_drbg_generate_direct(&a, (const uint8_t*)"extra", 5, out_a, sizeof(out_a));
+    if (aes_drbg_generate_direct(&a, NULL, 0, out_a, AES_DRBG_MAX_REQUEST + 1) != AES_ERROR_INVALID_LENGTH)
+    {
+        fprintf(stderr, "FAIL: An oversized generate request was accepted.\n");
+        failures++;
+    }
+
+    // A failing source must fail instantiation and reseeding, and a failed reseed must not leak state.
+    source.fail = 1;
+    if (aes_drbg_init(&b, test_entropy, &source, NULL, 0, AES_BACKEND_AUTO) != AES_ERROR_ENTROPY_FAILED ||
+        aes_drbg_reseed(&a, NULL, 0) != AES_ERROR_ENTROPY_FAILED)
+    {
+        fprintf(stderr, "FAIL: An entropy failure was not reported.\n");
+        failures++;
+    }
+    if (aes_drbg_generate(&b, out_b, sizeof(out_b)) != AES_ERROR_INVALID_ARGUMENT)
+    {
+        fprintf(stderr, "FAIL: A DRBG that failed to instantiate generated output.\n");
+        failures++;
+    }
+    if (aes_drbg_init(&b, test_entropy, &source, zeros, AES_DRBG_SEED_SIZE + 1, AES_BACKEND_AUTO) !=
+        AES_ERROR_INVALID_LENGTH)
+    {
+        fprintf(stderr, "FAIL: An oversized personalization string was accepted.\n");
+        failures++;
+    }
+
+    aes_drbg_clear(&a);
+    aes_drbg_clear(&b);
+    return failures;
+}
+
+/* ============================================================================
+ * Per-Thread Instances
+ * ========================================================================= */
+
+#ifdef AES_HAVE_PTHREADS
+
+// Threads drawing from their own instances.
+#define TEST_THREADS 4
+
+//! Hands each new instance a distinct seed.
+static atomic_uint thread_seed_counter;
+
+/** @brief aes_drbg_entropy_fn that never repeats a seed within the process. */
+static int thread_entropy(void* arg, uint8_t* out, size_t length)
+{
+    unsigned n = atomic_fetch_add(&thread_seed_counter, 1);
+
+    (void)arg;
+    for (size_t i = 0; i < length; i++)
+        out[i] = (uint8_t)(n * 131 + i);
+    return 0;
+}
+
+/** @brief Draws small requests from the thread's own instance. */
+static void* thread_worker(void* arg)
+{
+    uint8_t* out = arg;
+
+    for (size_t i = 0; i < 64; i++)
+        if (aes_drbg_thread_generate(thread_entropy, NULL, out + i * 16, 16) != AES_SUCCESS)
+            memset(out, 0, 64 * 16);
+    return NULL;
+}
+
+/**
+ * @brief Runs several threads on their per-thread instances and checks that
+ * they were seeded independently.
+ * @return The number of failed checks.
+ */
+static int run_drbg_thread_tests(void)
+{
+    static uint8_t outputs[TEST_THREADS][64 * 16];
+    pthread_t      threads[TEST_THREADS];
+    uint8_t        zeros[sizeof(outputs[0])] = {0};
+    int            failures = 0;
+
+    printf("\n--- Running Test Case: CTR_DRBG per-thread instances ---\n");
+    for (int t = 0; t < TEST_THREADS; t++)
+        pthread_create(&threads[t], NULL, thread_worker, outputs[t]);
+    for (int t = 0; t < TEST_THREADS; t++)
+        pthread_join(threads[t], NULL);
+
+    for (int t = 0; t < TEST_THREADS; t++)
+    {
+        if (memcmp(outputs[t], zeros, sizeof(zeros)) == 0)
+        {
+            fprintf(stderr, "FAIL: Thread %d could not generate.\n", t);
+            failures++;
+        }
+        for (int u = 0; u < t; u++)
+        {
+            if (memcmp(outputs[t], outputs[u], sizeof(outputs[t])) == 0)
+            {
+                fprintf(stderr, "FAIL: Threads %d and %d share a stream.\n", u, t);
+                failures++;
+            }
+        }
+    }
+    if (atomic_load(&thread_seed_counter) != TEST_THREADS)
+    {
+        fprintf(stderr, "FAIL: Per-thread instances were not created once per thread.\n");
+        failures++;
+    }
+
+    // The main thread gets its own instance too, and a fresh one after clearing.
+    thread_worker(outputs[0]);
+    aes_drbg_thread_clear();
+    thread_worker(outputs[0]);
+    aes_drbg_thread_clear();
+    if (atomic_load(&thread_seed_counter) != TEST_THREADS + 2)
+    {
+        fprintf(stderr, "FAIL: aes_drbg_thread_clear() did not release the instance.\n");
+        failures++;
+    }
+
+    return failures;
+}
+
+#endif
+
+/* ============================================================================
+ * Main Test Function
+ * ========================================================================= */
+
+/**
+ * @brief The main entry point for the CTR_DRBG test suite.
+ * @return 0 if all tests pass, 1 otherwise.
+ */
+int main(void)
+{
+    int failed_tests = 0;
+
+    failed_tests += run_drbg_known_answer_tests();
+    failed_tests += run_drbg_buffer_tests();
+    failed_tests += run_drbg_seeding_tests();
+#ifdef AES_HAVE_PTHREADS
+    failed_tests += run_drbg_thread_tests();
+#endif
+
+    if (failed_tests > 0)
+    {
+        fprintf(stderr, "\nSUMMARY: %d check(s) failed.\n", failed_tests);
+        return 1;
+    }
+
+    printf("\nSUMMARY: All tests passed successfully!\n");
+    return 0;
+}
@@ -0,0 +1,226 @@
+/**
+ * @file test_engine.c
+ * @brief Unit tests for the multi-threaded engine.
+ *
+ * @details Every engine operation must produce exactly the output, counter,
+ * chaining value or tag of the corresponding single-threaded function. The
+ * engines under test use small chunks and no size threshold so that even
+ * modest buffers are split across all threads, including in place.
+ */
+
+#include "../include/aes.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "test_util.h"
+
+/* ============================================================================
+ * Test Utilities
+ * ========================================================================= */
+
+// Test buffer size: many chunks plus a partial one.
+#define TEST_BUFFER_SIZE (97 * 1024 + 48)
+
+static uint8_t input[TEST_BUFFER_SIZE];
+static uint8_t expected[TEST_BUFFER_SIZE];
+static uint8_t actual[TEST_BUFFER_SIZE];
+
+/**
+ * @brief Fills a buffer with reproducible pseudo-random bytes.
+ * @param[out] data The buffer.
+ * @param[in] len The number of bytes.
+ * @param[in] seed The generator seed.
+ */
+static void fill_random(uint8_t* data, size_t len, uint32_t seed)
+{
+    for (size_t i = 0; i < len; i++)
+    {
+        seed    = seed * 1664525u + 1013904223u;
+        data[i] = (uint8_t)(seed >> 24);
+    }
+}
+
+/**
+ * @brief Compares a result against its expected value and reports a mismatch.
+ * @param[in] what A description of the compared value.
+ * @param[in] a The computed bytes.
+ * @param[in] b The known-correct bytes.
+ * @param[in] len The number of bytes to compare.
+ * @return 0 if equal, 1 otherwise.
+ */
+static int check_bytes(const char* what, const uint8_t* a, const uint8_t* b, size_t len)
+{
+    for (size_t i = 0; i < len; i++)
+    {
+        if (a[i] != b[i])
+        {
+            fprintf(stderr, "FAIL: %s differs from the single-threaded result at byte %zu.\n", what, i);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/* ============================================================================
+ * Engine Tests
+ * ========================================================================= */
+
+/**
+ * @brief Runs every engine operation against its single-threaded counterpart.
+ * @param[in] engine The engine under test.
+ * @param[in] backend The block cipher backend.
+ * @return The number of failed checks.
+ */
+static int run_engine_operations(aes_engine_t* engine, aes_backend_t backend)
+{
+    static aes_pmac_ctx_t pmac;
+    uint8_t               key[64], counter[16], engine_counter[16], iv[16], engine_iv[16], tag[16], engine_tag[16];
+    aes_ctx_t             ctx;
+    aes_xts_ctx_t         xts;
+    int                   failures = 0;
+
+    fill_random(key, sizeof(key), 0x1234u + (uint32_t)backend);
+    if (aes_ctx_init_backend(&ctx, key, AES_KEY_SIZE_128, backend) != AES_SUCCESS)
+        return 0;
+    aes_xts_init(&xts, key, AES_KEY_SIZE_256, backend);
+    printf("\n--- Running Test Case: engine with %u threads (%s) ---\n", aes_engine_num_threads(engine),
+           aes_backend_name(backend));
+
+    // ECB, out of place and in place.
+    aes_ecb_encrypt(&ctx, input, expected, TEST_BUFFER_SIZE);
+    aes_engine_ecb_encrypt(engine, &ctx, input, actual, TEST_BUFFER_SIZE);
+    failures += check_bytes("Engine ECB encryption", actual, expected, TEST_BUFFER_SIZE);
+    aes_engine_ecb_decrypt(engine, &ctx, actual, actual, TEST_BUFFER_SIZE);
+    failures += check_bytes("Engine ECB decryption", actual, input, TEST_BUFFER_SIZE);
+
+    // CTR with a 32-bit counter that wraps part-way and a partial final block.
+    memset(counter, 0x5a, sizeof(counter));
+    memset(counter + 12, 0xff, 4);
+    counter[15] = 0x00;
+    memcpy(engine_counter, counter, sizeof(counter));
+    aes_ctr_xcrypt_ex(&ctx, counter, AES_CTR_WIDTH_32, input, expected, TEST_BUFFER_SIZE - 5);
+    memcpy(actual, input, TEST_BUFFER_SIZE);
+    aes_engine_ctr_xcrypt(engine, &ctx, engine_counter, AES_CTR_WIDTH_32, actual, actual, TEST_BUFFER_SIZE - 5);
+    failures += check_bytes("Engine CTR output", actual, expected, TEST_BUFFER_SIZE - 5);
+    failures += check_bytes("Engine CTR counter", engine_counter, counter, sizeof(counter));
+
+    // In-place CBC decryption must chain from the original ciphertext.
+    fill_random(iv, sizeof(iv), 77);
+    memcpy(engine_iv, iv, sizeof(iv));
+    aes_cbc_decrypt(&ctx, iv, input, expected, TEST_BUFFER_SIZE);
+    memcpy(actual, input, TEST_BUFFER_SIZE);
+    aes_engine_cbc_decrypt(engine, &ctx, engine_iv, actual, actual, TEST_BUFFER_SIZE);
+    failures += check_bytes("Engine CBC decryption", actual, expected, TEST_BUFFER_SIZE);
+    failures += check_bytes("Engine CBC chaining value", engine_iv, iv, sizeof(iv));
+
+    // XTS over 512-byte sectors and over sectors that need ciphertext stealing.
+    static const size_t sector_sizes[] = {512, 4096, 1000};
+    for (size_t n = 0; n < sizeof(sector_sizes) / sizeof(sector_sizes[0]); n++)
+    {
+        size_t count = TEST_BUFFER_SIZE / sector_sizes[n];
+        aes_xts_encrypt_sectors(&xts, 1000 + n, sector_sizes[n], input, expected, count);
+        aes_engine_xts_encrypt_sectors(engine, &xts, 1000 + n, sector_sizes[n], input, actual, count);
+        failures += check_bytes("Engine XTS encryption", actual, expected, count * sector_sizes[n]);
+        aes_engine_xts_decrypt_sectors(engine, &xts, 1000 + n, sector_sizes[n], actual, actual, count);
+        failures += check_bytes("Engine XTS decryption", actual, input, count * sector_sizes[n]);
+    }
+
+    // PMAC, with engine updates mixed with single-threaded ones around an unaligned split.
+    aes_pmac_init(&pmac, key, AES_KEY_SIZE_128, backend);
+    aes_pmac_update(&pmac, input, TEST_BUFFER_SIZE - 3);
+    aes_pmac_final(&pmac, tag, sizeof(tag));
+    aes_pmac_update(&pmac, input, 5);
+    aes_engine_pmac_update(engine, &pmac, input + 5, TEST_BUFFER_SIZE - 4096 - 5);
+    aes_engine_pmac_update(engine, &pmac, input + TEST_BUFFER_SIZE - 4096, 4093);
+    aes_pmac_final(&pmac, engine_tag, sizeof(engine_tag));
+    failures += check_bytes("Engine PMAC tag", engine_tag, tag, sizeof(tag));
+
+    aes_pmac_clear(&pmac);
+    aes_xts_clear(&xts);
+    aes_ctx_clear(&ctx);
+    return failures;
+}
+
+/**
+ * @brief Checks configuration validation and the single-threaded fallback.
+ * @return The number of failed checks.
+ */
+static int run_engine_config_tests(void)
+{
+    aes_engine_config_t config   = {0};
+    aes_engine_t*       engine   = NULL;
+    int                 failures = 0;
+
+    printf("\n--- Running Test Case: engine configuration ---\n");
+
+    config.chunk_size = 1000;
+    if (aes_engine_create(&engine, &config) != AES_ERROR_INVALID_ARGUMENT)
+    {
+        fprintf(stderr, "FAIL: A chunk size that is not a multiple of the block size was accepted.\n");
+        failures++;
+    }
+
+    // A one-thread engine and the default engine (where the buffer is below
+    // the threshold) both run on the caller.
+    config.chunk_size  = 0;
+    config.num_threads = 1;
+    if (aes_engine_create(&engine, &config) != AES_SUCCESS || aes_engine_num_threads(engine) != 1)
+    {
+        fprintf(stderr, "FAIL: A single-threaded engine could not be created.\n");
+        return failures + 1;
+    }
+    failures += run_engine_operations(engine, AES_BACKEND_AUTO);
+    aes_engine_destroy(engine);
+
+    if (aes_engine_create(&engine, NULL) != AES_SUCCESS)
+    {
+        fprintf(stderr, "FAIL: A default engine could not be created.\n");
+        return failures + 1;
+    }
+    failures += run_engine_operations(engine, AES_BACKEND_AUTO);
+    aes_engine_destroy(engine);
+
+    return failures;
+}
+
+/* ============================================================================
+ * Main Test Function
+ * ========================================================================= */
+
+/**
+ * @brief The main entry point for the engine test suite.
+ * @return 0 if all tests pass, 1 otherwise.
+ */
+int main(void)
+{
+    aes_engine_config_t config       = {0};
+    aes_engine_t*       engine       = NULL;
+    int                 failed_tests = 0;
+
+    fill_random(input, sizeof(input), 2024);
+
+    // Small chunks and no threshold: every operation is split across threads.
+    config.num_threads       = 4;
+    config.chunk_size        = 4096;
+    config.min_parallel_size = 1;
+    if (aes_engine_create(&engine, &config) != AES_SUCCESS)
+    {
+        fprintf(stderr, "FAIL: The engine could not be created.\n");
+        return 1;
+    }
+    for (size_t b = 0; b < TEST_BACKEND_COUNT; b++)
+        failed_tests += run_engine_operations(engine, test_backends[b]);
+    aes_engine_destroy(engine);
+
+    failed_tests += run_engine_config_tests();
+
+    if (failed_tests > 0)
+    {
+        fprintf(stderr, "\nSUMMARY: %d check(s) failed.\n", failed_tests);
+        return 1;
+    }
+
+    printf("\nSUMMARY: All tests passed successfully!\n");
+    return 0;
+}
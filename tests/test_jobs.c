@@ -0,0 +1,462 @@
+/**
+ * @file test_jobs.c
+ * @brief Unit tests for the job manager.
+ *
+ * @details Every job must produce exactly the output, IV and counter of the
+ * matching contiguous function, whatever mix of modes, keys, backends and
+ * lengths shares the lanes. Invalid jobs must be rejected at submission, and
+ * destruction must complete what is queued. Where threads are available, a
+ * lone job must complete within its latency budget without a flush, and
+ * jobs from many threads, polled or signalled by callback, must all complete
+ * correctly.
+ */
+
+#include "../include/aes.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#ifdef AES_HAVE_PTHREADS
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <time.h>
+#endif
+
+/* ============================================================================
+ * Test Utilities
+ * ========================================================================= */
+
+// Jobs submitted by the mixed test; more than the widest lanes, so lanes refill.
+#define TEST_JOB_COUNT 80
+
+// Largest job of the tests, in bytes.
+#define TEST_MAX_LENGTH 200
+
+//! A job with its buffers and the expected result.
+typedef struct
+{
+    aes_job_t job;
+    uint8_t   in[TEST_MAX_LENGTH];
+    uint8_t   out[TEST_MAX_LENGTH];
+    uint8_t   expected[TEST_MAX_LENGTH];
+    uint8_t   expected_iv[AES_BLOCK_SIZE];
+} test_job_t;
+
+/**
+ * @brief Prepares job i of a sequence: mode, key, length and data all vary with i.
+ * @param[out] t The job to fill in.
+ * @param[in] ctxs The contexts to choose from.
+ * @param[in] num_ctxs The number of contexts.
+ * @param[in] i The job index.
+ */
+static void make_job(test_job_t* t, const aes_ctx_t* ctxs, size_t num_ctxs, size_t i)
+{
+    static const aes_job_mode_t modes[] = {AES_JOB_ECB_ENCRYPT, AES_JOB_ECB_DECRYPT, AES_JOB_CBC_ENCRYPT,
+                                           AES_JOB_CBC_DECRYPT, AES_JOB_CTR};
+    aes_job_mode_t mode   = modes[i % 5];
+    size_t         length = (i * 37 % (TEST_MAX_LENGTH / AES_BLOCK_SIZE)) * AES_BLOCK_SIZE + AES_BLOCK_SIZE;
+    if (mode == AES_JOB_CTR)
+        length = i * 53 % TEST_MAX_LENGTH + 1;
+
+    memset(t, 0, sizeof(*t));
+    for (size_t j = 0; j < length; j++)
+        t->in[j] = (uint8_t)(i * 11 + j * 3);
+    for (size_t j = 0; j < AES_BLOCK_SIZE; j++)
+        t->job.iv[j] = (uint8_t)(i + j * 17);
+    if (mode == AES_JOB_CTR)
+        memset(t->job.iv + 12, 0xff, 4); // Wrap the 32-bit counter field early.
+
+    t->job.ctx    = &ctxs[i % num_ctxs];
+    t->job.mode   = mode;
+    t->job.in     = t->in;
+    t->job.out    = i % 3 == 0 ? t->in : t->out; // Every third job runs in place.
+    t->job.length = length;
+    t->job.width  = AES_CTR_WIDTH_32;
+
+    // The expected result, from the contiguous functions.
+    memcpy(t->expected_iv, t->job.iv, AES_BLOCK_SIZE);
+    switch (mode)
+    {
+        case AES_JOB_ECB_ENCRYPT:
+            aes_ecb_encrypt(t->job.ctx, t->in, t->expected, length);
+            break;
+        case AES_JOB_ECB_DECRYPT:
+            aes_ecb_decrypt(t->job.ctx, t->in, t->expected, length);
+            break;
+        case AES_JOB_CBC_ENCRYPT:
+            aes_cbc_encrypt(t->job.ctx, t->expected_iv, t->in, t->expected, length);
+            break;
+        case AES_JOB_CBC_DECRYPT:
+            aes_cbc_decrypt(t->job.ctx, t->expected_iv, t->in, t->expected, length);
+            break;
+        case AES_JOB_CTR:
+            aes_ctr_xcrypt_ex(t->job.ctx, t->expected_iv, AES_CTR_WIDTH_32, t->in, t->expected, length);
+            break;
+    }
+}
+
+/**
+ * @brief Checks a completed job against its expected result.
+ * @return 0 if it matches, 1 otherwise.
+ */
+static int check_job(const char* name, const test_job_t* t, size_t i)
+{
+    if (memcmp(t->job.out, t->expected, t->job.length) != 0 ||
+        (t->job.mode != AES_JOB_ECB_ENCRYPT && t->job.mode != AES_JOB_ECB_DECRYPT &&
+         memcmp(t->job.iv, t->expected_iv, AES_BLOCK_SIZE) != 0))
+    {
+        fprintf(stderr, "FAIL: %s job %zu (mode %d, %zu bytes) differs from the contiguous mode.\n", name, i,
+                (int)t->job.mode, t->job.length);
+        return 1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Initializes contexts under different keys, sizes and backends.
+ * @return The number of contexts initialized (at most 4).
+ */
+static size_t make_contexts(aes_ctx_t* ctxs)
+{
+    static const aes_key_size_t sizes[] = {AES_KEY_SIZE_128, AES_KEY_SIZE_256, AES_KEY_SIZE_192, AES_KEY_SIZE_128};
+    uint8_t                     key[32];
+
+    for (size_t i = 0; i < 4; i++)
+    {
+        for (size_t j = 0; j < sizeof(key); j++)
+            key[j] = (uint8_t)(i * 29 + j);
+        // The last context is pinned to the reference backend so the lanes mix backends.
+        aes_ctx_init_backend(&ctxs[i], key, sizes[i], i == 3 ? AES_BACKEND_REFERENCE : AES_BACKEND_AUTO);
+    }
+    return 4;
+}
+
+/* ============================================================================
+ * Single-Threaded Tests
+ * ========================================================================= */
+
+/**
+ * @brief Submits a mix of jobs to managers of several widths and compares
+ * each result with the contiguous functions.
+ */
+static int run_job_mixed_tests(void)
+{
+    static test_job_t jobs[TEST_JOB_COUNT];
+    static const unsigned widths[] = {1, 3, 8, AES_JOB_MAX_LANES};
+    aes_ctx_t             ctxs[4];
+    size_t                num_ctxs = make_contexts(ctxs);
+    int                   failures = 0;
+
+    printf("--- Job Manager Tests ---\n");
+    for (size_t w = 0; w < sizeof(widths) / sizeof(widths[0]); w++)
+    {
+        aes_job_manager_config_t config  = {widths[w], 0};
+        aes_job_manager_t*       manager = NULL;
+        int                      failed  = 0;
+
+        if (aes_job_manager_create(&manager, &config) != AES_SUCCESS)
+        {
+            fprintf(stderr, "FAIL: aes_job_manager_create() with %u lanes failed.\n", widths[w]);
+            failures++;
+            continue;
+        }
+
+        for (size_t i = 0; i < TEST_JOB_COUNT; i++)
+        {
+            make_job(&jobs[i], ctxs, num_ctxs, i);
+            if (aes_job_submit(manager, &jobs[i].job) != AES_SUCCESS)
+            {
+                fprintf(stderr, "FAIL: aes_job_submit() rejected job %zu.\n", i);
+                failed++;
+            }
+        }
+        aes_job_manager_flush(manager);
+
+        for (size_t i = 0; i < TEST_JOB_COUNT; i++)
+        {
+            if (!aes_job_done(&jobs[i].job))
+            {
+                fprintf(stderr, "FAIL: job %zu not done after a flush.\n", i);
+                failed++;
+            }
+            else
+                failed += check_job("mixed", &jobs[i], i);
+        }
+        aes_job_manager_destroy(manager);
+
+        printf("%s: %u lanes, %d jobs\n", failed ? "FAIL" : "PASS", widths[w], TEST_JOB_COUNT);
+        failures += failed;
+    }
+
+    for (size_t i = 0; i < num_ctxs; i++)
+        aes_ctx_clear(&ctxs[i]);
+    return failures;
+}
+
+/**
+ * @brief Checks argument validation, zero-length jobs and completion on destruction.
+ */
+static int run_job_edge_tests(void)
+{
+    static test_job_t        jobs[TEST_JOB_COUNT];
+    aes_ctx_t                ctxs[4];
+    size_t                   num_ctxs = make_contexts(ctxs);
+    aes_job_manager_config_t wide     = {AES_JOB_MAX_LANES + 1, 0};
+    aes_job_manager_t*       manager  = NULL;
+    int                      failures = 0;
+
+    if (aes_job_manager_create(&manager, &wide) != AES_ERROR_INVALID_ARGUMENT || manager)
+    {
+        fprintf(stderr, "FAIL: a manager wider than AES_JOB_MAX_LANES was created.\n");
+        failures++;
+    }
+    if (aes_job_manager_create(&manager, NULL) != AES_SUCCESS)
+    {
+        fprintf(stderr, "FAIL: aes_job_manager_create() with the defaults failed.\n");
+        return failures + 1;
+    }
+
+    test_job_t* t = &jobs[0];
+    make_job(t, ctxs, num_ctxs, 0);
+    t->job.length = 24;
+    if (aes_job_submit(manager, &t->job) != AES_ERROR_INVALID_LENGTH)
+    {
+        fprintf(stderr, "FAIL: an ECB job of 24 bytes was accepted.\n");
+        failures++;
+    }
+    make_job(t, ctxs, num_ctxs, 4);
+    t->job.width = (aes_ctr_width_t)5;
+    if (aes_job_submit(manager, &t->job) != AES_ERROR_INVALID_ARGUMENT)
+    {
+        fprintf(stderr, "FAIL: a CTR job with an invalid counter width was accepted.\n");
+        failures++;
+    }
+    make_job(t, ctxs, num_ctxs, 1);
+    t->job.ctx = NULL;
+    if (aes_job_submit(manager, &t->job) != AES_ERROR_INVALID_ARGUMENT)
+    {
+        fprintf(stderr, "FAIL: a job without a context was accepted.\n");
+        failures++;
+    }
+    make_job(t, ctxs, num_ctxs, 2);
+    t->job.length = 0;
+    t->job.in     = NULL;
+    if (aes_job_submit(manager, &t->job) != AES_SUCCESS || !aes_job_done(&t->job))
+    {
+        fprintf(stderr, "FAIL: a zero-length job did not complete on submission.\n");
+        failures++;
+    }
+
+    // Destruction completes queued jobs without a flush.
+    for (size_t i = 0; i < TEST_JOB_COUNT; i++)
+    {
+        make_job(&jobs[i], ctxs, num_ctxs, i + 7);
+        aes_job_submit(manager, &jobs[i].job);
+    }
+    aes_job_manager_destroy(manager);
+    for (size_t i = 0; i < TEST_JOB_COUNT; i++)
+    {
+        if (!aes_job_done(&jobs[i].job))
+        {
+            fprintf(stderr, "FAIL: job %zu not done after destruction.\n", i);
+            failures++;
+        }
+        else
+            failures += check_job("destroyed", &jobs[i], i);
+    }
+
+    for (size_t i = 0; i < num_ctxs; i++)
+        aes_ctx_clear(&ctxs[i]);
+    printf("%s: argument checks and completion on destruction\n", failures ? "FAIL" : "PASS");
+    return failures;
+}
+
+#ifdef AES_HAVE_PTHREADS
+
+/* ============================================================================
+ * Multi-Threaded Tests
+ * ========================================================================= */
+
+// Submitting threads, and jobs per thread.
+#define TEST_THREADS         16
+#define TEST_JOBS_PER_THREAD 200
+
+//! What each submitting thread needs.
+typedef struct
+{
+    aes_job_manager_t* manager;
+    const aes_ctx_t*   ctxs;
+    size_t             num_ctxs;
+    size_t             index;
+    int                use_callback;
+    atomic_int         signalled; /**< Set by the callback. */
+    int                failures;
+} submitter_t;
+
+/** @brief Marks the submitter that owns a job as signalled. */
+static void job_signalled(aes_job_t* job)
+{
+    submitter_t* submitter = job->user_data;
+    atomic_store_explicit(&submitter->signalled, 1, memory_order_release);
+}
+
+/**
+ * @brief Submits jobs one at a time and waits for each, by polling or by callback.
+ * @param[in] arg A submitter_t.
+ * @return NULL.
+ */
+static void* submitter_main(void* arg)
+{
+    submitter_t* submitter = arg;
+    test_job_t   t;
+
+    for (size_t i = 0; i < TEST_JOBS_PER_THREAD; i++)
+    {
+        size_t seq = submitter->index * TEST_JOBS_PER_THREAD + i;
+        make_job(&t, submitter->ctxs, submitter->num_ctxs, seq);
+        if (submitter->use_callback)
+        {
+            t.job.callback  = job_signalled;
+            t.job.user_data = submitter;
+            atomic_store(&submitter->signalled, 0);
+        }
+        if (aes_job_submit(submitter->manager, &t.job) != AES_SUCCESS)
+        {
+            submitter->failures++;
+            continue;
+        }
+
+        if (submitter->use_callback)
+            while (!atomic_load_explicit(&submitter->signalled, memory_order_acquire))
+                sched_yield();
+        else
+            while (!aes_job_done(&t.job))
+                sched_yield();
+        submitter->failures += check_job("threaded", &t, seq);
+    }
+    return NULL;
+}
+
+/**
+ * @brief Has many threads submit and wait for jobs on one manager at once.
+ * @details Every thread waits for its job before submitting the next, so
+ * the lanes only fill across threads, and partial batches rely on the
+ * deadline.
+ */
+static int run_job_thread_tests(void)
+{
+    static submitter_t       submitters[TEST_THREADS];
+    pthread_t                threads[TEST_THREADS];
+    aes_ctx_t                ctxs[4];
+    size_t                   num_ctxs = make_contexts(ctxs);
+    aes_job_manager_config_t config   = {8, 100};
+    aes_job_manager_t*       manager  = NULL;
+    int                      failures = 0;
+
+    if (aes_job_manager_create(&manager, &config) != AES_SUCCESS)
+    {
+        fprintf(stderr, "FAIL: aes_job_manager_create() failed.\n");
+        return 1;
+    }
+
+    size_t started = 0;
+    for (size_t i = 0; i < TEST_THREADS; i++)
+    {
+        submitters[i].manager      = manager;
+        submitters[i].ctxs         = ctxs;
+        submitters[i].num_ctxs     = num_ctxs;
+        submitters[i].index        = i;
+        submitters[i].use_callback = (int)(i % 2);
+        submitters[i].failures     = 0;
+        atomic_init(&submitters[i].signalled, 0);
+        if (pthread_create(&threads[i], NULL, submitter_main, &submitters[i]) != 0)
+            break;
+        started++;
+    }
+    for (size_t i = 0; i < started; i++)
+    {
+        pthread_join(threads[i], NULL);
+        failures += submitters[i].failures;
+    }
+    if (started < TEST_THREADS)
+    {
+        fprintf(stderr, "FAIL: only %zu submitting threads started.\n", started);
+        failures++;
+    }
+    aes_job_manager_destroy(manager);
+
+    for (size_t i = 0; i < num_ctxs; i++)
+        aes_ctx_clear(&ctxs[i]);
+    printf("%s: %d threads, %d jobs each, polled and by callback\n", failures ? "FAIL" : "PASS", TEST_THREADS,
+           TEST_JOBS_PER_THREAD);
+    return failures;
+}
+
+/**
+ * @brief Checks that a lone job in wide lanes completes by its deadline alone.
+ */
+static int run_job_deadline_test(void)
+{
+    static test_job_t        t;
+    aes_ctx_t                ctxs[4];
+    size_t                   num_ctxs = make_contexts(ctxs);
+    aes_job_manager_config_t config   = {AES_JOB_MAX_LANES, 2000};
+    aes_job_manager_t*       manager  = NULL;
+    int                      failures = 0;
+
+    if (aes_job_manager_create(&manager, &config) != AES_SUCCESS)
+    {
+        fprintf(stderr, "FAIL: aes_job_manager_create() failed.\n");
+        return 1;
+    }
+
+    make_job(&t, ctxs, num_ctxs, 4);
+    aes_job_submit(manager, &t.job);
+
+    // Allow far more than the 2 ms budget before calling it lost.
+    struct timespec start, now;
+    timespec_get(&start, TIME_UTC);
+    do
+    {
+        sched_yield();
+        timespec_get(&now, TIME_UTC);
+    } while (!aes_job_done(&t.job) && now.tv_sec - start.tv_sec < 5);
+
+    if (!aes_job_done(&t.job))
+    {
+        fprintf(stderr, "FAIL: a lone job did not complete without a flush.\n");
+        failures++;
+    }
+    else
+        failures += check_job("deadline", &t, 4);
+
+    aes_job_manager_destroy(manager);
+    for (size_t i = 0; i < num_ctxs; i++)
+        aes_ctx_clear(&ctxs[i]);
+    printf("%s: a partial batch runs at its deadline\n", failures ? "FAIL" : "PASS");
+    return failures;
+}
+
+#endif // AES_HAVE_PTHREADS
+
+int main(void)
+{
+    int failed_tests = 0;
+
+    failed_tests += run_job_mixed_tests();
+    failed_tests += run_job_edge_tests();
+#ifdef AES_HAVE_PTHREADS
+    failed_tests += run_job_deadline_test();
+    failed_tests += run_job_thread_tests();
+#endif
+
+    if (failed_tests > 0)
+    {
+        fprintf(stderr, "\nSUMMARY: %d check(s) failed.\n", failed_tests);
+        return 1;
+    }
+
+    printf("\nSUMMARY: All tests passed successfully!\n");
+    return 0;
+}
@@ -0,0 +1,303 @@
+/**
+ * @file test_keyring.c
+ * @brief Unit tests for the shared keyring.
+ *
+ * @details Registered keys must encrypt exactly like a private context, stale
+ * and removed handles must never resolve, and, where threads are available,
+ * readers racing with key rotation must only ever see live, intact keys.
+ */
+
+#include "../include/aes.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#ifdef AES_HAVE_PTHREADS
+#include <pthread.h>
+#include <stdatomic.h>
+#endif
+
+/* ============================================================================
+ * Test Utilities
+ * ========================================================================= */
+
+// Keys registered by the tests.
+#define TEST_KEY_COUNT 64
+
+/**
+ * @brief Derives the reproducible test key with the given index.
+ * @param[out] key Receives AES_KEY_SIZE_256 bytes.
+ * @param[in] index The key index.
+ */
+static void make_key(uint8_t* key, size_t index)
+{
+    for (size_t i = 0; i < AES_KEY_SIZE_256; i++)
+        key[i] = (uint8_t)(index * 31 + i * 7 + 1);
+}
+
+/**
+ * @brief Checks a keyring context against a private context for the same key.
+ * @param[in] ctx The context returned by the keyring.
+ * @param[in] index The test key index.
+ * @param[in] key_size The size the key was registered with.
+ * @return 0 if both encrypt a block identically, 1 otherwise.
+ */
+static int check_context(const aes_ctx_t* ctx, size_t index, aes_key_size_t key_size)
+{
+    uint8_t   key[AES_KEY_SIZE_256], block[AES_BLOCK_SIZE] = {0}, expected[AES_BLOCK_SIZE], actual[AES_BLOCK_SIZE];
+    aes_ctx_t reference;
+
+    make_key(key, index);
+    aes_ctx_init_backend(&reference, key, key_size, AES_BACKEND_REFERENCE);
+    aes_ctx_encrypt(&reference, block, expected);
+    aes_ctx_encrypt(ctx, block, actual);
+    aes_ctx_clear(&reference);
+    return memcmp(expected, actual, sizeof(actual)) != 0;
+}
+
+/* ============================================================================
+ * Keyring Tests
+ * ========================================================================= */
+
+/**
+ * @brief Checks registration, lookup, removal, slot reuse and capacity.
+ * @return The number of failed checks.
+ */
+static int run_keyring_basic_tests(void)
+{
+    static const aes_key_size_t key_sizes[] = {AES_KEY_SIZE_128, AES_KEY_SIZE_192, AES_KEY_SIZE_256};
+    aes_keyring_t*              keyring     = NULL;
+    aes_key_handle_t            handles[TEST_KEY_COUNT];
+    uint8_t                     key[AES_KEY_SIZE_256], block[2 * AES_BLOCK_SIZE] = {0}, copy[sizeof(block)];
+    int                         failures = 0;
+
+    printf("\n--- Running Test Case: keyring registration and lookup ---\n");
+    if (aes_keyring_create(&keyring, TEST_KEY_COUNT) != AES_SUCCESS)
+    {
+        fprintf(stderr, "FAIL: The keyring could not be created.\n");
+        return 1;
+    }
+
+    for (size_t i = 0; i < TEST_KEY_COUNT; i++)
+    {
+        make_key(key, i);
+        if (aes_keyring_add(keyring, key, key_sizes[i % 3], AES_BACKEND_AUTO, &handles[i]) != AES_SUCCESS ||
+            handles[i] == 0)
+        {
+            fprintf(stderr, "FAIL: Key %zu could not be registered.\n", i);
+            failures++;
+        }
+    }
+
+    make_key(key, TEST_KEY_COUNT);
+    aes_key_handle_t extra;
+    if (aes_keyring_add(keyring, key, AES_KEY_SIZE_128, AES_BACKEND_AUTO, &extra) != AES_ERROR_KEYRING_FULL)
+    {
+        fprintf(stderr, "FAIL: A full keyring accepted another key.\n");
+        failures++;
+    }
+
+    unsigned token = aes_keyring_read_begin(keyring);
+    for (size_t i = 0; i < TEST_KEY_COUNT; i++)
+    {
+        const aes_ctx_t* ctx = aes_keyring_lookup(keyring, handles[i]);
+        if (!ctx || check_context(ctx, i, key_sizes[i % 3]) != 0)
+        {
+            fprintf(stderr, "FAIL: Key %zu does not resolve to its schedule.\n", i);
+            failures++;
+        }
+    }
+    aes_keyring_read_end(keyring, token);
+
+    // ECB through the keyring round-trips, and matches a looked-up context.
+    memcpy(copy, block, sizeof(block));
+    aes_keyring_ecb_encrypt(keyring, handles[5], block, block, sizeof(block));
+    token = aes_keyring_read_begin(keyring);
+    aes_ecb_encrypt(aes_keyring_lookup(keyring, handles[5]), copy, copy, sizeof(copy));
+    aes_keyring_read_end(keyring, token);
+    if (memcmp(block, copy, sizeof(block)) != 0 ||
+        aes_keyring_ecb_decrypt(keyring, handles[5], block, block, sizeof(block)) != AES_SUCCESS ||
+        block[0] != 0 || block[sizeof(block) - 1] != 0)
+    {
+        fprintf(stderr, "FAIL: Keyring ECB does not match the registered key.\n");
+        failures++;
+    }
+
+    // A removed handle stays dead even after its slot is reused.
+    aes_key_handle_t removed = handles[7];
+    if (aes_keyring_remove(keyring, removed) != AES_SUCCESS ||
+        aes_keyring_remove(keyring, removed) != AES_ERROR_KEY_NOT_FOUND ||
+        aes_keyring_ecb_encrypt(keyring, removed, block, block, sizeof(block)) != AES_ERROR_KEY_NOT_FOUND)
+    {
+        fprintf(stderr, "FAIL: A removed key was still usable.\n");
+        failures++;
+    }
+    if (aes_keyring_add(keyring, key, AES_KEY_SIZE_128, AES_BACKEND_AUTO, &handles[7]) != AES_SUCCESS ||
+        handles[7] == removed)
+    {
+        fprintf(stderr, "FAIL: A freed slot was not reused with a new handle.\n");
+        failures++;
+    }
+    token = aes_keyring_read_begin(keyring);
+    if (aes_keyring_lookup(keyring, removed) != NULL || aes_keyring_lookup(keyring, 0) != NULL ||
+        aes_keyring_lookup(keyring, ((aes_key_handle_t)1 << 32) | 0xffffffu) != NULL)
+    {
+        fprintf(stderr, "FAIL: A stale or invalid handle resolved.\n");
+        failures++;
+    }
+    aes_keyring_read_end(keyring, token);
+
+    aes_keyring_destroy(keyring);
+    if (aes_keyring_create(&keyring, 0) != AES_ERROR_INVALID_ARGUMENT)
+    {
+        fprintf(stderr, "FAIL: A zero-capacity keyring was created.\n");
+        failures++;
+    }
+    return failures;
+}
+
+#ifdef AES_HAVE_PTHREADS
+
+// Reader threads and rotation rounds of the concurrent test.
+#define TEST_READERS   4
+#define TEST_ROTATIONS 128
+
+//! Shared state of the concurrent test.
+typedef struct
+{
+    aes_keyring_t*            keyring;
+    _Atomic(size_t)           index[TEST_KEY_COUNT];  /**< The test key index held by each logical slot. */
+    _Atomic(aes_key_handle_t) handle[TEST_KEY_COUNT]; /**< Its current handle, 0 while it is rotated. */
+    atomic_int                stop;
+    atomic_int                failures;
+    atomic_size_t             lookups;
+} rotation_test_t;
+
+/**
+ * @brief Reader loop: resolves random handles and checks every hit.
+ * @details A handle read just before a rotation may already be dead, which is
+ * fine; a handle that resolves must yield an intact schedule for its key.
+ */
+static void* rotation_reader(void* arg)
+{
+    rotation_test_t* test = arg;
+    uint32_t         seed = (uint32_t)(uintptr_t)&seed;
+
+    while (!atomic_load(&test->stop))
+    {
+        seed                    = seed * 1664525u + 1013904223u;
+        size_t           n      = (seed >> 16) % TEST_KEY_COUNT;
+        aes_key_handle_t handle = atomic_load(&test->handle[n]);
+        size_t           index  = atomic_load(&test->index[n]);
+
+        // The handle is cleared before the index changes, so an unchanged handle pins the index.
+        if (handle == 0 || atomic_load(&test->handle[n]) != handle)
+            continue;
+
+        // Even if the key is retired now, it must stay intact until the section ends.
+        unsigned         token = aes_keyring_read_begin(test->keyring);
+        const aes_ctx_t* ctx   = aes_keyring_lookup(test->keyring, handle);
+        if (ctx && check_context(ctx, index, AES_KEY_SIZE_128) != 0)
+            atomic_fetch_add(&test->failures, 1);
+        aes_keyring_read_end(test->keyring, token);
+        atomic_fetch_add_explicit(&test->lookups, 1, memory_order_relaxed);
+    }
+    return NULL;
+}
+
+/**
+ * @brief Rotates keys while reader threads look them up.
+ * @return The number of failed checks.
+ */
+static int run_keyring_rotation_test(void)
+{
+    static rotation_test_t test;
+    pthread_t              readers[TEST_READERS];
+    uint8_t                key[AES_KEY_SIZE_256];
+    int                    failures = 0;
+
+    printf("\n--- Running Test Case: keyring rotation under %d concurrent readers ---\n", TEST_READERS);
+    if (aes_keyring_create(&test.keyring, TEST_KEY_COUNT + 1) != AES_SUCCESS)
+    {
+        fprintf(stderr, "FAIL: The keyring could not be created.\n");
+        return 1;
+    }
+    for (size_t n = 0; n < TEST_KEY_COUNT; n++)
+    {
+        aes_key_handle_t handle;
+        make_key(key, n);
+        aes_keyring_add(test.keyring, key, AES_KEY_SIZE_128, AES_BACKEND_AUTO, &handle);
+        atomic_init(&test.index[n], n);
+        atomic_init(&test.handle[n], handle);
+    }
+
+    for (int t = 0; t < TEST_READERS; t++)
+        pthread_create(&readers[t], NULL, rotation_reader, &test);
+
+    // Each rotation registers a new key for a logical slot, then retires the old one.
+    for (size_t r = 0; r < TEST_ROTATIONS; r++)
+    {
+        size_t           n     = r % TEST_KEY_COUNT;
+        size_t           index = TEST_KEY_COUNT + r;
+        aes_key_handle_t old   = atomic_load(&test.handle[n]);
+        aes_key_handle_t handle;
+
+        make_key(key, index);
+        if (aes_keyring_add(test.keyring, key, AES_KEY_SIZE_128, AES_BACKEND_AUTO, &handle) != AES_SUCCESS)
+        {
+            fprintf(stderr, "FAIL: Rotation %zu could not register its key.\n", r);
+            failures++;
+            break;
+        }
+        atomic_store(&test.handle[n], 0);
+        atomic_store(&test.index[n], index);
+        atomic_store(&test.handle[n], handle);
+        if (aes_keyring_remove(test.keyring, old) != AES_SUCCESS)
+        {
+            fprintf(stderr, "FAIL: Rotation %zu could not retire its old key.\n", r);
+            failures++;
+        }
+    }
+
+    atomic_store(&test.stop, 1);
+    for (int t = 0; t < TEST_READERS; t++)
+        pthread_join(readers[t], NULL);
+
+    if (atomic_load(&test.failures) != 0)
+    {
+        fprintf(stderr, "FAIL: %d lookups returned a corrupted schedule.\n", atomic_load(&test.failures));
+        failures++;
+    }
+    printf("%zu concurrent lookups\n", atomic_load(&test.lookups));
+    aes_keyring_destroy(test.keyring);
+    return failures;
+}
+
+#endif
+
+/* ============================================================================
+ * Main Test Function
+ * ========================================================================= */
+
+/**
+ * @brief The main entry point for the keyring test suite.
+ * @return 0 if all tests pass, 1 otherwise.
+ */
+int main(void)
+{
+    int failed_tests = 0;
+
+    failed_tests += run_keyring_basic_tests();
+#ifdef AES_HAVE_PTHREADS
+    failed_tests += run_keyring_rotation_test();
+#endif
+
+    if (failed_tests > 0)
+    {
+        fprintf(stderr, "\nSUMMARY: %d check(s) failed.\n", failed_tests);
+        return 1;
+    }
+
+    printf("\nSUMMARY: All tests passed successfully!\n");
+    return 0;
+}
@@ -0,0 +1,1482 @@
+/**
+ * @file test_modes.c
+ * @brief Unit tests for the block cipher modes of operation.
+ *
+ * @details Every mode is checked against published known answer vectors and
+ * for consistency across call patterns (in-place, split calls, partial
+ * blocks) on each backend the host supports.
+ */
+
+#include "../include/aes.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "test_util.h"
+
+/* ============================================================================
+ * Test Utilities
+ * ========================================================================= */
+
+/**
+ * @brief Prints a byte array in hexadecimal format.
+ * @param[in] label A descriptive label to print before the hex string.
+ * @param[in] data A pointer to the byte array.
+ * @param[in] len The number of bytes to print.
+ */
+static void print_hex(const char* label, const uint8_t* data, size_t len)
+{
+    printf("%-12s", label);
+    for (size_t i = 0; i < len; i++)
+    {
+        printf("%02x", data[i]);
+    }
+    printf("\n");
+}
+
+/**
+ * @brief Compares a result against its expected value and reports a mismatch.
+ * @param[in] what A description of the compared value.
+ * @param[in] actual The computed bytes.
+ * @param[in] expected The known-correct bytes.
+ * @param[in] len The number of bytes to compare.
+ * @return 0 if equal, 1 otherwise.
+ */
+static int check_bytes(const char* what, const uint8_t* actual, const uint8_t* expected, size_t len)
+{
+    if (memcmp(actual, expected, len) == 0)
+        return 0;
+
+    fprintf(stderr, "FAIL: %s does not match the expected value.\n", what);
+    print_hex("Expected:", expected, len);
+    print_hex("Actual:", actual, len);
+    return 1;
+}
+
+/* ============================================================================
+ * CTR Mode
+ * ========================================================================= */
+
+/**
+ * @brief CTR known answer test from NIST SP 800-38A F.5.1 / F.5.2, plus
+ * split-call, in-place and partial-block consistency checks.
+ * @return The number of failed checks.
+ */
+static int run_ctr_tests(void)
+{
+    uint8_t key[16], counter0[16], plaintext[64], expected[64];
+    uint8_t counter[16], buffer[64], again[64];
+    int     failures = 0;
+
+    hex_to_bytes("2b7e151628aed2a6abf7158809cf4f3c", key, sizeof(key));
+    hex_to_bytes("f0f1f2f3f4f5f6f7f8f9fafbfcfdfeff", counter0, sizeof(counter0));
+    hex_to_bytes("6bc1bee22e409f96e93d7e117393172aae2d8a571e03ac9c9eb76fac45af8e51"
+                 "30c81c46a35ce411e5fbc1191a0a52eff69f2445df4f9b17ad2b417be66c3710",
+                 plaintext, sizeof(plaintext));
+    hex_to_bytes("874d6191b620e3261bef6864990db6ce9806f66b7970fdff8617187bb9fffdff"
+                 "5ae4df3edbd5d35e5b4f09020db03eab1e031dda2fbe03d1792170a0f3009cee",
+                 expected, sizeof(expected));
+
+    for (size_t b = 0; b < TEST_BACKEND_COUNT; b++)
+    {
+        aes_ctx_t ctx;
+        if (aes_ctx_init_backend(&ctx, key, AES_KEY_SIZE_128, test_backends[b]) != AES_SUCCESS)
+            continue;
+        printf("\n--- Running Test Case: CTR-AES128 SP 800-38A F.5.1 (%s) ---\n", aes_backend_name(test_backends[b]));
+
+        memcpy(counter, counter0, sizeof(counter));
+        aes_ctr_xcrypt(&ctx, counter, plaintext, buffer, sizeof(plaintext));
+        failures += check_bytes("CTR ciphertext", buffer, expected, sizeof(expected));
+
+        // Two calls split on a block boundary continue the same keystream, in place.
+        memcpy(counter, counter0, sizeof(counter));
+        memcpy(again, plaintext, sizeof(again));
+        aes_ctr_xcrypt(&ctx, counter, again, again, 32);
+        aes_ctr_xcrypt(&ctx, counter, again + 32, again + 32, 27);
+        failures += check_bytes("Split in-place CTR ciphertext", again, expected, 59);
+
+        // Decryption is the same operation.
+        memcpy(counter, counter0, sizeof(counter));
+        aes_ctr_xcrypt(&ctx, counter, buffer, buffer, sizeof(buffer));
+        failures += check_bytes("CTR decryption", buffer, plaintext, sizeof(plaintext));
+
+        aes_ctx_clear(&ctx);
+    }
+
+    return failures;
+}
+
+/**
+ * @brief Checks that each counter width wraps within its own field.
+ * @details The keystream of a counter block just below the wrap point is
+ * compared with single-block encryptions of the expected counter values.
+ * @return The number of failed checks.
+ */
+static int run_ctr_width_tests(void)
+{
+    static const aes_ctr_width_t widths[] = {AES_CTR_WIDTH_32, AES_CTR_WIDTH_64, AES_CTR_WIDTH_128};
+    static const uint8_t         key[16]  = {0};
+    uint8_t                      zeros[3 * AES_BLOCK_SIZE];
+    uint8_t                      keystream[sizeof(zeros)];
+    uint8_t                      expected[sizeof(zeros)];
+    uint8_t                      counter[AES_BLOCK_SIZE];
+    uint8_t                      block[AES_BLOCK_SIZE];
+    aes_ctx_t                    ctx;
+    int                          failures = 0;
+
+    printf("\n--- Running Test Case: CTR counter widths ---\n");
+    memset(zeros, 0, sizeof(zeros));
+    aes_ctx_init(&ctx, key, AES_KEY_SIZE_128);
+
+    for (size_t w = 0; w < sizeof(widths) / sizeof(widths[0]); w++)
+    {
+        size_t field = (size_t)widths[w] / 8;
+
+        // Every counter byte is 0xaa except the counter field, which is all ones.
+        memset(counter, 0xaa, sizeof(counter));
+        memset(counter + AES_BLOCK_SIZE - field, 0xff, field);
+
+        memcpy(block, counter, sizeof(block));
+        for (size_t i = 0; i < 3; i++)
+        {
+            aes_ctx_encrypt(&ctx, block, expected + i * AES_BLOCK_SIZE);
+            // Big-endian increment confined to the field.
+            for (size_t j = AES_BLOCK_SIZE; j-- > AES_BLOCK_SIZE - field;)
+                if (++block[j] != 0)
+                    break;
+        }
+
+        aes_ctr_xcrypt_ex(&ctx, counter, widths[w], zeros, keystream, sizeof(zeros));
+        failures += check_bytes("CTR keystream across the wrap", keystream, expected, sizeof(expected));
+        failures += check_bytes("CTR counter after the wrap", counter, block, sizeof(block));
+    }
+
+    if (aes_ctr_xcrypt_ex(&ctx, counter, (aes_ctr_width_t)16, zeros, keystream, 16) != AES_ERROR_INVALID_ARGUMENT)
+    {
+        fprintf(stderr, "FAIL: An unsupported counter width was accepted.\n");
+        failures++;
+    }
+
+    aes_ctx_clear(&ctx);
+    return failures;
+}
+
+/* ============================================================================
+ * CBC Mode
+ * ========================================================================= */
+
+/**
+ * @brief CBC known answer test from NIST SP 800-38A F.2.1 / F.2.2, plus
+ * in-place, streamed and chaining value checks.
+ * @return The number of failed checks.
+ */
+static int run_cbc_tests(void)
+{
+    uint8_t key[16], iv0[16], plaintext[64], expected[64];
+    uint8_t iv[16], buffer[64];
+    int     failures = 0;
+
+    hex_to_bytes("2b7e151628aed2a6abf7158809cf4f3c", key, sizeof(key));
+    hex_to_bytes("000102030405060708090a0b0c0d0e0f", iv0, sizeof(iv0));
+    hex_to_bytes("6bc1bee22e409f96e93d7e117393172aae2d8a571e03ac9c9eb76fac45af8e51"
+                 "30c81c46a35ce411e5fbc1191a0a52eff69f2445df4f9b17ad2b417be66c3710",
+                 plaintext, sizeof(plaintext));
+    hex_to_bytes("7649abac8119b246cee98e9b12e9197d5086cb9b507219ee95db113a917678b2"
+                 "73bed6b8e3c1743b7116e69e222295163ff1caa1681fac09120eca307586e1a7",
+                 expected, sizeof(expected));
+
+    for (size_t b = 0; b < TEST_BACKEND_COUNT; b++)
+    {
+        aes_ctx_t ctx;
+        if (aes_ctx_init_backend(&ctx, key, AES_KEY_SIZE_128, test_backends[b]) != AES_SUCCESS)
+            continue;
+        printf("\n--- Running Test Case: CBC-AES128 SP 800-38A F.2.1 (%s) ---\n", aes_backend_name(test_backends[b]));
+
+        memcpy(iv, iv0, sizeof(iv));
+        aes_cbc_encrypt(&ctx, iv, plaintext, buffer, sizeof(plaintext));
+        failures += check_bytes("CBC ciphertext", buffer, expected, sizeof(expected));
+        failures += check_bytes("CBC chaining value", iv, expected + 48, sizeof(iv));
+
+        // In-place decryption, streamed in two chunks through the chaining value.
+        memcpy(iv, iv0, sizeof(iv));
+        aes_cbc_decrypt(&ctx, iv, buffer, buffer, 16);
+        failures += check_bytes("CBC chaining value after one block", iv, expected, sizeof(iv));
+        aes_cbc_decrypt(&ctx, iv, buffer + 16, buffer + 16, 48);
+        failures += check_bytes("Streamed in-place CBC decryption", buffer, plaintext, sizeof(plaintext));
+
+        if (aes_cbc_decrypt(&ctx, iv, buffer, buffer, 17) != AES_ERROR_INVALID_LENGTH)
+        {
+            fprintf(stderr, "FAIL: A partial CBC block was accepted.\n");
+            failures++;
+        }
+
+        aes_ctx_clear(&ctx);
+    }
+
+    return failures;
+}
+
+/**
+ * @brief Checks batched CBC decryption and PKCS#7 padding on every backend:
+ * round trips of every length up to a few batches, compared with the
+ * reference backend, and rejection of corrupted padding.
+ * @return The number of failed checks.
+ */
+static int run_cbc_padding_tests(void)
+{
+    static uint8_t plaintext[1100], expected[sizeof(plaintext) + 16], buffer[sizeof(expected)];
+    uint8_t        key[32], iv0[16], iv[16];
+    uint32_t       seed     = 0x9e3779b9u;
+    int            failures = 0;
+
+    for (size_t i = 0; i < sizeof(plaintext); i++)
+    {
+        seed         = seed * 1664525u + 1013904223u;
+        plaintext[i] = (uint8_t)(seed >> 24);
+    }
+    memcpy(key, plaintext + 500, sizeof(key));
+    memcpy(iv0, plaintext + 600, sizeof(iv0));
+
+    aes_ctx_t reference;
+    aes_ctx_init_backend(&reference, key, AES_KEY_SIZE_256, AES_BACKEND_REFERENCE);
+
+    for (size_t b = 0; b < TEST_BACKEND_COUNT; b++)
+    {
+        aes_ctx_t ctx;
+        if (aes_ctx_init_backend(&ctx, key, AES_KEY_SIZE_256, test_backends[b]) != AES_SUCCESS)
+            continue;
+        printf("\n--- Running Test Case: CBC PKCS#7 round trips (%s) ---\n", aes_backend_name(test_backends[b]));
+
+        for (size_t length = 0; length < sizeof(plaintext); length += (length < 40 ? 1 : 97))
+        {
+            size_t expected_length, out_length, plain_length;
+
+            memcpy(iv, iv0, sizeof(iv));
+            aes_cbc_encrypt_pkcs7(&reference, iv, plaintext, length, expected, sizeof(expected), &expected_length);
+
+            memcpy(iv, iv0, sizeof(iv));
+            memcpy(buffer, plaintext, length);
+            aes_cbc_encrypt_pkcs7(&ctx, iv, buffer, length, buffer, sizeof(buffer), &out_length);
+            if (out_length != (length / 16 + 1) * 16)
+            {
+                fprintf(stderr, "FAIL: PKCS#7 ciphertext of %zu bytes has length %zu.\n", length, out_length);
+                failures++;
+                continue;
+            }
+            failures += check_bytes("PKCS#7 CBC ciphertext", buffer, expected, out_length);
+
+            memcpy(iv, iv0, sizeof(iv));
+            if (aes_cbc_decrypt_pkcs7(&ctx, iv, buffer, out_length, buffer, &plain_length) != AES_SUCCESS ||
+                plain_length != length)
+            {
+                fprintf(stderr, "FAIL: Valid PKCS#7 padding was rejected for %zu bytes.\n", length);
+                failures++;
+                continue;
+            }
+            failures += check_bytes("PKCS#7 CBC decryption", buffer, plaintext, length);
+        }
+
+        // Flipping the last ciphertext byte corrupts the padding in the last block.
+        size_t out_length, plain_length;
+        memcpy(iv, iv0, sizeof(iv));
+        aes_cbc_encrypt_pkcs7(&ctx, iv, plaintext, 20, buffer, sizeof(buffer), &out_length);
+        buffer[out_length - 1] ^= 0x01;
+        memcpy(iv, iv0, sizeof(iv));
+        if (aes_cbc_decrypt_pkcs7(&ctx, iv, buffer, out_length, buffer, &plain_length) != AES_ERROR_INVALID_PADDING)
+        {
+            fprintf(stderr, "FAIL: Corrupted PKCS#7 padding was accepted.\n");
+            failures++;
+        }
+
+        aes_ctx_clear(&ctx);
+    }
+
+    aes_ctx_clear(&reference);
+    return failures;
+}
+
+/**
+ * @brief Checks multi-stream CBC encryption on every backend against one
+ * aes_cbc_encrypt() call per stream: streams of unequal lengths (including
+ * empty ones), each under its own key and some in place, so lanes are
+ * refilled mid-batch. The first pass keeps every lane on the backend with
+ * one key size, for its multi-stream kernel; the second mixes key sizes and
+ * the reference backend in, for the one-block-per-step path.
+ * @return The number of failed checks.
+ */
+static int run_cbc_multi_tests(void)
+{
+    enum
+    {
+        STREAMS    = 21,
+        MAX_BLOCKS = 64
+    };
+    static const aes_key_size_t key_sizes[] = {AES_KEY_SIZE_128, AES_KEY_SIZE_192, AES_KEY_SIZE_256};
+    static uint8_t              plaintext[STREAMS][MAX_BLOCKS * 16], expected[STREAMS][MAX_BLOCKS * 16];
+    static uint8_t              buffer[STREAMS][MAX_BLOCKS * 16];
+    uint8_t                     key[32], iv0[16], ivs[STREAMS][16], expected_ivs[STREAMS][16];
+    aes_ctx_t                   ctxs[STREAMS];
+    aes_cbc_stream_t            streams[STREAMS];
+    uint32_t                    seed     = 0x2545f491u;
+    int                         failures = 0;
+
+    for (size_t i = 0; i < STREAMS; i++)
+        for (size_t j = 0; j < sizeof(plaintext[i]); j++)
+        {
+            seed            = seed * 1664525u + 1013904223u;
+            plaintext[i][j] = (uint8_t)(seed >> 24);
+        }
+    memcpy(iv0, plaintext[3], sizeof(iv0));
+
+    for (size_t b = 0; b < TEST_BACKEND_COUNT; b++)
+    {
+        aes_ctx_t probe;
+        if (aes_ctx_init_backend(&probe, plaintext[0], AES_KEY_SIZE_128, test_backends[b]) != AES_SUCCESS)
+            continue;
+        aes_ctx_clear(&probe);
+        for (int mixed = 0; mixed < 2; mixed++)
+        {
+            printf("\n--- Running Test Case: multi-stream CBC encryption (%s, %s) ---\n",
+                   aes_backend_name(test_backends[b]), mixed ? "mixed lanes" : "uniform lanes");
+
+            for (size_t i = 0; i < STREAMS; i++)
+            {
+                // Stream 2 is long, so it keeps its lane while the short streams around it are replaced.
+                size_t         length   = (i == 2 ? MAX_BLOCKS : (i * 7) % 13) * 16;
+                aes_key_size_t key_size = mixed ? key_sizes[i % 3] : AES_KEY_SIZE_256;
+                aes_backend_t  backend  = mixed && i % 4 == 3 ? AES_BACKEND_REFERENCE : test_backends[b];
+
+                memcpy(key, plaintext[(i + 5) % STREAMS], sizeof(key));
+                aes_ctx_init_backend(&ctxs[i], key, key_size, backend);
+                memcpy(expected_ivs[i], iv0, sizeof(iv0));
+                expected_ivs[i][0] ^= (uint8_t)i;
+                memcpy(ivs[i], expected_ivs[i], sizeof(iv0));
+                aes_cbc_encrypt(&ctxs[i], expected_ivs[i], plaintext[i], expected[i], length);
+
+                memcpy(buffer[i], plaintext[i], length);
+                streams[i].ctx    = &ctxs[i];
+                streams[i].iv     = ivs[i];
+                streams[i].in     = i % 2 ? buffer[i] : plaintext[i];
+                streams[i].out    = buffer[i];
+                streams[i].length = length;
+            }
+
+            if (aes_cbc_encrypt_multi(streams, STREAMS) != AES_SUCCESS)
+            {
+                fprintf(stderr, "FAIL: Valid CBC streams were rejected.\n");
+                failures++;
+            }
+            for (size_t i = 0; i < STREAMS; i++)
+            {
+                failures += check_bytes("Multi-stream CBC ciphertext", buffer[i], expected[i], streams[i].length);
+                failures += check_bytes("Multi-stream CBC chaining value", ivs[i], expected_ivs[i], sizeof(iv0));
+            }
+
+            // Invalid streams are rejected before any stream is touched.
+            memcpy(ivs[0], iv0, sizeof(iv0));
+            streams[STREAMS - 1].length = 17;
+            if (aes_cbc_encrypt_multi(streams, STREAMS) != AES_ERROR_INVALID_LENGTH ||
+                memcmp(ivs[0], iv0, sizeof(iv0)) != 0)
+            {
+                fprintf(stderr, "FAIL: A partial block in one CBC stream was not rejected up front.\n");
+                failures++;
+            }
+            streams[STREAMS - 1].iv = NULL;
+            if (aes_cbc_encrypt_multi(streams, STREAMS) != AES_ERROR_INVALID_ARGUMENT ||
+                aes_cbc_encrypt_multi(NULL, 1) != AES_ERROR_INVALID_ARGUMENT ||
+                aes_cbc_encrypt_multi(NULL, 0) != AES_SUCCESS)
+            {
+                fprintf(stderr, "FAIL: An invalid CBC stream was accepted.\n");
+                failures++;
+            }
+
+            for (size_t i = 0; i < STREAMS; i++)
+                aes_ctx_clear(&ctxs[i]);
+        }
+    }
+
+    return failures;
+}
+
+/* ============================================================================
+ * XTS Mode
+ * ========================================================================= */
+
+//! An XTS known answer vector; all fields are hexadecimal strings.
+typedef struct
+{
+    const char* name;
+    const char* key;
+    const char* tweak;
+    const char* plaintext;
+    const char* ciphertext;
+} xts_vector_t;
+
+//! Vectors from IEEE 1619, including ciphertext stealing (vectors 15 and 17).
+//! Vector 1 is left out: its all-zero key has equal halves, which aes_xts_init() rejects.
+static const xts_vector_t xts_vectors[] = {
+    {"Vector 2", "1111111111111111111111111111111122222222222222222222222222222222", "33333333330000000000000000000000",
+     "4444444444444444444444444444444444444444444444444444444444444444",
+     "c454185e6a16936e39334038acef838bfb186fff7480adc4289382ecd6d394f0"},
+    {"Vector 15 (17 bytes)", "fffefdfcfbfaf9f8f7f6f5f4f3f2f1f0bfbebdbcbbbab9b8b7b6b5b4b3b2b1b0",
+     "9a785634120000000000000000000000", "000102030405060708090a0b0c0d0e0f10", "6c1625db4671522d3d7599601de7ca09ed"},
+    {"Vector 17 (31 bytes)", "fffefdfcfbfaf9f8f7f6f5f4f3f2f1f0bfbebdbcbbbab9b8b7b6b5b4b3b2b1b0",
+     "9a785634120000000000000000000000", "000102030405060708090a0b0c0d0e0f101112131415161718191a1b1c1d1e",
+     "d05bc090a8e04f1b3d3ecdd5baec0fd4edbf9dace45d6f6a7306e64be5dd82"},
+    {"Vector 10 (AES-256, first 32 bytes)",
+     "2718281828459045235360287471352662497757247093699959574966967627"
+     "3141592653589793238462643383279502884197169399375105820974944592",
+     "ff000000000000000000000000000000", "000102030405060708090a0b0c0d0e0f101112131415161718191a1b1c1d1e1f",
+     "1c3b3a102f770386e4836c99e370cf9bea00803f5e482357a4ae12d414a3e63b"},
+};
+
+/**
+ * @brief XTS known answer tests on every backend, with in-place decryption.
+ * @return The number of failed checks.
+ */
+static int run_xts_tests(void)
+{
+    int failures = 0;
+
+    for (size_t v = 0; v < sizeof(xts_vectors) / sizeof(xts_vectors[0]); v++)
+    {
+        const xts_vector_t* tv = &xts_vectors[v];
+        uint8_t             key[64], tweak[16], plaintext[32], expected[32], buffer[32];
+
+        size_t key_len = hex_to_bytes(tv->key, key, sizeof(key));
+        hex_to_bytes(tv->tweak, tweak, sizeof(tweak));
+        size_t length = hex_to_bytes(tv->plaintext, plaintext, sizeof(plaintext));
+        hex_to_bytes(tv->ciphertext, expected, sizeof(expected));
+
+        for (size_t b = 0; b < TEST_BACKEND_COUNT; b++)
+        {
+            aes_xts_ctx_t xts;
+            if (aes_xts_init(&xts, key, (aes_key_size_t)(key_len / 2), test_backends[b]) != AES_SUCCESS)
+                continue;
+            printf("\n--- Running Test Case: XTS %s (%s) ---\n", tv->name, aes_backend_name(test_backends[b]));
+
+            aes_xts_encrypt(&xts, tweak, plaintext, buffer, length);
+            failures += check_bytes("XTS ciphertext", buffer, expected, length);
+            aes_xts_decrypt(&xts, tweak, buffer, buffer, length);
+            failures += check_bytes("XTS decryption", buffer, plaintext, length);
+
+            aes_xts_clear(&xts);
+        }
+    }
+
+    // Equal data and tweak keys are refused; halves differing in a single bit are accepted.
+    for (size_t b = 0; b < TEST_BACKEND_COUNT; b++)
+    {
+        static const aes_key_size_t key_sizes[] = {AES_KEY_SIZE_128, AES_KEY_SIZE_256};
+        aes_xts_ctx_t               xts;
+        uint8_t                     key[64];
+
+        if (!aes_backend_is_supported(test_backends[b]))
+            continue;
+        printf("\n--- Running Test Case: XTS equal key halves (%s) ---\n", aes_backend_name(test_backends[b]));
+        for (size_t k = 0; k < sizeof(key_sizes) / sizeof(key_sizes[0]); k++)
+        {
+            size_t half = (size_t)key_sizes[k];
+            for (size_t i = 0; i < half; i++)
+                key[i] = (uint8_t)(i * 29 + 3);
+            memcpy(key + half, key, half);
+            if (aes_xts_init(&xts, key, key_sizes[k], test_backends[b]) != AES_ERROR_INVALID_ARGUMENT)
+            {
+                fprintf(stderr, "FAIL: XTS accepted equal %zu-byte key halves.\n", half);
+                failures++;
+            }
+
+            key[2 * half - 1] ^= 0x80;
+            if (aes_xts_init(&xts, key, key_sizes[k], test_backends[b]) != AES_SUCCESS)
+            {
+                fprintf(stderr, "FAIL: XTS rejected %zu-byte key halves differing in one bit.\n", half);
+                failures++;
+            }
+            else
+            {
+                aes_xts_clear(&xts);
+            }
+        }
+    }
+
+    return failures;
+}
+
+/**
+ * @brief Checks the batched sector API against one aes_xts_encrypt() call per
+ * sector with a little-endian sector number tweak, on every backend.
+ * @return The number of failed checks.
+ */
+static int run_xts_sector_tests(void)
+{
+    static const size_t sector_sizes[] = {512, 4096, 528, 1000};
+    static uint8_t      plaintext[9 * 4096], expected[sizeof(plaintext)], buffer[sizeof(plaintext)];
+    uint8_t             key[64], tweak[16];
+    uint32_t            seed     = 0x6d2b79f5u;
+    int                 failures = 0;
+
+    for (size_t i = 0; i < sizeof(plaintext); i++)
+    {
+        seed         = seed * 1664525u + 1013904223u;
+        plaintext[i] = (uint8_t)(seed >> 24);
+    }
+    memcpy(key, plaintext + 700, sizeof(key));
+
+    for (size_t b = 0; b < TEST_BACKEND_COUNT; b++)
+    {
+        aes_xts_ctx_t xts;
+        if (aes_xts_init(&xts, key, AES_KEY_SIZE_256, test_backends[b]) != AES_SUCCESS)
+            continue;
+        printf("\n--- Running Test Case: XTS sector batches (%s) ---\n", aes_backend_name(test_backends[b]));
+
+        for (size_t n = 0; n < sizeof(sector_sizes) / sizeof(sector_sizes[0]); n++)
+        {
+            size_t   sector_size = sector_sizes[n];
+            size_t   count       = sizeof(plaintext) / sector_size;
+            uint64_t first       = 0x0123456789abcdefULL + n;
+
+            for (size_t i = 0; i < count; i++)
+            {
+                uint64_t sector = first + i;
+                memset(tweak, 0, sizeof(tweak));
+                for (size_t j = 0; j < 8; j++)
+                    tweak[j] = (uint8_t)(sector >> (8 * j));
+                aes_xts_encrypt(&xts, tweak, plaintext + i * sector_size, expected + i * sector_size, sector_size);
+            }
+
+            memcpy(buffer, plaintext, count * sector_size);
+            aes_xts_encrypt_sectors(&xts, first, sector_size, buffer, buffer, count);
+            failures += check_bytes("XTS sector ciphertext", buffer, expected, count * sector_size);
+            aes_xts_decrypt_sectors(&xts, first, sector_size, buffer, buffer, count);
+            failures += check_bytes("XTS sector decryption", buffer, plaintext, count * sector_size);
+        }
+
+        if (aes_xts_encrypt_sectors(&xts, 0, 15, buffer, buffer, 1) != AES_ERROR_INVALID_LENGTH)
+        {
+            fprintf(stderr, "FAIL: An XTS sector shorter than a block was accepted.\n");
+            failures++;
+        }
+
+        aes_xts_clear(&xts);
+    }
+
+    return failures;
+}
+
+/* ============================================================================
+ * GCM Mode
+ * ========================================================================= */
+
+//! A GCM known answer vector; all fields are hexadecimal strings.
+typedef struct
+{
+    const char* name;
+    const char* key;
+    const char* iv;
+    const char* aad;
+    const char* plaintext;
+    const char* ciphertext;
+    const char* tag;
+} gcm_vector_t;
+
+//! Test cases from McGrew and Viega, "The Galois/Counter Mode of Operation (GCM)".
+static const gcm_vector_t gcm_vectors[] = {
+    {"Test Case 1", "00000000000000000000000000000000", "000000000000000000000000", "", "", "",
+     "58e2fccefa7e3061367f1d57a4e7455a"},
+    {"Test Case 2", "00000000000000000000000000000000", "000000000000000000000000", "",
+     "00000000000000000000000000000000", "0388dace60b6a392f328c2b971b2fe78", "ab6e47d42cec13bdf53a67b21257bddf"},
+    {"Test Case 4", "feffe9928665731c6d6a8f9467308308", "cafebabefacedbaddecaf888",
+     "feedfacedeadbeeffeedfacedeadbeefabaddad2",
+     "d9313225f88406e5a55909c5aff5269a86a7a9531534f7da2e4c303d8a318a721c3c0c95956809532fcf0e2449a6b525b16aedf5aa0de657"
+     "ba637b39",
+     "42831ec2217774244b7221b784d0d49ce3aa212f2c02a4e035c17e2329aca12e21d514b25466931c7d8f6a5aac84aa051ba30b396a0aac97"
+     "3d58e091",
+     "5bc94fbc3221a5db94fae95ae7121a47"},
+    {"Test Case 5 (64-bit IV)", "feffe9928665731c6d6a8f9467308308", "cafebabefacedbad",
+     "feedfacedeadbeeffeedfacedeadbeefabaddad2",
+     "d9313225f88406e5a55909c5aff5269a86a7a9531534f7da2e4c303d8a318a721c3c0c95956809532fcf0e2449a6b525b16aedf5aa0de657"
+     "ba637b39",
+     "61353b4c2806934a777ff51fa22a4755699b2a714fcdc6f83766e5f97b6c742373806900e49f24b22b097544d4896b424989b5e1ebac0f07"
+     "c23f4598",
+     "3612d2e79e3b0785561be14aaca2fccb"},
+    {"Test Case 6 (480-bit IV)", "feffe9928665731c6d6a8f9467308308",
+     "9313225df88406e555909c5aff5269aa6a7a9538534f7da1e4c303d2a318a728c3c0c95156809539fcf0e2429a6b525416aedbf5a0de6a57"
+     "a637b39b",
+     "feedfacedeadbeeffeedfacedeadbeefabaddad2",
+     "d9313225f88406e5a55909c5aff5269a86a7a9531534f7da2e4c303d8a318a721c3c0c95956809532fcf0e2449a6b525b16aedf5aa0de657"
+     "ba637b39",
+     "8ce24998625615b603a033aca13fb894be9112a5c3a211a8ba262a3cca7e2ca701e4a9a4fba43c90ccdcb281d48c7c6fd62875d2aca41703"
+     "4c34aee5",
+     "619cc5aefffe0bfa462af43c1699d050"},
+    {"Test Case 10 (AES-192)", "feffe9928665731c6d6a8f9467308308feffe9928665731c", "cafebabefacedbaddecaf888",
+     "feedfacedeadbeeffeedfacedeadbeefabaddad2",
+     "d9313225f88406e5a55909c5aff5269a86a7a9531534f7da2e4c303d8a318a721c3c0c95956809532fcf0e2449a6b525b16aedf5aa0de657"
+     "ba637b39",
+     "3980ca0b3c00e841eb06fac4872a2757859e1ceaa6efd984628593b40ca1e19c7d773d00c144c525ac619d18c84a3f4718e2448b2fe324d9"
+     "ccda2710",
+     "2519498e80f1478f37ba55bd6d27618c"},
+    {"Test Case 16 (AES-256)", "feffe9928665731c6d6a8f9467308308feffe9928665731c6d6a8f9467308308",
+     "cafebabefacedbaddecaf888", "feedfacedeadbeeffeedfacedeadbeefabaddad2",
+     "d9313225f88406e5a55909c5aff5269a86a7a9531534f7da2e4c303d8a318a721c3c0c95956809532fcf0e2449a6b525b16aedf5aa0de657"
+     "ba637b39",
+     "522dc1f099567d07f47f37a32a84427d643a8cdcbfe5c0c97598a2bd2555d1aa8cb08e48590dbb3da7b08b1056828838c5f61e6393ba7a0a"
+     "bcc9f662",
+     "76fc6ece0f4e1768cddf8853bb2d551b"},
+};
+
+/**
+ * @brief GCM known answer tests on every backend, with in-place open,
+ * truncated tags and tampering checks.
+ * @return The number of failed checks.
+ */
+static int run_gcm_tests(void)
+{
+    int failures = 0;
+
+    for (size_t v = 0; v < sizeof(gcm_vectors) / sizeof(gcm_vectors[0]); v++)
+    {
+        const gcm_vector_t* tv = &gcm_vectors[v];
+        uint8_t             key[32], iv[64], aad[32], plaintext[64], expected[64], expected_tag[16];
+        uint8_t             buffer[64], tag[16];
+
+        size_t key_len = hex_to_bytes(tv->key, key, sizeof(key));
+        size_t iv_len  = hex_to_bytes(tv->iv, iv, sizeof(iv));
+        size_t aad_len = hex_to_bytes(tv->aad, aad, sizeof(aad));
+        size_t length  = hex_to_bytes(tv->plaintext, plaintext, sizeof(plaintext));
+        hex_to_bytes(tv->ciphertext, expected, sizeof(expected));
+        hex_to_bytes(tv->tag, expected_tag, sizeof(expected_tag));
+
+        for (size_t b = 0; b < TEST_BACKEND_COUNT; b++)
+        {
+            aes_gcm_ctx_t gcm;
+            if (aes_gcm_init(&gcm, key, (aes_key_size_t)key_len, test_backends[b]) != AES_SUCCESS)
+                continue;
+            printf("\n--- Running Test Case: GCM %s (%s) ---\n", tv->name, aes_backend_name(test_backends[b]));
+
+            aes_gcm_seal(&gcm, iv, iv_len, aad, aad_len, plaintext, buffer, length, tag, sizeof(tag));
+            failures += check_bytes("GCM ciphertext", buffer, expected, length);
+            failures += check_bytes("GCM tag", tag, expected_tag, sizeof(tag));
+
+            // In-place open with the full tag and with a 12-byte truncation.
+            if (aes_gcm_open(&gcm, iv, iv_len, aad, aad_len, buffer, buffer, length, tag, sizeof(tag)) != AES_SUCCESS)
+            {
+                fprintf(stderr, "FAIL: A valid GCM message was rejected.\n");
+                failures++;
+            }
+            failures += check_bytes("GCM decryption", buffer, plaintext, length);
+
+            aes_gcm_seal(&gcm, iv, iv_len, aad, aad_len, plaintext, buffer, length, tag, 12);
+            failures += check_bytes("Truncated GCM tag", tag, expected_tag, 12);
+            if (aes_gcm_open(&gcm, iv, iv_len, aad, aad_len, buffer, buffer, length, tag, 12) != AES_SUCCESS)
+            {
+                fprintf(stderr, "FAIL: A valid GCM message with a truncated tag was rejected.\n");
+                failures++;
+            }
+
+            // A modified tag must be rejected and the output wiped.
+            memcpy(buffer, expected, length);
+            memcpy(tag, expected_tag, sizeof(tag));
+            tag[sizeof(tag) - 1] ^= 0x80;
+            if (aes_gcm_open(&gcm, iv, iv_len, aad, aad_len, buffer, buffer, length, tag, sizeof(tag)) !=
+                AES_ERROR_AUTHENTICATION_FAILED)
+            {
+                fprintf(stderr, "FAIL: A forged GCM tag was accepted.\n");
+                failures++;
+            }
+            for (size_t i = 0; i < length; i++)
+            {
+                if (buffer[i] != 0)
+                {
+                    fprintf(stderr, "FAIL: Unauthenticated GCM plaintext was released.\n");
+                    failures++;
+                    break;
+                }
+            }
+
+            aes_gcm_clear(&gcm);
+        }
+    }
+
+    return failures;
+}
+
+/**
+ * @brief Checks that every backend agrees with the reference on long messages
+ * of awkward lengths, which exercise the bulk and tail paths.
+ * @return The number of failed checks.
+ */
+static int run_gcm_consistency_tests(void)
+{
+    static const size_t lengths[] = {1, 15, 16, 127, 128, 129, 1000, 4096 + 7};
+    static uint8_t      plaintext[4096 + 7], expected[sizeof(plaintext)], buffer[sizeof(plaintext)];
+    uint8_t             key[32], iv[12], aad[45], expected_tag[16], tag[16];
+    uint32_t            seed = 0x2545f491u;
+    int                 failures = 0;
+
+    // Linear congruential generator, for reproducible pseudo-random inputs.
+    for (size_t i = 0; i < sizeof(plaintext); i++)
+    {
+        seed         = seed * 1664525u + 1013904223u;
+        plaintext[i] = (uint8_t)(seed >> 24);
+    }
+    memcpy(key, plaintext + 100, sizeof(key));
+    memcpy(iv, plaintext + 200, sizeof(iv));
+    memcpy(aad, plaintext + 300, sizeof(aad));
+
+    printf("\n--- Running Test Case: GCM backend consistency ---\n");
+    for (size_t n = 0; n < sizeof(lengths) / sizeof(lengths[0]); n++)
+    {
+        size_t        length = lengths[n];
+        aes_gcm_ctx_t gcm;
+
+        aes_gcm_init(&gcm, key, AES_KEY_SIZE_256, AES_BACKEND_REFERENCE);
+        aes_gcm_seal(&gcm, iv, sizeof(iv), aad, sizeof(aad), plaintext, expected, length, expected_tag, sizeof(tag));
+
+        for (size_t b = 0; b < TEST_BACKEND_COUNT; b++)
+        {
+            if (aes_gcm_init(&gcm, key, AES_KEY_SIZE_256, test_backends[b]) != AES_SUCCESS)
+                continue;
+
+            memcpy(buffer, plaintext, length);
+            aes_gcm_seal(&gcm, iv, sizeof(iv), aad, sizeof(aad), buffer, buffer, length, tag, sizeof(tag));
+            failures += check_bytes("GCM bulk ciphertext", buffer, expected, length);
+            failures += check_bytes("GCM bulk tag", tag, expected_tag, sizeof(tag));
+
+            if (aes_gcm_open(&gcm, iv, sizeof(iv), aad, sizeof(aad), buffer, buffer, length, tag, sizeof(tag)) !=
+                AES_SUCCESS)
+            {
+                fprintf(stderr, "FAIL: A %zu-byte GCM message was rejected by %s.\n", length,
+                        aes_backend_name(test_backends[b]));
+                failures++;
+            }
+            failures += check_bytes("GCM bulk decryption", buffer, plaintext, length);
+            aes_gcm_clear(&gcm);
+        }
+    }
+
+    aes_gcm_ctx_t gcm;
+    aes_gcm_init(&gcm, key, AES_KEY_SIZE_128, AES_BACKEND_AUTO);
+    if (aes_gcm_seal(&gcm, iv, sizeof(iv), NULL, 0, plaintext, buffer, 16, tag, 10) != AES_ERROR_INVALID_LENGTH ||
+        aes_gcm_seal(&gcm, iv, 0, NULL, 0, plaintext, buffer, 16, tag, 16) != AES_ERROR_INVALID_LENGTH)
+    {
+        fprintf(stderr, "FAIL: An invalid GCM tag or IV length was accepted.\n");
+        failures++;
+    }
+    aes_gcm_clear(&gcm);
+
+    return failures;
+}
+
+/* ============================================================================
+ * OCB Mode
+ * ========================================================================= */
+
+//! An OCB known answer vector; all fields are hexadecimal strings.
+typedef struct
+{
+    const char* name;
+    const char* key;
+    const char* nonce;
+    const char* aad;
+    const char* plaintext;
+    const char* ciphertext;
+    const char* tag;
+} ocb_vector_t;
+
+#define OCB_SAMPLE_KEY "000102030405060708090a0b0c0d0e0f"
+
+//! Sample results from RFC 7253, Appendix A.
+static const ocb_vector_t ocb_vectors[] = {
+    {"Sample 1", OCB_SAMPLE_KEY, "bbaa99887766554433221100", "", "", "", "785407bfffc8ad9edcc5520ac9111ee6"},
+    {"Sample 2", OCB_SAMPLE_KEY, "bbaa99887766554433221101", "0001020304050607", "0001020304050607",
+     "6820b3657b6f615a", "5725bda0d3b4eb3a257c9af1f8f03009"},
+    {"Sample 3", OCB_SAMPLE_KEY, "bbaa99887766554433221102", "0001020304050607", "", "",
+     "81017f8203f081277152fade694a0a00"},
+    {"Sample 4", OCB_SAMPLE_KEY, "bbaa99887766554433221103", "", "0001020304050607", "45dd69f8f5aae724",
+     "14054cd1f35d82760b2cd00d2f99bfa9"},
+    {"Sample 5", OCB_SAMPLE_KEY, "bbaa99887766554433221104", "000102030405060708090a0b0c0d0e0f",
+     "000102030405060708090a0b0c0d0e0f", "571d535b60b277188be5147170a9a22c", "3ad7a4ff3835b8c5701c1ccec8fc3358"},
+    {"Sample 6", OCB_SAMPLE_KEY, "bbaa99887766554433221105", "000102030405060708090a0b0c0d0e0f", "", "",
+     "8cf761b6902ef764462ad86498ca6b97"},
+    {"Sample 7", OCB_SAMPLE_KEY, "bbaa99887766554433221106", "", "000102030405060708090a0b0c0d0e0f",
+     "5ce88ec2e0692706a915c00aeb8b2396", "f40e1c743f52436bdf06d8fa1eca343d"},
+    {"Sample 8", OCB_SAMPLE_KEY, "bbaa99887766554433221107", "000102030405060708090a0b0c0d0e0f1011121314151617",
+     "000102030405060708090a0b0c0d0e0f1011121314151617", "1ca2207308c87c010756104d8840ce1952f09673a448a122",
+     "c92c62241051f57356d7f3c90bb0e07f"},
+    {"Sample 9", OCB_SAMPLE_KEY, "bbaa99887766554433221108", "000102030405060708090a0b0c0d0e0f1011121314151617", "",
+     "", "6dc225a071fc1b9f7c69f93b0f1e10de"},
+    {"Sample 10", OCB_SAMPLE_KEY, "bbaa99887766554433221109", "", "000102030405060708090a0b0c0d0e0f1011121314151617",
+     "221bd0de7fa6fe993eccd769460a0af2d6cded0c395b1c3c", "e725f32494b9f914d85c0b1eb38357ff"},
+    {"Sample 11", OCB_SAMPLE_KEY, "bbaa9988776655443322110a",
+     "000102030405060708090a0b0c0d0e0f101112131415161718191a1b1c1d1e1f",
+     "000102030405060708090a0b0c0d0e0f101112131415161718191a1b1c1d1e1f",
+     "bd6f6c496201c69296c11efd138a467abd3c707924b964deaffc40319af5a485", "40fbba186c5553c68ad9f592a79a4240"},
+    {"Sample 12", OCB_SAMPLE_KEY, "bbaa9988776655443322110b",
+     "000102030405060708090a0b0c0d0e0f101112131415161718191a1b1c1d1e1f", "", "", "fe80690bee8a485d11f32965bc9d2a32"},
+    {"Sample 13", OCB_SAMPLE_KEY, "bbaa9988776655443322110c", "",
+     "000102030405060708090a0b0c0d0e0f101112131415161718191a1b1c1d1e1f",
+     "2942bfc773bda23cabc6acfd9bfd5835bd300f0973792ef46040c53f1432bcdf", "b5e1dde3bc18a5f840b52e653444d5df"},
+    {"96-bit tag", "0f0e0d0c0b0a09080706050403020100", "bbaa9988776655443322110d",
+     "000102030405060708090a0b0c0d0e0f101112131415161718191a1b1c1d1e1f2021222324252627",
+     "000102030405060708090a0b0c0d0e0f101112131415161718191a1b1c1d1e1f2021222324252627",
+     "1792a4e31e0755fb03e31b22116e6c2ddf9efd6e33d536f1a0124b0a55bae884ed93481529c76b6a", "d0c515f4d1cdd4fdac4f02aa"},
+};
+
+/**
+ * @brief OCB known answer tests on every backend, with in-place open and
+ * tampering checks.
+ * @return The number of failed checks.
+ */
+static int run_ocb_tests(void)
+{
+    int failures = 0;
+
+    for (size_t v = 0; v < sizeof(ocb_vectors) / sizeof(ocb_vectors[0]); v++)
+    {
+        const ocb_vector_t* tv = &ocb_vectors[v];
+        uint8_t             key[32], nonce[15], aad[64], plaintext[64], expected[64], expected_tag[16];
+        uint8_t             buffer[64], tag[16];
+
+        size_t key_len   = hex_to_bytes(tv->key, key, sizeof(key));
+        size_t nonce_len = hex_to_bytes(tv->nonce, nonce, sizeof(nonce));
+        size_t aad_len   = hex_to_bytes(tv->aad, aad, sizeof(aad));
+        size_t length    = hex_to_bytes(tv->plaintext, plaintext, sizeof(plaintext));
+        size_t tag_len   = hex_to_bytes(tv->tag, expected_tag, sizeof(expected_tag));
+        hex_to_bytes(tv->ciphertext, expected, sizeof(expected));
+
+        for (size_t b = 0; b < TEST_BACKEND_COUNT; b++)
+        {
+            aes_ocb_ctx_t ocb;
+            if (aes_ocb_init(&ocb, key, (aes_key_size_t)key_len, test_backends[b]) != AES_SUCCESS)
+                continue;
+            printf("\n--- Running Test Case: OCB %s (%s) ---\n", tv->name, aes_backend_name(test_backends[b]));
+
+            aes_ocb_seal(&ocb, nonce, nonce_len, aad, aad_len, plaintext, buffer, length, tag, tag_len);
+            failures += check_bytes("OCB ciphertext", buffer, expected, length);
+            failures += check_bytes("OCB tag", tag, expected_tag, tag_len);
+
+            if (aes_ocb_open(&ocb, nonce, nonce_len, aad, aad_len, buffer, buffer, length, tag, tag_len) !=
+                AES_SUCCESS)
+            {
+                fprintf(stderr, "FAIL: A valid OCB message was rejected.\n");
+                failures++;
+            }
+            failures += check_bytes("OCB decryption", buffer, plaintext, length);
+
+            // The tag length is authenticated, so a tag cut short after sealing must not verify.
+            memcpy(buffer, expected, length);
+            if (tag_len > 8 &&
+                aes_ocb_open(&ocb, nonce, nonce_len, aad, aad_len, buffer, buffer, length, expected_tag, 8) !=
+                    AES_ERROR_AUTHENTICATION_FAILED)
+            {
+                fprintf(stderr, "FAIL: A truncated OCB tag was accepted.\n");
+                failures++;
+            }
+
+            // A modified tag must be rejected and the output wiped.
+            memcpy(buffer, expected, length);
+            memcpy(tag, expected_tag, tag_len);
+            tag[tag_len - 1] ^= 0x80;
+            if (aes_ocb_open(&ocb, nonce, nonce_len, aad, aad_len, buffer, buffer, length, tag, tag_len) !=
+                AES_ERROR_AUTHENTICATION_FAILED)
+            {
+                fprintf(stderr, "FAIL: A forged OCB tag was accepted.\n");
+                failures++;
+            }
+            for (size_t i = 0; i < length; i++)
+            {
+                if (buffer[i] != 0)
+                {
+                    fprintf(stderr, "FAIL: Unauthenticated OCB plaintext was released.\n");
+                    failures++;
+                    break;
+                }
+            }
+
+            aes_ocb_clear(&ocb);
+        }
+    }
+
+    return failures;
+}
+
+/** @brief Writes num2str(value, 96), the big-endian 12-byte nonce of the RFC 7253 iterated test. */
+static void store_nonce(uint8_t* nonce, uint32_t value)
+{
+    memset(nonce, 0, 8);
+    for (size_t i = 0; i < 4; i++)
+        nonce[8 + i] = (uint8_t)(value >> (24 - 8 * i));
+}
+
+/**
+ * @brief The iterated test of RFC 7253, Appendix A, for every key size and
+ * for 128, 96 and 64-bit tags: 384 messages of 0 to 127 bytes are sealed and
+ * the concatenated output is authenticated once more.
+ * @return The number of failed checks.
+ */
+static int run_ocb_iterated_tests(void)
+{
+    static const struct
+    {
+        aes_key_size_t key_size;
+        size_t         tag_len;
+        const char*    expected;
+    } cases[] = {
+        {AES_KEY_SIZE_128, 16, "67e944d23256c5e0b6c61fa22fdf1ea2"},
+        {AES_KEY_SIZE_192, 16, "f673f2c3e7174aae7bae986ca9f29e17"},
+        {AES_KEY_SIZE_256, 16, "d90eb8e9c977c88b79dd793d7ffa161c"},
+        {AES_KEY_SIZE_128, 12, "77a3d8e73589158d25d01209"},
+        {AES_KEY_SIZE_192, 12, "05d56ead2752c86be6932c5e"},
+        {AES_KEY_SIZE_256, 12, "5458359ac23b0cba9e6330dd"},
+        {AES_KEY_SIZE_128, 8, "192c9b7bd90ba06a"},
+        {AES_KEY_SIZE_192, 8, "0066bc6e0ef34e24"},
+        {AES_KEY_SIZE_256, 8, "7d4ea5d445501cbe"},
+    };
+    static uint8_t output[2 * 128 * 127 / 2 + 3 * 128 * 16];
+    uint8_t        zeros[128] = {0};
+    int            failures   = 0;
+
+    for (size_t c = 0; c < sizeof(cases) / sizeof(cases[0]); c++)
+    {
+        uint8_t key[32] = {0}, nonce[12] = {0}, expected[16], tag[16];
+        size_t  tag_len = cases[c].tag_len;
+
+        key[cases[c].key_size - 1] = (uint8_t)(tag_len * 8);
+        hex_to_bytes(cases[c].expected, expected, sizeof(expected));
+
+        for (size_t b = 0; b < TEST_BACKEND_COUNT; b++)
+        {
+            aes_ocb_ctx_t ocb;
+            size_t        used = 0;
+            if (aes_ocb_init(&ocb, key, cases[c].key_size, test_backends[b]) != AES_SUCCESS)
+                continue;
+            printf("\n--- Running Test Case: OCB iterated, %d-bit key, %zu-byte tag (%s) ---\n",
+                   (int)cases[c].key_size * 8, tag_len, aes_backend_name(test_backends[b]));
+
+            for (uint32_t i = 0; i < 128; i++)
+            {
+                store_nonce(nonce, 3 * i + 1);
+                aes_ocb_seal(&ocb, nonce, sizeof(nonce), zeros, i, zeros, output + used, i, output + used + i, tag_len);
+                used += i + tag_len;
+                store_nonce(nonce, 3 * i + 2);
+                aes_ocb_seal(&ocb, nonce, sizeof(nonce), NULL, 0, zeros, output + used, i, output + used + i, tag_len);
+                used += i + tag_len;
+                store_nonce(nonce, 3 * i + 3);
+                aes_ocb_seal(&ocb, nonce, sizeof(nonce), zeros, i, NULL, NULL, 0, output + used, tag_len);
+                used += tag_len;
+            }
+            store_nonce(nonce, 385);
+            aes_ocb_seal(&ocb, nonce, sizeof(nonce), output, used, NULL, NULL, 0, tag, tag_len);
+            failures += check_bytes("OCB iterated tag", tag, expected, tag_len);
+
+            aes_ocb_clear(&ocb);
+        }
+    }
+
+    return failures;
+}
+
+/**
+ * @brief Checks that every backend agrees with the reference on long messages
+ * of awkward lengths, which exercise whole and partial batches.
+ * @return The number of failed checks.
+ */
+static int run_ocb_consistency_tests(void)
+{
+    static const size_t lengths[] = {1, 15, 16, 127, 128, 129, 1000, 4096 + 7};
+    static uint8_t      plaintext[4096 + 7], expected[sizeof(plaintext)], buffer[sizeof(plaintext)];
+    uint8_t             key[32], nonce[12], aad[300], expected_tag[16], tag[16];
+    uint32_t            seed = 0x6b8b4567u;
+    int                 failures = 0;
+
+    // Linear congruential generator, for reproducible pseudo-random inputs.
+    for (size_t i = 0; i < sizeof(plaintext); i++)
+    {
+        seed         = seed * 1664525u + 1013904223u;
+        plaintext[i] = (uint8_t)(seed >> 24);
+    }
+    memcpy(key, plaintext + 100, sizeof(key));
+    memcpy(nonce, plaintext + 200, sizeof(nonce));
+    memcpy(aad, plaintext + 300, sizeof(aad));
+
+    printf("\n--- Running Test Case: OCB backend consistency ---\n");
+    for (size_t n = 0; n < sizeof(lengths) / sizeof(lengths[0]); n++)
+    {
+        size_t        length = lengths[n];
+        aes_ocb_ctx_t ocb;
+
+        aes_ocb_init(&ocb, key, AES_KEY_SIZE_256, AES_BACKEND_REFERENCE);
+        aes_ocb_seal(&ocb, nonce, sizeof(nonce), aad, sizeof(aad), plaintext, expected, length, expected_tag,
+                     sizeof(tag));
+
+        for (size_t b = 0; b < TEST_BACKEND_COUNT; b++)
+        {
+            if (aes_ocb_init(&ocb, key, AES_KEY_SIZE_256, test_backends[b]) != AES_SUCCESS)
+                continue;
+
+            memcpy(buffer, plaintext, length);
+            aes_ocb_seal(&ocb, nonce, sizeof(nonce), aad, sizeof(aad), buffer, buffer, length, tag, sizeof(tag));
+            failures += check_bytes("OCB bulk ciphertext", buffer, expected, length);
+            failures += check_bytes("OCB bulk tag", tag, expected_tag, sizeof(tag));
+
+            if (aes_ocb_open(&ocb, nonce, sizeof(nonce), aad, sizeof(aad), buffer, buffer, length, tag, sizeof(tag)) !=
+                AES_SUCCESS)
+            {
+                fprintf(stderr, "FAIL: A %zu-byte OCB message was rejected by %s.\n", length,
+                        aes_backend_name(test_backends[b]));
+                failures++;
+            }
+            failures += check_bytes("OCB bulk decryption", buffer, plaintext, length);
+            aes_ocb_clear(&ocb);
+        }
+    }
+
+    aes_ocb_ctx_t ocb;
+    aes_ocb_init(&ocb, key, AES_KEY_SIZE_128, AES_BACKEND_AUTO);
+    if (aes_ocb_seal(&ocb, nonce, sizeof(nonce), NULL, 0, plaintext, buffer, 16, tag, 0) != AES_ERROR_INVALID_LENGTH ||
+        aes_ocb_seal(&ocb, nonce, 0, NULL, 0, plaintext, buffer, 16, tag, 16) != AES_ERROR_INVALID_LENGTH ||
+        aes_ocb_seal(&ocb, key, 16, NULL, 0, plaintext, buffer, 16, tag, 16) != AES_ERROR_INVALID_LENGTH)
+    {
+        fprintf(stderr, "FAIL: An invalid OCB tag or nonce length was accepted.\n");
+        failures++;
+    }
+    aes_ocb_clear(&ocb);
+
+    return failures;
+}
+
+/* ============================================================================
+ * Message Authentication
+ * ========================================================================= */
+
+//! A MAC known answer vector; all fields are hexadecimal strings.
+typedef struct
+{
+    const char* name;
+    const char* key;
+    const char* message;
+    const char* tag;
+} mac_vector_t;
+
+// The four messages of the CMAC examples: 0, 16, 40 and 64 bytes of the SP 800-38A plaintext.
+#define CMAC_M16 "6bc1bee22e409f96e93d7e117393172a"
+#define CMAC_M40 CMAC_M16 "ae2d8a571e03ac9c9eb76fac45af8e5130c81c46a35ce411"
+#define CMAC_M64 CMAC_M16 "ae2d8a571e03ac9c9eb76fac45af8e5130c81c46a35ce411e5fbc1191a0a52eff69f2445df4f9b17ad2b417be66c3710"
+
+//! CMAC examples from RFC 4493 section 4 (AES-128) and NIST SP 800-38B appendix D (AES-192 and AES-256).
+static const mac_vector_t cmac_vectors[] = {
+    {"AES-128 Example 1", "2b7e151628aed2a6abf7158809cf4f3c", "", "bb1d6929e95937287fa37d129b756746"},
+    {"AES-128 Example 2", "2b7e151628aed2a6abf7158809cf4f3c", CMAC_M16, "070a16b46b4d4144f79bdd9dd04a287c"},
+    {"AES-128 Example 3", "2b7e151628aed2a6abf7158809cf4f3c", CMAC_M40, "dfa66747de9ae63030ca32611497c827"},
+    {"AES-128 Example 4", "2b7e151628aed2a6abf7158809cf4f3c", CMAC_M64, "51f0bebf7e3b9d92fc49741779363cfe"},
+    {"AES-192 Example 7", "8e73b0f7da0e6452c810f32b809079e562f8ead2522c6b7b", CMAC_M40,
+     "8a1de5be2eb31aad089a82e6ee908b0e"},
+    {"AES-256 Example 9", "603deb1015ca71be2b73aef0857d77811f352c073b6108d72d9810a30914dff4", "",
+     "028962f61b7bf89efc6b551f4667d983"},
+    {"AES-256 Example 12", "603deb1015ca71be2b73aef0857d77811f352c073b6108d72d9810a30914dff4", CMAC_M64,
+     "e1992190549f6ed5696a2c056c315410"},
+};
+
+//! PMAC-AES-128 vectors from the PMAC reference implementation.
+static const mac_vector_t pmac_vectors[] = {
+    {"empty", "000102030405060708090a0b0c0d0e0f", "", "4399572cd6ea5341b8d35876a7098af7"},
+    {"3 bytes", "000102030405060708090a0b0c0d0e0f", "000102", "256ba5193c1b991b4df0c51f388a9e27"},
+    {"16 bytes", "000102030405060708090a0b0c0d0e0f", "000102030405060708090a0b0c0d0e0f",
+     "ebbd822fa458daf6dfdad7c27da76338"},
+    {"20 bytes", "000102030405060708090a0b0c0d0e0f", "000102030405060708090a0b0c0d0e0f10111213",
+     "0412ca150bbf79058d8c75a58c993f55"},
+    {"32 bytes", "000102030405060708090a0b0c0d0e0f",
+     "000102030405060708090a0b0c0d0e0f101112131415161718191a1b1c1d1e1f", "e97ac04e9e5e3399ce5355cd7407bc75"},
+    {"34 bytes", "000102030405060708090a0b0c0d0e0f",
+     "000102030405060708090a0b0c0d0e0f101112131415161718191a1b1c1d1e1f2021", "5cba7d5eb24f7c86ccc54604e53d5512"},
+};
+
+//! The operations of one MAC, so CMAC and PMAC share their tests.
+typedef struct
+{
+    const char* name;
+    aes_error_t (*init)(void* ctx, const uint8_t* key, aes_key_size_t key_size, aes_backend_t backend);
+    aes_error_t (*update)(void* ctx, const uint8_t* data, size_t length);
+    aes_error_t (*final)(void* ctx, uint8_t* tag, size_t tag_len);
+    aes_error_t (*verify)(void* ctx, const uint8_t* tag, size_t tag_len);
+    void (*clear)(void* ctx);
+} mac_ops_t;
+
+static aes_error_t cmac_init(void* ctx, const uint8_t* key, aes_key_size_t key_size, aes_backend_t backend)
+{
+    return aes_cmac_init(ctx, key, key_size, backend);
+}
+static aes_error_t cmac_update(void* ctx, const uint8_t* data, size_t length)
+{
+    return aes_cmac_update(ctx, data, length);
+}
+static aes_error_t cmac_final(void* ctx, uint8_t* tag, size_t tag_len)
+{
+    return aes_cmac_final(ctx, tag, tag_len);
+}
+static aes_error_t cmac_verify(void* ctx, const uint8_t* tag, size_t tag_len)
+{
+    return aes_cmac_verify(ctx, tag, tag_len);
+}
+static void cmac_clear(void* ctx)
+{
+    aes_cmac_clear(ctx);
+}
+static aes_error_t pmac_init(void* ctx, const uint8_t* key, aes_key_size_t key_size, aes_backend_t backend)
+{
+    return aes_pmac_init(ctx, key, key_size, backend);
+}
+static aes_error_t pmac_update(void* ctx, const uint8_t* data, size_t length)
+{
+    return aes_pmac_update(ctx, data, length);
+}
+static aes_error_t pmac_final(void* ctx, uint8_t* tag, size_t tag_len)
+{
+    return aes_pmac_final(ctx, tag, tag_len);
+}
+static aes_error_t pmac_verify(void* ctx, const uint8_t* tag, size_t tag_len)
+{
+    return aes_pmac_verify(ctx, tag, tag_len);
+}
+static void pmac_clear(void* ctx)
+{
+    aes_pmac_clear(ctx);
+}
+
+static const mac_ops_t cmac_ops = {"CMAC", cmac_init, cmac_update, cmac_final, cmac_verify, cmac_clear};
+static const mac_ops_t pmac_ops = {"PMAC", pmac_init, pmac_update, pmac_final, pmac_verify, pmac_clear};
+
+//! Storage for the context of either MAC.
+static union
+{
+    aes_cmac_ctx_t cmac;
+    aes_pmac_ctx_t pmac;
+} mac_ctx;
+
+/**
+ * @brief MAC known answer tests on every backend: whole and byte-by-byte
+ * updates, context reuse, truncated tags and forged tags.
+ * @param[in] mac The MAC under test.
+ * @param[in] vectors Its known answer vectors.
+ * @param[in] count The number of vectors.
+ * @return The number of failed checks.
+ */
+static int run_mac_tests(const mac_ops_t* mac, const mac_vector_t* vectors, size_t count)
+{
+    void* ctx      = &mac_ctx;
+    int   failures = 0;
+
+    for (size_t v = 0; v < count; v++)
+    {
+        const mac_vector_t* tv = &vectors[v];
+        uint8_t             key[32], message[64], expected[16], tag[16];
+
+        size_t key_len = hex_to_bytes(tv->key, key, sizeof(key));
+        size_t length  = hex_to_bytes(tv->message, message, sizeof(message));
+        hex_to_bytes(tv->tag, expected, sizeof(expected));
+
+        for (size_t b = 0; b < TEST_BACKEND_COUNT; b++)
+        {
+            if (mac->init(ctx, key, (aes_key_size_t)key_len, test_backends[b]) != AES_SUCCESS)
+                continue;
+            printf("\n--- Running Test Case: %s %s (%s) ---\n", mac->name, tv->name,
+                   aes_backend_name(test_backends[b]));
+
+            mac->update(ctx, message, length);
+            mac->final(ctx, tag, sizeof(tag));
+            failures += check_bytes("MAC tag", tag, expected, sizeof(tag));
+
+            // The context starts a new message after final; feed this one a byte at a time.
+            for (size_t i = 0; i < length; i++)
+                mac->update(ctx, message + i, 1);
+            mac->update(ctx, NULL, 0);
+            mac->final(ctx, tag, 8);
+            failures += check_bytes("Truncated MAC tag from byte-wise updates", tag, expected, 8);
+
+            mac->update(ctx, message, length);
+            if (mac->verify(ctx, expected, sizeof(expected)) != AES_SUCCESS)
+            {
+                fprintf(stderr, "FAIL: A valid %s tag was rejected.\n", mac->name);
+                failures++;
+            }
+            expected[0] ^= 1;
+            mac->update(ctx, message, length);
+            if (mac->verify(ctx, expected, sizeof(expected)) != AES_ERROR_AUTHENTICATION_FAILED)
+            {
+                fprintf(stderr, "FAIL: A forged %s tag was accepted.\n", mac->name);
+                failures++;
+            }
+            expected[0] ^= 1;
+
+            if (mac->final(ctx, tag, 0) != AES_ERROR_INVALID_LENGTH ||
+                mac->final(ctx, tag, AES_BLOCK_SIZE + 1) != AES_ERROR_INVALID_LENGTH)
+            {
+                fprintf(stderr, "FAIL: An invalid %s tag length was accepted.\n", mac->name);
+                failures++;
+            }
+            mac->clear(ctx);
+        }
+    }
+
+    return failures;
+}
+
+/**
+ * @brief Checks that every backend agrees with the reference on long
+ * messages fed in uneven pieces, which exercise the bulk and tail paths.
+ * @param[in] mac The MAC under test.
+ * @return The number of failed checks.
+ */
+static int run_mac_consistency_tests(const mac_ops_t* mac)
+{
+    static const size_t lengths[] = {15, 16, 17, 1000, 4096, 4096 + 7};
+    static const size_t pieces[]  = {1, 13, 16, 100, 700};
+    static uint8_t      message[4096 + 7];
+    void*               ctx = &mac_ctx;
+    uint8_t             key[32], expected[16], tag[16];
+    int                 failures = 0;
+
+    for (size_t i = 0; i < sizeof(message); i++)
+        message[i] = (uint8_t)(i * 13 + 7);
+    for (size_t i = 0; i < sizeof(key); i++)
+        key[i] = (uint8_t)(i * 3 + 1);
+
+    printf("\n--- Running Test Case: %s backend and split-update consistency ---\n", mac->name);
+    for (size_t n = 0; n < sizeof(lengths) / sizeof(lengths[0]); n++)
+    {
+        mac->init(ctx, key, AES_KEY_SIZE_256, AES_BACKEND_REFERENCE);
+        mac->update(ctx, message, lengths[n]);
+        mac->final(ctx, expected, sizeof(expected));
+
+        for (size_t b = 0; b < TEST_BACKEND_COUNT; b++)
+        {
+            if (mac->init(ctx, key, AES_KEY_SIZE_256, test_backends[b]) != AES_SUCCESS)
+                continue;
+            for (size_t p = 0; p < sizeof(pieces) / sizeof(pieces[0]); p++)
+            {
+                for (size_t offset = 0; offset < lengths[n]; offset += pieces[p])
+                    mac->update(ctx, message + offset,
+                                lengths[n] - offset < pieces[p] ? lengths[n] - offset : pieces[p]);
+                mac->final(ctx, tag, sizeof(tag));
+                failures += check_bytes("MAC tag from split updates", tag, expected, sizeof(tag));
+            }
+            mac->clear(ctx);
+        }
+    }
+
+    return failures;
+}
+
+/* ============================================================================
+ * Scatter-Gather
+ * ========================================================================= */
+
+//! Segment size patterns, repeated to cover a buffer: empty, sub-block, straddling and aligned segments.
+static const size_t iov_pattern_a[] = {7, 0, 1, 16, 33};
+static const size_t iov_pattern_b[] = {16};
+static const size_t iov_pattern_c[] = {100, 3, 0, 48};
+static const size_t iov_pattern_d[] = {SIZE_MAX};
+
+static const struct
+{
+    const size_t* sizes;
+    size_t        count;
+} iov_patterns[] = {{iov_pattern_a, 5}, {iov_pattern_b, 1}, {iov_pattern_c, 4}, {iov_pattern_d, 1}};
+
+#define IOV_PATTERN_COUNT (sizeof(iov_patterns) / sizeof(iov_patterns[0]))
+#define IOV_MAX_SEGMENTS  256
+
+/**
+ * @brief Describes a buffer as segments sized by repeating a pattern.
+ * @return The number of segments written to iov.
+ */
+static size_t split_iov(uint8_t* base, size_t length, size_t pattern, aes_iovec_t* iov)
+{
+    size_t count = 0;
+
+    for (size_t offset = 0, i = 0; offset < length; i++)
+    {
+        size_t n = iov_patterns[pattern].sizes[i % iov_patterns[pattern].count];
+        if (n > length - offset)
+            n = length - offset;
+        iov[count].iov_base = base + offset;
+        iov[count].iov_len  = n;
+        count++;
+        offset += n;
+    }
+    return count;
+}
+
+/**
+ * @brief Checks every *_iov function against its contiguous counterpart.
+ *
+ * @details Each length is split under every pair of segmentations, both out
+ * of place and in place, and the results must match byte for byte.
+ */
+static int run_iov_tests(void)
+{
+    static const size_t lengths[] = {0, 15, 16, 64, 1000, 1024};
+    static uint8_t      plaintext[1024], expected[1024], buffer[1024];
+    aes_iovec_t         in_iov[IOV_MAX_SEGMENTS], out_iov[IOV_MAX_SEGMENTS];
+    uint8_t             key[32], iv[16], chain[16], tag[16], expected_tag[16];
+    int                 failures = 0;
+
+    for (size_t i = 0; i < sizeof(plaintext); i++)
+        plaintext[i] = (uint8_t)(i * 29 + 3);
+    for (size_t i = 0; i < sizeof(key); i++)
+        key[i] = (uint8_t)(i * 7 + 11);
+    for (size_t i = 0; i < sizeof(iv); i++)
+        iv[i] = (uint8_t)(0xf0 + i);
+
+    printf("\n--- Running Test Case: Scatter-gather modes against contiguous ---\n");
+    for (size_t b = 0; b < TEST_BACKEND_COUNT; b++)
+    {
+        aes_ctx_t     ctx;
+        aes_gcm_ctx_t gcm;
+
+        if (aes_ctx_init_backend(&ctx, key, AES_KEY_SIZE_256, test_backends[b]) != AES_SUCCESS)
+            continue;
+        aes_gcm_init(&gcm, key, AES_KEY_SIZE_128, test_backends[b]);
+
+        for (size_t n = 0; n < sizeof(lengths) / sizeof(lengths[0]); n++)
+        {
+            size_t length = lengths[n];
+            int    blocks = length % AES_BLOCK_SIZE == 0;
+
+            for (size_t p = 0; p < IOV_PATTERN_COUNT; p++)
+            {
+                for (size_t q = 0; q < IOV_PATTERN_COUNT; q++)
+                {
+                    size_t in_count  = split_iov(plaintext, length, p, in_iov);
+                    size_t out_count = split_iov(buffer, length, q, out_iov);
+
+                    if (blocks)
+                    {
+                        aes_ecb_encrypt(&ctx, plaintext, expected, length);
+                        aes_ecb_encrypt_iov(&ctx, in_iov, in_count, out_iov, out_count);
+                        failures += check_bytes("ECB scatter-gather encryption", buffer, expected, length);
+                        in_count = split_iov(buffer, length, p, in_iov);
+                        aes_ecb_decrypt_iov(&ctx, in_iov, in_count, out_iov, out_count);
+                        failures += check_bytes("ECB in-place scatter-gather decryption", buffer, plaintext, length);
+
+                        memcpy(chain, iv, sizeof(chain));
+                        aes_cbc_encrypt(&ctx, chain, plaintext, expected, length);
+                        memcpy(chain, iv, sizeof(chain));
+                        memcpy(buffer, plaintext, length);
+                        aes_cbc_encrypt_iov(&ctx, chain, in_iov, in_count, out_iov, out_count);
+                        failures += check_bytes("CBC in-place scatter-gather encryption", buffer, expected, length);
+                        memcpy(chain, iv, sizeof(chain));
+                        aes_cbc_decrypt_iov(&ctx, chain, in_iov, in_count, out_iov, out_count);
+                        failures += check_bytes("CBC in-place scatter-gather decryption", buffer, plaintext, length);
+                        in_count = split_iov(plaintext, length, p, in_iov);
+                    }
+
+                    memcpy(chain, iv, sizeof(chain));
+                    aes_ctr_xcrypt_ex(&ctx, chain, AES_CTR_WIDTH_32, plaintext, expected, length);
+                    memcpy(chain, iv, sizeof(chain));
+                    aes_ctr_xcrypt_iov(&ctx, chain, AES_CTR_WIDTH_32, in_iov, in_count, out_iov, out_count);
+                    failures += check_bytes("CTR scatter-gather keystream", buffer, expected, length);
+
+                    aes_gcm_seal(&gcm, iv, 12, key, 20, plaintext, expected, length, expected_tag, 16);
+                    aes_gcm_seal_iov(&gcm, iv, 12, key, 20, in_iov, in_count, out_iov, out_count, tag, 16);
+                    failures += check_bytes("GCM scatter-gather ciphertext", buffer, expected, length);
+                    failures += check_bytes("GCM scatter-gather tag", tag, expected_tag, sizeof(tag));
+                    in_count = split_iov(buffer, length, p, in_iov);
+                    if (aes_gcm_open_iov(&gcm, iv, 12, key, 20, in_iov, in_count, out_iov, out_count, tag, 16) !=
+                        AES_SUCCESS)
+                    {
+                        fprintf(stderr, "FAIL: A %zu-byte scatter-gather GCM message was rejected by %s.\n",
+                                length, aes_backend_name(test_backends[b]));
+                        failures++;
+                    }
+                    failures += check_bytes("GCM in-place scatter-gather decryption", buffer, plaintext, length);
+                }
+            }
+        }
+
+        aes_ctx_clear(&ctx);
+        aes_gcm_clear(&gcm);
+    }
+
+    // Error handling: short output, partial blocks, and a forged tag.
+    static const uint8_t zeros[64] = {0};
+    aes_ctx_t            ctx;
+    aes_gcm_ctx_t        gcm;
+
+    aes_ctx_init(&ctx, key, AES_KEY_SIZE_128);
+    aes_gcm_init(&gcm, key, AES_KEY_SIZE_128, AES_BACKEND_AUTO);
+    size_t in_count  = split_iov(plaintext, 64, 0, in_iov);
+    size_t out_count = split_iov(buffer, 48, 0, out_iov);
+    if (aes_ecb_encrypt_iov(&ctx, in_iov, in_count, out_iov, out_count) != AES_ERROR_INVALID_LENGTH ||
+        aes_ctr_xcrypt_iov(&ctx, chain, AES_CTR_WIDTH_32, in_iov, in_count, out_iov, out_count) !=
+            AES_ERROR_INVALID_LENGTH)
+    {
+        fprintf(stderr, "FAIL: A scatter-gather output shorter than the input was accepted.\n");
+        failures++;
+    }
+    in_count  = split_iov(plaintext, 40, 0, in_iov);
+    out_count = split_iov(buffer, 40, 2, out_iov);
+    if (aes_ecb_decrypt_iov(&ctx, in_iov, in_count, out_iov, out_count) != AES_ERROR_INVALID_LENGTH ||
+        aes_cbc_encrypt_iov(&ctx, chain, in_iov, in_count, out_iov, out_count) != AES_ERROR_INVALID_LENGTH)
+    {
+        fprintf(stderr, "FAIL: A scatter-gather ECB or CBC message with a partial block was accepted.\n");
+        failures++;
+    }
+
+    in_count  = split_iov(plaintext, 64, 0, in_iov);
+    out_count = split_iov(buffer, 64, 2, out_iov);
+    aes_gcm_seal_iov(&gcm, iv, 12, NULL, 0, in_iov, in_count, out_iov, out_count, tag, 16);
+    tag[0] ^= 1;
+    in_count = split_iov(buffer, 64, 0, in_iov);
+    if (aes_gcm_open_iov(&gcm, iv, 12, NULL, 0, in_iov, in_count, out_iov, out_count, tag, 16) !=
+        AES_ERROR_AUTHENTICATION_FAILED)
+    {
+        fprintf(stderr, "FAIL: A forged scatter-gather GCM tag was accepted.\n");
+        failures++;
+    }
+    failures += check_bytes("GCM scatter-gather output wiped on failure", buffer, zeros, sizeof(zeros));
+
+    aes_ctx_clear(&ctx);
+    aes_gcm_clear(&gcm);
+    return failures;
+}
+
+/* ============================================================================
+ * Main Test Function
+ * ========================================================================= */
+
+/**
+ * @brief The main entry point for the modes of operation test suite.
+ * @return 0 if all tests pass, 1 otherwise.
+ */
+int main(void)
+{
+    int failed_tests = 0;
+
+    failed_tests += run_ctr_tests();
+    failed_tests += run_ctr_width_tests();
+    failed_tests += run_cbc_tests();
+    failed_tests += run_cbc_padding_tests();
+    failed_tests += run_cbc_multi_tests();
+    failed_tests += run_xts_tests();
+    failed_tests += run_xts_sector_tests();
+    failed_tests += run_gcm_tests();
+    failed_tests += run_gcm_consistency_tests();
+    failed_tests += run_ocb_tests();
+    failed_tests += run_ocb_iterated_tests();
+    failed_tests += run_ocb_consistency_tests();
+    failed_tests += run_mac_tests(&cmac_ops, cmac_vectors, sizeof(cmac_vectors) / sizeof(cmac_vectors[0]));
+    failed_tests += run_mac_tests(&pmac_ops, pmac_vectors, sizeof(pmac_vectors) / sizeof(pmac_vectors[0]));
+    failed_tests += run_mac_consistency_tests(&cmac_ops);
+    failed_tests += run_mac_consistency_tests(&pmac_ops);
+    failed_tests += run_iov_tests();
+
+    if (failed_tests > 0)
+    {
+        fprintf(stderr, "\nSUMMARY: %d check(s) failed.\n", failed_tests);
+        return 1;
+    }
+
+    printf("\nSUMMARY: All tests passed successfully!\n");
+    return 0;
+}
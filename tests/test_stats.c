@@ -0,0 +1,317 @@
+/**
+ * @file test_stats.c
+ * @brief Unit tests for the statistics layer.
+ *
+ * @details With the layer compiled in, each counted operation must add
+ * exactly its calls, bytes and blocks to its operation and backend totals,
+ * sampled timing must reach the hook once per sampled call, and the counts
+ * of exited threads must survive in the snapshot. Compiled out, the snapshot
+ * must be empty.
+ */
+
+#include "../include/aes.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#ifdef AES_HAVE_PTHREADS
+#include <pthread.h>
+#endif
+
+/* ============================================================================
+ * Test Utilities
+ * ========================================================================= */
+
+/**
+ * @brief Checks the change of one counter between two snapshots.
+ * @return 0 if it matches, 1 otherwise.
+ */
+static int check_delta(const char* what, uint64_t before, uint64_t after, uint64_t expected)
+{
+    if (after - before == expected)
+        return 0;
+    fprintf(stderr, "FAIL: %s changed by %llu, expected %llu.\n", what, (unsigned long long)(after - before),
+            (unsigned long long)expected);
+    return 1;
+}
+
+//! An entropy source for the DRBG checks; the output is never inspected.
+static int test_entropy(void* arg, uint8_t* out, size_t length)
+{
+    (void)arg;
+    for (size_t i = 0; i < length; i++)
+        out[i] = (uint8_t)(i * 7 + 1);
+    return 0;
+}
+
+/* ============================================================================
+ * Counters
+ * ========================================================================= */
+
+/**
+ * @brief Runs one call of several modes on the reference backend and checks
+ * what each added to the snapshot.
+ */
+static int run_counter_tests(void)
+{
+    static uint8_t buffer[1024];
+    uint8_t        key[32] = {1, 2, 3}, iv[16] = {0}, tag[16];
+    aes_stats_t    before, after;
+    aes_ctx_t      ctx;
+    aes_gcm_ctx_t  gcm;
+    aes_drbg_ctx_t drbg;
+    int            failures = 0;
+
+    printf("\n--- Running Test Case: Per-operation and per-backend counters ---\n");
+    aes_stats_snapshot(&before);
+
+    aes_ctx_init_backend(&ctx, key, AES_KEY_SIZE_128, AES_BACKEND_REFERENCE);
+    aes_ecb_encrypt(&ctx, buffer, buffer, 1024);
+    aes_ctr_xcrypt(&ctx, iv, buffer, buffer, 100);
+    aes_cbc_encrypt(&ctx, iv, buffer, buffer, 64);
+    aes_gcm_init(&gcm, key, AES_KEY_SIZE_128, AES_BACKEND_REFERENCE);
+    aes_gcm_seal(&gcm, iv, 12, NULL, 0, buffer, buffer, 33, tag, sizeof(tag));
+    aes_drbg_init(&drbg, test_entropy, NULL, NULL, 0, AES_BACKEND_REFERENCE);
+
+    aes_stats_snapshot(&after);
+    failures += check_delta("ECB calls", before.ops[AES_STATS_ECB].calls, after.ops[AES_STATS_ECB].calls, 1);
+    failures += check_delta("ECB bytes", before.ops[AES_STATS_ECB].bytes, after.ops[AES_STATS_ECB].bytes, 1024);
+    failures += check_delta("ECB blocks", before.ops[AES_STATS_ECB].blocks, after.ops[AES_STATS_ECB].blocks, 64);
+    failures += check_delta("CTR bytes", before.ops[AES_STATS_CTR].bytes, after.ops[AES_STATS_CTR].bytes, 100);
+    failures += check_delta("CTR blocks", before.ops[AES_STATS_CTR].blocks, after.ops[AES_STATS_CTR].blocks, 7);
+    failures += check_delta("CBC bytes", before.ops[AES_STATS_CBC].bytes, after.ops[AES_STATS_CBC].bytes, 64);
+    failures += check_delta("GCM calls", before.ops[AES_STATS_GCM].calls, after.ops[AES_STATS_GCM].calls, 1);
+    failures += check_delta("GCM bytes", before.ops[AES_STATS_GCM].bytes, after.ops[AES_STATS_GCM].bytes, 33);
+
+    // The context, the GCM key, and the DRBG's Key = 0 and its first seed update.
+    failures += check_delta("key expansions", before.ops[AES_STATS_KEY_EXPANSION].calls,
+                            after.ops[AES_STATS_KEY_EXPANSION].calls, 4);
+    failures += check_delta("reference backend bytes", before.backends[AES_BACKEND_REFERENCE].bytes,
+                            after.backends[AES_BACKEND_REFERENCE].bytes, 1024 + 100 + 64 + 33);
+
+    before = after;
+    aes_drbg_generate(&drbg, buffer, 10);
+    aes_stats_snapshot(&after);
+    failures += check_delta("DRBG bytes", before.ops[AES_STATS_DRBG].bytes, after.ops[AES_STATS_DRBG].bytes, 10);
+    failures += check_delta("DRBG refill key expansions", before.ops[AES_STATS_KEY_EXPANSION].calls,
+                            after.ops[AES_STATS_KEY_EXPANSION].calls, 1);
+
+    // Rejected calls count nothing.
+    before = after;
+    aes_ecb_encrypt(&ctx, buffer, buffer, 15);
+    aes_stats_snapshot(&after);
+    failures += check_delta("ECB calls after a rejected call", before.ops[AES_STATS_ECB].calls,
+                            after.ops[AES_STATS_ECB].calls, 0);
+
+    if (after.default_backend != aes_get_default_backend())
+    {
+        fprintf(stderr, "FAIL: The snapshot reports the wrong default backend.\n");
+        failures++;
+    }
+
+    aes_ctx_clear(&ctx);
+    aes_gcm_clear(&gcm);
+    aes_drbg_clear(&drbg);
+    return failures;
+}
+
+/* ============================================================================
+ * Sampled Timing
+ * ========================================================================= */
+
+//! What the test hook has received.
+typedef struct
+{
+    unsigned calls;  /**< Measurements received. */
+    size_t   bytes;  /**< Their summed byte counts. */
+    uint64_t cycles; /**< Their summed durations. */
+} hook_log_t;
+
+/** @brief aes_stats_callback_fn that logs into a hook_log_t. */
+static void test_hook(void* arg, aes_stats_op_t op, aes_backend_t backend, size_t bytes, uint64_t cycles)
+{
+    hook_log_t* log = arg;
+
+    if (op == AES_STATS_ECB && backend == AES_BACKEND_REFERENCE)
+    {
+        log->calls++;
+        log->bytes += bytes;
+        log->cycles += cycles;
+    }
+}
+
+/** @brief Checks that one call in every interval is timed and reported to the hook. */
+static int run_timing_tests(void)
+{
+    uint8_t          key[16] = {0}, buffer[64] = {0};
+    hook_log_t       log     = {0};
+    aes_stats_hook_t hook    = {test_hook, &log};
+    aes_stats_t      before, after;
+    aes_ctx_t        ctx;
+    int              failures = 0;
+
+    printf("\n--- Running Test Case: Sampled timing and the hook ---\n");
+    aes_ctx_init_backend(&ctx, key, AES_KEY_SIZE_128, AES_BACKEND_REFERENCE);
+    aes_stats_set_hook(&hook);
+    aes_stats_set_sample_interval(1);
+    aes_stats_snapshot(&before);
+
+    for (int i = 0; i < 10; i++)
+        aes_ecb_encrypt(&ctx, buffer, buffer, sizeof(buffer));
+
+    aes_stats_snapshot(&after);
+    failures += check_delta("timed ECB calls", before.ops[AES_STATS_ECB].timed_calls,
+                            after.ops[AES_STATS_ECB].timed_calls, 10);
+    if (log.calls != 10 || log.bytes != 10 * sizeof(buffer) || log.cycles == 0)
+    {
+        fprintf(stderr, "FAIL: The hook received %u measurements of %zu bytes, expected 10 of %zu.\n", log.calls,
+                log.bytes, 10 * sizeof(buffer));
+        failures++;
+    }
+
+    // One in four calls is sampled; nothing reaches a removed hook.
+    aes_stats_set_sample_interval(4);
+    before = after;
+    for (int i = 0; i < 20; i++)
+        aes_ecb_encrypt(&ctx, buffer, buffer, sizeof(buffer));
+    aes_stats_snapshot(&after);
+    failures += check_delta("timed ECB calls at 1 in 4", before.ops[AES_STATS_ECB].timed_calls,
+                            after.ops[AES_STATS_ECB].timed_calls, 5);
+
+    aes_stats_set_hook(NULL);
+    aes_stats_set_sample_interval(1);
+    aes_ecb_encrypt(&ctx, buffer, buffer, sizeof(buffer));
+    if (log.calls != 15)
+    {
+        fprintf(stderr, "FAIL: The hook received %u measurements, expected 15.\n", log.calls);
+        failures++;
+    }
+
+    aes_stats_set_sample_interval(0);
+    aes_ctx_clear(&ctx);
+    return failures;
+}
+
+/* ============================================================================
+ * Threads
+ * ========================================================================= */
+
+#ifdef AES_HAVE_PTHREADS
+
+#define TEST_THREADS      4
+#define TEST_THREAD_CALLS 100
+
+/** @brief Runs TEST_THREAD_CALLS ECB calls on its own context. */
+static void* thread_worker(void* arg)
+{
+    uint8_t   key[16] = {0}, buffer[32] = {0};
+    aes_ctx_t ctx;
+
+    (void)arg;
+    aes_ctx_init_backend(&ctx, key, AES_KEY_SIZE_128, AES_BACKEND_REFERENCE);
+    for (int i = 0; i < TEST_THREAD_CALLS; i++)
+        aes_ecb_encrypt(&ctx, buffer, buffer, sizeof(buffer));
+    aes_ctx_clear(&ctx);
+    return NULL;
+}
+
+/** @brief Checks that the counts of threads that have exited are kept. */
+static int run_thread_tests(void)
+{
+    pthread_t   threads[TEST_THREADS];
+    aes_stats_t before, after;
+    int         failures = 0;
+
+    printf("\n--- Running Test Case: Counts of exited threads ---\n");
+    aes_stats_snapshot(&before);
+    for (int t = 0; t < TEST_THREADS; t++)
+        pthread_create(&threads[t], NULL, thread_worker, NULL);
+    for (int t = 0; t < TEST_THREADS; t++)
+        pthread_join(threads[t], NULL);
+    aes_stats_snapshot(&after);
+
+    failures += check_delta("ECB calls from exited threads", before.ops[AES_STATS_ECB].calls,
+                            after.ops[AES_STATS_ECB].calls, TEST_THREADS * TEST_THREAD_CALLS);
+    failures += check_delta("key expansions from exited threads", before.ops[AES_STATS_KEY_EXPANSION].calls,
+                            after.ops[AES_STATS_KEY_EXPANSION].calls, TEST_THREADS);
+    return failures;
+}
+
+#endif
+
+/* ============================================================================
+ * Compiled Out
+ * ========================================================================= */
+
+/** @brief Checks that a library built without the layer reports empty statistics. */
+static int run_disabled_tests(void)
+{
+    static const aes_stats_t empty = {0};
+    uint8_t                  key[16] = {0}, buffer[16] = {0};
+    aes_stats_t              stats;
+    aes_ctx_t                ctx;
+    int                      failures = 0;
+
+    printf("\n--- Running Test Case: Statistics compiled out ---\n");
+    aes_ctx_init(&ctx, key, AES_KEY_SIZE_128);
+    aes_ecb_encrypt(&ctx, buffer, buffer, sizeof(buffer));
+    aes_stats_set_sample_interval(1);
+
+    aes_stats_snapshot(&stats);
+    if (stats.default_backend != aes_get_default_backend())
+    {
+        fprintf(stderr, "FAIL: The snapshot reports the wrong default backend.\n");
+        failures++;
+    }
+    stats.default_backend = empty.default_backend;
+    if (memcmp(&stats, &empty, sizeof(stats)) != 0)
+    {
+        fprintf(stderr, "FAIL: A library without statistics reported nonzero counters.\n");
+        failures++;
+    }
+
+    aes_stats_set_sample_interval(0);
+    aes_ctx_clear(&ctx);
+    return failures;
+}
+
+/* ============================================================================
+ * Main Test Function
+ * ========================================================================= */
+
+/**
+ * @brief The main entry point for the statistics test suite.
+ * @return 0 if all tests pass, 1 otherwise.
+ */
+int main(void)
+{
+    int failed_tests = 0;
+
+    if (aes_stats_snapshot(NULL) != AES_ERROR_INVALID_ARGUMENT)
+    {
+        fprintf(stderr, "FAIL: aes_stats_snapshot() accepted NULL.\n");
+        failed_tests++;
+    }
+
+    if (aes_stats_enabled())
+    {
+        failed_tests += run_counter_tests();
+        failed_tests += run_timing_tests();
+#ifdef AES_HAVE_PTHREADS
+        failed_tests += run_thread_tests();
+#endif
+    }
+    else
+    {
+        failed_tests += run_disabled_tests();
+    }
+
+    if (failed_tests > 0)
+    {
+        fprintf(stderr, "\nSUMMARY: %d check(s) failed.\n", failed_tests);
+        return 1;
+    }
+
+    printf("\nSUMMARY: All tests passed successfully!\n");
+    return 0;
+}
@@ -0,0 +1,44 @@
+/**
+ * @file test_util.h
+ * @brief Helpers shared by the unit test programs.
+ *
+ * @details Each test is a single translation unit, so the helpers are static
+ * and every program that includes this header gets its own copy.
+ */
+
+#ifndef TEST_UTIL_H
+#define TEST_UTIL_H
+
+#include "../include/aes.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+//! Every explicit backend; tests skip those the CPU lacks.
+static const aes_backend_t test_backends[] = {AES_BACKEND_REFERENCE, AES_BACKEND_TTABLE, AES_BACKEND_AESNI,
+                                              AES_BACKEND_BITSLICE, AES_BACKEND_VPAES};
+
+#define TEST_BACKEND_COUNT (sizeof(test_backends) / sizeof(test_backends[0]))
+
+/**
+ * @brief Decodes a hexadecimal string into bytes.
+ * @param[in] hex A string of hexadecimal digit pairs.
+ * @param[out] out The output buffer.
+ * @param[in] max The capacity of out.
+ * @return The number of bytes written.
+ */
+static inline size_t hex_to_bytes(const char* hex, uint8_t* out, size_t max)
+{
+    size_t n = 0;
+    while (hex[0] && hex[1] && n < max)
+    {
+        unsigned value;
+        if (sscanf(hex, "%2x", &value) != 1)
+            break;
+        out[n++] = (uint8_t)value;
+        hex += 2;
+    }
+    return n;
+}
+
+#endif // TEST_UTIL_H
@@ -0,0 +1,502 @@
+/**
+ * @file aes_archive.c
+ * @brief Command-line packing and random-access reading of encrypted archives.
+ *
+ * @details Usage:
+ *
+ *     aes_archive pack (-k HEXKEY | -K KEYFILE) -i INPUT -o ARCHIVE [-m gcm|ocb] [-c CHUNK] [-d KEYID] [-t THREADS]
+ *     aes_archive info -i ARCHIVE
+ *     aes_archive read (-k HEXKEY | -K KEYFILE) -i ARCHIVE [-s OFFSET] [-n LENGTH] [-o OUTPUT] [-t THREADS]
+ *
+ * pack maps the input and the output and seals every chunk of the input
+ * straight from one mapping into the other on the multi-threaded engine.
+ * info prints the header, including the key id, without needing the key.
+ * read maps the archive with a random-access hint and decrypts only the
+ * chunks covering the requested range, a bounded window at a time, so a
+ * small read from a large archive faults in only the pages it needs. Output
+ * defaults to stdout. A window that fails to verify ends the read with a
+ * nonzero status; windows written before it have been verified.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "../include/aes.h"
+#include "tool_util.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/* ============================================================================
+ * Constants and Types
+ * ========================================================================= */
+
+// Plaintext bytes per chunk unless -c says otherwise.
+#define ARCHIVE_TOOL_CHUNK_SIZE (64 * 1024)
+
+// Plaintext bytes decrypted per window by the read command.
+#define ARCHIVE_TOOL_WINDOW_SIZE (8 * 1024 * 1024)
+
+//! The commands the tool understands.
+typedef enum
+{
+    TOOL_PACK,
+    TOOL_INFO,
+    TOOL_READ,
+} tool_command_t;
+
+//! Parsed command-line options and the resulting key.
+typedef struct
+{
+    tool_command_t     command;
+    aes_archive_mode_t mode;
+    const char*        input_path;
+    const char*        output_path;
+    uint32_t           chunk_size;
+    uint64_t           key_id;
+    uint64_t           offset;
+    uint64_t           length;
+    int                have_length;
+    unsigned           threads;
+    uint8_t            key[32];
+    aes_key_size_t     key_size;
+} tool_options_t;
+
+/* ============================================================================
+ * Utilities
+ * ========================================================================= */
+
+/** @brief Prints the usage text. */
+static void print_usage(const char* program)
+{
+    fprintf(stderr,
+            "Usage: %s pack (-k HEXKEY | -K KEYFILE) -i INPUT -o ARCHIVE [-m gcm|ocb] [-c CHUNK] [-d KEYID]\n"
+            "       %s info -i ARCHIVE\n"
+            "       %s read (-k HEXKEY | -K KEYFILE) -i ARCHIVE [-s OFFSET] [-n LENGTH] [-o OUTPUT]\n"
+            "  -m  Chunk mode for packing (default gcm).\n"
+            "  -c  Plaintext bytes per chunk, a multiple of 16 (default 65536).\n"
+            "  -d  A numeric key id to record in the header (default 0).\n"
+            "  -k  A 128, 192 or 256-bit key as hexadecimal digits.\n"
+            "  -K  A file holding a raw 16, 24 or 32-byte key.\n"
+            "  -s  First plaintext byte to read (default 0).\n"
+            "  -n  Bytes to read (default: to the end).\n"
+            "  -o  Output file for read (default stdout).\n"
+            "  -t  Worker threads (default: all online CPUs); accepted by pack and read.\n",
+            program, program, program);
+}
+
+/**
+ * @brief Parses an unsigned decimal (or 0x-prefixed hexadecimal) number.
+ * @return 0 on success, -1 if the string is not a number.
+ */
+static int parse_u64(const char* text, uint64_t* value)
+{
+    char* end;
+    errno  = 0;
+    *value = strtoull(text, &end, 0);
+    return errno == 0 && *text != '\0' && *text != '-' && *end == '\0' ? 0 : -1;
+}
+
+/**
+ * @brief Creates an engine with the requested thread count.
+ * @return The engine, or NULL after printing an error.
+ */
+static aes_engine_t* create_engine(const tool_options_t* options)
+{
+    aes_engine_config_t config = {0};
+    aes_engine_t*       engine = NULL;
+
+    config.num_threads = options->threads;
+    aes_error_t result = aes_engine_create(&engine, &config);
+    if (result != AES_SUCCESS)
+        fprintf(stderr, "Error: %s\n", aes_error_to_string(result));
+    return engine;
+}
+
+/**
+ * @brief Maps a whole archive read-only and parses its header.
+ * @return The mapping, or NULL after printing an error.
+ */
+static const uint8_t* map_archive(const char* path, aes_archive_info_t* info, size_t* size)
+{
+    struct stat st;
+    int         fd = open(path, O_RDONLY);
+    if (fd < 0)
+    {
+        perror(path);
+        return NULL;
+    }
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size < AES_ARCHIVE_HEADER_SIZE)
+    {
+        fprintf(stderr, "Error: %s is not an archive.\n", path);
+        close(fd);
+        return NULL;
+    }
+
+    *size              = (size_t)st.st_size;
+    const uint8_t* map = mmap(NULL, *size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED)
+    {
+        perror("mmap archive");
+        return NULL;
+    }
+    // Reads touch a few chunks and their index entries; read-ahead would only waste I/O.
+    posix_madvise((void*)map, *size, POSIX_MADV_RANDOM);
+
+    if (aes_archive_read_info(info, map, *size) != AES_SUCCESS)
+    {
+        fprintf(stderr, "Error: %s is not an archive or is truncated.\n", path);
+        munmap((void*)map, *size);
+        return NULL;
+    }
+    return map;
+}
+
+/* ============================================================================
+ * Commands
+ * ========================================================================= */
+
+/**
+ * @brief Seals the input file into a new archive.
+ * @return 0 on success, 1 on failure.
+ */
+static int run_pack(const tool_options_t* options)
+{
+    aes_archive_info_t info = {0};
+    aes_archive_ctx_t  archive;
+    struct stat        st;
+    uint64_t           size   = 0;
+    const uint8_t*     in     = NULL;
+    uint8_t*           out    = MAP_FAILED;
+    aes_engine_t*      engine = NULL;
+    int                status = 1;
+
+    int in_fd = open(options->input_path, O_RDONLY);
+    if (in_fd < 0)
+    {
+        perror(options->input_path);
+        return 1;
+    }
+    int out_fd = open(options->output_path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (out_fd < 0)
+    {
+        perror(options->output_path);
+        close(in_fd);
+        return 1;
+    }
+    if (fstat(in_fd, &st) != 0 || !S_ISREG(st.st_mode))
+    {
+        fprintf(stderr, "Error: The input must be a regular file.\n");
+        goto close_files;
+    }
+
+    info.mode       = options->mode;
+    info.key_size   = options->key_size;
+    info.chunk_size = options->chunk_size;
+    info.key_id     = options->key_id;
+    info.length     = (uint64_t)st.st_size;
+    if (random_bytes(info.nonce_base, sizeof(info.nonce_base)) != 0)
+    {
+        perror("random");
+        goto close_files;
+    }
+    size = aes_archive_size(&info);
+    if (size == 0 || size > SIZE_MAX ||
+        aes_archive_init(&archive, &info, options->key, AES_BACKEND_AUTO) != AES_SUCCESS)
+    {
+        fprintf(stderr, "Error: Invalid archive parameters.\n");
+        goto close_files;
+    }
+
+    if (info.length > 0)
+    {
+        in = mmap(NULL, (size_t)info.length, PROT_READ, MAP_SHARED, in_fd, 0);
+        if (in == MAP_FAILED)
+        {
+            perror("mmap input");
+            in = NULL;
+            goto clear_archive;
+        }
+        posix_madvise((void*)in, (size_t)info.length, POSIX_MADV_SEQUENTIAL);
+    }
+    if (ftruncate(out_fd, (off_t)size) != 0)
+    {
+        perror("ftruncate");
+        goto unmap;
+    }
+    out = mmap(NULL, (size_t)size, PROT_READ | PROT_WRITE, MAP_SHARED, out_fd, 0);
+    if (out == MAP_FAILED)
+    {
+        perror("mmap output");
+        goto unmap;
+    }
+
+    if ((engine = create_engine(options)) != NULL)
+    {
+        aes_error_t result = aes_archive_seal(&archive, engine, in, out);
+        if (result == AES_SUCCESS)
+            status = 0;
+        else
+            fprintf(stderr, "Error: %s\n", aes_error_to_string(result));
+        aes_engine_destroy(engine);
+    }
+
+unmap:
+    if (out != MAP_FAILED)
+        munmap(out, (size_t)size);
+    if (in)
+        munmap((void*)in, (size_t)info.length);
+clear_archive:
+    aes_archive_clear(&archive);
+close_files:
+    close(in_fd);
+    close(out_fd);
+    if (status != 0)
+        unlink(options->output_path);
+    return status;
+}
+
+/**
+ * @brief Prints the header of an archive.
+ * @return 0 on success, 1 on failure.
+ */
+static int run_info(const tool_options_t* options)
+{
+    aes_archive_info_t info;
+    size_t             size;
+    const uint8_t*     map = map_archive(options->input_path, &info, &size);
+    if (!map)
+        return 1;
+
+    printf("mode:       %s\n", info.mode == AES_ARCHIVE_MODE_GCM ? "gcm" : "ocb");
+    printf("key size:   %d bits\n", (int)info.key_size * 8);
+    printf("key id:     %" PRIu64 "\n", info.key_id);
+    printf("chunk size: %" PRIu32 "\n", info.chunk_size);
+    printf("length:     %" PRIu64 "\n", info.length);
+    printf("size:       %zu\n", size);
+    munmap((void*)map, size);
+    return 0;
+}
+
+/**
+ * @brief Decrypts a byte range of an archive to the output.
+ * @return 0 on success, 1 on failure.
+ */
+static int run_read(const tool_options_t* options)
+{
+    aes_archive_info_t info;
+    aes_archive_ctx_t  archive;
+    size_t             size;
+    aes_engine_t*      engine = NULL;
+    uint8_t*           window = NULL;
+    int                out_fd = STDOUT_FILENO;
+    int                status = 1;
+
+    const uint8_t* map = map_archive(options->input_path, &info, &size);
+    if (!map)
+        return 1;
+    if (info.key_size != options->key_size)
+    {
+        fprintf(stderr, "Error: The archive needs a %d-bit key.\n", (int)info.key_size * 8);
+        munmap((void*)map, size);
+        return 1;
+    }
+    if (aes_archive_init(&archive, &info, options->key, AES_BACKEND_AUTO) != AES_SUCCESS)
+    {
+        munmap((void*)map, size);
+        return 1;
+    }
+
+    uint64_t offset = options->offset;
+    if (offset > info.length || (options->have_length && options->length > info.length - offset))
+    {
+        fprintf(stderr, "Error: The range ends past the %" PRIu64 "-byte plaintext.\n", info.length);
+        goto done;
+    }
+    uint64_t remaining = options->have_length ? options->length : info.length - offset;
+
+    // Whole chunks per window, so that only the ends of the range are partial chunks.
+    size_t window_size = ARCHIVE_TOOL_WINDOW_SIZE / info.chunk_size * info.chunk_size;
+    if (window_size == 0)
+        window_size = info.chunk_size;
+    if ((window = malloc(window_size)) == NULL || (engine = create_engine(options)) == NULL)
+        goto done;
+    if (options->output_path && (out_fd = open(options->output_path, O_WRONLY | O_CREAT | O_TRUNC, 0600)) < 0)
+    {
+        perror(options->output_path);
+        goto done;
+    }
+
+    status = 0;
+    while (remaining > 0)
+    {
+        // The first window ends on a chunk boundary; later ones start on one.
+        size_t n = window_size - (size_t)(offset % info.chunk_size);
+        if (n > remaining)
+            n = (size_t)remaining;
+
+        aes_error_t result = aes_archive_read(&archive, engine, map, size, offset, window, n);
+        if (result != AES_SUCCESS)
+        {
+            fprintf(stderr, "Error: Bytes %" PRIu64 " to %" PRIu64 ": %s\n", offset, offset + n,
+                    aes_error_to_string(result));
+            status = 1;
+            break;
+        }
+        if (write_full(out_fd, window, n) != 0)
+        {
+            perror("write");
+            status = 1;
+            break;
+        }
+        offset += n;
+        remaining -= n;
+    }
+
+    if (options->output_path)
+        close(out_fd);
+done:
+    if (window)
+    {
+        wipe(window, window_size);
+        free(window);
+    }
+    aes_engine_destroy(engine);
+    aes_archive_clear(&archive);
+    munmap((void*)map, size);
+    return status;
+}
+
+/* ============================================================================
+ * Entry Point
+ * ========================================================================= */
+
+/**
+ * @brief Parses the command line.
+ * @return 0 on success, -1 on a usage error.
+ */
+static int parse_options(int argc, char** argv, tool_options_t* options)
+{
+    size_t   key_length = 0;
+    uint64_t value;
+
+    if (argc < 2)
+        return -1;
+    if (strcmp(argv[1], "pack") == 0)
+        options->command = TOOL_PACK;
+    else if (strcmp(argv[1], "info") == 0)
+        options->command = TOOL_INFO;
+    else if (strcmp(argv[1], "read") == 0)
+        options->command = TOOL_READ;
+    else
+        return -1;
+
+    options->mode       = AES_ARCHIVE_MODE_GCM;
+    options->chunk_size = ARCHIVE_TOOL_CHUNK_SIZE;
+    for (int i = 2; i < argc; i++)
+    {
+        const char* flag       = argv[i];
+        const char* value_text = i + 1 < argc ? argv[i + 1] : NULL;
+        if (!value_text || flag[0] != '-' || flag[1] == '\0' || flag[2] != '\0')
+            return -1;
+        i++;
+
+        switch (flag[1])
+        {
+            case 'm':
+                if (strcmp(value_text, "gcm") == 0)
+                    options->mode = AES_ARCHIVE_MODE_GCM;
+                else if (strcmp(value_text, "ocb") == 0)
+                    options->mode = AES_ARCHIVE_MODE_OCB;
+                else
+                    return -1;
+                break;
+            case 'c':
+                if (parse_u64(value_text, &value) != 0 || value == 0 || value > UINT32_MAX ||
+                    value % AES_BLOCK_SIZE != 0)
+                    return -1;
+                options->chunk_size = (uint32_t)value;
+                break;
+            case 'd':
+                if (parse_u64(value_text, &options->key_id) != 0)
+                    return -1;
+                break;
+            case 's':
+                if (parse_u64(value_text, &options->offset) != 0)
+                    return -1;
+                break;
+            case 'n':
+                if (parse_u64(value_text, &options->length) != 0)
+                    return -1;
+                options->have_length = 1;
+                break;
+            case 'k':
+                key_length = parse_hex_key(value_text, options->key);
+                break;
+            case 'K':
+                key_length = read_key_file(value_text, options->key);
+                break;
+            case 'i':
+                options->input_path = value_text;
+                break;
+            case 'o':
+                options->output_path = value_text;
+                break;
+            case 't':
+                options->threads = (unsigned)strtoul(value_text, NULL, 10);
+                break;
+            default:
+                return -1;
+        }
+    }
+
+    if (!options->input_path || (options->command == TOOL_PACK && !options->output_path))
+        return -1;
+    if (options->command != TOOL_INFO && key_length == 0)
+    {
+        fprintf(stderr, "Error: A 16, 24 or 32-byte key is required.\n");
+        return -1;
+    }
+    options->key_size = (aes_key_size_t)key_length;
+    return 0;
+}
+
+/**
+ * @brief The entry point of the archive tool.
+ * @return 0 on success, 1 on failure, 2 on a usage error.
+ */
+int main(int argc, char** argv)
+{
+    tool_options_t options = {0};
+    int            status;
+
+    if (parse_options(argc, argv, &options) != 0)
+    {
+        print_usage(argv[0]);
+        wipe(&options, sizeof(options));
+        return 2;
+    }
+
+    switch (options.command)
+    {
+        case TOOL_PACK:
+            status = run_pack(&options);
+            break;
+        case TOOL_INFO:
+            status = run_info(&options);
+            break;
+        default:
+            status = run_read(&options);
+            break;
+    }
+
+    wipe(&options, sizeof(options));
+    return status;
+}
@@ -0,0 +1,722 @@
+/**
+ * @file aes_cli.c
+ * @brief Command-line file and stream encryption with AES-CTR or AES-GCM.
+ *
+ * @details Usage:
+ *
+ *     aes_cli encrypt|decrypt [-m gcm|ctr] (-k HEXKEY | -K KEYFILE) [-i INPUT] [-o OUTPUT] [-t THREADS]
+ *
+ * Input and output default to stdin and stdout. When both are regular files
+ * they are memory-mapped and processed directly from the input mapping into
+ * the output mapping; CTR then runs on the multi-threaded engine across the
+ * whole file. Otherwise the input is read by a separate thread into two
+ * alternating buffers, so reading the next buffer overlaps with encrypting
+ * and writing the current one.
+ *
+ * Output starts with a 32-byte header carrying the mode, the key size and a
+ * random IV. In CTR mode the rest is the raw keystream XOR (confidentiality
+ * only). In GCM mode the plaintext is cut into records of AES_CLI_RECORD_SIZE
+ * bytes, each sealed with its own tag; the record index and a final-record
+ * flag are authenticated, so reordered, dropped or truncated records are
+ * detected. The final record is always shorter than a full one, and is empty
+ * when the plaintext is a whole number of records. When decrypting a stream,
+ * records are released as they verify, so a failure can leave verified output
+ * from earlier records; the exit status is then nonzero.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "../include/aes.h"
+#include "tool_util.h"
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/* ============================================================================
+ * Constants and Types
+ * ========================================================================= */
+
+#define AES_CLI_MAGIC       "AESC"
+#define AES_CLI_VERSION     1
+#define AES_CLI_HEADER_SIZE 32
+#define AES_CLI_TAG_SIZE    16
+#define AES_CLI_NONCE_SIZE  12
+
+// Plaintext bytes per GCM record, and the stream buffer size in CTR mode.
+#define AES_CLI_RECORD_SIZE (1024 * 1024)
+
+//! The bulk modes the tool can use.
+typedef enum
+{
+    CLI_MODE_CTR = 1,
+    CLI_MODE_GCM = 2,
+} cli_mode_t;
+
+//! Parsed command-line options and the resulting key state.
+typedef struct
+{
+    int            encrypt;
+    cli_mode_t     mode;
+    const char*    input_path;
+    const char*    output_path;
+    unsigned       threads;
+    uint8_t        key[32];
+    aes_key_size_t key_size;
+} cli_options_t;
+
+//! The fixed-size file header.
+typedef struct
+{
+    cli_mode_t     mode;
+    aes_key_size_t key_size;
+    uint8_t        iv[AES_BLOCK_SIZE];
+    uint32_t       record_size;
+    uint8_t        bytes[AES_CLI_HEADER_SIZE]; /**< The serialized header, authenticated in GCM mode. */
+} cli_header_t;
+
+//! Everything needed to transform a sequence of chunks.
+typedef struct
+{
+    const cli_options_t* options;
+    cli_header_t         header;
+    aes_ctx_t            ctx;
+    aes_gcm_ctx_t        gcm;
+    aes_engine_t*        engine;
+    uint8_t              counter[AES_BLOCK_SIZE];
+    uint64_t             record_index;
+} cli_state_t;
+
+/* ============================================================================
+ * Utilities
+ * ========================================================================= */
+
+/** @brief Prints the usage text. */
+static void print_usage(const char* program)
+{
+    fprintf(stderr,
+            "Usage: %s encrypt|decrypt [-m gcm|ctr] (-k HEXKEY | -K KEYFILE) [-i INPUT] [-o OUTPUT] [-t THREADS]\n"
+            "  -m  Bulk mode for encryption (default gcm); decryption reads it from the header.\n"
+            "  -k  A 128, 192 or 256-bit key as hexadecimal digits.\n"
+            "  -K  A file holding a raw 16, 24 or 32-byte key.\n"
+            "  -i  Input file (default stdin).\n"
+            "  -o  Output file (default stdout).\n"
+            "  -t  Worker threads for CTR (default: all online CPUs).\n",
+            program);
+}
+
+/** @brief Stores a 32-bit word in big-endian byte order. */
+static void put_be32(uint8_t* p, uint32_t v)
+{
+    p[0] = (uint8_t)(v >> 24);
+    p[1] = (uint8_t)(v >> 16);
+    p[2] = (uint8_t)(v >> 8);
+    p[3] = (uint8_t)v;
+}
+
+/** @brief Loads a big-endian 32-bit word. */
+static uint32_t get_be32(const uint8_t* p)
+{
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | (uint32_t)p[3];
+}
+
+/* ============================================================================
+ * Header
+ * ========================================================================= */
+
+/** @brief Serializes a header into header->bytes. */
+static void encode_header(cli_header_t* header)
+{
+    memset(header->bytes, 0, sizeof(header->bytes));
+    memcpy(header->bytes, AES_CLI_MAGIC, 4);
+    header->bytes[4] = AES_CLI_VERSION;
+    header->bytes[5] = (uint8_t)header->mode;
+    header->bytes[6] = (uint8_t)header->key_size;
+    memcpy(header->bytes + 8, header->iv, AES_BLOCK_SIZE);
+    put_be32(header->bytes + 24, header->record_size);
+}
+
+/**
+ * @brief Parses and validates header->bytes.
+ * @return 0 on success, -1 if the header is not one this tool wrote.
+ */
+static int decode_header(cli_header_t* header)
+{
+    if (memcmp(header->bytes, AES_CLI_MAGIC, 4) != 0 || header->bytes[4] != AES_CLI_VERSION)
+        return -1;
+
+    header->mode        = (cli_mode_t)header->bytes[5];
+    header->key_size    = (aes_key_size_t)header->bytes[6];
+    header->record_size = get_be32(header->bytes + 24);
+    memcpy(header->iv, header->bytes + 8, AES_BLOCK_SIZE);
+
+    if (header->mode != CLI_MODE_CTR && header->mode != CLI_MODE_GCM)
+        return -1;
+    if (header->mode == CLI_MODE_GCM && header->record_size != AES_CLI_RECORD_SIZE)
+        return -1;
+    return 0;
+}
+
+/* ============================================================================
+ * Chunk Processing
+ * ========================================================================= */
+
+/**
+ * @brief Prepares the cipher state once the header is known.
+ * @return 0 on success, -1 on error.
+ */
+static int init_state(cli_state_t* state)
+{
+    const cli_options_t* options = state->options;
+
+    if (state->header.key_size != options->key_size)
+    {
+        fprintf(stderr, "Error: The input was encrypted with a %d-bit key.\n", (int)state->header.key_size * 8);
+        return -1;
+    }
+
+    aes_error_t result = state->header.mode == CLI_MODE_GCM
+                             ? aes_gcm_init(&state->gcm, options->key, options->key_size, AES_BACKEND_AUTO)
+                             : aes_ctx_init(&state->ctx, options->key, options->key_size);
+    if (result == AES_SUCCESS && state->header.mode == CLI_MODE_CTR)
+    {
+        aes_engine_config_t config = {0};
+        config.num_threads         = options->threads;
+        result                     = aes_engine_create(&state->engine, &config);
+    }
+    if (result != AES_SUCCESS)
+    {
+        fprintf(stderr, "Error: %s.\n", aes_error_to_string(result));
+        return -1;
+    }
+
+    memcpy(state->counter, state->header.iv, AES_BLOCK_SIZE);
+    state->record_index = 0;
+    return 0;
+}
+
+/** @brief Releases the cipher state. */
+static void clear_state(cli_state_t* state)
+{
+    aes_engine_destroy(state->engine);
+    state->engine = NULL;
+    aes_ctx_clear(&state->ctx);
+    aes_gcm_clear(&state->gcm);
+}
+
+/**
+ * @brief Seals or opens one GCM record.
+ * @details The nonce is the header nonce with the record index XORed into its
+ * last eight bytes; the AAD is the header, the index and the final flag.
+ * @param[in,out] state The cipher state; the record index advances.
+ * @param[in] in The record input (plaintext, or ciphertext followed by the tag).
+ * @param[in] in_length The record input length.
+ * @param[out] out The record output.
+ * @param[in] last Nonzero for the final record.
+ * @return The output length, or -1 if the record did not verify.
+ */
+static ssize_t gcm_record(cli_state_t* state, const uint8_t* in, size_t in_length, uint8_t* out, int last)
+{
+    uint8_t nonce[AES_CLI_NONCE_SIZE];
+    uint8_t aad[AES_CLI_HEADER_SIZE + 9];
+    uint64_t index = state->record_index++;
+
+    memcpy(nonce, state->header.iv, sizeof(nonce));
+    for (int i = 0; i < 8; i++)
+        nonce[AES_CLI_NONCE_SIZE - 1 - i] ^= (uint8_t)(index >> (8 * i));
+
+    memcpy(aad, state->header.bytes, AES_CLI_HEADER_SIZE);
+    for (int i = 0; i < 8; i++)
+        aad[AES_CLI_HEADER_SIZE + 7 - i] = (uint8_t)(index >> (8 * i));
+    aad[AES_CLI_HEADER_SIZE + 8] = (uint8_t)(last ? 1 : 0);
+
+    if (state->options->encrypt)
+    {
+        aes_gcm_seal(&state->gcm, nonce, sizeof(nonce), aad, sizeof(aad), in, out, in_length, out + in_length,
+                     AES_CLI_TAG_SIZE);
+        return (ssize_t)(in_length + AES_CLI_TAG_SIZE);
+    }
+
+    if (in_length < AES_CLI_TAG_SIZE)
+        return -1;
+    size_t length = in_length - AES_CLI_TAG_SIZE;
+    if (aes_gcm_open(&state->gcm, nonce, sizeof(nonce), aad, sizeof(aad), in, out, length, in + length,
+                     AES_CLI_TAG_SIZE) != AES_SUCCESS)
+        return -1;
+    return (ssize_t)length;
+}
+
+/* ============================================================================
+ * Memory-Mapped Files
+ * ========================================================================= */
+
+/**
+ * @brief Computes the output size for a mapped input.
+ * @return The output size, or -1 if the input is malformed.
+ */
+static off_t mapped_output_size(const cli_state_t* state, size_t in_size)
+{
+    size_t record = state->header.record_size;
+
+    if (state->header.mode == CLI_MODE_CTR)
+        return (off_t)(state->options->encrypt ? in_size + AES_CLI_HEADER_SIZE : in_size - AES_CLI_HEADER_SIZE);
+    if (state->options->encrypt)
+        return (off_t)(AES_CLI_HEADER_SIZE + in_size + (in_size / record + 1) * AES_CLI_TAG_SIZE);
+
+    // Full records are followed by exactly one shorter, final record.
+    size_t body  = in_size - AES_CLI_HEADER_SIZE;
+    size_t full  = body / (record + AES_CLI_TAG_SIZE);
+    size_t final = body % (record + AES_CLI_TAG_SIZE);
+    if (final < AES_CLI_TAG_SIZE)
+        return -1;
+    return (off_t)(body - (full + 1) * AES_CLI_TAG_SIZE);
+}
+
+/**
+ * @brief Transforms a mapped input into a mapped output.
+ * @return 0 on success, -1 on error.
+ */
+static int process_mapped(cli_state_t* state, const uint8_t* in, size_t in_size, uint8_t* out, size_t out_size)
+{
+    if (state->options->encrypt)
+    {
+        memcpy(out, state->header.bytes, AES_CLI_HEADER_SIZE);
+        out += AES_CLI_HEADER_SIZE;
+    }
+    else
+    {
+        in += AES_CLI_HEADER_SIZE;
+        in_size -= AES_CLI_HEADER_SIZE;
+    }
+
+    if (state->header.mode == CLI_MODE_CTR)
+        return aes_engine_ctr_xcrypt(state->engine, &state->ctx, state->counter, AES_CTR_WIDTH_128, in, out,
+                                     in_size) == AES_SUCCESS
+                   ? 0
+                   : -1;
+
+    size_t record = state->header.record_size + (state->options->encrypt ? 0 : AES_CLI_TAG_SIZE);
+    for (;;)
+    {
+        size_t  chunk = in_size < record ? in_size : record;
+        int     last  = chunk < record;
+        ssize_t n     = gcm_record(state, in, chunk, out, last);
+        if (n < 0)
+            return -1;
+        in += chunk;
+        out += n;
+        in_size -= chunk;
+        if (last)
+            break;
+    }
+    (void)out_size;
+    return 0;
+}
+
+/**
+ * @brief Runs the whole operation on two regular files through mmap.
+ * @return 0 on success, 1 on failure.
+ */
+static int run_mapped(cli_state_t* state, int in_fd, size_t in_size, int out_fd)
+{
+    int status = 1;
+
+    const uint8_t* in = mmap(NULL, in_size, PROT_READ, MAP_SHARED, in_fd, 0);
+    if (in == MAP_FAILED)
+    {
+        perror("mmap input");
+        return 1;
+    }
+    posix_madvise((void*)in, in_size, POSIX_MADV_SEQUENTIAL);
+
+    if (state->options->encrypt)
+    {
+        if (random_bytes(state->header.iv, sizeof(state->header.iv)) != 0)
+        {
+            perror("random");
+            goto unmap_input;
+        }
+        encode_header(&state->header);
+    }
+    else
+    {
+        memcpy(state->header.bytes, in, in_size < AES_CLI_HEADER_SIZE ? in_size : AES_CLI_HEADER_SIZE);
+        if (in_size < AES_CLI_HEADER_SIZE || decode_header(&state->header) != 0)
+        {
+            fprintf(stderr, "Error: The input is not an aes_cli file.\n");
+            goto unmap_input;
+        }
+    }
+    if (init_state(state) != 0)
+        goto unmap_input;
+
+    off_t out_size = mapped_output_size(state, in_size);
+    if (out_size < 0)
+    {
+        fprintf(stderr, "Error: The input is truncated or corrupted.\n");
+        goto unmap_input;
+    }
+    if (ftruncate(out_fd, out_size) != 0)
+    {
+        perror("ftruncate");
+        goto unmap_input;
+    }
+
+    if (out_size == 0)
+    {
+        // Nothing to map; an empty GCM plaintext still has a tag to verify.
+        uint8_t empty[1];
+        status = process_mapped(state, in, in_size, empty, 0) == 0 ? 0 : 1;
+    }
+    else
+    {
+        uint8_t* out = mmap(NULL, (size_t)out_size, PROT_READ | PROT_WRITE, MAP_SHARED, out_fd, 0);
+        if (out == MAP_FAILED)
+        {
+            perror("mmap output");
+            goto unmap_input;
+        }
+        status = process_mapped(state, in, in_size, out, (size_t)out_size) == 0 ? 0 : 1;
+        munmap(out, (size_t)out_size);
+    }
+
+    if (status != 0)
+    {
+        fprintf(stderr, "Error: Authentication failed; no output was written.\n");
+        if (ftruncate(out_fd, 0) != 0)
+            perror("ftruncate");
+    }
+
+unmap_input:
+    munmap((void*)in, in_size);
+    return status;
+}
+
+/* ============================================================================
+ * Double-Buffered Streams
+ * ========================================================================= */
+
+//! A reader thread filling two alternating buffers.
+typedef struct
+{
+    int             fd;
+    size_t          size;       /**< The capacity of each buffer. */
+    uint8_t*        data[2];    /**< The buffers. */
+    size_t          length[2];  /**< Bytes held by each full buffer. */
+    int             full[2];    /**< Nonzero when a buffer is ready for the consumer. */
+    int             error;      /**< Set if a read failed. */
+    int             stop;       /**< Set by the consumer to end the reader early. */
+    pthread_mutex_t lock;
+    pthread_cond_t  changed;
+    pthread_t       thread;
+} cli_reader_t;
+
+/**
+ * @brief The reader loop: fill the free buffer, hand it over, repeat until a
+ * short read marks the end of the input.
+ * @details Cancellation is enabled only while reading, so a consumer that
+ * gives up can cancel a reader blocked on an idle pipe without it ever
+ * exiting with the lock held.
+ */
+static void* reader_main(void* arg)
+{
+    cli_reader_t* reader = arg;
+
+    pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, NULL);
+    for (int i = 0;; i ^= 1)
+    {
+        pthread_mutex_lock(&reader->lock);
+        while (reader->full[i] && !reader->stop)
+            pthread_cond_wait(&reader->changed, &reader->lock);
+        int stop = reader->stop;
+        pthread_mutex_unlock(&reader->lock);
+        if (stop)
+            break;
+
+        pthread_setcancelstate(PTHREAD_CANCEL_ENABLE, NULL);
+        ssize_t n = read_full(reader->fd, reader->data[i], reader->size);
+        pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, NULL);
+
+        pthread_mutex_lock(&reader->lock);
+        reader->error     = n < 0;
+        reader->length[i] = n < 0 ? 0 : (size_t)n;
+        reader->full[i]   = 1;
+        pthread_cond_broadcast(&reader->changed);
+        pthread_mutex_unlock(&reader->lock);
+
+        if (n < 0 || (size_t)n < reader->size)
+            break;
+    }
+    return NULL;
+}
+
+/** @brief Waits for buffer i to be full and returns its length, or -1 on a read error. */
+static ssize_t reader_take(cli_reader_t* reader, int i)
+{
+    pthread_mutex_lock(&reader->lock);
+    while (!reader->full[i])
+        pthread_cond_wait(&reader->changed, &reader->lock);
+    ssize_t n = reader->error ? -1 : (ssize_t)reader->length[i];
+    pthread_mutex_unlock(&reader->lock);
+    return n;
+}
+
+/** @brief Returns buffer i to the reader. */
+static void reader_release(cli_reader_t* reader, int i)
+{
+    pthread_mutex_lock(&reader->lock);
+    reader->full[i] = 0;
+    pthread_cond_broadcast(&reader->changed);
+    pthread_mutex_unlock(&reader->lock);
+}
+
+/**
+ * @brief Runs the operation on arbitrary file descriptors (pipes, terminals).
+ * @return 0 on success, 1 on failure.
+ */
+static int run_stream(cli_state_t* state, int in_fd, int out_fd)
+{
+    const cli_options_t* options = state->options;
+    int                  status  = 1;
+
+    if (options->encrypt)
+    {
+        if (random_bytes(state->header.iv, sizeof(state->header.iv)) != 0)
+        {
+            perror("random");
+            return 1;
+        }
+        encode_header(&state->header);
+        if (write_full(out_fd, state->header.bytes, AES_CLI_HEADER_SIZE) != 0)
+        {
+            perror("write");
+            return 1;
+        }
+    }
+    else if (read_full(in_fd, state->header.bytes, AES_CLI_HEADER_SIZE) != AES_CLI_HEADER_SIZE ||
+             decode_header(&state->header) != 0)
+    {
+        fprintf(stderr, "Error: The input is not an aes_cli file.\n");
+        return 1;
+    }
+    if (init_state(state) != 0)
+        return 1;
+
+    // GCM reads whole records; CTR uses the same buffer size.
+    size_t in_size  = AES_CLI_RECORD_SIZE + (state->header.mode == CLI_MODE_GCM && !options->encrypt
+                                                 ? AES_CLI_TAG_SIZE
+                                                 : 0);
+    size_t out_size = AES_CLI_RECORD_SIZE + AES_CLI_TAG_SIZE;
+
+    cli_reader_t reader = {0};
+    uint8_t*     output = malloc(out_size);
+    reader.fd           = in_fd;
+    reader.size         = in_size;
+    reader.data[0]      = malloc(in_size);
+    reader.data[1]      = malloc(in_size);
+    if (!output || !reader.data[0] || !reader.data[1])
+    {
+        fprintf(stderr, "Error: %s.\n", aes_error_to_string(AES_ERROR_MEMORY_ALLOCATION_FAILED));
+        goto free_buffers;
+    }
+
+    pthread_mutex_init(&reader.lock, NULL);
+    pthread_cond_init(&reader.changed, NULL);
+    if (pthread_create(&reader.thread, NULL, reader_main, &reader) != 0)
+    {
+        perror("pthread_create");
+        goto destroy_reader;
+    }
+
+    for (int i = 0;; i ^= 1)
+    {
+        ssize_t n = reader_take(&reader, i);
+        if (n < 0)
+        {
+            perror("read");
+            break;
+        }
+
+        size_t  length = (size_t)n;
+        int     last   = length < in_size;
+        ssize_t produced;
+        if (state->header.mode == CLI_MODE_CTR)
+        {
+            aes_engine_ctr_xcrypt(state->engine, &state->ctx, state->counter, AES_CTR_WIDTH_128, reader.data[i],
+                                  output, length);
+            produced = (ssize_t)length;
+        }
+        else
+        {
+            produced = gcm_record(state, reader.data[i], length, output, last);
+        }
+        reader_release(&reader, i);
+
+        if (produced < 0)
+        {
+            fprintf(stderr, "Error: Authentication failed at record %llu.\n",
+                    (unsigned long long)(state->record_index - 1));
+            break;
+        }
+        if (write_full(out_fd, output, (size_t)produced) != 0)
+        {
+            perror("write");
+            break;
+        }
+        if (last)
+        {
+            status = 0;
+            break;
+        }
+    }
+
+    pthread_mutex_lock(&reader.lock);
+    reader.stop = 1;
+    pthread_cond_broadcast(&reader.changed);
+    pthread_mutex_unlock(&reader.lock);
+    // On failure the reader may be blocked reading a source that never ends.
+    if (status != 0)
+        pthread_cancel(reader.thread);
+    pthread_join(reader.thread, NULL);
+
+destroy_reader:
+    pthread_cond_destroy(&reader.changed);
+    pthread_mutex_destroy(&reader.lock);
+free_buffers:
+    if (output)
+        wipe(output, out_size);
+    free(output);
+    free(reader.data[0]);
+    free(reader.data[1]);
+    return status;
+}
+
+/* ============================================================================
+ * Main Function
+ * ========================================================================= */
+
+/**
+ * @brief Parses the command line.
+ * @return 0 on success, -1 on a usage error.
+ */
+static int parse_options(int argc, char** argv, cli_options_t* options)
+{
+    size_t key_length = 0;
+
+    if (argc < 2)
+        return -1;
+    if (strcmp(argv[1], "encrypt") == 0)
+        options->encrypt = 1;
+    else if (strcmp(argv[1], "decrypt") != 0)
+        return -1;
+
+    options->mode = CLI_MODE_GCM;
+    for (int i = 2; i < argc; i++)
+    {
+        const char* flag  = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : NULL;
+        if (!value || flag[0] != '-' || flag[1] == '\0' || flag[2] != '\0')
+            return -1;
+        i++;
+
+        switch (flag[1])
+        {
+            case 'm':
+                if (strcmp(value, "gcm") == 0)
+                    options->mode = CLI_MODE_GCM;
+                else if (strcmp(value, "ctr") == 0)
+                    options->mode = CLI_MODE_CTR;
+                else
+                    return -1;
+                break;
+            case 'k':
+                key_length = parse_hex_key(value, options->key);
+                break;
+            case 'K':
+                key_length = read_key_file(value, options->key);
+                break;
+            case 'i':
+                options->input_path = value;
+                break;
+            case 'o':
+                options->output_path = value;
+                break;
+            case 't':
+                options->threads = (unsigned)strtoul(value, NULL, 10);
+                break;
+            default:
+                return -1;
+        }
+    }
+
+    if (key_length == 0)
+    {
+        fprintf(stderr, "Error: A 16, 24 or 32-byte key is required.\n");
+        return -1;
+    }
+    options->key_size = (aes_key_size_t)key_length;
+    return 0;
+}
+
+/**
+ * @brief The entry point of the command-line tool.
+ * @return 0 on success, 1 on failure, 2 on a usage error.
+ */
+int main(int argc, char** argv)
+{
+    cli_options_t options = {0};
+    cli_state_t   state   = {0};
+    int           in_fd   = STDIN_FILENO;
+    int           out_fd  = STDOUT_FILENO;
+    struct stat   in_stat, out_stat;
+    int           status;
+
+    if (parse_options(argc, argv, &options) != 0)
+    {
+        print_usage(argv[0]);
+        return 2;
+    }
+
+    state.options            = &options;
+    state.header.mode        = options.mode;
+    state.header.key_size    = options.key_size;
+    state.header.record_size = options.mode == CLI_MODE_GCM ? AES_CLI_RECORD_SIZE : 0;
+
+    if (options.input_path && (in_fd = open(options.input_path, O_RDONLY)) < 0)
+    {
+        perror(options.input_path);
+        return 1;
+    }
+    if (options.output_path && (out_fd = open(options.output_path, O_RDWR | O_CREAT | O_TRUNC, 0600)) < 0)
+    {
+        perror(options.output_path);
+        if (options.input_path)
+            close(in_fd);
+        return 1;
+    }
+
+    // Two non-empty regular files go through mmap; anything else is streamed.
+    if (fstat(in_fd, &in_stat) == 0 && fstat(out_fd, &out_stat) == 0 && S_ISREG(in_stat.st_mode) &&
+        S_ISREG(out_stat.st_mode) && in_stat.st_size > 0)
+        status = run_mapped(&state, in_fd, (size_t)in_stat.st_size, out_fd);
+    else
+        status = run_stream(&state, in_fd, out_fd);
+
+    // Close before the options (and with them the paths) are wiped; a failed
+    // close of the output can mean buffered data never reached the file.
+    if (options.input_path)
+        close(in_fd);
+    if (options.output_path && close(out_fd) != 0)
+    {
+        perror(options.output_path);
+        status = 1;
+    }
+    clear_state(&state);
+    wipe(&options, sizeof(options));
+    return status;
+}
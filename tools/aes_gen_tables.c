@@ -0,0 +1,478 @@
+/**
+ * @file aes_gen_tables.c
+ * @brief Build-time generator for the AES lookup tables.
+ *
+ * @details Derives the S-box, the inverse S-box, the key schedule round
+ * constants, the fused T-table round tables and the nibble tables of the
+ * vector-permute backend from aes_galois_mul(), the library's one definition
+ * of GF(2^8) arithmetic, and writes them as C source.
+ * Before writing anything it checks the field and the tables against their
+ * algebraic properties and the values published in FIPS-197, and fails the
+ * build if any check does not hold.
+ *
+ * Usage: aes_gen_tables OUTPUT.c
+ */
+
+#include "../src/aes_internal.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+/* ============================================================================
+ * Table Derivation
+ * ========================================================================= */
+
+//! The generated tables.
+typedef struct
+{
+    uint8_t  sbox[256];
+    uint8_t  rsbox[256];
+    uint8_t  rcon[32];
+    uint32_t te0[256];
+    uint32_t td0[256];
+    uint8_t  vpaes[AES_VPAES_TABLE_COUNT][16];
+} tables_t;
+
+/** @brief Returns the multiplicative inverse of a in GF(2^8) as a^254, with 0 mapped to 0. */
+static uint8_t gf_inverse(uint8_t a)
+{
+    uint8_t result = 1, square = a;
+    for (unsigned e = 254; e; e >>= 1)
+    {
+        if (e & 1)
+            result = aes_galois_mul(result, square);
+        square = aes_galois_mul(square, square);
+    }
+    return result;
+}
+
+/** @brief Rotates a byte left by n bits (0 < n < 8). */
+static uint8_t rotl8(uint8_t x, unsigned n)
+{
+    return (uint8_t)((x << n) | (x >> (8 - n)));
+}
+
+/** @brief Packs four bytes into a word, the first in the most significant byte. */
+static uint32_t pack(uint8_t b0, uint8_t b1, uint8_t b2, uint8_t b3)
+{
+    return ((uint32_t)b0 << 24) | ((uint32_t)b1 << 16) | ((uint32_t)b2 << 8) | (uint32_t)b3;
+}
+
+/** @brief Derives every table from the field definition (FIPS-197 sections 5.1.1 and 5.2). */
+static void derive_tables(tables_t* t)
+{
+    for (unsigned x = 0; x < 256; x++)
+    {
+        // SubBytes: the field inverse followed by the affine transformation.
+        uint8_t b = gf_inverse((uint8_t)x);
+        uint8_t s = (uint8_t)(b ^ rotl8(b, 1) ^ rotl8(b, 2) ^ rotl8(b, 3) ^ rotl8(b, 4) ^ 0x63);
+
+        t->sbox[x]  = s;
+        t->rsbox[s] = (uint8_t)x;
+    }
+
+    for (unsigned x = 0; x < 256; x++)
+    {
+        uint8_t s  = t->sbox[x];
+        uint8_t is = t->rsbox[x];
+
+        t->te0[x] = pack(aes_galois_mul(s, 2), s, s, aes_galois_mul(s, 3));
+        t->td0[x] = pack(aes_galois_mul(is, 14), aes_galois_mul(is, 9), aes_galois_mul(is, 13), aes_galois_mul(is, 11));
+    }
+
+    t->rcon[0] = 0;
+    t->rcon[1] = 1;
+    for (size_t i = 2; i < sizeof(t->rcon); i++)
+        t->rcon[i] = aes_galois_mul(t->rcon[i - 1], 2);
+}
+
+/* ============================================================================
+ * Vector-Permute Tables
+ * ========================================================================= */
+
+//! A GF(2^4)[u]/(u^2 + a.u + a) tower representation of the AES field.
+typedef struct
+{
+    uint8_t nibble_elem[16];  /**< The subfield element with each 4-bit code. */
+    uint8_t elem_nibble[256]; /**< The 4-bit code of each subfield element. */
+    uint8_t a;                /**< The subfield constant of the defining polynomial. */
+    uint8_t u;                /**< A root of u^2 + a.u + a outside the subfield. */
+    uint8_t phi[256];         /**< Each byte's tower coordinates, i in the high nibble and k in the low: x = i.u + k. */
+} tower_t;
+
+/** @brief Raises x to the power e in GF(2^8). */
+static uint8_t gf_pow(uint8_t x, unsigned e)
+{
+    uint8_t result = 1;
+    while (e--)
+        result = aes_galois_mul(result, x);
+    return result;
+}
+
+/** @brief The linear part of the S-box affine transformation (FIPS-197 equation 5.1, without {63}). */
+static uint8_t affine_linear(uint8_t b)
+{
+    return (uint8_t)(b ^ rotl8(b, 1) ^ rotl8(b, 2) ^ rotl8(b, 3) ^ rotl8(b, 4));
+}
+
+/**
+ * @brief Finds the subfield GF(2^4) inside the AES field and builds a quadratic tower over it.
+ * @return 0 on success, 1 if no suitable tower exists (which would mean a broken field).
+ */
+static int build_tower(tower_t* tw)
+{
+    uint8_t sub[16], g = 0;
+    size_t  n = 0;
+
+    for (unsigned x = 0; x < 256; x++)
+        if (gf_pow((uint8_t)x, 16) == x && n < 16)
+            sub[n++] = (uint8_t)x;
+    for (size_t i = 0; i < n && !g; i++)
+        if (sub[i] > 1 && gf_pow(sub[i], 3) != 1 && gf_pow(sub[i], 5) != 1)
+            g = sub[i];
+    if (n != 16 || !g)
+        return 1;
+
+    // Code the subfield in the basis {1, g, g^2, g^3}.
+    memset(tw->elem_nibble, 0xff, sizeof(tw->elem_nibble));
+    for (unsigned code = 0; code < 16; code++)
+    {
+        uint8_t e = 0;
+        for (unsigned b = 0; b < 4; b++)
+            if (code >> b & 1)
+                e ^= gf_pow(g, b);
+        tw->nibble_elem[code] = e;
+        tw->elem_nibble[e]    = (uint8_t)code;
+    }
+
+    // u^2 + a.u + a must have no root in the subfield, and a root u outside it.
+    tw->a = tw->u = 0;
+    for (size_t i = 0; i < 16 && !tw->a; i++)
+    {
+        int irreducible = sub[i] != 0;
+        for (size_t r = 0; r < 16 && irreducible; r++)
+            irreducible = (aes_galois_mul(sub[r], sub[r]) ^ aes_galois_mul(sub[i], sub[r]) ^ sub[i]) != 0;
+        if (irreducible)
+            tw->a = sub[i];
+    }
+    for (unsigned x = 0; x < 256 && tw->a && !tw->u; x++)
+        if (tw->elem_nibble[x] == 0xff &&
+            (aes_galois_mul((uint8_t)x, (uint8_t)x) ^ aes_galois_mul(tw->a, (uint8_t)x) ^ tw->a) == 0)
+            tw->u = (uint8_t)x;
+    if (!tw->u)
+        return 1;
+
+    for (unsigned i = 0; i < 16; i++)
+        for (unsigned k = 0; k < 16; k++)
+            tw->phi[aes_galois_mul(tw->nibble_elem[i], tw->u) ^ tw->nibble_elem[k]] = (uint8_t)(i << 4 | k);
+    return 0;
+}
+
+/** @brief A pshufb lookup of one byte: 0 if bit 7 of the index is set, otherwise table[index & 15]. */
+static uint8_t shuffle(const uint8_t* table, uint8_t index)
+{
+    return (index & 0x80) ? 0 : table[index & 15];
+}
+
+/**
+ * @brief The backend's inversion on one tower-basis byte, exactly as the vector code runs it.
+ * @details With i and k the coordinates and j = i ^ k, it yields
+ * io = 1/(1/i + a/k) + j and jo = 1/(1/j + a/k) + i, where 0x80 stands for
+ * infinity. Both are the norm of x divided by a linear form in (i, k), so
+ * 1/io and 1/jo are linear in 1/x and an _IO/_JO table pair maps them back.
+ */
+static void vpaes_invert(const uint8_t (*v)[16], uint8_t x, uint8_t* io, uint8_t* jo)
+{
+    uint8_t i = x >> 4, k = x & 15, j = i ^ k;
+    uint8_t ak  = shuffle(v[AES_VPAES_INVA], k);
+    uint8_t iak = shuffle(v[AES_VPAES_INV], i) ^ ak;
+    uint8_t jak = shuffle(v[AES_VPAES_INV], j) ^ ak;
+
+    *io = shuffle(v[AES_VPAES_INV], iak) ^ j;
+    *jo = shuffle(v[AES_VPAES_INV], jak) ^ i;
+}
+
+/** @brief Looks up an _IO/_JO table pair starting at row and XORs the halves. */
+static uint8_t lookup_pair(const uint8_t (*v)[16], unsigned row, uint8_t io, uint8_t jo)
+{
+    return shuffle(v[row], io) ^ shuffle(v[row + 1], jo);
+}
+
+/**
+ * @brief Derives the vector-permute tables.
+ * @details Encryption holds the state in the tower basis phi, decryption in
+ * psi = phi . A^-1 with A the linear part of the S-box affine map, so that
+ * the input of every inversion is a tower-basis byte.
+ * @return 0 on success, 1 if the tower cannot be built.
+ */
+static int derive_vpaes_tables(tables_t* t)
+{
+    static const struct
+    {
+        unsigned row;
+        uint8_t  factor;
+    } dsb[] = {{AES_VPAES_DSB9_IO, 9}, {AES_VPAES_DSBB_IO, 11}, {AES_VPAES_DSBD_IO, 13}, {AES_VPAES_DSBE_IO, 14}};
+    uint8_t (*v)[16] = t->vpaes;
+    tower_t  tw;
+    uint8_t  psi[256], affine_inv[256], base[2][16] = {{0}};
+
+    if (build_tower(&tw) != 0)
+        return 1;
+    for (unsigned x = 0; x < 256; x++)
+        affine_inv[affine_linear((uint8_t)x)] = (uint8_t)x;
+    for (unsigned x = 0; x < 256; x++)
+        psi[x] = tw.phi[affine_inv[x]];
+
+    v[AES_VPAES_INV][0] = v[AES_VPAES_INVA][0] = 0x80;
+    for (unsigned n = 1; n < 16; n++)
+    {
+        uint8_t inverse      = gf_inverse(tw.nibble_elem[n]);
+        v[AES_VPAES_INV][n]  = tw.elem_nibble[inverse];
+        v[AES_VPAES_INVA][n] = tw.elem_nibble[aes_galois_mul(tw.a, inverse)];
+    }
+    for (unsigned n = 0; n < 16; n++)
+    {
+        v[AES_VPAES_IPT_LO][n]  = tw.phi[n];
+        v[AES_VPAES_IPT_HI][n]  = tw.phi[n << 4];
+        v[AES_VPAES_DIPT_LO][n] = psi[n];
+        v[AES_VPAES_DIPT_HI][n] = psi[n << 4];
+    }
+
+    // Where one index is infinite, the other alone gives 1/x; linearity covers the rest.
+    for (unsigned x = 0; x < 256; x++)
+    {
+        uint8_t io, jo;
+        vpaes_invert((const uint8_t(*)[16])v, tw.phi[x], &io, &jo);
+        if ((jo & 0x80) && !(io & 0x80))
+            base[0][io] = gf_inverse((uint8_t)x);
+        if ((io & 0x80) && !(jo & 0x80))
+            base[1][jo] = gf_inverse((uint8_t)x);
+    }
+
+    for (unsigned half = 0; half < 2; half++)
+    {
+        for (unsigned n = 0; n < 16; n++)
+        {
+            uint8_t y = base[half][n];
+
+            v[AES_VPAES_SB1_IO + half][n]  = tw.phi[affine_linear(y)];
+            v[AES_VPAES_SB2_IO + half][n]  = tw.phi[aes_galois_mul(2, affine_linear(y))];
+            v[AES_VPAES_SBO_IO + half][n]  = affine_linear(y);
+            v[AES_VPAES_DSBO_IO + half][n] = y;
+            for (size_t m = 0; m < sizeof(dsb) / sizeof(dsb[0]); m++)
+                v[dsb[m].row + half][n] = psi[aes_galois_mul(dsb[m].factor, y)];
+        }
+    }
+    return 0;
+}
+
+/* ============================================================================
+ * Checks
+ * ========================================================================= */
+
+// Reports a failed check and counts it.
+#define CHECK(cond, ...)                                                                                               \
+    do                                                                                                                 \
+    {                                                                                                                  \
+        if (!(cond))                                                                                                   \
+        {                                                                                                              \
+            fprintf(stderr, "aes_gen_tables: check failed: " __VA_ARGS__);                                             \
+            fputc('\n', stderr);                                                                                       \
+            failures++;                                                                                                \
+        }                                                                                                              \
+    } while (0)
+
+/**
+ * @brief Checks the field and the derived tables.
+ * @return The number of failed checks.
+ */
+static int check_tables(const tables_t* t)
+{
+    int failures = 0;
+
+    // The field: {02} * {80} reduces by the AES polynomial, the FIPS-197 section 4.2
+    // example holds, multiplication commutes and every nonzero element is invertible.
+    CHECK(aes_galois_mul(0x80, 0x02) == 0x1b, "{80}.{02} = {1b}");
+    CHECK(aes_galois_mul(0x57, 0x83) == 0xc1, "{57}.{83} = {c1}");
+    CHECK(aes_galois_mul(0x57, 0x13) == 0xfe, "{57}.{13} = {fe}");
+    for (unsigned a = 0; a < 256; a++)
+    {
+        for (unsigned b = a; b < 256; b++)
+            CHECK(aes_galois_mul((uint8_t)a, (uint8_t)b) == aes_galois_mul((uint8_t)b, (uint8_t)a), "commutes");
+        if (a != 0)
+            CHECK(aes_galois_mul((uint8_t)a, gf_inverse((uint8_t)a)) == 1, "{%02x} is invertible", a);
+    }
+
+    // The S-boxes: mutually inverse permutations without fixed or opposite fixed points.
+    for (unsigned x = 0; x < 256; x++)
+    {
+        CHECK(t->rsbox[t->sbox[x]] == x && t->sbox[t->rsbox[x]] == x, "S-boxes are inverse at {%02x}", x);
+        CHECK(t->sbox[x] != x && t->sbox[x] != (uint8_t)~x, "S({%02x}) is not a (opposite) fixed point", x);
+    }
+
+    // Published values: FIPS-197 Figure 7, Figure 14 and Appendix A.1.
+    CHECK(t->sbox[0x00] == 0x63 && t->sbox[0x53] == 0xed && t->sbox[0xff] == 0x16, "S-box matches Figure 7");
+    CHECK(t->rsbox[0x00] == 0x52 && t->rsbox[0xed] == 0x53 && t->rsbox[0xff] == 0x7d, "InvS-box matches Figure 14");
+    CHECK(t->rcon[1] == 0x01 && t->rcon[9] == 0x1b && t->rcon[10] == 0x36, "Rcon matches Appendix A.1");
+
+    // The fused tables: each entry is the MixColumns or InvMixColumns column of one substituted byte.
+    for (unsigned x = 0; x < 256; x++)
+    {
+        uint8_t s = t->sbox[x];
+        CHECK((t->te0[x] >> 16 & 0xff) == s && (t->te0[x] >> 8 & 0xff) == s &&
+                  (uint8_t)((t->te0[x] >> 24) ^ s) == (uint8_t)t->te0[x],
+              "Te0[{%02x}] is the column {02, 01, 01, 03}.S[x]", x);
+    }
+    CHECK(t->te0[0x00] == 0xc66363a5U && t->te0[0xff] == 0x2c16163aU, "Te0 matches its published values");
+    CHECK(t->td0[0x00] == 0x51f4a750U && t->td0[0xff] == 0xd0b85742U, "Td0 matches its published values");
+
+    return failures;
+}
+
+/**
+ * @brief Checks the vector-permute tables by running the backend's S-box on every byte.
+ * @return The number of failed checks.
+ */
+static int check_vpaes_tables(const tables_t* t)
+{
+    const uint8_t (*v)[16] = (const uint8_t(*)[16])t->vpaes;
+    uint8_t       phi[256], psi[256];
+    int           failures = 0;
+
+    // The basis changes must be linear bijections: MixColumns and the round keys rely on it.
+    for (unsigned x = 0; x < 256; x++)
+    {
+        phi[x] = v[AES_VPAES_IPT_LO][x & 15] ^ v[AES_VPAES_IPT_HI][x >> 4];
+        psi[x] = v[AES_VPAES_DIPT_LO][x & 15] ^ v[AES_VPAES_DIPT_HI][x >> 4];
+    }
+    for (unsigned a = 0; a < 16; a++)
+        for (unsigned b = 0; b < 16; b++)
+            CHECK(v[AES_VPAES_IPT_LO][a ^ b] == (v[AES_VPAES_IPT_LO][a] ^ v[AES_VPAES_IPT_LO][b]) &&
+                      v[AES_VPAES_IPT_HI][a ^ b] == (v[AES_VPAES_IPT_HI][a] ^ v[AES_VPAES_IPT_HI][b]) &&
+                      v[AES_VPAES_DIPT_LO][a ^ b] == (v[AES_VPAES_DIPT_LO][a] ^ v[AES_VPAES_DIPT_LO][b]) &&
+                      v[AES_VPAES_DIPT_HI][a ^ b] == (v[AES_VPAES_DIPT_HI][a] ^ v[AES_VPAES_DIPT_HI][b]),
+                  "basis changes are linear at {%x}, {%x}", a, b);
+    for (unsigned x = 1; x < 256; x++)
+        CHECK(phi[x] != 0 && psi[x] != 0, "basis changes are bijective at {%02x}", x);
+
+    for (unsigned x = 0; x < 256; x++)
+    {
+        uint8_t io, jo, s = t->sbox[x], is = t->rsbox[x];
+
+        vpaes_invert(v, phi[x], &io, &jo);
+        CHECK((lookup_pair(v, AES_VPAES_SBO_IO, io, jo) ^ 0x63) == s, "vpaes S({%02x})", x);
+        CHECK(lookup_pair(v, AES_VPAES_SB1_IO, io, jo) == (phi[s] ^ phi[0x63]), "vpaes sb1({%02x})", x);
+        CHECK(lookup_pair(v, AES_VPAES_SB2_IO, io, jo) == (phi[aes_galois_mul(2, s)] ^ phi[aes_galois_mul(2, 0x63)]),
+              "vpaes sb2({%02x})", x);
+
+        vpaes_invert(v, psi[x] ^ psi[0x63], &io, &jo);
+        CHECK(lookup_pair(v, AES_VPAES_DSBO_IO, io, jo) == is, "vpaes IS({%02x})", x);
+        CHECK(lookup_pair(v, AES_VPAES_DSB9_IO, io, jo) == psi[aes_galois_mul(9, is)], "vpaes dsb9({%02x})", x);
+        CHECK(lookup_pair(v, AES_VPAES_DSBB_IO, io, jo) == psi[aes_galois_mul(11, is)], "vpaes dsbb({%02x})", x);
+        CHECK(lookup_pair(v, AES_VPAES_DSBD_IO, io, jo) == psi[aes_galois_mul(13, is)], "vpaes dsbd({%02x})", x);
+        CHECK(lookup_pair(v, AES_VPAES_DSBE_IO, io, jo) == psi[aes_galois_mul(14, is)], "vpaes dsbe({%02x})", x);
+    }
+    return failures;
+}
+
+/* ============================================================================
+ * Output
+ * ========================================================================= */
+
+/** @brief Writes a byte table, sixteen entries per line. */
+static void write_bytes(FILE* out, const char* comment, const char* name, const uint8_t* table, size_t n)
+{
+    fprintf(out, "\n//! %s\nconst uint8_t %s[%zu] = {\n", comment, name, n);
+    for (size_t i = 0; i < n; i++)
+        fprintf(out, "%s0x%02x,%s", i % 16 == 0 ? "    " : " ", table[i], i % 16 == 15 || i + 1 == n ? "\n" : "");
+    fputs("};\n", out);
+}
+
+/** @brief Writes a word table, eight entries per line. */
+static void write_words(FILE* out, const char* comment, const char* name, const uint32_t* table, size_t n)
+{
+    fprintf(out, "\n//! %s\nconst uint32_t %s[%zu] = {\n", comment, name, n);
+    for (size_t i = 0; i < n; i++)
+        fprintf(out, "%s0x%08xU,%s", i % 8 == 0 ? "    " : " ", (unsigned)table[i], i % 8 == 7 ? "\n" : "");
+    fputs("};\n", out);
+}
+
+/** @brief Writes the vector-permute tables, one designated row per line. */
+static void write_vpaes(FILE* out, const tables_t* t)
+{
+    static const char* const rows[AES_VPAES_TABLE_COUNT] = {
+        "INV",     "INVA",    "IPT_LO",  "IPT_HI",  "SB1_IO",  "SB1_JO",  "SB2_IO",  "SB2_JO",
+        "SBO_IO",  "SBO_JO",  "DIPT_LO", "DIPT_HI", "DSB9_IO", "DSB9_JO", "DSBB_IO", "DSBB_JO",
+        "DSBD_IO", "DSBD_JO", "DSBE_IO", "DSBE_JO", "DSBO_IO", "DSBO_JO",
+    };
+
+    fputs("\n//! The vector-permute backend's nibble tables.\n"
+          "_Alignas(16) const uint8_t aes_vpaes_tables[AES_VPAES_TABLE_COUNT][16] = {\n",
+          out);
+    for (size_t r = 0; r < AES_VPAES_TABLE_COUNT; r++)
+    {
+        fprintf(out, "    [AES_VPAES_%s] = {", rows[r]);
+        for (size_t i = 0; i < 16; i++)
+            fprintf(out, "0x%02x%s", t->vpaes[r][i], i == 15 ? "},\n" : ", ");
+    }
+    fputs("};\n", out);
+}
+
+/**
+ * @brief The entry point: derives, checks and writes the tables.
+ * @return 0 on success, 1 if a check fails or the output cannot be written.
+ */
+int main(int argc, char** argv)
+{
+    static tables_t tables;
+
+    if (argc != 2)
+    {
+        fprintf(stderr, "usage: aes_gen_tables OUTPUT.c\n");
+        return 1;
+    }
+
+    derive_tables(&tables);
+    if (derive_vpaes_tables(&tables) != 0)
+    {
+        fprintf(stderr, "aes_gen_tables: the field has no GF(2^4) tower\n");
+        return 1;
+    }
+    int failures = check_tables(&tables) + check_vpaes_tables(&tables);
+    if (failures != 0)
+    {
+        fprintf(stderr, "aes_gen_tables: %d check(s) failed, no tables written\n", failures);
+        return 1;
+    }
+
+    FILE* out = fopen(argv[1], "w");
+    if (!out)
+    {
+        perror(argv[1]);
+        return 1;
+    }
+
+    fputs("/**\n"
+          " * @file aes_tables.c\n"
+          " * @brief The AES lookup tables, generated from aes_galois_mul() by aes_gen_tables.\n"
+          " *\n"
+          " * @details Generated at build time. Do not edit.\n"
+          " */\n\n"
+          "#include \"aes_internal.h\"\n",
+          out);
+    write_bytes(out, "The AES Substitution Box (S-Box).", "aes_sbox", tables.sbox, sizeof(tables.sbox));
+    write_bytes(out, "The AES Inverse Substitution Box (InvS-Box).", "aes_rsbox", tables.rsbox, sizeof(tables.rsbox));
+    write_bytes(out, "The key schedule round constants.", "aes_rcon", tables.rcon, sizeof(tables.rcon));
+    write_words(out, "Encryption round table: {02}.S[x] || S[x] || S[x] || {03}.S[x].", "aes_te0", tables.te0, 256);
+    write_words(out, "Decryption round table: {0e}.IS[x] || {09}.IS[x] || {0d}.IS[x] || {0b}.IS[x].", "aes_td0",
+                tables.td0, 256);
+    write_vpaes(out, &tables);
+
+    if (fclose(out) != 0)
+    {
+        perror(argv[1]);
+        remove(argv[1]);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,111 @@
+/**
+ * @file tool_util.c
+ * @brief File, key and randomness helpers shared by the command-line tools.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "tool_util.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+
+void wipe(void* data, size_t size)
+{
+    volatile uint8_t* p = data;
+    while (size--)
+        *p++ = 0;
+}
+
+ssize_t read_full(int fd, uint8_t* buffer, size_t size)
+{
+    size_t done = 0;
+    while (done < size)
+    {
+        ssize_t n = read(fd, buffer + done, size - done);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n < 0)
+            return -1;
+        if (n == 0)
+            break;
+        done += (size_t)n;
+    }
+    return (ssize_t)done;
+}
+
+int write_full(int fd, const uint8_t* buffer, size_t size)
+{
+    while (size > 0)
+    {
+        ssize_t n = write(fd, buffer, size);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return -1;
+        buffer += n;
+        size -= (size_t)n;
+    }
+    return 0;
+}
+
+/** @brief Returns the value of one hexadecimal digit, or -1 if c is not one. */
+static int hex_value(char c)
+{
+    if (c >= '0' && c <= '9')
+        return c - '0';
+    if (c >= 'a' && c <= 'f')
+        return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F')
+        return c - 'A' + 10;
+    return -1;
+}
+
+size_t parse_hex_key(const char* hex, uint8_t* key)
+{
+    size_t len = strlen(hex);
+    if (len != 32 && len != 48 && len != 64)
+        return 0;
+
+    for (size_t i = 0; i < len / 2; i++)
+    {
+        int high = hex_value(hex[2 * i]);
+        int low  = hex_value(hex[2 * i + 1]);
+        if (high < 0 || low < 0)
+        {
+            wipe(key, i);
+            return 0;
+        }
+        key[i] = (uint8_t)(high << 4 | low);
+    }
+    return len / 2;
+}
+
+size_t read_key_file(const char* path, uint8_t* key)
+{
+    uint8_t buffer[33];
+    int     fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return 0;
+
+    ssize_t n = read_full(fd, buffer, sizeof(buffer));
+    close(fd);
+    if (n == 16 || n == 24 || n == 32)
+        memcpy(key, buffer, (size_t)n);
+    else
+        n = 0;
+
+    wipe(buffer, sizeof(buffer));
+    return (size_t)n;
+}
+
+int random_bytes(uint8_t* buffer, size_t size)
+{
+    int fd = open("/dev/urandom", O_RDONLY);
+    if (fd < 0)
+        return -1;
+    ssize_t n = read_full(fd, buffer, size);
+    close(fd);
+    return n == (ssize_t)size ? 0 : -1;
+}
@@ -0,0 +1,48 @@
+/**
+ * @file tool_util.h
+ * @brief File, key and randomness helpers shared by the command-line tools.
+ */
+
+#ifndef TOOL_UTIL_H
+#define TOOL_UTIL_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+/** @brief Clears sensitive memory in a way the compiler cannot elide. */
+void wipe(void* data, size_t size);
+
+/**
+ * @brief Reads until the buffer is full or the input ends.
+ * @return The number of bytes read, or -1 on error.
+ */
+ssize_t read_full(int fd, uint8_t* buffer, size_t size);
+
+/**
+ * @brief Writes the whole buffer.
+ * @return 0 on success, -1 on error.
+ */
+int write_full(int fd, const uint8_t* buffer, size_t size);
+
+/**
+ * @brief Decodes a hexadecimal key.
+ * @details The string must be exactly 32, 48 or 64 hexadecimal digits; any
+ * other character rejects it, and whatever was decoded into key is wiped.
+ * @return The key size in bytes, or 0 if the string is not a valid key.
+ */
+size_t parse_hex_key(const char* hex, uint8_t* key);
+
+/**
+ * @brief Reads a raw key file.
+ * @return The key size in bytes, or 0 if the file is not a valid key.
+ */
+size_t read_key_file(const char* path, uint8_t* key);
+
+/**
+ * @brief Fills a buffer from the system random source.
+ * @return 0 on success, -1 on error.
+ */
+int random_bytes(uint8_t* buffer, size_t size);
+
+#endif // TOOL_UTIL_H